@@ -662,6 +662,16 @@ ZMQ_EXPORT void zmq_threadclose (void *thread_);
 #define ZMQ_NORM_NUM_PARITY 122
 #define ZMQ_NORM_NUM_AUTOPARITY 123
 #define ZMQ_NORM_PUSH 124
+#define ZMQ_OUT_IOV_THRESHOLD 125
+#define ZMQ_ZEROCOPY_THRESHOLD 126
+#define ZMQ_UDP_BATCH_SIZE 127
+#define ZMQ_SPIN_TIME 128
+#define ZMQ_SPIN_ADAPTIVE 129
+#define ZMQ_CORK_DELAY 130
+#define ZMQ_CORK_SIZE 131
+#define ZMQ_MEMFD_THRESHOLD 132
+#define ZMQ_REBALANCE_IVL 133
+#define ZMQ_SHM_SPIN 134
 
 /*  DRAFT ZMQ_NORM_MODE options                                               */
 #define ZMQ_NORM_FIXED 0
@@ -677,6 +687,28 @@ ZMQ_EXPORT void zmq_threadclose (void *thread_);
 
 /*  DRAFT Context options                                                     */
 #define ZMQ_ZERO_COPY_RECV 10
+#define ZMQ_MSG_ALLOCATOR 11
+#define ZMQ_MSG_POOL 12
+#define ZMQ_DNS_CACHE_TTL 13
+#define ZMQ_DNS_NEGATIVE_TTL 14
+#define ZMQ_CRYPTO_THREADS 15
+#define ZMQ_IO_THREAD_AFFINITY_CPU_ADD 16
+#define ZMQ_IO_THREAD_AFFINITY_CPU_REMOVE 17
+
+/*  DRAFT I/O thread and CPU, see ZMQ_IO_THREAD_AFFINITY_CPU_ADD              */
+typedef struct zmq_io_thread_cpu_t
+{
+    int io_thread;
+    int cpu;
+} zmq_io_thread_cpu_t;
+
+/*  DRAFT Message allocator hooks, see ZMQ_MSG_ALLOCATOR                      */
+typedef struct zmq_msg_allocator_t
+{
+    void *(*allocate_fn) (size_t size_, void *hint_);
+    void (*deallocate_fn) (void *data_, void *hint_);
+    void *hint;
+} zmq_msg_allocator_t;
 
 /*  DRAFT Context methods.                                                    */
 ZMQ_EXPORT int zmq_ctx_set_ext (void *context_,
@@ -692,6 +724,10 @@ ZMQ_EXPORT int zmq_ctx_get_ext (void *context_,
 ZMQ_EXPORT int zmq_join (void *s, const char *group);
 ZMQ_EXPORT int zmq_leave (void *s, const char *group);
 ZMQ_EXPORT uint32_t zmq_connect_peer (void *s_, const char *addr_);
+ZMQ_EXPORT int
+zmq_send_batch (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_);
+ZMQ_EXPORT int
+zmq_recv_batch (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_);
 
 /*  DRAFT Msg methods.                                                        */
 ZMQ_EXPORT int zmq_msg_set_routing_id (zmq_msg_t *msg, uint32_t routing_id);
@@ -700,6 +736,8 @@ ZMQ_EXPORT int zmq_msg_set_group (zmq_msg_t *msg, const char *group);
 ZMQ_EXPORT const char *zmq_msg_group (zmq_msg_t *msg);
 ZMQ_EXPORT int
 zmq_msg_init_buffer (zmq_msg_t *msg_, const void *buf_, size_t size_);
+ZMQ_EXPORT int
+zmq_msg_init_ctx_size (zmq_msg_t *msg_, void *context_, size_t size_);
 
 /*  DRAFT Msg property names.                                                 */
 #define ZMQ_MSG_PROPERTY_ROUTING_ID "Routing-Id"
@@ -762,6 +800,41 @@ ZMQ_EXPORT int zmq_socket_monitor_versioned (
   void *s_, const char *addr_, uint64_t events_, int event_version_, int type_);
 ZMQ_EXPORT int zmq_socket_monitor_pipes_stats (void *s);
 
+/*  DRAFT Socket statistics                                                   */
+#define ZMQ_STATS_ENDPOINT_MAX 256
+
+typedef struct zmq_socket_stats_t
+{
+    uint64_t msgs_in;
+    uint64_t bytes_in;
+    uint64_t msgs_out;
+    uint64_t bytes_out;
+    uint64_t queued_in;
+    uint64_t queued_out;
+    uint64_t hwm_hits;
+    uint64_t drops;
+    uint64_t engine_reads;
+    uint64_t engine_writes;
+} zmq_socket_stats_t;
+
+typedef struct zmq_pipe_stats_t
+{
+    char local_endpoint[ZMQ_STATS_ENDPOINT_MAX];
+    char remote_endpoint[ZMQ_STATS_ENDPOINT_MAX];
+    zmq_socket_stats_t stats;
+} zmq_pipe_stats_t;
+
+ZMQ_EXPORT int zmq_socket_stats (void *socket,
+                                 zmq_socket_stats_t *stats,
+                                 zmq_pipe_stats_t *pipes,
+                                 size_t *pipe_count);
+
+/*  DRAFT Message proxying                                                    */
+ZMQ_EXPORT int zmq_proxy_detached (void *frontend_,
+                                   void *backend_,
+                                   void *capture_,
+                                   void *control_);
+
 #if !defined _WIN32
 ZMQ_EXPORT int zmq_ppoll (zmq_pollitem_t *items_,
                           int nitems_,
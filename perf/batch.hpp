@@ -0,0 +1,115 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_PERF_BATCH_HPP_INCLUDED__
+#define __ZMQ_PERF_BATCH_HPP_INCLUDED__
+
+//  Parts shared by the throughput tools to send and receive the messages
+//  in batches with zmq_send_batch and zmq_recv_batch, selected with -b.
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_BATCH_SIZE 1024
+
+//  Takes the batch size from a leading -b option, returning 0 if there is
+//  none.
+inline int parse_batch_size (int *argc_, char ***argv_)
+{
+    if (*argc_ < 3 || strcmp ((*argv_)[1], "-b") != 0)
+        return 0;
+    const int batch_size = atoi ((*argv_)[2]);
+    if (batch_size < 1 || batch_size > MAX_BATCH_SIZE) {
+        printf ("batch size must be between 1 and %d\n", MAX_BATCH_SIZE);
+        exit (1);
+    }
+#ifndef ZMQ_BUILD_DRAFT_API
+    printf ("batches require the draft API\n");
+    exit (1);
+#endif
+    *argc_ -= 2;
+    *argv_ += 2;
+    return batch_size;
+}
+
+#ifdef ZMQ_BUILD_DRAFT_API
+//  Receives message_count_ messages of message_size_ bytes, up to
+//  batch_size_ at a time.
+inline void recv_batches (void *s_,
+                          int message_count_,
+                          size_t message_size_,
+                          int batch_size_)
+{
+    zmq_msg_t msgs[MAX_BATCH_SIZE];
+    int rc;
+    int i;
+
+    for (i = 0; i != batch_size_; i++)
+        zmq_msg_init (&msgs[i]);
+
+    while (message_count_ > 0) {
+        rc = zmq_recv_batch (
+          s_, msgs,
+          message_count_ < batch_size_ ? message_count_ : batch_size_, 0);
+        if (rc < 0) {
+            printf ("error in zmq_recv_batch: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+        for (i = 0; i != rc; i++)
+            if (zmq_msg_size (&msgs[i]) != message_size_) {
+                printf ("message of incorrect size received\n");
+                exit (1);
+            }
+        message_count_ -= rc;
+    }
+
+    for (i = 0; i != batch_size_; i++)
+        zmq_msg_close (&msgs[i]);
+}
+
+//  Sends message_count_ messages of message_size_ bytes, up to batch_size_
+//  at a time. They are allocated with the allocator of ctx_, if given.
+inline void send_batches (void *s_,
+                          int message_count_,
+                          size_t message_size_,
+                          int batch_size_,
+                          void *ctx_)
+{
+    zmq_msg_t msgs[MAX_BATCH_SIZE];
+    int rc;
+    int i;
+
+    while (message_count_ > 0) {
+        const int count =
+          message_count_ < batch_size_ ? message_count_ : batch_size_;
+        for (i = 0; i != count; i++) {
+            rc = ctx_ ? zmq_msg_init_ctx_size (&msgs[i], ctx_, message_size_)
+                      : zmq_msg_init_size (&msgs[i], message_size_);
+            if (rc != 0) {
+                printf ("error in zmq_msg_init_size: %s\n",
+                        zmq_strerror (errno));
+                exit (1);
+            }
+#if defined ZMQ_MAKE_VALGRIND_HAPPY
+            memset (zmq_msg_data (&msgs[i]), 0, message_size_);
+#endif
+        }
+
+        //  Only part of a batch may be sent when the pipe fills up.
+        for (i = 0; i != count; i += rc) {
+            rc = zmq_send_batch (s_, msgs + i, count - i, 0);
+            if (rc < 0) {
+                printf ("error in zmq_send_batch: %s\n", zmq_strerror (errno));
+                exit (1);
+            }
+        }
+
+        for (i = 0; i != count; i++)
+            zmq_msg_close (&msgs[i]);
+        message_count_ -= count;
+    }
+}
+#endif
+
+#endif
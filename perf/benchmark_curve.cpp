@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L
+
+#include "../include/zmq.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+//  Throughput of a PUSH/PULL pair over TCP loopback with the CURVE security
+//  mechanism, against the same pair with no security. The difference is the
+//  cost of encrypting and decrypting each message, which includes copying
+//  it in and out of the boxes.
+
+const std::size_t message_sizes[] = {16, 256, 4096, 65536};
+const std::size_t bytes_per_run = 256 * 1024 * 1024;
+const std::size_t max_message_count = 1000000;
+
+static void check (bool ok_, const char *what_)
+{
+    if (!ok_) {
+        std::fprintf (stderr, "%s: %s\n", what_, zmq_strerror (zmq_errno ()));
+        std::exit (1);
+    }
+}
+
+struct keys_t
+{
+    char server_public[41];
+    char server_secret[41];
+    char client_public[41];
+    char client_secret[41];
+};
+
+static void set_string (void *socket_, int option_, const char *value_)
+{
+    check (zmq_setsockopt (socket_, option_, value_, std::strlen (value_)) == 0,
+           "zmq_setsockopt");
+}
+
+static void send_messages (void *push_,
+                           std::size_t message_size_,
+                           std::size_t message_count_)
+{
+    std::vector<char> payload (message_size_, 'x');
+    for (std::size_t i = 0; i < message_count_; ++i)
+        check (zmq_send (push_, &payload[0], message_size_, 0)
+                 == static_cast<int> (message_size_),
+               "zmq_send");
+}
+
+static double
+run (void *ctx_, const keys_t *keys_, std::size_t message_size_)
+{
+    using namespace std::chrono;
+
+    std::size_t message_count = bytes_per_run / message_size_;
+    if (message_count > max_message_count)
+        message_count = max_message_count;
+
+    void *pull = zmq_socket (ctx_, ZMQ_PULL);
+    void *push = zmq_socket (ctx_, ZMQ_PUSH);
+    check (pull && push, "zmq_socket");
+
+    if (keys_) {
+        const int as_server = 1;
+        check (zmq_setsockopt (pull, ZMQ_CURVE_SERVER, &as_server,
+                               sizeof as_server)
+                 == 0,
+               "zmq_setsockopt");
+        set_string (pull, ZMQ_CURVE_SECRETKEY, keys_->server_secret);
+        set_string (push, ZMQ_CURVE_SERVERKEY, keys_->server_public);
+        set_string (push, ZMQ_CURVE_PUBLICKEY, keys_->client_public);
+        set_string (push, ZMQ_CURVE_SECRETKEY, keys_->client_secret);
+    }
+
+    check (zmq_bind (pull, "tcp://127.0.0.1:*") == 0, "zmq_bind");
+    char endpoint[256];
+    std::size_t endpoint_size = sizeof endpoint;
+    check (zmq_getsockopt (pull, ZMQ_LAST_ENDPOINT, endpoint, &endpoint_size)
+             == 0,
+           "zmq_getsockopt");
+    check (zmq_connect (push, endpoint) == 0, "zmq_connect");
+
+    //  Wait for the handshake before starting the clock.
+    std::vector<char> buf (message_size_);
+    send_messages (push, message_size_, 1);
+    check (zmq_recv (pull, &buf[0], buf.size (), 0) >= 0, "zmq_recv");
+
+    std::thread sender (send_messages, push, message_size_, message_count);
+    const auto start = steady_clock::now ();
+    for (std::size_t i = 0; i < message_count; ++i)
+        check (zmq_recv (pull, &buf[0], buf.size (), 0)
+                 == static_cast<int> (message_size_),
+               "zmq_recv");
+    const double elapsed =
+      duration<double> (steady_clock::now () - start).count ();
+    sender.join ();
+
+    zmq_close (push);
+    zmq_close (pull);
+    return message_count / elapsed;
+}
+
+int main ()
+{
+    void *ctx = zmq_ctx_new ();
+    check (ctx != NULL, "zmq_ctx_new");
+
+    keys_t keys;
+    const bool have_curve = zmq_has ("curve") != 0;
+    if (have_curve) {
+        check (zmq_curve_keypair (keys.server_public, keys.server_secret) == 0,
+               "zmq_curve_keypair");
+        check (zmq_curve_keypair (keys.client_public, keys.client_secret) == 0,
+               "zmq_curve_keypair");
+    } else
+        std::printf ("CURVE is not available, measuring NULL only\n");
+
+    std::printf ("%10s %14s %12s %14s %12s %8s\n", "size", "NULL msg/s",
+                 "NULL MB/s", "CURVE msg/s", "CURVE MB/s", "ratio");
+    for (const std::size_t message_size : message_sizes) {
+        const double null_rate = run (ctx, NULL, message_size);
+        const double null_mbps = null_rate * message_size / 1000000;
+        if (!have_curve) {
+            std::printf ("%10llu %14.0lf %12.1lf\n",
+                         static_cast<unsigned long long> (message_size),
+                         null_rate, null_mbps);
+            continue;
+        }
+        const double curve_rate = run (ctx, &keys, message_size);
+        std::printf ("%10llu %14.0lf %12.1lf %14.0lf %12.1lf %7.2lfx\n",
+                     static_cast<unsigned long long> (message_size), null_rate,
+                     null_mbps, curve_rate, curve_rate * message_size / 1000000,
+                     null_rate / curve_rate);
+    }
+
+    zmq_ctx_term (ctx);
+    return 0;
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
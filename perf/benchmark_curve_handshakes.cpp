@@ -0,0 +1,246 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L
+
+#include "../include/zmq.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+//  A CURVE server taking a storm of new clients, all connecting at once,
+//  while a connection to another socket handled by the same I/O thread
+//  keeps exchanging requests and replies. Reports the handshakes completed
+//  per second and the round-trip latency of the established connection
+//  while the handshakes run, with the crypto threads given on the command
+//  line (0 runs the handshakes in the I/O thread).
+
+static void check (bool ok_, const char *what_)
+{
+    if (!ok_) {
+        std::fprintf (stderr, "%s: %s\n", what_, zmq_strerror (zmq_errno ()));
+        std::exit (1);
+    }
+}
+
+static void set_int (void *target_, int option_, int value_, bool ctx_)
+{
+    const int rc =
+      ctx_ ? zmq_ctx_set (target_, option_, value_)
+           : zmq_setsockopt (target_, option_, &value_, sizeof value_);
+    check (rc == 0, "set option");
+}
+
+static void set_string (void *socket_, int option_, const char *value_)
+{
+    check (zmq_setsockopt (socket_, option_, value_, std::strlen (value_)) == 0,
+           "zmq_setsockopt");
+}
+
+static std::string last_endpoint (void *socket_)
+{
+    char endpoint[256];
+    std::size_t size = sizeof endpoint;
+    check (zmq_getsockopt (socket_, ZMQ_LAST_ENDPOINT, endpoint, &size) == 0,
+           "zmq_getsockopt");
+    return endpoint;
+}
+
+//  Replies to each request, until the context is terminated.
+static void echo (void *rep_)
+{
+    char buf[64];
+    while (true) {
+        const int size = zmq_recv (rep_, buf, sizeof buf, 0);
+        if (size == -1)
+            break;
+        if (zmq_send (rep_, buf, size, 0) == -1)
+            break;
+    }
+    zmq_close (rep_);
+}
+
+//  Sends requests back to back while 'running_' is set, recording the
+//  round-trip times in microseconds.
+static void ping (void *req_,
+                  const std::atomic<bool> *running_,
+                  std::vector<double> *latencies_)
+{
+    using namespace std::chrono;
+
+    char buf[64];
+    while (running_->load ()) {
+        const auto start = steady_clock::now ();
+        check (zmq_send (req_, "ping", 4, 0) == 4, "zmq_send");
+        check (zmq_recv (req_, buf, sizeof buf, 0) == 4, "zmq_recv");
+        latencies_->push_back (
+          duration<double, std::micro> (steady_clock::now () - start).count ());
+    }
+}
+
+static double percentile (std::vector<double> &values_, double fraction_)
+{
+    if (values_.empty ())
+        return 0;
+    std::sort (values_.begin (), values_.end ());
+    std::size_t index = static_cast<std::size_t> (values_.size () * fraction_);
+    if (index >= values_.size ())
+        index = values_.size () - 1;
+    return values_[index];
+}
+
+int main (int argc_, char *argv_[])
+{
+    using namespace std::chrono;
+
+    if (argc_ != 3) {
+        std::printf ("usage: benchmark_curve_handshakes <crypto-threads> "
+                     "<client-count>\n");
+        return 1;
+    }
+    const int crypto_threads = std::atoi (argv_[1]);
+    const int client_count = std::atoi (argv_[2]);
+
+    if (!zmq_has ("curve")) {
+        std::printf ("CURVE is not available\n");
+        return 0;
+    }
+
+    char server_public[41], server_secret[41];
+    char client_public[41], client_secret[41];
+    check (zmq_curve_keypair (server_public, server_secret) == 0,
+           "zmq_curve_keypair");
+    check (zmq_curve_keypair (client_public, client_secret) == 0,
+           "zmq_curve_keypair");
+
+    //  The server context has a single I/O thread, handling both the new
+    //  clients and the established connection.
+    void *server_ctx = zmq_ctx_new ();
+    check (server_ctx != NULL, "zmq_ctx_new");
+    set_int (server_ctx, ZMQ_IO_THREADS, 1, true);
+    set_int (server_ctx, ZMQ_MAX_SOCKETS, client_count + 16, true);
+#ifdef ZMQ_CRYPTO_THREADS
+    set_int (server_ctx, ZMQ_CRYPTO_THREADS, crypto_threads, true);
+#else
+    if (crypto_threads != 0) {
+        std::printf ("crypto threads are not available\n");
+        return 1;
+    }
+#endif
+
+    //  The clients do their side of the handshakes in the I/O thread of
+    //  their own context, so the established connection gets another one.
+    void *client_ctx = zmq_ctx_new ();
+    check (client_ctx != NULL, "zmq_ctx_new");
+    set_int (client_ctx, ZMQ_MAX_SOCKETS, client_count + 16, true);
+    void *ping_ctx = zmq_ctx_new ();
+    check (ping_ctx != NULL, "zmq_ctx_new");
+
+    void *router = zmq_socket (server_ctx, ZMQ_ROUTER);
+    check (router != NULL, "zmq_socket");
+    set_int (router, ZMQ_CURVE_SERVER, 1, false);
+    set_string (router, ZMQ_CURVE_SECRETKEY, server_secret);
+    check (zmq_bind (router, "tcp://127.0.0.1:*") == 0, "zmq_bind");
+    const std::string router_endpoint = last_endpoint (router);
+
+    void *rep = zmq_socket (server_ctx, ZMQ_REP);
+    check (rep != NULL, "zmq_socket");
+    check (zmq_bind (rep, "tcp://127.0.0.1:*") == 0, "zmq_bind");
+    void *req = zmq_socket (ping_ctx, ZMQ_REQ);
+    check (req != NULL, "zmq_socket");
+    check (zmq_connect (req, last_endpoint (rep).c_str ()) == 0,
+           "zmq_connect");
+    std::thread echo_thread (echo, rep);
+
+    //  Let the established connection settle before the storm.
+    std::atomic<bool> running (true);
+    std::vector<double> idle_latencies;
+    std::thread idle_pinger (ping, req, &running, &idle_latencies);
+    std::this_thread::sleep_for (milliseconds (500));
+    running = false;
+    idle_pinger.join ();
+
+    std::vector<void *> clients;
+    clients.reserve (client_count);
+    for (int i = 0; i < client_count; i++) {
+        void *client = zmq_socket (client_ctx, ZMQ_DEALER);
+        check (client != NULL, "zmq_socket");
+        set_string (client, ZMQ_CURVE_SERVERKEY, server_public);
+        set_string (client, ZMQ_CURVE_PUBLICKEY, client_public);
+        set_string (client, ZMQ_CURVE_SECRETKEY, client_secret);
+        set_int (client, ZMQ_LINGER, 0, false);
+        clients.push_back (client);
+    }
+
+    running = true;
+    std::vector<double> storm_latencies;
+    std::thread storm_pinger (ping, req, &running, &storm_latencies);
+
+    //  Each client says hello once its handshake is done.
+    const auto start = steady_clock::now ();
+    for (int i = 0; i < client_count; i++) {
+        check (zmq_connect (clients[i], router_endpoint.c_str ()) == 0,
+               "zmq_connect");
+        check (zmq_send (clients[i], "hello", 5, 0) == 5, "zmq_send");
+    }
+    char buf[256];
+    for (int i = 0; i < client_count; i++) {
+        check (zmq_recv (router, buf, sizeof buf, 0) >= 0, "zmq_recv");
+        check (zmq_recv (router, buf, sizeof buf, 0) == 5, "zmq_recv");
+    }
+    const double elapsed =
+      duration<double> (steady_clock::now () - start).count ();
+
+    running = false;
+    storm_pinger.join ();
+
+    std::printf ("crypto threads: %d, clients: %d\n", crypto_threads,
+                 client_count);
+    std::printf ("handshakes: %.0lf per second (%.3lf s)\n",
+                 client_count / elapsed, elapsed);
+    const std::size_t idle_count = idle_latencies.size ();
+    std::printf ("idle round trip:  p50 %8.1lf us, p99 %8.1lf us, max %8.1lf "
+                 "us (%llu samples)\n",
+                 percentile (idle_latencies, 0.5),
+                 percentile (idle_latencies, 0.99),
+                 percentile (idle_latencies, 1),
+                 static_cast<unsigned long long> (idle_count));
+    const std::size_t storm_count = storm_latencies.size ();
+    std::printf ("storm round trip: p50 %8.1lf us, p99 %8.1lf us, max %8.1lf "
+                 "us (%llu samples)\n",
+                 percentile (storm_latencies, 0.5),
+                 percentile (storm_latencies, 0.99),
+                 percentile (storm_latencies, 1),
+                 static_cast<unsigned long long> (storm_count));
+
+    for (int i = 0; i < client_count; i++)
+        zmq_close (clients[i]);
+    set_int (req, ZMQ_LINGER, 0, false);
+    zmq_close (req);
+    set_int (router, ZMQ_LINGER, 0, false);
+    zmq_close (router);
+    zmq_ctx_term (client_ctx);
+    zmq_ctx_term (ping_ctx);
+
+    //  Terminating the context stops the echo thread, which closes the
+    //  REP socket.
+    zmq_ctx_shutdown (server_ctx);
+    echo_thread.join ();
+    zmq_ctx_term (server_ctx);
+    return 0;
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
@@ -0,0 +1,144 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L && defined ZMQ_BUILD_DRAFT_API
+
+#include "../include/zmq.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+//  Throughput of a skewed load over several I/O threads, without and with
+//  ZMQ_REBALANCE_IVL. Of 16 tcp connections, every fourth carries a stream
+//  of messages, and the others are idle. Connections are spread over the
+//  I/O threads as they are made, so that the busy ones share an I/O thread
+//  unless they are moved. Each busy connection has a thread sending and a
+//  thread receiving. Reported is the number of messages received per
+//  second by all of them, once the load has settled. Moving connections
+//  pays off only with a core per I/O thread.
+
+static const int io_threads = 4;
+static const int pairs = 16;
+static const int message_size = 64;
+static const int warmup_ms = 1000;
+static const int measure_ms = 2000;
+
+static void check (bool ok_, const char *what_)
+{
+    if (!ok_) {
+        std::fprintf (stderr, "%s: %s\n", what_, zmq_strerror (zmq_errno ()));
+        std::exit (1);
+    }
+}
+
+static void set_int (void *socket_, int option_, int value_)
+{
+    check (zmq_setsockopt (socket_, option_, &value_, sizeof value_) == 0,
+           "zmq_setsockopt");
+}
+
+static void sender (void *push_, const std::atomic<bool> *stop_)
+{
+    char buffer[message_size] = {0};
+    while (!stop_->load ())
+        if (zmq_send (push_, buffer, sizeof buffer, 0) == -1)
+            check (zmq_errno () == EAGAIN, "zmq_send");
+}
+
+static void receiver (void *pull_,
+                      std::atomic<long> *received_,
+                      const std::atomic<bool> *stop_)
+{
+    char buffer[message_size];
+    while (!stop_->load ())
+        if (zmq_recv (pull_, buffer, sizeof buffer, 0) != -1)
+            received_->fetch_add (1);
+        else
+            check (zmq_errno () == EAGAIN, "zmq_recv");
+}
+
+static long total (const std::vector<std::atomic<long> > &received_)
+{
+    long sum = 0;
+    for (size_t i = 0; i < received_.size (); i++)
+        sum += received_[i].load ();
+    return sum;
+}
+
+static double benchmark (int rebalance_ivl_)
+{
+    void *ctx = zmq_ctx_new ();
+    check (ctx != NULL, "zmq_ctx_new");
+    check (zmq_ctx_set (ctx, ZMQ_IO_THREADS, io_threads) == 0, "zmq_ctx_set");
+
+    std::vector<void *> push (pairs), pull (pairs);
+    for (int i = 0; i < pairs; i++) {
+        pull[i] = zmq_socket (ctx, ZMQ_PULL);
+        push[i] = zmq_socket (ctx, ZMQ_PUSH);
+        check (pull[i] && push[i], "zmq_socket");
+        set_int (pull[i], ZMQ_REBALANCE_IVL, rebalance_ivl_);
+        set_int (push[i], ZMQ_REBALANCE_IVL, rebalance_ivl_);
+        //  The threads look at the stop flag now and then.
+        set_int (pull[i], ZMQ_RCVTIMEO, 100);
+        set_int (push[i], ZMQ_SNDTIMEO, 100);
+        set_int (pull[i], ZMQ_LINGER, 0);
+        set_int (push[i], ZMQ_LINGER, 0);
+
+        check (zmq_bind (pull[i], "tcp://127.0.0.1:*") == 0, "zmq_bind");
+        char endpoint[256];
+        size_t size = sizeof endpoint;
+        check (zmq_getsockopt (pull[i], ZMQ_LAST_ENDPOINT, endpoint, &size)
+                 == 0,
+               "zmq_getsockopt");
+        check (zmq_connect (push[i], endpoint) == 0, "zmq_connect");
+    }
+
+    std::atomic<bool> stop (false);
+    std::vector<std::atomic<long> > received (pairs);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < pairs; i += io_threads) {
+        threads.emplace_back (sender, push[i], &stop);
+        threads.emplace_back (receiver, pull[i], &received[i], &stop);
+    }
+
+    std::this_thread::sleep_for (std::chrono::milliseconds (warmup_ms));
+    const long before = total (received);
+    const auto start = std::chrono::steady_clock::now ();
+    std::this_thread::sleep_for (std::chrono::milliseconds (measure_ms));
+    const long after = total (received);
+    const double seconds =
+      std::chrono::duration<double> (std::chrono::steady_clock::now () - start)
+        .count ();
+
+    stop = true;
+    for (size_t i = 0; i < threads.size (); i++)
+        threads[i].join ();
+    for (int i = 0; i < pairs; i++) {
+        zmq_close (push[i]);
+        zmq_close (pull[i]);
+    }
+    zmq_ctx_term (ctx);
+    return (after - before) / seconds;
+}
+
+int main (int argc_, char *argv_[])
+{
+    const int rebalance_ivl = argc_ > 1 ? std::atoi (argv_[1]) : 10;
+
+    std::printf ("%14s %14s\n", "rebalance ms", "msgs/s");
+    std::printf ("%14d %14.0f\n", 0, benchmark (0));
+    std::printf ("%14d %14.0f\n", rebalance_ivl, benchmark (rebalance_ivl));
+    return 0;
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
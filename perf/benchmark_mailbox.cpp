@@ -0,0 +1,133 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L
+
+#include "precompiled.hpp"
+#include "mailbox.hpp"
+#include "mutex.hpp"
+#include "ypipe.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+//  Many threads sending commands to a single mailbox, the way sessions and
+//  pipes notify the socket they belong to. Compares the mailbox against the
+//  former ypipe protected by a mutex.
+
+const std::size_t total_commands = 2000000;
+const std::size_t sender_counts[] = {1, 2, 4, 16, 64, 256};
+
+//  The mailbox as it used to be: one ypipe with the sending side
+//  serialised by a mutex.
+class locked_mailbox_t
+{
+  public:
+    locked_mailbox_t () : _active (false)
+    {
+        const bool ok = _cpipe.check_read ();
+        zmq_assert (!ok);
+    }
+
+    void send (const zmq::command_t &cmd_)
+    {
+        _sync.lock ();
+        _cpipe.write (cmd_, false);
+        const bool ok = _cpipe.flush ();
+        _sync.unlock ();
+        if (!ok)
+            _signaler.send ();
+    }
+
+    int recv (zmq::command_t *cmd_, int timeout_)
+    {
+        if (_active) {
+            if (_cpipe.read (cmd_))
+                return 0;
+            _active = false;
+        }
+        if (_signaler.wait (timeout_) == -1)
+            return -1;
+        if (_signaler.recv_failable () == -1)
+            return -1;
+        _active = true;
+        const bool ok = _cpipe.read (cmd_);
+        zmq_assert (ok);
+        return 0;
+    }
+
+  private:
+    zmq::ypipe_t<zmq::command_t, zmq::command_pipe_granularity> _cpipe;
+    zmq::signaler_t _signaler;
+    zmq::mutex_t _sync;
+    bool _active;
+};
+
+template <class T> void benchmark_senders (T &mailbox_, std::size_t senders_)
+{
+    using namespace std::chrono;
+
+    const std::size_t per_sender = total_commands / senders_;
+    std::vector<std::thread> threads;
+    threads.reserve (senders_);
+
+    const auto start = steady_clock::now ();
+    for (std::size_t i = 0; i < senders_; ++i)
+        threads.emplace_back ([&mailbox_, per_sender] {
+            zmq::command_t cmd;
+            cmd.destination = NULL;
+            cmd.type = zmq::command_t::activate_read;
+            for (std::size_t j = 0; j < per_sender; ++j)
+                mailbox_.send (cmd);
+        });
+
+    //  Count the times the receiver found the mailbox empty and had to
+    //  wait for a signal.
+    std::size_t waits = 0;
+    zmq::command_t cmd;
+    for (std::size_t i = 0; i < per_sender * senders_; ++i) {
+        if (mailbox_.recv (&cmd, 0) == 0)
+            continue;
+        ++waits;
+        const int rc = mailbox_.recv (&cmd, -1);
+        zmq_assert (rc == 0);
+    }
+    const auto end = steady_clock::now ();
+
+    for (auto &thread : threads)
+        thread.join ();
+
+    const double seconds = duration<double> (end - start).count ();
+    std::printf ("senders = %4llu: %7.2lf M commands/s, %llu waits\n",
+                 static_cast<unsigned long long> (senders_),
+                 per_sender * senders_ / seconds / 1000000,
+                 static_cast<unsigned long long> (waits));
+}
+
+int main ()
+{
+    std::printf ("commands = %llu\n",
+                 static_cast<unsigned long long> (total_commands));
+    for (auto senders : sender_counts) {
+        std::puts ("[locked_mailbox]");
+        {
+            locked_mailbox_t mailbox;
+            benchmark_senders (mailbox, senders);
+        }
+        std::puts ("[mailbox]");
+        {
+            zmq::mailbox_t mailbox;
+            benchmark_senders (mailbox, senders);
+        }
+    }
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
@@ -0,0 +1,126 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L
+
+#include "../include/zmq.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+//  Throughput of large messages between two sockets over ipc://, passed
+//  through the socket or in a memfd (ZMQ_MEMFD_THRESHOLD), for message sizes
+//  from 1 to 256 MB. The receiver reads one byte per page of every message,
+//  so that mapped messages are paid for like copied ones. An optional
+//  argument limits the largest size, in MB.
+
+static void check (bool ok_, const char *what_)
+{
+    if (!ok_) {
+        std::fprintf (stderr, "%s: %s\n", what_, zmq_strerror (zmq_errno ()));
+        std::exit (1);
+    }
+}
+
+static void set_int (void *socket_, int option_, int value_)
+{
+    check (zmq_setsockopt (socket_, option_, &value_, sizeof value_) == 0,
+           "zmq_setsockopt");
+}
+
+//  Sends the same buffer count_ times, without copying it.
+static void send_messages (void *push_, std::vector<char> *buffer_, int count_)
+{
+    for (int i = 0; i < count_; i++) {
+        zmq_msg_t msg;
+        check (zmq_msg_init_data (&msg, buffer_->data (), buffer_->size (),
+                                  NULL, NULL)
+                 == 0,
+               "zmq_msg_init_data");
+        check (zmq_msg_send (&msg, push_, 0) != -1, "zmq_msg_send");
+    }
+}
+
+static double
+benchmark (void *ctx_, std::size_t size_, int count_, int threshold_)
+{
+    void *pull = zmq_socket (ctx_, ZMQ_PULL);
+    void *push = zmq_socket (ctx_, ZMQ_PUSH);
+    check (pull && push, "zmq_socket");
+    set_int (pull, ZMQ_MEMFD_THRESHOLD, threshold_);
+    set_int (push, ZMQ_MEMFD_THRESHOLD, threshold_);
+    set_int (pull, ZMQ_RCVHWM, 4);
+    set_int (push, ZMQ_SNDHWM, 4);
+
+    check (zmq_bind (pull, "ipc://*") == 0, "zmq_bind");
+    char endpoint[256];
+    std::size_t endpoint_size = sizeof endpoint;
+    check (zmq_getsockopt (pull, ZMQ_LAST_ENDPOINT, endpoint, &endpoint_size)
+             == 0,
+           "zmq_getsockopt");
+    check (zmq_connect (push, endpoint) == 0, "zmq_connect");
+
+    std::vector<char> buffer (size_, 'x');
+
+    //  The first message takes the connection time out of the measurement.
+    std::thread sender (send_messages, push, &buffer, count_ + 1);
+    zmq_msg_t msg;
+    zmq_msg_init (&msg);
+    check (zmq_msg_recv (&msg, pull, 0) != -1, "zmq_msg_recv");
+
+    unsigned long sum = 0;
+    const auto start = std::chrono::steady_clock::now ();
+    for (int i = 0; i < count_; i++) {
+        check (zmq_msg_recv (&msg, pull, 0) != -1, "zmq_msg_recv");
+        const char *data = static_cast<const char *> (zmq_msg_data (&msg));
+        for (std::size_t offset = 0; offset < size_; offset += 4096)
+            sum += static_cast<unsigned char> (data[offset]);
+    }
+    const double elapsed =
+      std::chrono::duration<double> (std::chrono::steady_clock::now () - start)
+        .count ();
+    zmq_msg_close (&msg);
+    sender.join ();
+    check (sum > 0, "message contents");
+
+    zmq_close (push);
+    zmq_close (pull);
+    return static_cast<double> (size_) * count_ / elapsed / 1e9;
+}
+
+int main (int argc_, char *argv_[])
+{
+    const int max_mb = argc_ > 1 ? std::atoi (argv_[1]) : 256;
+
+    void *ctx = zmq_ctx_new ();
+    check (ctx != NULL, "zmq_ctx_new");
+
+    std::printf ("%10s %10s %14s %14s\n", "size", "messages", "ipc GB/s",
+                 "memfd GB/s");
+    for (int mb = 1; mb <= max_mb; mb *= 4) {
+        const std::size_t size = static_cast<std::size_t> (mb) << 20;
+
+        //  About 2 GB per run, and at least 8 messages.
+        const int count = std::max (8, 2048 / mb);
+        const double ipc = benchmark (ctx, size, count, -1);
+        const double memfd = benchmark (ctx, size, count, 0);
+        std::printf ("%7d MB %10d %14.2f %14.2f\n", mb, count, ipc, memfd);
+    }
+
+    zmq_ctx_term (ctx);
+    return 0;
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
@@ -0,0 +1,194 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L && defined ZMQ_BUILD_DRAFT_API
+
+#include "../include/zmq.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+//  Throughput and latency of a tcp connection between two I/O threads,
+//  each pinned to a CPU, with message memory from the context's pool. The
+//  PUSH socket uses the first I/O thread and the PULL socket the second.
+//  The I/O threads run on two CPUs of the first NUMA node, then on the
+//  first CPU of the first node and the first CPU of the second node. The
+//  application threads are not pinned. On machines with a single node only
+//  the first layout is measured.
+
+static const int message_size = 1024;
+static const int message_count = 200000;
+static const int roundtrips = 20000;
+
+static void check (bool ok_, const char *what_)
+{
+    if (!ok_) {
+        std::fprintf (stderr, "%s: %s\n", what_, zmq_strerror (zmq_errno ()));
+        std::exit (1);
+    }
+}
+
+//  Makes the socket use the I/O thread of the index.
+static void use_io_thread (void *socket_, int io_thread_)
+{
+    const uint64_t affinity = uint64_t (1) << io_thread_;
+    check (zmq_setsockopt (socket_, ZMQ_AFFINITY, &affinity, sizeof affinity)
+             == 0,
+           "zmq_setsockopt");
+}
+
+//  Returns the CPUs of the node, which sysfs lists as e.g. "0-3,8-11".
+static std::vector<int> node_cpus (int node_)
+{
+    std::vector<int> cpus;
+    char path[64];
+    std::snprintf (path, sizeof path,
+                   "/sys/devices/system/node/node%d/cpulist", node_);
+    FILE *file = std::fopen (path, "r");
+    if (!file)
+        return cpus;
+    char buffer[4096];
+    if (std::fgets (buffer, sizeof buffer, file)) {
+        for (char *p = buffer; *p >= '0' && *p <= '9';) {
+            const int first = static_cast<int> (std::strtol (p, &p, 10));
+            const int last =
+              *p == '-' ? static_cast<int> (std::strtol (p + 1, &p, 10)) : first;
+            for (int cpu = first; cpu <= last; cpu++)
+                cpus.push_back (cpu);
+            if (*p == ',')
+                p++;
+        }
+    }
+    std::fclose (file);
+    return cpus;
+}
+
+static void pin (void *ctx_, int io_thread_, int cpu_)
+{
+    zmq_io_thread_cpu_t thread_cpu = {io_thread_, cpu_};
+    check (zmq_ctx_set_ext (ctx_, ZMQ_IO_THREAD_AFFINITY_CPU_ADD, &thread_cpu,
+                            sizeof thread_cpu)
+             == 0,
+           "zmq_ctx_set_ext");
+}
+
+static double elapsed_s (std::chrono::steady_clock::time_point start_)
+{
+    return std::chrono::duration<double> (std::chrono::steady_clock::now ()
+                                          - start_)
+      .count ();
+}
+
+//  Returns the messages per second from PUSH to PULL, and the round trip
+//  time between a DEALER and a ROUTER on the same I/O threads.
+static void benchmark (int push_cpu_,
+                       int pull_cpu_,
+                       double *throughput_,
+                       double *latency_us_)
+{
+    void *ctx = zmq_ctx_new ();
+    check (ctx != NULL, "zmq_ctx_new");
+    check (zmq_ctx_set (ctx, ZMQ_IO_THREADS, 2) == 0, "zmq_ctx_set");
+    check (zmq_ctx_set (ctx, ZMQ_MSG_POOL, 1) == 0, "zmq_ctx_set");
+    pin (ctx, 0, push_cpu_);
+    pin (ctx, 1, pull_cpu_);
+
+    void *pull = zmq_socket (ctx, ZMQ_PULL);
+    void *push = zmq_socket (ctx, ZMQ_PUSH);
+    check (pull && push, "zmq_socket");
+    use_io_thread (push, 0);
+    use_io_thread (pull, 1);
+    check (zmq_bind (pull, "tcp://127.0.0.1:*") == 0, "zmq_bind");
+    char endpoint[256];
+    size_t size = sizeof endpoint;
+    check (zmq_getsockopt (pull, ZMQ_LAST_ENDPOINT, endpoint, &size) == 0,
+           "zmq_getsockopt");
+    check (zmq_connect (push, endpoint) == 0, "zmq_connect");
+
+    std::vector<char> buffer (message_size);
+    check (zmq_send (push, &buffer[0], buffer.size (), 0) != -1, "zmq_send");
+    check (zmq_recv (pull, &buffer[0], buffer.size (), 0) != -1, "zmq_recv");
+
+    //  The application sends and receives in turns, so that neither side
+    //  waits on a full pipe.
+    const int batch = 1000;
+    auto start = std::chrono::steady_clock::now ();
+    for (int i = 0; i < message_count; i += batch) {
+        for (int j = 0; j < batch; j++)
+            check (zmq_send (push, &buffer[0], buffer.size (), 0) != -1,
+                   "zmq_send");
+        for (int j = 0; j < batch; j++)
+            check (zmq_recv (pull, &buffer[0], buffer.size (), 0) != -1,
+                   "zmq_recv");
+    }
+    *throughput_ = message_count / elapsed_s (start);
+
+    void *router = zmq_socket (ctx, ZMQ_ROUTER);
+    void *dealer = zmq_socket (ctx, ZMQ_DEALER);
+    check (router && dealer, "zmq_socket");
+    use_io_thread (dealer, 0);
+    use_io_thread (router, 1);
+    check (zmq_bind (router, "tcp://127.0.0.1:*") == 0, "zmq_bind");
+    size = sizeof endpoint;
+    check (zmq_getsockopt (router, ZMQ_LAST_ENDPOINT, endpoint, &size) == 0,
+           "zmq_getsockopt");
+    check (zmq_connect (dealer, endpoint) == 0, "zmq_connect");
+
+    char routing_id[256];
+    start = std::chrono::steady_clock::now ();
+    for (int i = 0; i < roundtrips; i++) {
+        check (zmq_send (dealer, &buffer[0], buffer.size (), 0) != -1,
+               "zmq_send");
+        const int id_size =
+          zmq_recv (router, routing_id, sizeof routing_id, 0);
+        check (id_size != -1
+                 && zmq_recv (router, &buffer[0], buffer.size (), 0) != -1,
+               "zmq_recv");
+        check (zmq_send (router, routing_id, id_size, ZMQ_SNDMORE) != -1
+                 && zmq_send (router, &buffer[0], buffer.size (), 0) != -1,
+               "zmq_send");
+        check (zmq_recv (dealer, &buffer[0], buffer.size (), 0) != -1,
+               "zmq_recv");
+    }
+    *latency_us_ = elapsed_s (start) * 1e6 / roundtrips;
+
+    zmq_close (dealer);
+    zmq_close (router);
+    zmq_close (push);
+    zmq_close (pull);
+    zmq_ctx_term (ctx);
+}
+
+int main ()
+{
+    const std::vector<int> first = node_cpus (0);
+    const std::vector<int> second = node_cpus (1);
+
+    std::printf ("%12s %8s %8s %14s %14s\n", "layout", "cpu", "cpu", "msgs/s",
+                 "roundtrip us");
+    double throughput, latency;
+    const int cpu = first.empty () ? 0 : first[0];
+    const int other = first.size () > 1 ? first[1] : cpu;
+    benchmark (cpu, other, &throughput, &latency);
+    std::printf ("%12s %8d %8d %14.0f %14.1f\n", "same node", cpu, other,
+                 throughput, latency);
+    if (first.empty () || second.empty ()) {
+        std::printf ("single NUMA node, no split layout\n");
+        return 0;
+    }
+    benchmark (cpu, second[0], &throughput, &latency);
+    std::printf ("%12s %8d %8d %14.0f %14.1f\n", "split nodes", cpu, second[0],
+                 throughput, latency);
+    return 0;
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
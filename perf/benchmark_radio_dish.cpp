@@ -0,0 +1,206 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L && defined ZMQ_BUILD_DRAFT_API
+
+#include "../include/zmq.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+//  Cost of group matching in RADIO and DISH sockets, for 10 to 10k groups.
+//
+//  inproc: a RADIO fans out to 8 DISHes, each joined to a quarter of the
+//  groups, so that every group reaches 2 DISHes. Reported is the time per
+//  message until both have received it.
+//
+//  udp: a RADIO sends to all groups, twice as many as a DISH has joined,
+//  and the DISH drops the others. Reported is the time the DISH takes per
+//  matching message received. Messages lost by UDP are not counted.
+
+static const int dishes = 8;
+static const int batch_size = 1000;
+static const int batches = 100;
+
+static void check (bool ok_, const char *what_)
+{
+    if (!ok_) {
+        std::fprintf (stderr, "%s: %s\n", what_, zmq_strerror (zmq_errno ()));
+        std::exit (1);
+    }
+}
+
+static void set_int (void *socket_, int option_, int value_)
+{
+    check (zmq_setsockopt (socket_, option_, &value_, sizeof value_) == 0,
+           "zmq_setsockopt");
+}
+
+static std::string group_name (int index_)
+{
+    char name[32];
+    std::snprintf (name, sizeof name, "benchmark-group-%05d", index_);
+    return name;
+}
+
+static void send_to_group (void *radio_, const std::string &group_)
+{
+    zmq_msg_t msg;
+    zmq_msg_init_size (&msg, 8);
+    check (zmq_msg_set_group (&msg, group_.c_str ()) == 0, "zmq_msg_set_group");
+    check (zmq_msg_send (&msg, radio_, 0) != -1, "zmq_msg_send");
+}
+
+//  Receives up to count_ messages, giving up once none arrive for a while.
+static int drain (void *dish_, int count_)
+{
+    zmq_msg_t msg;
+    zmq_msg_init (&msg);
+    int received = 0;
+    while (received < count_ && zmq_msg_recv (&msg, dish_, 0) != -1)
+        received++;
+    zmq_msg_close (&msg);
+    return received;
+}
+
+static double elapsed_ns (std::chrono::steady_clock::time_point start_)
+{
+    return std::chrono::duration<double, std::nano> (
+             std::chrono::steady_clock::now () - start_)
+      .count ();
+}
+
+static double benchmark_inproc (void *ctx_, int groups_)
+{
+    void *radio = zmq_socket (ctx_, ZMQ_RADIO);
+    check (radio != NULL, "zmq_socket");
+    //  Nothing may be dropped, as the DISHes count what they receive.
+    set_int (radio, ZMQ_SNDHWM, 0);
+    const std::string endpoint =
+      "inproc://benchmark-radio-" + std::to_string (groups_);
+    check (zmq_bind (radio, endpoint.c_str ()) == 0, "zmq_bind");
+
+    std::vector<std::string> names (groups_);
+    for (int i = 0; i < groups_; i++)
+        names[i] = group_name (i);
+
+    std::vector<void *> dish (dishes);
+    for (int d = 0; d < dishes; d++) {
+        dish[d] = zmq_socket (ctx_, ZMQ_DISH);
+        check (dish[d] != NULL, "zmq_socket");
+        set_int (dish[d], ZMQ_RCVHWM, 0);
+        //  The joins are sent when connecting, all at once.
+        set_int (dish[d], ZMQ_SNDHWM, 0);
+        set_int (dish[d], ZMQ_RCVTIMEO, 1000);
+        for (int i = d % 4; i < groups_; i += 4)
+            check (zmq_join (dish[d], names[i].c_str ()) == 0, "zmq_join");
+        check (zmq_connect (dish[d], endpoint.c_str ()) == 0, "zmq_connect");
+    }
+
+    //  Wait for the joins to reach the RADIO, which reads them when it
+    //  sends. Each DISH sends its joins at once, so it is enough that its
+    //  last join arrived. Then drop the messages sent meanwhile.
+    for (int d = 0; d < dishes; d++) {
+        const int last = groups_ - 1 - (groups_ - 1 - d % 4) % 4;
+        set_int (dish[d], ZMQ_RCVTIMEO, 10);
+        while (drain (dish[d], 1) == 0)
+            send_to_group (radio, names[last]);
+    }
+    for (int d = 0; d < dishes; d++) {
+        set_int (dish[d], ZMQ_RCVTIMEO, 0);
+        drain (dish[d], batches * batch_size);
+        set_int (dish[d], ZMQ_RCVTIMEO, 1000);
+    }
+
+    double total = 0;
+    int next = 0;
+    for (int batch = 0; batch < batches; batch++) {
+        //  Messages sent to the groups of each quarter of the DISHes.
+        int expected[4] = {0, 0, 0, 0};
+        const auto start = std::chrono::steady_clock::now ();
+        for (int i = 0; i < batch_size; i++) {
+            send_to_group (radio, names[next]);
+            expected[next % 4]++;
+            next = (next + 1) % groups_;
+        }
+        for (int d = 0; d < dishes; d++)
+            check (drain (dish[d], expected[d % 4]) == expected[d % 4],
+                   "zmq_msg_recv");
+        total += elapsed_ns (start);
+    }
+
+    for (int d = 0; d < dishes; d++)
+        zmq_close (dish[d]);
+    zmq_close (radio);
+    return total / (batches * batch_size);
+}
+
+static double benchmark_udp (void *ctx_, int groups_, int port_)
+{
+    void *dish = zmq_socket (ctx_, ZMQ_DISH);
+    void *radio = zmq_socket (ctx_, ZMQ_RADIO);
+    check (dish && radio, "zmq_socket");
+    set_int (dish, ZMQ_RCVTIMEO, 100);
+
+    const std::string endpoint = "udp://127.0.0.1:" + std::to_string (port_);
+    check (zmq_bind (dish, endpoint.c_str ()) == 0, "zmq_bind");
+    check (zmq_connect (radio, endpoint.c_str ()) == 0, "zmq_connect");
+
+    //  The DISH joins the even groups only.
+    std::vector<std::string> names (2 * groups_);
+    for (int i = 0; i < 2 * groups_; i++) {
+        names[i] = group_name (i);
+        if (i % 2 == 0)
+            check (zmq_join (dish, names[i].c_str ()) == 0, "zmq_join");
+    }
+
+    double total = 0;
+    int received = 0;
+    int next = 0;
+    for (int batch = 0; batch < batches; batch++) {
+        for (int i = 0; i < batch_size; i++) {
+            send_to_group (radio, names[next]);
+            next = (next + 1) % names.size ();
+        }
+
+        const auto start = std::chrono::steady_clock::now ();
+        const int batch_received = drain (dish, batch_size / 2);
+        double batch_time = elapsed_ns (start);
+        if (batch_received < batch_size / 2)
+            batch_time -= 100e6; //  Waited for lost messages.
+        total += batch_time;
+        received += batch_received;
+    }
+
+    zmq_close (radio);
+    zmq_close (dish);
+    return received ? total / received : 0;
+}
+
+int main (int argc_, char *argv_[])
+{
+    const int port = argc_ > 1 ? std::atoi (argv_[1]) : 5599;
+
+    void *ctx = zmq_ctx_new ();
+    check (ctx != NULL, "zmq_ctx_new");
+
+    std::printf ("%10s %14s %14s\n", "groups", "inproc ns", "udp ns");
+    for (int groups = 10; groups <= 10000; groups *= 10) {
+        const double inproc = benchmark_inproc (ctx, groups);
+        const double udp = benchmark_udp (ctx, groups, port);
+        std::printf ("%10d %14.1f %14.1f\n", groups, inproc, udp);
+    }
+
+    zmq_ctx_term (ctx);
+    return 0;
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
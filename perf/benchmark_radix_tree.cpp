@@ -2,6 +2,7 @@
 
 #if __cplusplus >= 201103L
 
+#include "art_tree.hpp"
 #include "radix_tree.hpp"
 #include "trie.hpp"
 
@@ -12,7 +13,11 @@
 #include <ratio>
 #include <vector>
 
-const std::size_t nkeys = 10000;
+#if defined __GLIBC__
+#include <malloc.h>
+#endif
+
+const std::size_t key_counts[] = {10000, 1000000};
 const std::size_t nqueries = 1000000;
 const std::size_t warmup_runs = 10;
 const std::size_t samples = 10;
@@ -20,6 +25,43 @@ const std::size_t key_length = 20;
 const char *chars = "abcdefghijklmnopqrstuvwxyz0123456789";
 const int chars_len = 36;
 
+//  The trie allocates a node per byte of each key, which makes it too
+//  large to be built with the biggest key sets.
+const std::size_t max_trie_keys = 100000;
+
+//  Bytes allocated on the heap, or 0 if this cannot be told.
+static std::size_t heap_in_use ()
+{
+#if defined __GLIBC__                                                          \
+  && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2 ().uordblks;
+#else
+    return 0;
+#endif
+}
+
+template <class T>
+void benchmark_insert (T &subscriptions_,
+                       std::vector<unsigned char *> &input_set_)
+{
+    using namespace std::chrono;
+
+    const std::size_t heap_before = heap_in_use ();
+    const auto start = steady_clock::now ();
+    for (auto &key : input_set_)
+        subscriptions_.add (key, key_length);
+    const auto end = steady_clock::now ();
+    const std::size_t heap_after = heap_in_use ();
+
+    std::printf ("Average insert time = %.1lf ns\n",
+                 duration<double, std::nano> (end - start).count ()
+                   / input_set_.size ());
+    if (heap_after > heap_before)
+        std::printf ("Memory per key = %.1lf bytes\n",
+                     static_cast<double> (heap_after - heap_before)
+                       / input_set_.size ());
+}
+
 template <class T>
 void benchmark_lookup (T &subscriptions_,
                        std::vector<unsigned char *> &queries_)
@@ -51,48 +93,50 @@ void benchmark_lookup (T &subscriptions_,
                  static_cast<double> (sum) / samples);
 }
 
+template <class T>
+void benchmark (const char *name_,
+                std::vector<unsigned char *> &input_set_,
+                std::vector<unsigned char *> &queries_)
+{
+    std::printf ("[%s]\n", name_);
+    T *subscriptions = new T;
+    benchmark_insert (*subscriptions, input_set_);
+    benchmark_lookup (*subscriptions, queries_);
+    delete subscriptions;
+}
+
 int main ()
 {
-    // Generate input set.
-    std::minstd_rand rng (123456789);
-    std::vector<unsigned char *> input_set;
-    std::vector<unsigned char *> queries;
-    input_set.reserve (nkeys);
-    queries.reserve (nqueries);
-
-    for (std::size_t i = 0; i < nkeys; ++i) {
-        unsigned char *key = new unsigned char[key_length];
-        for (std::size_t j = 0; j < key_length; j++)
-            key[j] = static_cast<unsigned char> (chars[rng () % chars_len]);
-        input_set.emplace_back (key);
-    }
-    for (std::size_t i = 0; i < nqueries; ++i)
-        queries.push_back (input_set[rng () % nkeys]);
-
-    // Initialize both data structures.
-    //
-    // Keeping initialization out of the benchmarking function helps
-    // heaptrack detect peak memory consumption of the radix tree.
-    zmq::trie_t trie;
-    zmq::radix_tree_t radix_tree;
-    for (auto &key : input_set) {
-        trie.add (key, key_length);
-        radix_tree.add (key, key_length);
+    for (const std::size_t nkeys : key_counts) {
+        // Generate input set.
+        std::minstd_rand rng (123456789);
+        std::vector<unsigned char *> input_set;
+        std::vector<unsigned char *> queries;
+        input_set.reserve (nkeys);
+        queries.reserve (nqueries);
+
+        for (std::size_t i = 0; i < nkeys; ++i) {
+            unsigned char *key = new unsigned char[key_length];
+            for (std::size_t j = 0; j < key_length; j++)
+                key[j] = static_cast<unsigned char> (chars[rng () % chars_len]);
+            input_set.emplace_back (key);
+        }
+        for (std::size_t i = 0; i < nqueries; ++i)
+            queries.push_back (input_set[rng () % nkeys]);
+
+        // Create a benchmark.
+        std::printf ("keys = %llu, queries = %llu, key size = %llu\n",
+                     static_cast<unsigned long long> (nkeys),
+                     static_cast<unsigned long long> (nqueries),
+                     static_cast<unsigned long long> (key_length));
+        if (nkeys <= max_trie_keys)
+            benchmark<zmq::trie_t> ("trie", input_set, queries);
+        benchmark<zmq::radix_tree_t> ("radix_tree", input_set, queries);
+        benchmark<zmq::art_tree_t> ("art_tree", input_set, queries);
+
+        for (auto &op : input_set)
+            delete[] op;
     }
-
-    // Create a benchmark.
-    std::printf ("keys = %llu, queries = %llu, key size = %llu\n",
-                 static_cast<unsigned long long> (nkeys),
-                 static_cast<unsigned long long> (nqueries),
-                 static_cast<unsigned long long> (key_length));
-    std::puts ("[trie]");
-    benchmark_lookup (trie, queries);
-
-    std::puts ("[radix_tree]");
-    benchmark_lookup (radix_tree, queries);
-
-    for (auto &op : input_set)
-        delete[] op;
 }
 
 #else
@@ -0,0 +1,170 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L
+
+#include "../include/zmq.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+//  Time taken by a ROUTER and a SERVER socket to send a message to one of
+//  many peers, picked at random, for 1k to 100k peers. The peers are the
+//  pipes of a single DEALER or CLIENT socket connected many times over
+//  inproc://, which the measurement does not include. An optional argument
+//  sets the largest number of peers.
+
+static const int batch_size = 10000;
+static const int batches = 20;
+
+static void check (bool ok_, const char *what_)
+{
+    if (!ok_) {
+        std::fprintf (stderr, "%s: %s\n", what_, zmq_strerror (zmq_errno ()));
+        std::exit (1);
+    }
+}
+
+static void set_int (void *socket_, int option_, int value_)
+{
+    check (zmq_setsockopt (socket_, option_, &value_, sizeof value_) == 0,
+           "zmq_setsockopt");
+}
+
+static void drain (void *socket_, int count_)
+{
+    char buffer[16];
+    for (int i = 0; i < count_; i++)
+        check (zmq_recv (socket_, buffer, sizeof buffer, 0) != -1,
+               "zmq_recv");
+}
+
+static double elapsed_ns (std::chrono::steady_clock::time_point start_)
+{
+    return std::chrono::duration<double, std::nano> (
+             std::chrono::steady_clock::now () - start_)
+      .count ();
+}
+
+static double benchmark_router (void *ctx_, int peers_, std::mt19937 &rng_)
+{
+    void *router = zmq_socket (ctx_, ZMQ_ROUTER);
+    void *dealer = zmq_socket (ctx_, ZMQ_DEALER);
+    check (router && dealer, "zmq_socket");
+    set_int (router, ZMQ_ROUTER_MANDATORY, 1);
+    const std::string endpoint =
+      "inproc://benchmark-router-" + std::to_string (peers_);
+    check (zmq_bind (router, endpoint.c_str ()) == 0, "zmq_bind");
+
+    //  Each connection brings its own routing id to the ROUTER.
+    std::vector<std::string> routing_ids (peers_);
+    for (int i = 0; i < peers_; i++) {
+        routing_ids[i] = "peer-" + std::to_string (i);
+        check (zmq_setsockopt (dealer, ZMQ_ROUTING_ID, routing_ids[i].data (),
+                               routing_ids[i].size ())
+                 == 0,
+               "zmq_setsockopt");
+        check (zmq_connect (dealer, endpoint.c_str ()) == 0, "zmq_connect");
+    }
+
+    std::uniform_int_distribution<int> peer (0, peers_ - 1);
+    std::vector<int> targets (batch_size);
+    double total = 0;
+    for (int batch = 0; batch < batches; batch++) {
+        for (int i = 0; i < batch_size; i++)
+            targets[i] = peer (rng_);
+
+        const auto start = std::chrono::steady_clock::now ();
+        for (int i = 0; i < batch_size; i++) {
+            const std::string &routing_id = routing_ids[targets[i]];
+            check (zmq_send (router, routing_id.data (), routing_id.size (),
+                             ZMQ_SNDMORE)
+                       != -1
+                     && zmq_send (router, "x", 1, 0) != -1,
+                   "zmq_send");
+        }
+        total += elapsed_ns (start);
+        drain (dealer, batch_size);
+    }
+
+    zmq_close (dealer);
+    zmq_close (router);
+    return total / (batches * batch_size);
+}
+
+static double benchmark_server (void *ctx_, int peers_, std::mt19937 &rng_)
+{
+    void *server = zmq_socket (ctx_, ZMQ_SERVER);
+    void *client = zmq_socket (ctx_, ZMQ_CLIENT);
+    check (server && client, "zmq_socket");
+    const std::string endpoint =
+      "inproc://benchmark-server-" + std::to_string (peers_);
+    check (zmq_bind (server, endpoint.c_str ()) == 0, "zmq_bind");
+    for (int i = 0; i < peers_; i++)
+        check (zmq_connect (client, endpoint.c_str ()) == 0, "zmq_connect");
+
+    //  The CLIENT sends round robin, so one message per peer tells the
+    //  SERVER all routing ids.
+    for (int i = 0; i < peers_; i++)
+        check (zmq_send (client, "x", 1, 0) != -1, "zmq_send");
+    std::vector<uint32_t> routing_ids (peers_);
+    zmq_msg_t msg;
+    zmq_msg_init (&msg);
+    for (int i = 0; i < peers_; i++) {
+        check (zmq_msg_recv (&msg, server, 0) != -1, "zmq_msg_recv");
+        routing_ids[i] = zmq_msg_routing_id (&msg);
+    }
+    zmq_msg_close (&msg);
+
+    std::uniform_int_distribution<int> peer (0, peers_ - 1);
+    std::vector<uint32_t> targets (batch_size);
+    double total = 0;
+    for (int batch = 0; batch < batches; batch++) {
+        for (int i = 0; i < batch_size; i++)
+            targets[i] = routing_ids[peer (rng_)];
+
+        const auto start = std::chrono::steady_clock::now ();
+        for (int i = 0; i < batch_size; i++) {
+            zmq_msg_init_size (&msg, 1);
+            zmq_msg_set_routing_id (&msg, targets[i]);
+            check (zmq_msg_send (&msg, server, 0) != -1, "zmq_msg_send");
+        }
+        total += elapsed_ns (start);
+        drain (client, batch_size);
+    }
+
+    zmq_close (client);
+    zmq_close (server);
+    return total / (batches * batch_size);
+}
+
+int main (int argc_, char *argv_[])
+{
+    const int max_peers = argc_ > 1 ? std::atoi (argv_[1]) : 100000;
+
+    void *ctx = zmq_ctx_new ();
+    check (ctx != NULL, "zmq_ctx_new");
+    std::mt19937 rng (42);
+
+    std::printf ("%10s %14s %14s\n", "peers", "ROUTER ns", "SERVER ns");
+    for (int peers = 1000; peers <= max_peers; peers *= 10) {
+        const double router = benchmark_router (ctx, peers, rng);
+        const double server = benchmark_server (ctx, peers, rng);
+        std::printf ("%10d %14.1f %14.1f\n", peers, router, server);
+    }
+
+    zmq_ctx_term (ctx);
+    return 0;
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L
+
+#include "precompiled.hpp"
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+//  Timers the way an I/O thread with many connections sees them: a million
+//  timers with timeouts spread over a minute, part of them cancelled before
+//  they expire and the rest run to expiry. Compares the timing wheel against
+//  the multimap with a linear cancel that poller_base_t used before.
+
+const std::size_t timer_count = 1000000;
+const std::size_t cancel_count = 1000;
+const uint64_t max_timeout = 60000;
+
+//  The timers as they used to be kept by poller_base_t.
+class multimap_timers_t
+{
+  public:
+    void add (uint64_t expiry_, void *owner_, int id_)
+    {
+        const entry_t entry = {owner_, id_};
+        _timers.insert (timers_t::value_type (expiry_, entry));
+    }
+
+    void cancel (void *owner_, int id_)
+    {
+        for (timers_t::iterator it = _timers.begin (), end = _timers.end ();
+             it != end; ++it)
+            if (it->second.owner == owner_ && it->second.id == id_) {
+                _timers.erase (it);
+                return;
+            }
+    }
+
+    std::size_t expire (uint64_t now_)
+    {
+        std::size_t expired = 0;
+        while (!_timers.empty () && _timers.begin ()->first <= now_) {
+            _timers.erase (_timers.begin ());
+            expired++;
+        }
+        return expired;
+    }
+
+  private:
+    struct entry_t
+    {
+        void *owner;
+        int id;
+    };
+    typedef std::multimap<uint64_t, entry_t> timers_t;
+    timers_t _timers;
+};
+
+class wheel_timers_t
+{
+  public:
+    void add (uint64_t expiry_, void *owner_, int id_)
+    {
+        _timers.add (new zmq::timer_wheel_t::node_t (owner_, id_), expiry_, 0);
+    }
+
+    void cancel (void *owner_, int id_)
+    {
+        zmq::timer_wheel_t::node_t *node = _timers.find (owner_, id_);
+        if (node) {
+            _timers.remove (node);
+            delete node;
+        }
+    }
+
+    std::size_t expire (uint64_t now_)
+    {
+        std::size_t expired = 0;
+        zmq::timer_wheel_t::node_t *node;
+        while ((node = _timers.pop_due (now_)) != NULL) {
+            delete node;
+            expired++;
+        }
+        return expired;
+    }
+
+  private:
+    zmq::timer_wheel_t _timers;
+};
+
+template <class T>
+void benchmark_timers (const char *name_,
+                       const std::vector<uint64_t> &expiries_,
+                       const std::vector<std::size_t> &cancels_)
+{
+    using namespace std::chrono;
+
+    //  Every timer belongs to an owner of its own, like the sessions and
+    //  engines of separate connections.
+    std::vector<char> owners (expiries_.size ());
+    T timers;
+
+    auto start = steady_clock::now ();
+    for (std::size_t i = 0; i < expiries_.size (); ++i)
+        timers.add (expiries_[i], &owners[i], 1);
+    const double add_time =
+      duration<double, std::nano> (steady_clock::now () - start).count ();
+
+    start = steady_clock::now ();
+    for (std::size_t i : cancels_)
+        timers.cancel (&owners[i], 1);
+    const double cancel_time =
+      duration<double, std::nano> (steady_clock::now () - start).count ();
+
+    //  Let the time run in 10 ms steps, the way a busy I/O thread polls.
+    std::size_t expired = 0;
+    start = steady_clock::now ();
+    for (uint64_t now = 0; now <= max_timeout; now += 10)
+        expired += timers.expire (now);
+    const double expire_time =
+      duration<double, std::nano> (steady_clock::now () - start).count ();
+
+    std::printf ("[%s]\n", name_);
+    std::printf ("  add:    %8.1lf ns/timer\n", add_time / expiries_.size ());
+    std::printf ("  cancel: %8.1lf ns/timer\n", cancel_time / cancels_.size ());
+    std::printf ("  expire: %8.1lf ns/timer (%llu expired)\n",
+                 expire_time / expired,
+                 static_cast<unsigned long long> (expired));
+}
+
+int main ()
+{
+    std::mt19937_64 generator (0x5eed);
+    std::uniform_int_distribution<uint64_t> timeout (0, max_timeout);
+
+    std::vector<uint64_t> expiries (timer_count);
+    for (auto &expiry : expiries)
+        expiry = timeout (generator);
+
+    std::vector<std::size_t> cancels (timer_count);
+    for (std::size_t i = 0; i < timer_count; ++i)
+        cancels[i] = i;
+    std::shuffle (cancels.begin (), cancels.end (), generator);
+    cancels.resize (cancel_count);
+
+    std::printf ("timers = %llu, cancelled = %llu\n",
+                 static_cast<unsigned long long> (timer_count),
+                 static_cast<unsigned long long> (cancel_count));
+    benchmark_timers<multimap_timers_t> ("multimap", expiries, cancels);
+    benchmark_timers<wheel_timers_t> ("timer_wheel", expiries, cancels);
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
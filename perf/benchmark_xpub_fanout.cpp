@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#if __cplusplus >= 201103L
+
+#include "precompiled.hpp"
+#include "array.hpp"
+#include "generic_mtrie_impl.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//  The work an XPUB socket does per published message: match the topic in
+//  its subscription trie and mark each matching subscriber in the
+//  distributor, which moves the matching pipes to the front of its array
+//  the way dist_t::match does. Sending itself is left out.
+
+const std::size_t subscriber_count = 10000;
+const std::size_t topic_count = 100;
+const std::size_t publish_count = 100000;
+
+struct subscriber_t : zmq::array_item_t<>
+{
+};
+
+class fanout_t
+{
+  public:
+    fanout_t (std::vector<subscriber_t> &subscribers_) : _matching (0)
+    {
+        for (auto &subscriber : subscribers_)
+            _subscribers.push_back (&subscriber);
+    }
+
+    static void mark_as_matching (subscriber_t *subscriber_, fanout_t *self_)
+    {
+        const std::size_t index = self_->_subscribers.index (subscriber_);
+        if (index < self_->_matching)
+            return;
+        self_->_subscribers.swap (index, self_->_matching);
+        self_->_matching++;
+    }
+
+    std::size_t unmatch ()
+    {
+        const std::size_t matching = _matching;
+        _matching = 0;
+        return matching;
+    }
+
+  private:
+    zmq::array_t<subscriber_t> _subscribers;
+    std::size_t _matching;
+};
+
+typedef zmq::generic_mtrie_t<subscriber_t> subscriptions_t;
+
+static std::string topic (std::size_t index_)
+{
+    char buf[32];
+    std::snprintf (buf, sizeof buf, "topic.%03u",
+                   static_cast<unsigned> (index_ % topic_count));
+    return buf;
+}
+
+static void subscribe (subscriptions_t &subscriptions_,
+                       const std::string &prefix_,
+                       subscriber_t *subscriber_)
+{
+    subscriptions_.add (
+      reinterpret_cast<const unsigned char *> (prefix_.data ()),
+      prefix_.size (), subscriber_);
+}
+
+static void benchmark (const char *name_,
+                       subscriptions_t &subscriptions_,
+                       std::vector<subscriber_t> &subscribers_)
+{
+    using namespace std::chrono;
+
+    fanout_t fanout (subscribers_);
+    std::vector<std::string> messages;
+    for (std::size_t i = 0; i < topic_count; ++i)
+        messages.push_back (topic (i) + " payload");
+
+    std::size_t delivered = 0;
+    const auto start = steady_clock::now ();
+    for (std::size_t i = 0; i < publish_count; ++i) {
+        const std::string &message = messages[i % topic_count];
+        subscriptions_.match (
+          reinterpret_cast<const unsigned char *> (message.data ()),
+          message.size (), fanout_t::mark_as_matching, &fanout);
+        delivered += fanout.unmatch ();
+    }
+    const double elapsed =
+      duration<double, std::nano> (steady_clock::now () - start).count ();
+
+    std::printf ("[%s]\n", name_);
+    std::printf ("  %8.1lf ns/message, %6.2lf ns/delivery, %.1lf "
+                 "subscribers/message\n",
+                 elapsed / publish_count, elapsed / delivered,
+                 static_cast<double> (delivered) / publish_count);
+}
+
+int main ()
+{
+    std::printf ("subscribers = %llu, topics = %llu, messages = %llu\n",
+                 static_cast<unsigned long long> (subscriber_count),
+                 static_cast<unsigned long long> (topic_count),
+                 static_cast<unsigned long long> (publish_count));
+
+    //  Every subscriber takes everything.
+    {
+        std::vector<subscriber_t> subscribers (subscriber_count);
+        subscriptions_t subscriptions;
+        for (auto &subscriber : subscribers)
+            subscribe (subscriptions, "", &subscriber);
+        benchmark ("broadcast", subscriptions, subscribers);
+    }
+
+    //  Every subscriber takes one topic.
+    {
+        std::vector<subscriber_t> subscribers (subscriber_count);
+        subscriptions_t subscriptions;
+        for (std::size_t i = 0; i < subscriber_count; ++i)
+            subscribe (subscriptions, topic (i), &subscribers[i]);
+        benchmark ("one topic each", subscriptions, subscribers);
+    }
+
+    //  Every subscriber takes one topic, and also the whole topic tree or
+    //  a prefix covering a tenth of the topics, so that most messages
+    //  match several nodes with overlapping subscribers.
+    {
+        std::vector<subscriber_t> subscribers (subscriber_count);
+        subscriptions_t subscriptions;
+        for (std::size_t i = 0; i < subscriber_count; ++i) {
+            subscribe (subscriptions, topic (i), &subscribers[i]);
+            if (i % 2 == 0)
+                subscribe (subscriptions, "topic.", &subscribers[i]);
+            else
+                subscribe (subscriptions, topic (i).substr (0, 8),
+                           &subscribers[i]);
+        }
+        benchmark ("overlapping prefixes", subscriptions, subscribers);
+    }
+}
+
+#else
+
+int main ()
+{
+}
+
+#endif
@@ -139,9 +139,17 @@ generate_output_file "proxy_thr" "" \
 
 
 # REQ/REP TCP latency CSV file:
-# NOTE: in this case it's the remote_lat utility that prints out the data, so we swap the local/remote arguments to the bash func:
+# NOTE: remote_lat measures and prints the CSV itself, sweeping all message sizes in one run:
 TEST_ENDPOINT="$REMOTE_TEST_ENDPOINT"
-generate_output_file "remote_lat" "local_lat" \
-    "reqrep_tcp_lat_results" \
-    "10000" \
-    "# message_size,message_count,latency[us]"
+MESSAGE_SIZE_CSV_LIST="$(echo $MESSAGE_SIZE_LIST | tr ' ' ',')"
+mkdir -p ${OUTPUT_DIR}
+pkill remote_lat
+ssh $REMOTE_IP_SSH "pkill local_lat"
+run_remote_perf_util "$MESSAGE_SIZE_CSV_LIST" "local_lat" "10000"
+./remote_lat -c $TEST_ENDPOINT $MESSAGE_SIZE_CSV_LIST 10000 >${OUTPUT_DIR}/reqrep_tcp_lat_results.csv
+wait
+
+# REQ/REP latency CSV file for all transports within a single process:
+./inproc_lat -c -t inproc,ipc,tcp $MESSAGE_SIZE_CSV_LIST 10000 >${OUTPUT_DIR}/reqrep_local_lat_results.csv
+
+echo "All latency measurements completed and saved into ${OUTPUT_DIR}"
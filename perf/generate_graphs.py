@@ -8,6 +8,7 @@
 # results for TCP:
 INPUT_FILE_PUSHPULL_TCP_THROUGHPUT="results/pushpull_tcp_thr_results.csv"
 INPUT_FILE_REQREP_TCP_LATENCY="results/reqrep_tcp_lat_results.csv"
+INPUT_FILE_REQREP_LOCAL_LATENCY="results/reqrep_local_lat_results.csv"
 TCP_LINK_GPBS=100
 
 # results for INPROC:
@@ -54,12 +55,23 @@ def plot_throughput(csv_filename, title, is_tcp=False):
     plt.show()
 
 def plot_latency(csv_filename, title):
-    message_size_bytes, message_count, lat = np.loadtxt(csv_filename, delimiter=',', unpack=True)
-    plt.semilogx(message_size_bytes, lat, label='Latency [us]', marker='o')
-    
+    # columns: transport,message_size,roundtrip_count,average,p50,p90,p99,p999,p9999,max
+    data = np.genfromtxt(csv_filename, delimiter=',', dtype=None, encoding=None, comments='#')
+    data = np.atleast_1d(data)
+    percentiles = [('p50', 4), ('p99', 6), ('p999', 7), ('p9999', 8)]
+
+    for transport in dict.fromkeys(row[0] for row in data):
+        rows = [row for row in data if row[0] == transport]
+        message_size_bytes = [row[1] for row in rows]
+        for name, column in percentiles:
+            plt.semilogx(message_size_bytes, [row[column] for row in rows],
+                         label='%s %s' % (transport, name), marker='o')
+
     plt.xlabel('Message size [B]')
     plt.ylabel('Latency [us]')
+    plt.yscale('log')
     plt.grid(True)
+    plt.legend()
     plt.title(title)
     plt.savefig(csv_filename.replace('.csv', '.png'))
     plt.show()
@@ -71,3 +83,4 @@ plot_throughput(INPUT_FILE_PUSHPULL_TCP_THROUGHPUT, 'ZeroMQ PUSH/PULL socket thr
 plot_throughput(INPUT_FILE_PUSHPULL_INPROC_THROUGHPUT, 'ZeroMQ PUSH/PULL socket throughput, INPROC transport')
 plot_throughput(INPUT_FILE_PUBSUBPROXY_INPROC_THROUGHPUT, 'ZeroMQ PUB/SUB PROXY socket throughput, INPROC transport')
 plot_latency(INPUT_FILE_REQREP_TCP_LATENCY, 'ZeroMQ REQ/REP socket latency, TCP transport')
+plot_latency(INPUT_FILE_REQREP_LOCAL_LATENCY, 'ZeroMQ REQ/REP socket latency percentiles, single process')
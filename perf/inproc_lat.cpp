@@ -1,10 +1,6 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
-#include "../include/zmq.h"
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
+#include "latency.hpp"
 
 #include "platform.hpp"
 
@@ -15,8 +11,16 @@
 #include <pthread.h>
 #endif
 
-static size_t message_size;
+//  Both ends of the test run in this process, over inproc by default. With
+//  -t they can talk over ipc and loopback tcp as well, each transport
+//  measured in turn.
+
 static int roundtrip_count;
+static int message_size_count;
+static int spin_time;
+static int adaptive;
+static char endpoint[256];
+static lat_histogram_t histogram;
 
 #if defined ZMQ_HAVE_WINDOWS
 static unsigned int __stdcall worker (void *ctx_)
@@ -35,7 +39,9 @@ static void *worker (void *ctx_)
         exit (1);
     }
 
-    rc = zmq_connect (s, "inproc://lat_test");
+    set_spin (s, spin_time, adaptive);
+
+    rc = zmq_connect (s, endpoint);
     if (rc != 0) {
         printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
         exit (1);
@@ -47,7 +53,7 @@ static void *worker (void *ctx_)
         exit (1);
     }
 
-    for (i = 0; i != roundtrip_count; i++) {
+    for (i = 0; i != roundtrip_count * message_size_count; i++) {
         rc = zmq_recvmsg (s, &msg, 0);
         if (rc < 0) {
             printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
@@ -79,101 +85,118 @@ static void *worker (void *ctx_)
 #endif
 }
 
-int main (int argc, char *argv[])
+//  Address to bind the measuring socket to, with the port or path chosen
+//  by the library.
+static const char *bind_address (const char *transport_)
+{
+    if (strcmp (transport_, "inproc") == 0)
+        return "inproc://lat_test";
+    if (strcmp (transport_, "ipc") == 0)
+        return "ipc://*";
+    if (strcmp (transport_, "tcp") == 0)
+        return "tcp://127.0.0.1:*";
+    printf ("unknown transport: %s\n", transport_);
+    exit (1);
+}
+
+static int measure (void *ctx_,
+                    const char *transport_,
+                    const size_t *message_sizes_,
+                    int csv_)
 {
 #if defined ZMQ_HAVE_WINDOWS
     HANDLE local_thread;
 #else
     pthread_t local_thread;
 #endif
-    void *ctx;
     void *s;
     int rc;
     int i;
+    int j;
+    size_t message_size;
+    size_t endpoint_size = sizeof (endpoint);
     zmq_msg_t msg;
-    void *watch;
-    unsigned long elapsed;
-    double latency;
-
-    if (argc != 3) {
-        printf ("usage: inproc_lat <message-size> <roundtrip-count>\n");
-        return 1;
-    }
-
-    message_size = atoi (argv[1]);
-    roundtrip_count = atoi (argv[2]);
-
-    ctx = zmq_init (1);
-    if (!ctx) {
-        printf ("error in zmq_init: %s\n", zmq_strerror (errno));
-        return -1;
-    }
+    unsigned long long start;
 
-    s = zmq_socket (ctx, ZMQ_REQ);
+    s = zmq_socket (ctx_, ZMQ_REQ);
     if (!s) {
         printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
         return -1;
     }
 
-    rc = zmq_bind (s, "inproc://lat_test");
+    set_spin (s, spin_time, adaptive);
+
+    rc = zmq_bind (s, bind_address (transport_));
     if (rc != 0) {
         printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
         return -1;
     }
+    rc = zmq_getsockopt (s, ZMQ_LAST_ENDPOINT, endpoint, &endpoint_size);
+    if (rc != 0) {
+        printf ("error in zmq_getsockopt: %s\n", zmq_strerror (errno));
+        return -1;
+    }
 
 #if defined ZMQ_HAVE_WINDOWS
-    local_thread = (HANDLE) _beginthreadex (NULL, 0, worker, ctx, 0, NULL);
+    local_thread = (HANDLE) _beginthreadex (NULL, 0, worker, ctx_, 0, NULL);
     if (local_thread == 0) {
         printf ("error in _beginthreadex\n");
         return -1;
     }
 #else
-    rc = pthread_create (&local_thread, NULL, worker, ctx);
+    rc = pthread_create (&local_thread, NULL, worker, ctx_);
     if (rc != 0) {
         printf ("error in pthread_create: %s\n", zmq_strerror (rc));
         return -1;
     }
 #endif
 
-    rc = zmq_msg_init_size (&msg, message_size);
-    if (rc != 0) {
-        printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
-        return -1;
-    }
-    memset (zmq_msg_data (&msg), 0, message_size);
+    for (j = 0; j != message_size_count; j++) {
+        message_size = message_sizes_[j];
 
-    printf ("message size: %d [B]\n", (int) message_size);
-    printf ("roundtrip count: %d\n", (int) roundtrip_count);
-
-    watch = zmq_stopwatch_start ();
-
-    for (i = 0; i != roundtrip_count; i++) {
-        rc = zmq_sendmsg (s, &msg, 0);
-        if (rc < 0) {
-            printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
+        rc = zmq_msg_init_size (&msg, message_size);
+        if (rc != 0) {
+            printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
             return -1;
         }
-        rc = zmq_recvmsg (s, &msg, 0);
-        if (rc < 0) {
-            printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
-            return -1;
+        memset (zmq_msg_data (&msg), 0, message_size);
+
+        lat_histogram_init (&histogram);
+        for (i = 0; i != roundtrip_count; i++) {
+            start = lat_clock_ns ();
+            rc = zmq_sendmsg (s, &msg, 0);
+            if (rc < 0) {
+                printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
+                return -1;
+            }
+            rc = zmq_recvmsg (s, &msg, 0);
+            if (rc < 0) {
+                printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
+                return -1;
+            }
+            lat_histogram_record (&histogram, lat_clock_ns () - start);
+            if (zmq_msg_size (&msg) != message_size) {
+                printf ("message of incorrect size received\n");
+                return -1;
+            }
         }
-        if (zmq_msg_size (&msg) != message_size) {
-            printf ("message of incorrect size received\n");
+
+        rc = zmq_msg_close (&msg);
+        if (rc != 0) {
+            printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
             return -1;
         }
-    }
 
-    elapsed = zmq_stopwatch_stop (watch);
-
-    rc = zmq_msg_close (&msg);
-    if (rc != 0) {
-        printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
-        return -1;
+        if (csv_)
+            lat_histogram_print_csv (&histogram, transport_, message_size);
+        else {
+            printf ("transport: %s\n", transport_);
+            printf ("message size: %d [B]\n", (int) message_size);
+            printf ("roundtrip count: %d\n", (int) roundtrip_count);
+            lat_histogram_print (&histogram);
+        }
     }
 
-    latency = (double) elapsed / (roundtrip_count * 2);
-
 #if defined ZMQ_HAVE_WINDOWS
     DWORD rc2 = WaitForSingleObject (local_thread, INFINITE);
     if (rc2 == WAIT_FAILED) {
@@ -193,14 +216,70 @@ int main (int argc, char *argv[])
     }
 #endif
 
-    printf ("average latency: %.3f [us]\n", (double) latency);
-
     rc = zmq_close (s);
     if (rc != 0) {
         printf ("error in zmq_close: %s\n", zmq_strerror (errno));
         return -1;
     }
 
+    return 0;
+}
+
+int main (int argc, char *argv[])
+{
+    void *ctx;
+    int rc;
+    size_t message_sizes[MAX_MESSAGE_SIZES];
+    char transports[64] = "inproc";
+    char *transport;
+    char *next;
+    int csv = 0;
+
+    while (argc > 1 && argv[1][0] == '-') {
+        if (strcmp (argv[1], "-c") == 0)
+            csv = 1;
+        else if (strcmp (argv[1], "-t") == 0 && argc > 2
+                 && strlen (argv[2]) < sizeof (transports)) {
+            strcpy (transports, argv[2]);
+            argc--;
+            argv++;
+        } else
+            break;
+        argc--;
+        argv++;
+    }
+    if (argc < 3 || argc > 5) {
+        printf ("usage: inproc_lat [-c] [-t <transport>[,...]] "
+                "<message-size>[,...] <roundtrip-count> "
+                "[<spin-time> [adaptive]]\n"
+                "  -c  print the results as CSV\n"
+                "  -t  transports to measure: inproc, ipc, tcp\n");
+        return 1;
+    }
+
+    message_size_count = parse_message_sizes (argv[1], message_sizes);
+    roundtrip_count = atoi (argv[2]);
+    spin_time = argc > 3 ? atoi (argv[3]) : 0;
+    adaptive = argc > 4 && strcmp (argv[4], "adaptive") == 0;
+
+    ctx = zmq_init (1);
+    if (!ctx) {
+        printf ("error in zmq_init: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    if (csv)
+        lat_print_csv_header ();
+
+    for (transport = transports; transport; transport = next) {
+        next = strchr (transport, ',');
+        if (next)
+            *next++ = 0;
+        rc = measure (ctx, transport, message_sizes, csv);
+        if (rc != 0)
+            return -1;
+    }
+
     rc = zmq_ctx_term (ctx);
     if (rc != 0) {
         printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
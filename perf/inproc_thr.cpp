@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
 #include "../include/zmq.h"
+#include "batch.hpp"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -17,6 +18,27 @@
 
 static int message_count;
 static size_t message_size;
+static int batch_size;
+
+#ifdef ZMQ_BUILD_DRAFT_API
+//  Number of blocks requested from the heap by the context's message
+//  allocator, when one is configured on the command line.
+static void *heap_allocations;
+static int use_allocator;
+
+static void *counting_allocate (size_t size_, void *hint_)
+{
+    (void) hint_;
+    zmq_atomic_counter_inc (heap_allocations);
+    return malloc (size_);
+}
+
+static void counting_deallocate (void *data_, void *hint_)
+{
+    (void) hint_;
+    free (data_);
+}
+#endif
 
 #if defined ZMQ_HAVE_WINDOWS
 static unsigned int __stdcall worker (void *ctx_)
@@ -27,6 +49,7 @@ static void *worker (void *ctx_)
     void *s;
     int rc;
     int i;
+    int count = message_count;
     zmq_msg_t msg;
 
     s = zmq_socket (ctx_, ZMQ_PUSH);
@@ -41,8 +64,21 @@ static void *worker (void *ctx_)
         exit (1);
     }
 
-    for (i = 0; i != message_count; i++) {
-        rc = zmq_msg_init_size (&msg, message_size);
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (batch_size) {
+        send_batches (s, message_count, message_size, batch_size,
+                      use_allocator ? ctx_ : NULL);
+        count = 0;
+    }
+#endif
+
+    for (i = 0; i != count; i++) {
+#ifdef ZMQ_BUILD_DRAFT_API
+        if (use_allocator)
+            rc = zmq_msg_init_ctx_size (&msg, ctx_, message_size);
+        else
+#endif
+            rc = zmq_msg_init_size (&msg, message_size);
         if (rc != 0) {
             printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
             exit (1);
@@ -87,19 +123,33 @@ int main (int argc, char *argv[])
     void *s;
     int rc;
     int i;
+    int count;
     zmq_msg_t msg;
     void *watch;
     unsigned long elapsed;
     unsigned long throughput;
     double megabits;
 
+    batch_size = parse_batch_size (&argc, &argv);
+
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (argc != 3 && argc != 4) {
+        printf ("usage: inproc_thr [-b <batch-size>] <message-size> "
+                "<message-count> [<allocator>]\n"
+                "  -b  send and receive up to batch-size messages per call\n"
+                "  allocator: 'malloc' or 'pool', reports heap allocations\n");
+        return 1;
+    }
+#else
     if (argc != 3) {
         printf ("usage: inproc_thr <message-size> <message-count>\n");
         return 1;
     }
+#endif
 
     message_size = atoi (argv[1]);
     message_count = atoi (argv[2]);
+    count = message_count - 1;
 
     ctx = zmq_init (1);
     if (!ctx) {
@@ -107,6 +157,22 @@ int main (int argc, char *argv[])
         return -1;
     }
 
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (argc == 4) {
+        zmq_msg_allocator_t fns = {counting_allocate, counting_deallocate,
+                                   NULL};
+        use_allocator = 1;
+        heap_allocations = zmq_atomic_counter_new ();
+        rc = zmq_ctx_set_ext (ctx, ZMQ_MSG_ALLOCATOR, &fns, sizeof (fns));
+        if (rc == 0)
+            rc = zmq_ctx_set (ctx, ZMQ_MSG_POOL, strcmp (argv[3], "pool") == 0);
+        if (rc != 0) {
+            printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+#endif
+
     s = zmq_socket (ctx, ZMQ_PULL);
     if (!s) {
         printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
@@ -141,6 +207,8 @@ int main (int argc, char *argv[])
 
     printf ("message size: %d [B]\n", (int) message_size);
     printf ("message count: %d\n", (int) message_count);
+    if (batch_size)
+        printf ("batch size: %d\n", batch_size);
 
     rc = zmq_recvmsg (s, &msg, 0);
     if (rc < 0) {
@@ -154,7 +222,14 @@ int main (int argc, char *argv[])
 
     watch = zmq_stopwatch_start ();
 
-    for (i = 0; i != message_count - 1; i++) {
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (batch_size) {
+        recv_batches (s, count, message_size, batch_size);
+        count = 0;
+    }
+#endif
+
+    for (i = 0; i != count; i++) {
         rc = zmq_recvmsg (s, &msg, 0);
         if (rc < 0) {
             printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
@@ -214,5 +289,14 @@ int main (int argc, char *argv[])
     printf ("mean throughput: %d [msg/s]\n", (int) throughput);
     printf ("mean throughput: %.3f [Mb/s]\n", (double) megabits);
 
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (use_allocator) {
+        printf ("heap allocations: %.3f [per msg]\n",
+                (double) zmq_atomic_counter_value (heap_allocations)
+                  / message_count);
+        zmq_atomic_counter_destroy (&heap_allocations);
+    }
+#endif
+
     return 0;
 }
@@ -0,0 +1,244 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_PERF_LATENCY_HPP_INCLUDED__
+#define __ZMQ_PERF_LATENCY_HPP_INCLUDED__
+
+//  Parts shared by the latency tools: the command line handling and a
+//  histogram of the round trip times.
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#if !defined CLOCK_MONOTONIC && __cplusplus >= 201103L
+#include <chrono>
+#endif
+#endif
+
+//  Makes blocking receives spin for up to spin_time_ microseconds before
+//  going to sleep, with the spin time tuned to the traffic if adaptive_.
+inline void set_spin (void *s_, int spin_time_, int adaptive_)
+{
+#ifdef ZMQ_BUILD_DRAFT_API
+    int rc = zmq_setsockopt (s_, ZMQ_SPIN_TIME, &spin_time_, sizeof (int));
+    if (rc == 0)
+        rc = zmq_setsockopt (s_, ZMQ_SPIN_ADAPTIVE, &adaptive_, sizeof (int));
+    if (rc != 0) {
+        printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+#else
+    if (spin_time_ != 0) {
+        printf ("spinning requires the draft API\n");
+        exit (1);
+    }
+    (void) s_;
+    (void) adaptive_;
+#endif
+}
+
+//  Monotonic clock for timing round trips, in nanoseconds. zmq_stopwatch
+//  only counts microseconds, too coarse for round trips that take a few.
+inline unsigned long long lat_clock_ns ()
+{
+#if defined _WIN32
+    LARGE_INTEGER frequency, count;
+    QueryPerformanceFrequency (&frequency);
+    QueryPerformanceCounter (&count);
+    return (unsigned long long) count.QuadPart / frequency.QuadPart
+             * 1000000000ULL
+           + (unsigned long long) count.QuadPart % frequency.QuadPart
+               * 1000000000ULL / frequency.QuadPart;
+#elif defined CLOCK_MONOTONIC
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#elif __cplusplus >= 201103L
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (
+             std::chrono::steady_clock::now ().time_since_epoch ())
+      .count ();
+#else
+    static void *watch = zmq_stopwatch_start ();
+    return (unsigned long long) zmq_stopwatch_intermediate (watch) * 1000;
+#endif
+}
+
+//  Smallest step of lat_clock_ns, as printed next to the latencies.
+inline unsigned long long lat_clock_resolution_ns ()
+{
+#if defined _WIN32
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency (&frequency);
+    return (1000000000ULL + frequency.QuadPart - 1) / frequency.QuadPart;
+#elif defined CLOCK_MONOTONIC
+    struct timespec ts;
+    clock_getres (CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#elif __cplusplus >= 201103L
+    const unsigned long long resolution =
+      1000000000ULL * std::chrono::steady_clock::period::num
+      / std::chrono::steady_clock::period::den;
+    return resolution ? resolution : 1;
+#else
+    return 1000;
+#endif
+}
+
+//  Message sizes are given as a comma separated list, which makes the
+//  tools sweep over all of them in a single run.
+#define MAX_MESSAGE_SIZES 64
+
+inline int parse_message_sizes (const char *arg_, size_t *sizes_)
+{
+    int count = 0;
+    while (*arg_) {
+        char *end;
+        const long size = strtol (arg_, &end, 10);
+        if (end == arg_ || size < 0 || (*end && *end != ',')
+            || count == MAX_MESSAGE_SIZES) {
+            printf ("invalid message sizes: %s\n", arg_);
+            exit (1);
+        }
+        sizes_[count++] = (size_t) size;
+        arg_ = *end ? end + 1 : end;
+    }
+    if (count == 0) {
+        printf ("no message size given\n");
+        exit (1);
+    }
+    return count;
+}
+
+//  Transport part of an endpoint, naming the rows of the CSV output.
+inline void transport_name (const char *endpoint_, char *name_, size_t size_)
+{
+    const char *end = strstr (endpoint_, "://");
+    size_t len = end ? (size_t) (end - endpoint_) : strlen (endpoint_);
+    if (len >= size_)
+        len = size_ - 1;
+    memcpy (name_, endpoint_, len);
+    name_[len] = 0;
+}
+
+//  Histogram of round trip times in nanoseconds, in the manner of HDR
+//  histograms: values below 2 * sub_buckets are counted exactly, larger
+//  ones in sub_buckets linear buckets per power of two. That bounds the
+//  relative error to 1 / sub_buckets over the whole range while keeping
+//  recording a matter of a few shifts.
+#define LAT_SUB_BUCKET_BITS 6
+#define LAT_SUB_BUCKETS (1 << LAT_SUB_BUCKET_BITS)
+#define LAT_BUCKETS (LAT_SUB_BUCKETS * (66 - LAT_SUB_BUCKET_BITS))
+
+struct lat_histogram_t
+{
+    unsigned long long counts[LAT_BUCKETS];
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned long long max;
+};
+
+inline void lat_histogram_init (lat_histogram_t *h_)
+{
+    memset (h_, 0, sizeof (lat_histogram_t));
+}
+
+inline int lat_bucket_index (unsigned long long value_)
+{
+    int shift = 0;
+    while ((value_ >> shift) >= 2 * LAT_SUB_BUCKETS)
+        shift++;
+    return shift * LAT_SUB_BUCKETS + (int) (value_ >> shift);
+}
+
+//  Largest value counted in the bucket.
+inline unsigned long long lat_bucket_value (int index_)
+{
+    if (index_ < 2 * LAT_SUB_BUCKETS)
+        return index_;
+    const int shift = index_ / LAT_SUB_BUCKETS - 1;
+    const unsigned long long sub = index_ - shift * LAT_SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+inline void lat_histogram_record (lat_histogram_t *h_,
+                                  unsigned long long value_)
+{
+    h_->counts[lat_bucket_index (value_)]++;
+    h_->count++;
+    h_->sum += value_;
+    if (value_ > h_->max)
+        h_->max = value_;
+}
+
+//  Value below or at which percentile_ percent of the samples are.
+inline unsigned long long
+lat_histogram_percentile (const lat_histogram_t *h_, double percentile_)
+{
+    unsigned long long rank =
+      (unsigned long long) (percentile_ / 100 * h_->count + 0.5);
+    if (rank == 0)
+        rank = 1;
+    unsigned long long seen = 0;
+    for (int i = 0; i != LAT_BUCKETS; i++) {
+        seen += h_->counts[i];
+        if (seen >= rank) {
+            const unsigned long long value = lat_bucket_value (i);
+            return value < h_->max ? value : h_->max;
+        }
+    }
+    return h_->max;
+}
+
+//  Latencies are reported one way, as half of the round trip times, and in
+//  microseconds.
+static const double lat_percentiles[] = {50, 90, 99, 99.9, 99.99};
+static const char *const lat_percentile_names[] = {"p50", "p90", "p99",
+                                                   "p999", "p9999"};
+#define LAT_PERCENTILES 5
+
+inline double lat_one_way_us (double roundtrip_ns_)
+{
+    return roundtrip_ns_ / 2000;
+}
+
+inline void lat_histogram_print (const lat_histogram_t *h_)
+{
+    printf ("clock resolution: %llu [ns]\n", lat_clock_resolution_ns ());
+    printf ("average latency: %.3f [us]\n",
+            lat_one_way_us (h_->count ? (double) h_->sum / h_->count : 0.0));
+    for (int i = 0; i != LAT_PERCENTILES; i++)
+        printf ("%s latency: %.3f [us]\n", lat_percentile_names[i],
+                lat_one_way_us (
+                  (double) lat_histogram_percentile (h_, lat_percentiles[i])));
+    printf ("max latency: %.3f [us]\n", lat_one_way_us ((double) h_->max));
+}
+
+//  CSV lines as read by generate_graphs.py, one per transport and message
+//  size.
+inline void lat_print_csv_header ()
+{
+    printf ("# transport,message_size,roundtrip_count,average[us]");
+    for (int i = 0; i != LAT_PERCENTILES; i++)
+        printf (",%s[us]", lat_percentile_names[i]);
+    printf (",max[us]\n");
+}
+
+inline void lat_histogram_print_csv (const lat_histogram_t *h_,
+                                     const char *transport_,
+                                     size_t message_size_)
+{
+    printf ("%s,%d,%llu,%.3f", transport_, (int) message_size_, h_->count,
+            lat_one_way_us (h_->count ? (double) h_->sum / h_->count : 0.0));
+    for (int i = 0; i != LAT_PERCENTILES; i++)
+        printf (",%.3f",
+                lat_one_way_us (
+                  (double) lat_histogram_percentile (h_, lat_percentiles[i])));
+    printf (",%.3f\n", lat_one_way_us ((double) h_->max));
+}
+
+#endif
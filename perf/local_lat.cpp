@@ -1,28 +1,32 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
-#include "../include/zmq.h"
-#include <stdio.h>
-#include <stdlib.h>
+#include "latency.hpp"
 
 int main (int argc, char *argv[])
 {
     const char *bind_to;
     int roundtrip_count;
-    size_t message_size;
+    size_t message_sizes[MAX_MESSAGE_SIZES];
+    int message_size_count;
     void *ctx;
     void *s;
     int rc;
     int i;
+    int j;
     zmq_msg_t msg;
+    int spin_time;
+    int adaptive;
 
-    if (argc != 4) {
-        printf ("usage: local_lat <bind-to> <message-size> "
-                "<roundtrip-count>\n");
+    if (argc < 4 || argc > 6) {
+        printf ("usage: local_lat <bind-to> <message-size>[,...] "
+                "<roundtrip-count> [<spin-time> [adaptive]]\n");
         return 1;
     }
     bind_to = argv[1];
-    message_size = atoi (argv[2]);
+    message_size_count = parse_message_sizes (argv[2], message_sizes);
     roundtrip_count = atoi (argv[3]);
+    spin_time = argc > 4 ? atoi (argv[4]) : 0;
+    adaptive = argc > 5 && strcmp (argv[5], "adaptive") == 0;
 
     ctx = zmq_init (1);
     if (!ctx) {
@@ -36,6 +40,8 @@ int main (int argc, char *argv[])
         return -1;
     }
 
+    set_spin (s, spin_time, adaptive);
+
     rc = zmq_bind (s, bind_to);
     if (rc != 0) {
         printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
@@ -48,22 +54,24 @@ int main (int argc, char *argv[])
         return -1;
     }
 
-    for (i = 0; i != roundtrip_count; i++) {
-        rc = zmq_recvmsg (s, &msg, 0);
-        if (rc < 0) {
-            printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
-            return -1;
-        }
-        if (zmq_msg_size (&msg) != message_size) {
-            printf ("message of incorrect size received\n");
-            return -1;
+    //  The message sizes come in the same order remote_lat sends them.
+    for (j = 0; j != message_size_count; j++)
+        for (i = 0; i != roundtrip_count; i++) {
+            rc = zmq_recvmsg (s, &msg, 0);
+            if (rc < 0) {
+                printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
+                return -1;
+            }
+            if (zmq_msg_size (&msg) != message_sizes[j]) {
+                printf ("message of incorrect size received\n");
+                return -1;
+            }
+            rc = zmq_sendmsg (s, &msg, 0);
+            if (rc < 0) {
+                printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
+                return -1;
+            }
         }
-        rc = zmq_sendmsg (s, &msg, 0);
-        if (rc < 0) {
-            printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
-            return -1;
-        }
-    }
 
     rc = zmq_msg_close (&msg);
     if (rc != 0) {
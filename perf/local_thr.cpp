@@ -1,12 +1,33 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
 #include "../include/zmq.h"
+#include "batch.hpp"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // keys are arbitrary but must match remote_lat.cpp
 const char server_prvkey[] = "{X}#>t#jRGaQ}gMhv=30r(Mw+87YGs+5%kh=i@f8";
 
+#ifdef ZMQ_BUILD_DRAFT_API
+//  Number of blocks requested from the heap by the context's message
+//  allocator, when one is configured on the command line.
+static void *heap_allocations;
+
+static void *counting_allocate (size_t size_, void *hint_)
+{
+    (void) hint_;
+    zmq_atomic_counter_inc (heap_allocations);
+    return malloc (size_);
+}
+
+static void counting_deallocate (void *data_, void *hint_)
+{
+    (void) hint_;
+    free (data_);
+}
+#endif
+
 int main (int argc, char *argv[])
 {
     const char *bind_to;
@@ -16,21 +37,34 @@ int main (int argc, char *argv[])
     void *s;
     int rc;
     int i;
+    int count;
     zmq_msg_t msg;
     void *watch;
     unsigned long elapsed;
     double throughput;
     double megabits;
     int curve = 0;
-
+    const int batch_size = parse_batch_size (&argc, &argv);
+
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (argc < 4 || argc > 6) {
+        printf ("usage: local_thr [-b <batch-size>] <bind-to> <message-size> "
+                "<message-count> [<enable_curve>] [<allocator>]\n"
+                "  -b  receive up to batch-size messages per call\n"
+                "  allocator: 'malloc' or 'pool', reports heap allocations\n");
+        return 1;
+    }
+#else
     if (argc != 4 && argc != 5) {
         printf ("usage: local_thr <bind-to> <message-size> <message-count> "
                 "[<enable_curve>]\n");
         return 1;
     }
+#endif
     bind_to = argv[1];
     message_size = atoi (argv[2]);
     message_count = atoi (argv[3]);
+    count = message_count - 1;
     if (argc >= 5 && atoi (argv[4])) {
         curve = 1;
     }
@@ -41,6 +75,21 @@ int main (int argc, char *argv[])
         return -1;
     }
 
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (argc == 6) {
+        zmq_msg_allocator_t fns = {counting_allocate, counting_deallocate,
+                                   NULL};
+        heap_allocations = zmq_atomic_counter_new ();
+        rc = zmq_ctx_set_ext (ctx, ZMQ_MSG_ALLOCATOR, &fns, sizeof (fns));
+        if (rc == 0)
+            rc = zmq_ctx_set (ctx, ZMQ_MSG_POOL, strcmp (argv[5], "pool") == 0);
+        if (rc != 0) {
+            printf ("error in zmq_ctx_set: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+#endif
+
     s = zmq_socket (ctx, ZMQ_PULL);
     if (!s) {
         printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
@@ -88,7 +137,14 @@ int main (int argc, char *argv[])
 
     watch = zmq_stopwatch_start ();
 
-    for (i = 0; i != message_count - 1; i++) {
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (batch_size) {
+        recv_batches (s, count, message_size, batch_size);
+        count = 0;
+    }
+#endif
+
+    for (i = 0; i != count; i++) {
         rc = zmq_recvmsg (s, &msg, 0);
         if (rc < 0) {
             printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
@@ -104,6 +160,17 @@ int main (int argc, char *argv[])
     if (elapsed == 0)
         elapsed = 1;
 
+#ifdef ZMQ_BUILD_DRAFT_API
+    //  The fewer reads the messages take, the better the sender managed
+    //  to coalesce its writes.
+    zmq_socket_stats_t stats;
+    rc = zmq_socket_stats (s, &stats, NULL, NULL);
+    if (rc != 0) {
+        printf ("error in zmq_socket_stats: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+#endif
+
     rc = zmq_msg_close (&msg);
     if (rc != 0) {
         printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
@@ -115,8 +182,15 @@ int main (int argc, char *argv[])
 
     printf ("message size: %d [B]\n", (int) message_size);
     printf ("message count: %d\n", (int) message_count);
+    if (batch_size)
+        printf ("batch size: %d\n", batch_size);
     printf ("mean throughput: %d [msg/s]\n", (int) throughput);
     printf ("mean throughput: %.3f [Mb/s]\n", (double) megabits);
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (stats.engine_reads)
+        printf ("mean messages per read: %.3f\n",
+                (double) stats.msgs_in / (double) stats.engine_reads);
+#endif
 
     rc = zmq_close (s);
     if (rc != 0) {
@@ -130,5 +204,14 @@ int main (int argc, char *argv[])
         return -1;
     }
 
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (heap_allocations) {
+        printf ("heap allocations: %.3f [per msg]\n",
+                (double) zmq_atomic_counter_value (heap_allocations)
+                  / message_count);
+        zmq_atomic_counter_destroy (&heap_allocations);
+    }
+#endif
+
     return 0;
 }
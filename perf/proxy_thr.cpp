@@ -35,6 +35,9 @@
    All connections use "inproc" transport. The two XPUB sockets start
    flooding the proxy. The throughput is computed using the bytes received
    in the SUB socket.
+
+   With -d, the proxy runs detached in an I/O thread of the context
+   (zmq_proxy_detached) instead of in an application thread.
 */
 
 
@@ -61,6 +64,7 @@
 
 static uint64_t message_count = 0;
 static size_t message_size = 0;
+static bool detached = false;
 
 
 typedef struct
@@ -202,9 +206,13 @@ static void subscriber_thread_main (void *pvoid)
     //printf ("subscriber thread ended\n");
 }
 
-static void proxy_thread_main (void *pvoid)
+//  Creates and binds the frontend and backend sockets of the proxy, and
+//  its control socket if asked for one.
+static void create_proxy_sockets (const proxy_hwm_cfg_t *cfg,
+                                  void **frontend_,
+                                  void **backend_,
+                                  void **control_)
 {
-    const proxy_hwm_cfg_t *cfg = (proxy_hwm_cfg_t *) pvoid;
     int rc;
 
     //  FRONTEND SUB
@@ -250,6 +258,11 @@ static void proxy_thread_main (void *pvoid)
         }
     }
 
+    *frontend_ = frontend_xsub;
+    *backend_ = backend_xpub;
+    if (!control_)
+        return;
+
     //  CONTROL REP
 
     void *control_rep = zmq_socket (
@@ -261,16 +274,45 @@ static void proxy_thread_main (void *pvoid)
     rc = zmq_bind (control_rep, cfg->control_endpoint);
     ASSERT_EXPR_SAFE (rc == 0);
 
-    //  Start proxying!
+    *control_ = control_rep;
+}
+
+static void proxy_thread_main (void *pvoid)
+{
+    const proxy_hwm_cfg_t *cfg = (proxy_hwm_cfg_t *) pvoid;
+
+    void *frontend_xsub;
+    void *backend_xpub;
+    create_proxy_sockets (cfg, &frontend_xsub, &backend_xpub, NULL);
+
+    //  Start proxying! It runs until the context is shut down.
 
-    zmq_proxy_steerable (frontend_xsub, backend_xpub, NULL, control_rep);
+    zmq_proxy (frontend_xsub, backend_xpub, NULL);
 
     zmq_close (frontend_xsub);
     zmq_close (backend_xpub);
-    zmq_close (control_rep);
     //printf ("proxy thread ended\n");
 }
 
+//  Hands the sockets over to a proxy in an I/O thread, which closes them
+//  once it is terminated.
+static void start_detached_proxy (const proxy_hwm_cfg_t *cfg)
+{
+#ifdef ZMQ_BUILD_DRAFT_API
+    void *frontend_xsub;
+    void *backend_xpub;
+    void *control_rep;
+    create_proxy_sockets (cfg, &frontend_xsub, &backend_xpub, &control_rep);
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_proxy_detached (frontend_xsub, backend_xpub, NULL, control_rep));
+#else
+    (void) cfg;
+    printf ("the detached proxy requires the draft API\n");
+    exit (1);
+#endif
+}
+
 void terminate_proxy (const proxy_hwm_cfg_t *cfg)
 {
     //  CONTROL REQ
@@ -297,8 +339,13 @@ void terminate_proxy (const proxy_hwm_cfg_t *cfg)
 
 int main (int argc, char *argv[])
 {
+    if (argc == 4 && strcmp (argv[1], "-d") == 0) {
+        detached = true;
+        argc--;
+        argv++;
+    }
     if (argc != 3) {
-        printf ("usage: proxy_thr <message-size> <message-count>\n");
+        printf ("usage: proxy_thr [-d] <message-size> <message-count>\n");
         return 1;
     }
 
@@ -306,6 +353,7 @@ int main (int argc, char *argv[])
     message_count = atoi (argv[2]);
     printf ("message size: %d [B]\n", (int) message_size);
     printf ("message count: %d\n", (int) message_count);
+    printf ("proxy: %s\n", detached ? "detached" : "application thread");
 
     void *context = zmq_ctx_new ();
     assert (context);
@@ -328,8 +376,13 @@ int main (int argc, char *argv[])
 
     //  Proxy
     proxy_hwm_cfg_t cfg_proxy = cfg_global;
-    void *proxy = zmq_threadstart (&proxy_thread_main, (void *) &cfg_proxy);
-    assert (proxy != 0);
+    void *proxy = NULL;
+    if (detached)
+        start_detached_proxy (&cfg_proxy);
+    else {
+        proxy = zmq_threadstart (&proxy_thread_main, (void *) &cfg_proxy);
+        assert (proxy != 0);
+    }
 
     //  Subscriber 1
     proxy_hwm_cfg_t cfg_sub1 = cfg_global;
@@ -375,8 +428,12 @@ int main (int argc, char *argv[])
     zmq_threadclose (publisher2);
 
     //  ... then close the proxy
-    terminate_proxy (&cfg_proxy);
-    zmq_threadclose (proxy);
+    if (detached)
+        terminate_proxy (&cfg_proxy);
+    else {
+        zmq_ctx_shutdown (context);
+        zmq_threadclose (proxy);
+    }
 
     int rc = zmq_ctx_term (context);
     ASSERT_EXPR_SAFE (rc == 0);
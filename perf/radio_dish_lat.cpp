@@ -0,0 +1,195 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Measures the latency of RADIO/DISH over UDP. A worker thread echoes the
+//  messages back over a second pair of sockets. Datagrams may get lost, in
+//  which case the round trip is counted as lost after a second.
+
+#ifdef ZMQ_BUILD_DRAFT_API
+static const char *address;
+static int port;
+static size_t message_size;
+static int roundtrip_count;
+static int batch_size;
+
+static void *open_socket (void *ctx_, int type_, int port_, int timeout_)
+{
+    char endpoint[256];
+    int rc;
+
+    void *s = zmq_socket (ctx_, type_);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    if (batch_size > 0) {
+        rc = zmq_setsockopt (s, ZMQ_UDP_BATCH_SIZE, &batch_size,
+                             sizeof (batch_size));
+        if (rc != 0) {
+            printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+    }
+
+    if (type_ == ZMQ_DISH) {
+        rc = zmq_setsockopt (s, ZMQ_RCVTIMEO, &timeout_, sizeof (timeout_));
+        if (rc == 0) {
+            snprintf (endpoint, sizeof (endpoint), "udp://*:%d", port_);
+            rc = zmq_bind (s, endpoint);
+        }
+        if (rc == 0)
+            rc = zmq_join (s, "lat");
+    } else {
+        snprintf (endpoint, sizeof (endpoint), "udp://%s:%d", address, port_);
+        rc = zmq_connect (s, endpoint);
+    }
+    if (rc != 0) {
+        printf ("error in socket setup: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+    return s;
+}
+
+static void worker (void *ctx_)
+{
+    void *dish = open_socket (ctx_, ZMQ_DISH, port, -1);
+    void *radio = open_socket (ctx_, ZMQ_RADIO, port + 1, -1);
+    zmq_msg_t msg;
+    int rc;
+
+    rc = zmq_msg_init (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    //  Echo until the context is terminated.
+    while (zmq_recvmsg (dish, &msg, 0) >= 0) {
+        rc = zmq_sendmsg (radio, &msg, 0);
+        if (rc < 0) {
+            printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+    }
+
+    zmq_msg_close (&msg);
+    zmq_close (dish);
+    zmq_close (radio);
+}
+#endif
+
+int main (int argc, char *argv[])
+{
+#ifdef ZMQ_BUILD_DRAFT_API
+    void *ctx;
+    void *radio;
+    void *dish;
+    void *thread;
+    int rc;
+    int i;
+    int lost = 0;
+    zmq_msg_t msg;
+    void *watch;
+    unsigned long elapsed;
+    double latency;
+
+    if (argc != 5 && argc != 6) {
+        printf ("usage: radio_dish_lat <address> <port> <message-size> "
+                "<roundtrip-count> [<batch-size>]\n"
+                "  uses UDP ports <port> and <port>+1\n");
+        return 1;
+    }
+    address = argv[1];
+    port = atoi (argv[2]);
+    message_size = atoi (argv[3]);
+    roundtrip_count = atoi (argv[4]);
+    batch_size = argc == 6 ? atoi (argv[5]) : 0;
+
+    ctx = zmq_init (1);
+    if (!ctx) {
+        printf ("error in zmq_init: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    dish = open_socket (ctx, ZMQ_DISH, port + 1, 1000);
+    radio = open_socket (ctx, ZMQ_RADIO, port, -1);
+    thread = zmq_threadstart (worker, ctx);
+
+    //  Let both ends join their groups before measuring.
+    zmq_sleep (1);
+
+    watch = zmq_stopwatch_start ();
+
+    for (i = 0; i != roundtrip_count; i++) {
+        rc = zmq_msg_init_size (&msg, message_size);
+        if (rc == 0)
+            rc = zmq_msg_set_group (&msg, "lat");
+        if (rc != 0) {
+            printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_sendmsg (radio, &msg, 0);
+        if (rc < 0) {
+            printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_msg_init (&msg);
+        if (rc != 0) {
+            printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_recvmsg (dish, &msg, 0);
+        if (rc < 0 && errno == EAGAIN)
+            lost++;
+        else if (rc < 0) {
+            printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
+            return -1;
+        } else if (zmq_msg_size (&msg) != message_size) {
+            printf ("message of incorrect size received\n");
+            return -1;
+        }
+        rc = zmq_msg_close (&msg);
+        if (rc != 0) {
+            printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    elapsed = zmq_stopwatch_stop (watch);
+
+    //  Lost round trips took a full timeout; leave them out.
+    if (roundtrip_count > lost)
+        latency = ((double) elapsed - lost * 1000000.0)
+                  / ((roundtrip_count - lost) * 2);
+    else
+        latency = 0;
+
+    printf ("message size: %d [B]\n", (int) message_size);
+    printf ("roundtrip count: %d\n", (int) roundtrip_count);
+    printf ("lost: %d\n", lost);
+    printf ("average latency: %.3f [us]\n", (double) latency);
+
+    zmq_close (radio);
+    zmq_close (dish);
+
+    //  Terminating the context stops the worker.
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+    zmq_threadclose (thread);
+
+    return 0;
+#else
+    (void) argc;
+    (void) argv;
+    printf ("radio_dish_lat requires the draft API\n");
+    return 1;
+#endif
+}
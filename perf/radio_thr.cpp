@@ -0,0 +1,120 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Sending end of the RADIO/DISH throughput test over UDP, see dish_thr.
+
+int main (int argc, char *argv[])
+{
+#ifdef ZMQ_BUILD_DRAFT_API
+    const char *connect_to;
+    int message_count;
+    int message_size;
+    void *ctx;
+    void *s;
+    int rc;
+    int i;
+    zmq_msg_t msg;
+    void *watch;
+    unsigned long elapsed;
+    int hwm = 0;
+
+    if (argc != 4 && argc != 5) {
+        printf ("usage: radio_thr <connect-to> <message-size> "
+                "<message-count> [<batch-size>]\n");
+        return 1;
+    }
+    connect_to = argv[1];
+    message_size = atoi (argv[2]);
+    message_count = atoi (argv[3]);
+
+    ctx = zmq_init (1);
+    if (!ctx) {
+        printf ("error in zmq_init: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    s = zmq_socket (ctx, ZMQ_RADIO);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    //  RADIO drops messages when the pipe is full; queue them all instead,
+    //  so that the test measures how fast they can be put on the wire.
+    rc = zmq_setsockopt (s, ZMQ_SNDHWM, &hwm, sizeof (hwm));
+    if (rc != 0) {
+        printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    //  Number of datagrams sent by a single system call.
+    if (argc == 5) {
+        int batch_size = atoi (argv[4]);
+        rc = zmq_setsockopt (s, ZMQ_UDP_BATCH_SIZE, &batch_size,
+                             sizeof (batch_size));
+        if (rc != 0) {
+            printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    rc = zmq_connect (s, connect_to);
+    if (rc != 0) {
+        printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    watch = zmq_stopwatch_start ();
+
+    for (i = 0; i != message_count; i++) {
+        rc = zmq_msg_init_size (&msg, message_size);
+        if (rc != 0) {
+            printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_msg_set_group (&msg, "perf");
+        if (rc != 0) {
+            printf ("error in zmq_msg_set_group: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_sendmsg (s, &msg, 0);
+        if (rc < 0) {
+            printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    //  Terminating the context waits for all the messages to be sent.
+    rc = zmq_close (s);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    elapsed = zmq_stopwatch_stop (watch);
+    if (elapsed == 0)
+        elapsed = 1;
+
+    printf ("message size: %d [B]\n", message_size);
+    printf ("message count: %d\n", message_count);
+    printf ("mean send rate: %d [msg/s]\n",
+            (int) ((double) message_count / (double) elapsed * 1000000));
+
+    return 0;
+#else
+    (void) argc;
+    (void) argv;
+    printf ("radio_thr requires the draft API\n");
+    return 1;
+#endif
+}
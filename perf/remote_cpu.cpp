@@ -0,0 +1,179 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../include/zmq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+//  Sends large messages to local_thr and reports the CPU time the sending
+//  process spent per gigabyte, split into user and kernel time. The payload
+//  is shared by all the messages, so the figures only cover the work done
+//  by the library and the kernel.
+
+static void cpu_times (double *user_, double *system_)
+{
+#if defined _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetProcessTimes (GetCurrentProcess (), &creation, &exit, &kernel, &user);
+    ULARGE_INTEGER u, k;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    *user_ = (double) u.QuadPart / 10000000;
+    *system_ = (double) k.QuadPart / 10000000;
+#else
+    struct rusage usage;
+    getrusage (RUSAGE_SELF, &usage);
+    *user_ = usage.ru_utime.tv_sec + (double) usage.ru_utime.tv_usec / 1000000;
+    *system_ =
+      usage.ru_stime.tv_sec + (double) usage.ru_stime.tv_usec / 1000000;
+#endif
+}
+
+static void free_payload (void *data_, void *hint_)
+{
+    (void) hint_;
+    free (data_);
+}
+
+int main (int argc, char *argv[])
+{
+    const char *connect_to;
+    int message_count;
+    size_t message_size;
+    void *ctx;
+    void *s;
+    int rc;
+    int i;
+    zmq_msg_t payload;
+    zmq_msg_t msg;
+    void *data;
+    void *watch;
+    unsigned long elapsed;
+    double user_start, system_start;
+    double user_end, system_end;
+    double gigabytes;
+
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (argc != 4 && argc != 5) {
+        printf ("usage: remote_cpu <connect-to> <message-size> "
+                "<message-count> [<zerocopy_threshold>]\n");
+        return 1;
+    }
+#else
+    if (argc != 4) {
+        printf ("usage: remote_cpu <connect-to> <message-size> "
+                "<message-count>\n");
+        return 1;
+    }
+#endif
+    connect_to = argv[1];
+    message_size = atoi (argv[2]);
+    message_count = atoi (argv[3]);
+
+    ctx = zmq_init (1);
+    if (!ctx) {
+        printf ("error in zmq_init: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    s = zmq_socket (ctx, ZMQ_PUSH);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+#ifdef ZMQ_BUILD_DRAFT_API
+    //  Message bodies of at least this size are sent without copying them
+    //  into the kernel. -1 (the default) disables it.
+    if (argc == 5) {
+        int threshold = atoi (argv[4]);
+        rc = zmq_setsockopt (s, ZMQ_ZEROCOPY_THRESHOLD, &threshold,
+                             sizeof (threshold));
+        if (rc != 0) {
+            printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+#endif
+
+    rc = zmq_connect (s, connect_to);
+    if (rc != 0) {
+        printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    data = malloc (message_size);
+    if (!data) {
+        printf ("error in malloc\n");
+        return -1;
+    }
+    memset (data, 'x', message_size);
+    rc = zmq_msg_init_data (&payload, data, message_size, free_payload, NULL);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init_data: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    watch = zmq_stopwatch_start ();
+    cpu_times (&user_start, &system_start);
+
+    for (i = 0; i != message_count; i++) {
+        rc = zmq_msg_init (&msg);
+        if (rc == 0)
+            rc = zmq_msg_copy (&msg, &payload);
+        if (rc != 0) {
+            printf ("error in zmq_msg_copy: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+        rc = zmq_sendmsg (s, &msg, 0);
+        if (rc < 0) {
+            printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    rc = zmq_msg_close (&payload);
+    if (rc != 0) {
+        printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    //  Terminating the context waits for all the messages to be sent.
+    rc = zmq_close (s);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    cpu_times (&user_end, &system_end);
+    elapsed = zmq_stopwatch_stop (watch);
+    if (elapsed == 0)
+        elapsed = 1;
+
+    gigabytes = (double) message_size * message_count / 1000000000;
+
+    printf ("message size: %d [B]\n", (int) message_size);
+    printf ("message count: %d\n", (int) message_count);
+    printf ("elapsed: %.3f [s]\n", (double) elapsed / 1000000);
+    printf ("throughput: %.3f [GB/s]\n", gigabytes * 1000000 / elapsed);
+    printf ("user CPU per GB: %.3f [s]\n", (user_end - user_start) / gigabytes);
+    printf ("system CPU per GB: %.3f [s]\n",
+            (system_end - system_start) / gigabytes);
+
+    return 0;
+}
@@ -1,32 +1,45 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
-#include "../include/zmq.h"
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
+#include "latency.hpp"
+
+static lat_histogram_t histogram;
 
 int main (int argc, char *argv[])
 {
     const char *connect_to;
     int roundtrip_count;
+    size_t message_sizes[MAX_MESSAGE_SIZES];
+    int message_size_count;
     size_t message_size;
     void *ctx;
     void *s;
     int rc;
     int i;
+    int j;
     zmq_msg_t msg;
-    void *watch;
-    unsigned long elapsed;
-    double latency;
-
-    if (argc != 4) {
-        printf ("usage: remote_lat <connect-to> <message-size> "
-                "<roundtrip-count>\n");
+    unsigned long long start;
+    int spin_time;
+    int adaptive;
+    int csv = 0;
+    char transport[32];
+
+    if (argc > 1 && strcmp (argv[1], "-c") == 0) {
+        csv = 1;
+        argc--;
+        argv++;
+    }
+    if (argc < 4 || argc > 6) {
+        printf ("usage: remote_lat [-c] <connect-to> <message-size>[,...] "
+                "<roundtrip-count> [<spin-time> [adaptive]]\n"
+                "  -c  print the results as CSV\n");
         return 1;
     }
     connect_to = argv[1];
-    message_size = atoi (argv[2]);
+    message_size_count = parse_message_sizes (argv[2], message_sizes);
     roundtrip_count = atoi (argv[3]);
+    spin_time = argc > 4 ? atoi (argv[4]) : 0;
+    adaptive = argc > 5 && strcmp (argv[5], "adaptive") == 0;
+    transport_name (connect_to, transport, sizeof (transport));
 
     ctx = zmq_init (1);
     if (!ctx) {
@@ -40,52 +53,62 @@ int main (int argc, char *argv[])
         return -1;
     }
 
+    set_spin (s, spin_time, adaptive);
+
     rc = zmq_connect (s, connect_to);
     if (rc != 0) {
         printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
         return -1;
     }
 
-    rc = zmq_msg_init_size (&msg, message_size);
-    if (rc != 0) {
-        printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
-        return -1;
-    }
-    memset (zmq_msg_data (&msg), 0, message_size);
+    if (csv)
+        lat_print_csv_header ();
 
-    watch = zmq_stopwatch_start ();
+    for (j = 0; j != message_size_count; j++) {
+        message_size = message_sizes[j];
 
-    for (i = 0; i != roundtrip_count; i++) {
-        rc = zmq_sendmsg (s, &msg, 0);
-        if (rc < 0) {
-            printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
+        rc = zmq_msg_init_size (&msg, message_size);
+        if (rc != 0) {
+            printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
             return -1;
         }
-        rc = zmq_recvmsg (s, &msg, 0);
-        if (rc < 0) {
-            printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
-            return -1;
+        memset (zmq_msg_data (&msg), 0, message_size);
+
+        lat_histogram_init (&histogram);
+        for (i = 0; i != roundtrip_count; i++) {
+            start = lat_clock_ns ();
+            rc = zmq_sendmsg (s, &msg, 0);
+            if (rc < 0) {
+                printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
+                return -1;
+            }
+            rc = zmq_recvmsg (s, &msg, 0);
+            if (rc < 0) {
+                printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
+                return -1;
+            }
+            lat_histogram_record (&histogram, lat_clock_ns () - start);
+            if (zmq_msg_size (&msg) != message_size) {
+                printf ("message of incorrect size received\n");
+                return -1;
+            }
         }
-        if (zmq_msg_size (&msg) != message_size) {
-            printf ("message of incorrect size received\n");
+
+        rc = zmq_msg_close (&msg);
+        if (rc != 0) {
+            printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
             return -1;
         }
-    }
 
-    elapsed = zmq_stopwatch_stop (watch);
-
-    rc = zmq_msg_close (&msg);
-    if (rc != 0) {
-        printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
-        return -1;
+        if (csv)
+            lat_histogram_print_csv (&histogram, transport, message_size);
+        else {
+            printf ("message size: %d [B]\n", (int) message_size);
+            printf ("roundtrip count: %d\n", (int) roundtrip_count);
+            lat_histogram_print (&histogram);
+        }
     }
 
-    latency = (double) elapsed / (roundtrip_count * 2);
-
-    printf ("message size: %d [B]\n", (int) message_size);
-    printf ("roundtrip count: %d\n", (int) roundtrip_count);
-    printf ("average latency: %.3f [us]\n", (double) latency);
-
     rc = zmq_close (s);
     if (rc != 0) {
         printf ("error in zmq_close: %s\n", zmq_strerror (errno));
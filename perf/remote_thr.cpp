@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
 #include "../include/zmq.h"
+#include "batch.hpp"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,17 +20,31 @@ int main (int argc, char *argv[])
     void *s;
     int rc;
     int i;
+    int count;
     zmq_msg_t msg;
     int curve = 0;
+    const int batch_size = parse_batch_size (&argc, &argv);
 
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (argc < 4 || argc > 7) {
+        printf ("usage: remote_thr [-b <batch-size>] <connect-to> "
+                "<message-size> <message-count> [<enable_curve>] "
+                "[<out_iov_threshold>] [<cork_delay>]\n"
+                "  -b  send up to batch-size messages per call\n"
+                "  cork_delay: microseconds small writes are held back\n");
+        return 1;
+    }
+#else
     if (argc != 4 && argc != 5) {
         printf ("usage: remote_thr <connect-to> <message-size> "
                 "<message-count> [<enable_curve>]\n");
         return 1;
     }
+#endif
     connect_to = argv[1];
     message_size = atoi (argv[2]);
     message_count = atoi (argv[3]);
+    count = message_count;
     if (argc >= 5 && atoi (argv[4])) {
         curve = 1;
     }
@@ -71,13 +86,46 @@ int main (int argc, char *argv[])
         }
     }
 
+#ifdef ZMQ_BUILD_DRAFT_API
+    //  Compare gathered writes of message bodies (threshold in bytes)
+    //  with copying them to the output batch (-1).
+    if (argc >= 6) {
+        int threshold = atoi (argv[5]);
+        rc = zmq_setsockopt (s, ZMQ_OUT_IOV_THRESHOLD, &threshold,
+                             sizeof (threshold));
+        if (rc != 0) {
+            printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+
+    //  Hold back small writes to coalesce them (delay in microseconds).
+    if (argc >= 7) {
+        int delay = atoi (argv[6]);
+        rc = zmq_setsockopt (s, ZMQ_CORK_DELAY, &delay, sizeof (delay));
+        if (rc != 0) {
+            printf ("error in zmq_setsockopt: %s\n", zmq_strerror (errno));
+            return -1;
+        }
+    }
+#endif
+
     rc = zmq_connect (s, connect_to);
     if (rc != 0) {
         printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
         return -1;
     }
 
-    for (i = 0; i != message_count; i++) {
+#ifdef ZMQ_BUILD_DRAFT_API
+    if (batch_size) {
+        send_batches (s, count, message_size, batch_size, NULL);
+        count = 0;
+    }
+#else
+    (void) batch_size;
+#endif
+
+    for (i = 0; i != count; i++) {
         rc = zmq_msg_init_size (&msg, message_size);
         if (rc != 0) {
             printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
@@ -0,0 +1,180 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "latency.hpp"
+
+//  Compares the throughput of web sockets with plain tcp over loopback.
+//  The pushing side connects, so it is the web socket client which masks
+//  every frame, and the pulling side unmasks them.
+
+static int message_count;
+static size_t message_size;
+static char endpoint[256];
+
+static void worker (void *ctx_)
+{
+    void *s;
+    int rc;
+    int i;
+    zmq_msg_t msg;
+
+    s = zmq_socket (ctx_, ZMQ_PUSH);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    rc = zmq_connect (s, endpoint);
+    if (rc != 0) {
+        printf ("error in zmq_connect: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    for (i = 0; i != message_count; i++) {
+        rc = zmq_msg_init_size (&msg, message_size);
+        if (rc != 0) {
+            printf ("error in zmq_msg_init_size: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+        memset (zmq_msg_data (&msg), 0, message_size);
+
+        rc = zmq_sendmsg (s, &msg, 0);
+        if (rc < 0) {
+            printf ("error in zmq_sendmsg: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+    }
+
+    rc = zmq_close (s);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+}
+
+//  Throughput in megabits per second for one transport and message size.
+static double measure (void *ctx_, const char *transport_)
+{
+    void *s;
+    void *thread;
+    int rc;
+    int i;
+    size_t endpoint_size = sizeof (endpoint);
+    zmq_msg_t msg;
+    void *watch;
+    unsigned long elapsed;
+
+    s = zmq_socket (ctx_, ZMQ_PULL);
+    if (!s) {
+        printf ("error in zmq_socket: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    snprintf (endpoint, sizeof (endpoint), "%s://127.0.0.1:*", transport_);
+    rc = zmq_bind (s, endpoint);
+    if (rc == 0)
+        rc = zmq_getsockopt (s, ZMQ_LAST_ENDPOINT, endpoint, &endpoint_size);
+    if (rc != 0) {
+        printf ("error in zmq_bind: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    thread = zmq_threadstart (worker, ctx_);
+
+    rc = zmq_msg_init (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_init: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    //  Start timing with the first message, after the connection is up.
+    rc = zmq_recvmsg (s, &msg, 0);
+    if (rc < 0) {
+        printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    watch = zmq_stopwatch_start ();
+
+    for (i = 0; i != message_count - 1; i++) {
+        rc = zmq_recvmsg (s, &msg, 0);
+        if (rc < 0) {
+            printf ("error in zmq_recvmsg: %s\n", zmq_strerror (errno));
+            exit (1);
+        }
+        if (zmq_msg_size (&msg) != message_size) {
+            printf ("message of incorrect size received\n");
+            exit (1);
+        }
+    }
+
+    elapsed = zmq_stopwatch_stop (watch);
+    if (elapsed == 0)
+        elapsed = 1;
+
+    rc = zmq_msg_close (&msg);
+    if (rc != 0) {
+        printf ("error in zmq_msg_close: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    zmq_threadclose (thread);
+
+    rc = zmq_close (s);
+    if (rc != 0) {
+        printf ("error in zmq_close: %s\n", zmq_strerror (errno));
+        exit (1);
+    }
+
+    return (double) (message_count - 1) * message_size * 8 / elapsed;
+}
+
+int main (int argc, char *argv[])
+{
+    void *ctx;
+    int rc;
+    int i;
+    size_t message_sizes[MAX_MESSAGE_SIZES];
+    int message_size_count;
+    int total_bytes;
+
+    if (argc > 3) {
+        printf ("usage: ws_thr [<message-size>[,...] [<megabytes>]]\n"
+                "  sends the given amount of data per message size, by "
+                "default\n"
+                "  256 MB for each of 1KB to 1MB\n");
+        return 1;
+    }
+
+    message_size_count = parse_message_sizes (
+      argc > 1 ? argv[1] : "1024,4096,16384,65536,262144,1048576",
+      message_sizes);
+    total_bytes = (argc > 2 ? atoi (argv[2]) : 256) * 1024 * 1024;
+
+    ctx = zmq_init (1);
+    if (!ctx) {
+        printf ("error in zmq_init: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    printf ("%10s %12s %12s %8s\n", "size [B]", "tcp [Mb/s]", "ws [Mb/s]",
+            "ws/tcp");
+    for (i = 0; i != message_size_count; i++) {
+        message_size = message_sizes[i];
+        message_count = (int) (total_bytes / (message_size ? message_size : 1));
+        if (message_count < 2)
+            message_count = 2;
+
+        const double tcp = measure (ctx, "tcp");
+        const double ws = measure (ctx, "ws");
+        printf ("%10d %12.3f %12.3f %8.3f\n", (int) message_size, tcp, ws,
+                ws / tcp);
+    }
+
+    rc = zmq_ctx_term (ctx);
+    if (rc != 0) {
+        printf ("error in zmq_ctx_term: %s\n", zmq_strerror (errno));
+        return -1;
+    }
+
+    return 0;
+}
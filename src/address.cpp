@@ -50,6 +50,11 @@ zmq::address_t::~address_t ()
         LIBZMQ_DELETE (resolved.ipc_addr);
     }
 #endif
+#if defined ZMQ_HAVE_SHM
+    else if (protocol == protocol_name::shm) {
+        LIBZMQ_DELETE (resolved.ipc_addr);
+    }
+#endif
 #if defined ZMQ_HAVE_TIPC
     else if (protocol == protocol_name::tipc) {
         LIBZMQ_DELETE (resolved.tipc_addr);
@@ -80,6 +85,10 @@ int zmq::address_t::to_string (std::string &addr_) const
     if (protocol == protocol_name::ipc && resolved.ipc_addr)
         return resolved.ipc_addr->to_string (addr_);
 #endif
+#if defined ZMQ_HAVE_SHM
+    if (protocol == protocol_name::shm && resolved.ipc_addr)
+        return resolved.ipc_addr->to_string (addr_, protocol_name::shm);
+#endif
 #if defined ZMQ_HAVE_TIPC
     if (protocol == protocol_name::tipc && resolved.tipc_addr)
         return resolved.tipc_addr->to_string (addr_);
@@ -112,3 +121,19 @@ zmq::zmq_socklen_t zmq::get_socket_address (fd_t fd_,
 
     return rc != 0 ? 0 : sl;
 }
+
+#if defined ZMQ_HAVE_SHM
+std::string zmq::get_shm_socket_name (fd_t fd_, socket_end_t socket_end_)
+{
+    struct sockaddr_storage ss;
+    const zmq_socklen_t sl = get_socket_address (fd_, socket_end_, &ss);
+    if (sl == 0) {
+        return std::string ();
+    }
+
+    const ipc_address_t addr (reinterpret_cast<struct sockaddr *> (&ss), sl);
+    std::string address_string;
+    addr.to_string (address_string, protocol_name::shm);
+    return address_string;
+}
+#endif
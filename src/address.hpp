@@ -53,6 +53,9 @@ static const char wss[] = "wss";
 #if defined ZMQ_HAVE_IPC
 static const char ipc[] = "ipc";
 #endif
+#if defined ZMQ_HAVE_SHM
+static const char shm[] = "shm";
+#endif
 #if defined ZMQ_HAVE_TIPC
 static const char tipc[] = "tipc";
 #endif
@@ -130,6 +133,12 @@ std::string get_socket_name (fd_t fd_, socket_end_t socket_end_)
     addr.to_string (address_string);
     return address_string;
 }
+
+#if defined ZMQ_HAVE_SHM
+//  The shm:// transport runs over UNIX domain sockets, with the endpoints
+//  named after it.
+std::string get_shm_socket_name (fd_t fd_, socket_end_t socket_end_);
+#endif
 }
 
 #endif
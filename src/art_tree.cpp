@@ -0,0 +1,569 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "art_tree.hpp"
+#include "err.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#if defined __SSE2__ || defined _M_X64                                         \
+  || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define ZMQ_ART_TREE_SSE2
+#include <emmintrin.h>
+#elif defined __ARM_NEON || defined _M_ARM64
+#define ZMQ_ART_TREE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace zmq
+{
+//  Node layouts, named after the number of children they hold.
+enum art_node_type_t
+{
+    art_node_0,
+    art_node_4,
+    art_node_16,
+    art_node_48,
+    art_node_256
+};
+
+//  Header shared by all the node layouts. The layout specific part follows
+//  the header, and the node's prefix follows that.
+struct art_node_t
+{
+    //  The number of times the key ending at this node has been added.
+    //  This is 0 if the node doesn't hold a key.
+    uint32_t refcount;
+
+    //  The number of bytes in the node's prefix. The byte leading to the
+    //  node from its parent is not part of the prefix.
+    uint32_t prefix_length;
+
+    //  The number of children.
+    uint16_t count;
+
+    unsigned char type;
+};
+
+//  Children sorted by their first byte.
+struct art_node4_t : art_node_t
+{
+    unsigned char bytes[4];
+    art_node_t *children[4];
+};
+
+struct art_node16_t : art_node_t
+{
+    unsigned char bytes[16];
+    art_node_t *children[16];
+};
+
+//  Index of the child for each byte, plus 1. Zero means no child.
+struct art_node48_t : art_node_t
+{
+    unsigned char index[256];
+    art_node_t *children[48];
+};
+
+struct art_node256_t : art_node_t
+{
+    art_node_t *children[256];
+};
+}
+
+static const size_t capacities[] = {0, 4, 16, 48, 256};
+
+//  A node is replaced by the next smaller layout once it has fewer
+//  children than this. The gap to the capacity of the smaller layout
+//  keeps a node from flipping between two layouts.
+static const size_t shrink_limits[] = {0, 1, 4, 13, 38};
+
+static size_t layout_size (unsigned char type_)
+{
+    switch (type_) {
+        case zmq::art_node_0:
+            return sizeof (zmq::art_node_t);
+        case zmq::art_node_4:
+            return sizeof (zmq::art_node4_t);
+        case zmq::art_node_16:
+            return sizeof (zmq::art_node16_t);
+        case zmq::art_node_48:
+            return sizeof (zmq::art_node48_t);
+        default:
+            zmq_assert (type_ == zmq::art_node_256);
+            return sizeof (zmq::art_node256_t);
+    }
+}
+
+static unsigned char *prefix_of (zmq::art_node_t *node_)
+{
+    return reinterpret_cast<unsigned char *> (node_) + layout_size (node_->type);
+}
+
+static zmq::art_node_t *make_node (unsigned char type_,
+                                   const unsigned char *prefix_,
+                                   size_t prefix_length_,
+                                   uint32_t refcount_)
+{
+    const size_t size = layout_size (type_);
+    zmq::art_node_t *node =
+      static_cast<zmq::art_node_t *> (malloc (size + prefix_length_));
+    alloc_assert (node);
+    memset (node, 0, size);
+    node->refcount = refcount_;
+    node->prefix_length = static_cast<uint32_t> (prefix_length_);
+    node->type = type_;
+    if (prefix_length_ > 0)
+        memcpy (prefix_of (node), prefix_, prefix_length_);
+    return node;
+}
+
+static int lowest_bit (unsigned int mask_)
+{
+#if defined __GNUC__
+    return __builtin_ctz (mask_);
+#else
+    int bit = 0;
+    while ((mask_ & (1u << bit)) == 0)
+        bit++;
+    return bit;
+#endif
+}
+
+static zmq::art_node_t **find_child (zmq::art_node_t *node_,
+                                     unsigned char byte_)
+{
+    switch (node_->type) {
+        case zmq::art_node_4: {
+            zmq::art_node4_t *node = static_cast<zmq::art_node4_t *> (node_);
+            for (unsigned int i = 0; i < node->count; i++)
+                if (node->bytes[i] == byte_)
+                    return &node->children[i];
+            return NULL;
+        }
+        case zmq::art_node_16: {
+            zmq::art_node16_t *node = static_cast<zmq::art_node16_t *> (node_);
+#if defined ZMQ_ART_TREE_SSE2
+            const __m128i matches = _mm_cmpeq_epi8 (
+              _mm_set1_epi8 (static_cast<char> (byte_)),
+              _mm_loadu_si128 (reinterpret_cast<const __m128i *> (node->bytes)));
+            const unsigned int mask =
+              static_cast<unsigned int> (_mm_movemask_epi8 (matches))
+              & ((1u << node->count) - 1);
+            if (mask)
+                return &node->children[lowest_bit (mask)];
+            return NULL;
+#elif defined ZMQ_ART_TREE_NEON
+            //  Narrow the byte mask to 4 bits per byte to get it into a
+            //  general purpose register.
+            const uint8x16_t matches =
+              vceqq_u8 (vdupq_n_u8 (byte_), vld1q_u8 (node->bytes));
+            const uint64_t mask =
+              vget_lane_u64 (vreinterpret_u64_u8 (vshrn_n_u16 (
+                               vreinterpretq_u16_u8 (matches), 4)),
+                             0)
+              & (node->count == 16 ? ~uint64_t (0)
+                                   : (uint64_t (1) << (4 * node->count)) - 1);
+            if (mask) {
+                unsigned int i = 0;
+                while ((mask & (uint64_t (0xf) << (4 * i))) == 0)
+                    i++;
+                return &node->children[i];
+            }
+            return NULL;
+#else
+            for (unsigned int i = 0; i < node->count; i++)
+                if (node->bytes[i] == byte_)
+                    return &node->children[i];
+            return NULL;
+#endif
+        }
+        case zmq::art_node_48: {
+            zmq::art_node48_t *node = static_cast<zmq::art_node48_t *> (node_);
+            const unsigned char index = node->index[byte_];
+            return index ? &node->children[index - 1] : NULL;
+        }
+        case zmq::art_node_256: {
+            zmq::art_node256_t *node =
+              static_cast<zmq::art_node256_t *> (node_);
+            return node->children[byte_] ? &node->children[byte_] : NULL;
+        }
+        default:
+            return NULL;
+    }
+}
+
+//  Iterates over the children of the node ordered by their first byte.
+//  pos_ starts at 0. Returns NULL after the last child.
+static zmq::art_node_t *
+next_child (zmq::art_node_t *node_, unsigned int *pos_, unsigned char *byte_)
+{
+    switch (node_->type) {
+        case zmq::art_node_4: {
+            zmq::art_node4_t *node = static_cast<zmq::art_node4_t *> (node_);
+            if (*pos_ >= node->count)
+                return NULL;
+            *byte_ = node->bytes[*pos_];
+            return node->children[(*pos_)++];
+        }
+        case zmq::art_node_16: {
+            zmq::art_node16_t *node = static_cast<zmq::art_node16_t *> (node_);
+            if (*pos_ >= node->count)
+                return NULL;
+            *byte_ = node->bytes[*pos_];
+            return node->children[(*pos_)++];
+        }
+        case zmq::art_node_48: {
+            zmq::art_node48_t *node = static_cast<zmq::art_node48_t *> (node_);
+            for (; *pos_ < 256; (*pos_)++)
+                if (node->index[*pos_]) {
+                    *byte_ = static_cast<unsigned char> (*pos_);
+                    return node->children[node->index[(*pos_)++] - 1];
+                }
+            return NULL;
+        }
+        case zmq::art_node_256: {
+            zmq::art_node256_t *node =
+              static_cast<zmq::art_node256_t *> (node_);
+            for (; *pos_ < 256; (*pos_)++)
+                if (node->children[*pos_]) {
+                    *byte_ = static_cast<unsigned char> (*pos_);
+                    return node->children[(*pos_)++];
+                }
+            return NULL;
+        }
+        default:
+            return NULL;
+    }
+}
+
+//  Inserts a child into a node that has room for it.
+static void
+insert_child (zmq::art_node_t *node_, unsigned char byte_, zmq::art_node_t *child_)
+{
+    switch (node_->type) {
+        case zmq::art_node_4:
+        case zmq::art_node_16: {
+            unsigned char *bytes;
+            zmq::art_node_t **children;
+            if (node_->type == zmq::art_node_4) {
+                bytes = static_cast<zmq::art_node4_t *> (node_)->bytes;
+                children = static_cast<zmq::art_node4_t *> (node_)->children;
+            } else {
+                bytes = static_cast<zmq::art_node16_t *> (node_)->bytes;
+                children = static_cast<zmq::art_node16_t *> (node_)->children;
+            }
+            unsigned int pos = 0;
+            while (pos < node_->count && bytes[pos] < byte_)
+                pos++;
+            memmove (bytes + pos + 1, bytes + pos, node_->count - pos);
+            memmove (children + pos + 1, children + pos,
+                     (node_->count - pos) * sizeof (zmq::art_node_t *));
+            bytes[pos] = byte_;
+            children[pos] = child_;
+            break;
+        }
+        case zmq::art_node_48: {
+            zmq::art_node48_t *node = static_cast<zmq::art_node48_t *> (node_);
+            unsigned int slot = 0;
+            while (node->children[slot])
+                slot++;
+            node->children[slot] = child_;
+            node->index[byte_] = static_cast<unsigned char> (slot + 1);
+            break;
+        }
+        case zmq::art_node_256:
+            static_cast<zmq::art_node256_t *> (node_)->children[byte_] = child_;
+            break;
+        default:
+            zmq_assert (false);
+    }
+    node_->count++;
+}
+
+//  Moves the node into a different layout and returns the new node.
+static zmq::art_node_t *convert (zmq::art_node_t *node_, unsigned char type_)
+{
+    zmq::art_node_t *node = make_node (type_, prefix_of (node_),
+                                       node_->prefix_length, node_->refcount);
+    unsigned int pos = 0;
+    unsigned char byte;
+    while (zmq::art_node_t *child = next_child (node_, &pos, &byte))
+        insert_child (node, byte, child);
+    free (node_);
+    return node;
+}
+
+static void
+add_child (zmq::art_node_t **ref_, unsigned char byte_, zmq::art_node_t *child_)
+{
+    if ((*ref_)->count == capacities[(*ref_)->type])
+        *ref_ =
+          convert (*ref_, static_cast<unsigned char> ((*ref_)->type + 1));
+    insert_child (*ref_, byte_, child_);
+}
+
+static void remove_child (zmq::art_node_t **ref_, unsigned char byte_)
+{
+    zmq::art_node_t *node_ = *ref_;
+    switch (node_->type) {
+        case zmq::art_node_4:
+        case zmq::art_node_16: {
+            unsigned char *bytes;
+            zmq::art_node_t **children;
+            if (node_->type == zmq::art_node_4) {
+                bytes = static_cast<zmq::art_node4_t *> (node_)->bytes;
+                children = static_cast<zmq::art_node4_t *> (node_)->children;
+            } else {
+                bytes = static_cast<zmq::art_node16_t *> (node_)->bytes;
+                children = static_cast<zmq::art_node16_t *> (node_)->children;
+            }
+            unsigned int pos = 0;
+            while (bytes[pos] != byte_)
+                pos++;
+            memmove (bytes + pos, bytes + pos + 1, node_->count - pos - 1);
+            memmove (children + pos, children + pos + 1,
+                     (node_->count - pos - 1) * sizeof (zmq::art_node_t *));
+            break;
+        }
+        case zmq::art_node_48: {
+            zmq::art_node48_t *node = static_cast<zmq::art_node48_t *> (node_);
+            node->children[node->index[byte_] - 1] = NULL;
+            node->index[byte_] = 0;
+            break;
+        }
+        case zmq::art_node_256:
+            static_cast<zmq::art_node256_t *> (node_)->children[byte_] = NULL;
+            break;
+        default:
+            zmq_assert (false);
+    }
+    node_->count--;
+
+    if (node_->count < shrink_limits[node_->type])
+        *ref_ = convert (node_, static_cast<unsigned char> (node_->type - 1));
+}
+
+//  Folds a node that holds no key into its only child.
+static void merge_child (zmq::art_node_t **ref_)
+{
+    zmq::art_node_t *node = *ref_;
+    unsigned int pos = 0;
+    unsigned char byte;
+    zmq::art_node_t *child = next_child (node, &pos, &byte);
+
+    std::vector<unsigned char> prefix (prefix_of (node),
+                                       prefix_of (node) + node->prefix_length);
+    prefix.push_back (byte);
+    prefix.insert (prefix.end (), prefix_of (child),
+                   prefix_of (child) + child->prefix_length);
+
+    const size_t size = layout_size (child->type);
+    zmq::art_node_t *merged = static_cast<zmq::art_node_t *> (
+      malloc (size + prefix.size ()));
+    alloc_assert (merged);
+    memcpy (merged, child, size);
+    merged->prefix_length = static_cast<uint32_t> (prefix.size ());
+    memcpy (prefix_of (merged), &prefix[0], prefix.size ());
+
+    free (child);
+    free (node);
+    *ref_ = merged;
+}
+
+static void destroy (zmq::art_node_t *node_)
+{
+    unsigned int pos = 0;
+    unsigned char byte;
+    while (zmq::art_node_t *child = next_child (node_, &pos, &byte))
+        destroy (child);
+    free (node_);
+}
+
+zmq::art_tree_t::art_tree_t () : _root (make_node (art_node_0, NULL, 0, 0))
+{
+}
+
+zmq::art_tree_t::~art_tree_t ()
+{
+    destroy (_root);
+}
+
+bool zmq::art_tree_t::add (const unsigned char *key_, size_t key_size_)
+{
+    art_node_t **ref = &_root;
+    size_t depth = 0;
+
+    while (true) {
+        art_node_t *node = *ref;
+        const unsigned char *prefix = prefix_of (node);
+
+        size_t matched = 0;
+        while (matched < node->prefix_length && depth + matched < key_size_
+               && prefix[matched] == key_[depth + matched])
+            matched++;
+
+        if (matched < node->prefix_length) {
+            //  The key diverges inside the prefix. Split the node, moving
+            //  the part of the prefix the key shares into a new parent.
+            art_node_t *parent =
+              make_node (art_node_4, prefix, matched, 0);
+            const unsigned char byte = prefix[matched];
+            const size_t rest = node->prefix_length - matched - 1;
+            memmove (prefix_of (node), prefix + matched + 1, rest);
+            node->prefix_length = static_cast<uint32_t> (rest);
+            insert_child (parent, byte, node);
+
+            depth += matched;
+            if (depth == key_size_)
+                parent->refcount = 1;
+            else
+                insert_child (parent, key_[depth],
+                              make_node (art_node_0, key_ + depth + 1,
+                                         key_size_ - depth - 1, 1));
+            *ref = parent;
+            _size.add (1);
+            return true;
+        }
+
+        depth += matched;
+        if (depth == key_size_) {
+            _size.add (1);
+            node->refcount++;
+            return node->refcount == 1;
+        }
+
+        art_node_t **child = find_child (node, key_[depth]);
+        if (!child) {
+            add_child (ref, key_[depth],
+                       make_node (art_node_0, key_ + depth + 1,
+                                  key_size_ - depth - 1, 1));
+            _size.add (1);
+            return true;
+        }
+        ref = child;
+        depth++;
+    }
+}
+
+bool zmq::art_tree_t::rm (const unsigned char *key_, size_t key_size_)
+{
+    art_node_t **parent_ref = NULL;
+    art_node_t **ref = &_root;
+    unsigned char byte = 0;
+    size_t depth = 0;
+
+    while (true) {
+        art_node_t *node = *ref;
+        const size_t prefix_length = node->prefix_length;
+        if (key_size_ - depth < prefix_length
+            || (prefix_length > 0
+                && memcmp (prefix_of (node), key_ + depth, prefix_length)
+                     != 0))
+            return false;
+        depth += prefix_length;
+        if (depth == key_size_)
+            break;
+
+        art_node_t **child = find_child (node, key_[depth]);
+        if (!child)
+            return false;
+        parent_ref = ref;
+        byte = key_[depth];
+        ref = child;
+        depth++;
+    }
+
+    art_node_t *node = *ref;
+    if (node->refcount == 0)
+        return false;
+    _size.sub (1);
+    node->refcount--;
+    if (node->refcount > 0)
+        return false;
+
+    //  The root stays in place even when it holds no key.
+    if (ref == &_root)
+        return true;
+
+    if (node->count == 0) {
+        free (node);
+        remove_child (parent_ref, byte);
+        art_node_t *parent = *parent_ref;
+        if (parent_ref != &_root && parent->refcount == 0
+            && parent->count == 1)
+            merge_child (parent_ref);
+    } else if (node->count == 1)
+        merge_child (ref);
+
+    return true;
+}
+
+bool zmq::art_tree_t::check (const unsigned char *data_, size_t size_) const
+{
+    art_node_t *node = _root;
+    size_t depth = 0;
+
+    while (true) {
+        const size_t prefix_length = node->prefix_length;
+        if (size_ - depth < prefix_length
+            || (prefix_length > 0
+                && memcmp (prefix_of (node), data_ + depth, prefix_length)
+                     != 0))
+            return false;
+        depth += prefix_length;
+
+        //  A key that is a prefix of the data is a matching subscription.
+        if (node->refcount > 0)
+            return true;
+        if (depth == size_)
+            return false;
+
+        art_node_t **child = find_child (node, data_[depth]);
+        if (!child)
+            return false;
+        node = *child;
+        depth++;
+    }
+}
+
+static void
+visit_keys (zmq::art_node_t *node_,
+            std::vector<unsigned char> &buffer_,
+            void (*func_) (unsigned char *data_, size_t size_, void *arg_),
+            void *arg_)
+{
+    const size_t size = buffer_.size ();
+    buffer_.insert (buffer_.end (), prefix_of (node_),
+                    prefix_of (node_) + node_->prefix_length);
+
+    if (node_->refcount > 0) {
+        if (buffer_.empty ())
+            func_ (NULL, 0, arg_);
+        else
+            func_ (&buffer_[0], buffer_.size (), arg_);
+    }
+
+    unsigned int pos = 0;
+    unsigned char byte;
+    while (zmq::art_node_t *child = next_child (node_, &pos, &byte)) {
+        buffer_.push_back (byte);
+        visit_keys (child, buffer_, func_, arg_);
+        buffer_.pop_back ();
+    }
+    buffer_.resize (size);
+}
+
+void zmq::art_tree_t::apply (
+  void (*func_) (unsigned char *data_, size_t size_, void *arg_), void *arg_)
+{
+    std::vector<unsigned char> buffer;
+    visit_keys (_root, buffer, func_, arg_);
+}
+
+size_t zmq::art_tree_t::size () const
+{
+    return _size.get ();
+}
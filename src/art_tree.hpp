@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_ART_TREE_HPP_INCLUDED__
+#define __ZMQ_ART_TREE_HPP_INCLUDED__
+
+#include <stddef.h>
+
+#include "macros.hpp"
+#include "stdint.hpp"
+#include "atomic_counter.hpp"
+
+namespace zmq
+{
+struct art_node_t;
+
+//  Set of subscriptions kept in an adaptive radix tree. Each node stores
+//  the bytes it shares with all the keys below it (path compression) and
+//  its children in one of four layouts, picked by their number: sorted
+//  arrays of 4 or 16 child bytes, a 256 byte index into 48 child pointers,
+//  or 256 child pointers indexed by the byte itself. Nodes with 16
+//  children are searched with SIMD compares where the target supports it.
+//  Nodes without children, which hold most of the keys, carry no child
+//  storage at all.
+class art_tree_t
+{
+  public:
+    art_tree_t ();
+    ~art_tree_t ();
+
+    //  Add key to the tree. Returns true if this was a new key rather
+    //  than a duplicate.
+    bool add (const unsigned char *key_, size_t key_size_);
+
+    //  Remove key from the tree. Returns true if the item is actually
+    //  removed from the tree.
+    bool rm (const unsigned char *key_, size_t key_size_);
+
+    //  Check whether any key in the tree is a prefix of the data.
+    bool check (const unsigned char *data_, size_t size_) const;
+
+    //  Apply the function supplied to each key in the tree.
+    void apply (void (*func_) (unsigned char *data_, size_t size_, void *arg_),
+                void *arg_);
+
+    //  Retrieve size of the tree. Note this is a multithread safe function.
+    size_t size () const;
+
+  private:
+    art_node_t *_root;
+    atomic_counter_t _size;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (art_tree_t)
+};
+}
+
+#endif
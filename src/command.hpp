@@ -15,6 +15,8 @@ class own_t;
 struct i_engine;
 class pipe_t;
 class socket_base_t;
+class tcp_address_t;
+class crypto_job_t;
 
 //  This structure defines the commands that can be sent between threads.
 
@@ -44,8 +46,14 @@ struct command_t
         reaped,
         inproc_connected,
         conn_failed,
+        resolved,
+        crypto_done,
         pipe_peer_stats,
         pipe_stats_publish,
+        migrate,
+        migrate_sync,
+        migrate_ack,
+        migrated,
         done
     } type;
 
@@ -159,6 +167,25 @@ struct command_t
         {
         } reaped;
 
+        //  Sent by the resolver of the context to a connecter once it looked
+        //  its address up. The address is NULL if resolving failed, with
+        //  the errno value in error. Caller have used inc_seqnum beforehand
+        //  sending the command.
+        struct
+        {
+            zmq::tcp_address_t *address;
+            int error;
+        } resolved;
+
+        //  Sent by the crypto pool of the context to the object that
+        //  submitted the job once it is executed. The job now belongs to
+        //  the object. Caller have used inc_seqnum beforehand sending the
+        //  command.
+        struct
+        {
+            zmq::crypto_job_t *job;
+        } crypto_done;
+
         //  Send application-side pipe count and ask to send monitor event
         struct
         {
@@ -176,6 +203,37 @@ struct command_t
             endpoint_uri_pair_t *endpoint_pair;
         } pipe_stats_publish;
 
+        //  Sent by a session to the I/O thread it is about to move to. The
+        //  I/O thread holds back the commands to the session and its pipe
+        //  until the session arrives, and acknowledges with migrate_ack.
+        struct
+        {
+            zmq::object_t *session;
+            zmq::object_t *pipe;
+        } migrate;
+
+        //  Sent by a moving session to the objects that send it commands,
+        //  once it has redirected its commands to the new I/O thread. The
+        //  object acknowledges with migrate_ack, sent to the thread tid.
+        struct
+        {
+            zmq::object_t *session;
+            uint32_t tid;
+        } migrate_sync;
+
+        //  Acknowledges migrate and migrate_sync.
+        struct
+        {
+        } migrate_ack;
+
+        //  Sent by a moving session to itself in the new I/O thread, once
+        //  it has left the old one. If cancelled, the session stays where
+        //  it is, and the new I/O thread only stops waiting for it.
+        struct
+        {
+            bool cancelled;
+        } migrated;
+
         //  Sent by reaper thread to the term thread when all the sockets
         //  are successfully deallocated.
         struct
@@ -36,6 +36,22 @@ enum
     //  latency and fairness.
     proxy_burst_size = 1000,
 
+    //  Maximal number of addresses cached by the resolver of a context.
+    resolver_cache_size = 10000,
+
+    //  Default times, in milliseconds, for which resolved host names and
+    //  failures to resolve them are cached.
+    dns_cache_ttl_dflt = 10000,
+    dns_negative_ttl_dflt = 1000,
+
+    //  Default number of threads running the expensive steps of security
+    //  handshakes. With none, the I/O threads run them.
+    crypto_threads_dflt = 0,
+
+    //  Size in bytes of each of the two rings shared by the ends of an
+    //  shm:// connection. Must be a power of two.
+    shm_ring_size = 256 * 1024,
+
     //  Maximal delay to process command in API thread (in CPU ticks).
     //  3,000,000 ticks equals to 1 - 2 milliseconds on current CPUs.
     //  Note that delay is only applied when there is continuous stream of
@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include <new>
+
+#include "crypto_pool.hpp"
+#include "command.hpp"
+#include "ctx.hpp"
+#include "err.hpp"
+#include "own.hpp"
+
+zmq::crypto_pool_t::crypto_pool_t (ctx_t *ctx_, int thread_count_) :
+    _ctx (ctx_),
+    _thread_count (thread_count_),
+    _started (false),
+    _stopping (false)
+{
+    zmq_assert (_thread_count > 0);
+}
+
+zmq::crypto_pool_t::~crypto_pool_t ()
+{
+    stop ();
+}
+
+void zmq::crypto_pool_t::stop ()
+{
+    {
+        scoped_lock_t locker (_sync);
+        if (!_started || _stopping)
+            return;
+        _stopping = true;
+        _cv.broadcast ();
+    }
+    for (std::vector<thread_t *>::iterator it = _workers.begin (),
+                                           end = _workers.end ();
+         it != end; ++it) {
+        (*it)->stop ();
+        LIBZMQ_DELETE (*it);
+    }
+    _workers.clear ();
+}
+
+void zmq::crypto_pool_t::submit (own_t *destination_, crypto_job_t *job_)
+{
+    scoped_lock_t locker (_sync);
+    zmq_assert (!_stopping);
+
+    if (!_started) {
+        for (int i = 0; i != _thread_count; i++) {
+            thread_t *const worker = new (std::nothrow) thread_t;
+            alloc_assert (worker);
+            _workers.push_back (worker);
+            _ctx->start_thread (*worker, worker_routine, this, "Crypto");
+        }
+        _started = true;
+    }
+
+    //  The requester cannot be deallocated before it got the job back.
+    destination_->inc_seqnum ();
+    const request_t request = {destination_, job_};
+    _requests.push_back (request);
+    _cv.broadcast ();
+}
+
+void zmq::crypto_pool_t::reply (own_t *destination_, crypto_job_t *job_)
+{
+    command_t cmd;
+    cmd.destination = destination_;
+    cmd.type = command_t::crypto_done;
+    cmd.args.crypto_done.job = job_;
+    _ctx->send_command (destination_->get_tid (), cmd);
+}
+
+void zmq::crypto_pool_t::worker_routine (void *arg_)
+{
+    static_cast<crypto_pool_t *> (arg_)->loop ();
+}
+
+void zmq::crypto_pool_t::loop ()
+{
+    _sync.lock ();
+    while (true) {
+        if (_requests.empty ()) {
+            if (_stopping)
+                break;
+            const int rc = _cv.wait (&_sync, -1);
+            errno_assert (rc == 0);
+            continue;
+        }
+
+        const request_t request = _requests.front ();
+        _requests.pop_front ();
+
+        _sync.unlock ();
+        request.job->execute ();
+        reply (request.destination, request.job);
+        _sync.lock ();
+    }
+    _sync.unlock ();
+}
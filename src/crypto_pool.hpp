@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_CRYPTO_POOL_HPP_INCLUDED__
+#define __ZMQ_CRYPTO_POOL_HPP_INCLUDED__
+
+#include <deque>
+#include <vector>
+
+#include "condition_variable.hpp"
+#include "macros.hpp"
+#include "mutex.hpp"
+#include "thread.hpp"
+
+namespace zmq
+{
+class ctx_t;
+class own_t;
+
+//  Expensive step of a security handshake. The job works on its own copy
+//  of whatever it needs, so that it does not depend on the object that
+//  requested it, which may be gone by the time the job is done.
+
+class crypto_job_t
+{
+  public:
+    crypto_job_t () : _cancelled (false) {}
+    virtual ~crypto_job_t () ZMQ_DEFAULT;
+
+    //  Does the work, in a thread of the pool.
+    virtual void execute () = 0;
+
+    //  Marks the result as unwanted. Both are only called in the thread
+    //  of the requester.
+    void cancel () { _cancelled = true; }
+    bool cancelled () const { return _cancelled; }
+
+  private:
+    bool _cancelled;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (crypto_job_t)
+};
+
+//  Threads of the context running crypto jobs for the I/O threads, so
+//  that a burst of handshakes does not hold up the traffic of established
+//  connections on the same I/O threads.
+
+class crypto_pool_t
+{
+  public:
+    crypto_pool_t (ctx_t *ctx_, int thread_count_);
+    virtual ~crypto_pool_t ();
+
+    //  Queues the job. Once it is executed, the job is sent back to
+    //  'destination_' with a crypto_done command, and belongs to it.
+    void submit (own_t *destination_, crypto_job_t *job_);
+
+  protected:
+    //  Hands the executed job over to the requester. Tests override it
+    //  to keep the results to themselves.
+    virtual void reply (own_t *destination_, crypto_job_t *job_);
+
+    //  Stops the threads once all jobs are done. Must be called by the
+    //  destructor of classes overriding the function above.
+    void stop ();
+
+  private:
+    struct request_t
+    {
+        own_t *destination;
+        crypto_job_t *job;
+    };
+
+    static void worker_routine (void *arg_);
+    void loop ();
+
+    ctx_t *const _ctx;
+    const int _thread_count;
+
+    //  Protects everything below, the threads wait for jobs on _cv.
+    mutex_t _sync;
+    condition_variable_t _cv;
+
+    std::deque<request_t> _requests;
+
+    //  The threads are only started once the first job is submitted.
+    bool _started;
+    bool _stopping;
+    std::vector<thread_t *> _workers;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (crypto_pool_t)
+};
+}
+
+#endif
@@ -19,7 +19,10 @@
 #include "pipe.hpp"
 #include "err.hpp"
 #include "msg.hpp"
+#include "msg_allocator.hpp"
 #include "random.hpp"
+#include "resolver.hpp"
+#include "crypto_pool.hpp"
 
 #ifdef ZMQ_HAVE_VMCI
 #include <vmci_sockets.h>
@@ -56,8 +59,18 @@ zmq::ctx_t::ctx_t () :
     _io_thread_count (ZMQ_IO_THREADS_DFLT),
     _blocky (true),
     _ipv6 (false),
-    _zero_copy (true)
+    _zero_copy (true),
+    _msg_pool (false),
+    _msg_allocator (NULL),
+    _msg_allocator_backend (NULL),
+    _msg_allocator_fixed (0),
+    _dns_cache_ttl (dns_cache_ttl_dflt),
+    _dns_negative_ttl (dns_negative_ttl_dflt),
+    _resolver (NULL),
+    _crypto_threads (crypto_threads_dflt),
+    _crypto_pool (NULL)
 {
+    memset (&_msg_allocator_fns, 0, sizeof (_msg_allocator_fns));
 #ifdef HAVE_FORK
     _pid = getpid ();
 #endif
@@ -103,6 +116,18 @@ zmq::ctx_t::~ctx_t ()
     //  Deallocate the reaper thread object.
     LIBZMQ_DELETE (_reaper);
 
+    //  The connecters are gone, so the resolver has no requests left.
+    LIBZMQ_DELETE (_resolver);
+
+    //  Likewise the sessions are gone, so the crypto pool has no jobs left.
+    LIBZMQ_DELETE (_crypto_pool);
+
+    //  All the sockets are gone, so the message memory is not referenced
+    //  anymore, except by messages the application failed to close.
+    if (_msg_allocator != _msg_allocator_backend)
+        LIBZMQ_DELETE (_msg_allocator);
+    LIBZMQ_DELETE (_msg_allocator_backend);
+
     //  The mailboxes in _slots themselves were deallocated with their
     //  corresponding io_thread/socket objects.
 
@@ -284,6 +309,51 @@ int zmq::ctx_t::set (int option_, const void *optval_, size_t optvallen_)
             }
             break;
 
+        case ZMQ_MSG_ALLOCATOR:
+            if (optvallen_ == sizeof (zmq_msg_allocator_t)) {
+                zmq_msg_allocator_t fns;
+                memcpy (&fns, optval_, sizeof (fns));
+                scoped_lock_t locker (_opt_sync);
+                if ((fns.allocate_fn == NULL) == (fns.deallocate_fn == NULL)
+                    && !_msg_allocator_fixed.load ()) {
+                    _msg_allocator_fns = fns;
+                    return 0;
+                }
+            }
+            break;
+
+        case ZMQ_MSG_POOL:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                if (!_msg_allocator_fixed.load ()) {
+                    _msg_pool = (value != 0);
+                    return 0;
+                }
+            }
+            break;
+
+        case ZMQ_DNS_CACHE_TTL:
+        case ZMQ_DNS_NEGATIVE_TTL:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                if (option_ == ZMQ_DNS_CACHE_TTL)
+                    _dns_cache_ttl = value;
+                else
+                    _dns_negative_ttl = value;
+                if (_resolver)
+                    _resolver->set_ttl (_dns_cache_ttl, _dns_negative_ttl);
+                return 0;
+            }
+            break;
+
+        case ZMQ_CRYPTO_THREADS:
+            if (is_int && value >= 0) {
+                scoped_lock_t locker (_opt_sync);
+                _crypto_threads = value;
+                return 0;
+            }
+            break;
+
         default: {
             return thread_ctx_t::set (option_, optval_, optvallen_);
         }
@@ -362,6 +432,47 @@ int zmq::ctx_t::get (int option_, void *optval_, const size_t *optvallen_)
             }
             break;
 
+        case ZMQ_MSG_ALLOCATOR:
+            if (*optvallen_ == sizeof (zmq_msg_allocator_t)) {
+                scoped_lock_t locker (_opt_sync);
+                memcpy (optval_, &_msg_allocator_fns,
+                        sizeof (_msg_allocator_fns));
+                return 0;
+            }
+            break;
+
+        case ZMQ_MSG_POOL:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _msg_pool;
+                return 0;
+            }
+            break;
+
+        case ZMQ_DNS_CACHE_TTL:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _dns_cache_ttl;
+                return 0;
+            }
+            break;
+
+        case ZMQ_DNS_NEGATIVE_TTL:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _dns_negative_ttl;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CRYPTO_THREADS:
+            if (is_int) {
+                scoped_lock_t locker (_opt_sync);
+                *value = _crypto_threads;
+                return 0;
+            }
+            break;
+
         default: {
             return thread_ctx_t::get (option_, optval_, optvallen_);
         }
@@ -519,6 +630,63 @@ zmq::object_t *zmq::ctx_t::get_reaper () const
     return _reaper;
 }
 
+zmq::i_msg_allocator *zmq::ctx_t::get_msg_allocator ()
+{
+    //  The allocator never changes once handed out, so the lock is only
+    //  needed the first time around.
+    if (likely (_msg_allocator_fixed.load ()))
+        return _msg_allocator;
+
+    scoped_lock_t locker (_opt_sync);
+    if (!_msg_allocator_fixed.load ()) {
+        if (_msg_pool || _msg_allocator_fns.allocate_fn) {
+            _msg_allocator_backend = new (std::nothrow)
+              heap_msg_allocator_t (_msg_allocator_fns.allocate_fn,
+                                    _msg_allocator_fns.deallocate_fn,
+                                    _msg_allocator_fns.hint);
+            alloc_assert (_msg_allocator_backend);
+            _msg_allocator = _msg_allocator_backend;
+            if (_msg_pool) {
+                //  On machines with several NUMA nodes, each node has a
+                //  pool of its own. This only places pooled memory; pipe
+                //  queues are allocated by whichever thread writes them.
+                const std::vector<int> cpu_nodes =
+                  numa_msg_pool_t::cpu_nodes ();
+                if (cpu_nodes.empty ())
+                    _msg_allocator =
+                      new (std::nothrow) msg_pool_t (_msg_allocator_backend);
+                else
+                    _msg_allocator = new (std::nothrow)
+                      numa_msg_pool_t (_msg_allocator_backend, cpu_nodes);
+                alloc_assert (_msg_allocator);
+            }
+        }
+        _msg_allocator_fixed.store (1);
+    }
+    return _msg_allocator;
+}
+
+zmq::resolver_t *zmq::ctx_t::get_resolver ()
+{
+    scoped_lock_t locker (_opt_sync);
+    if (!_resolver) {
+        _resolver = new (std::nothrow)
+          resolver_t (this, _dns_cache_ttl, _dns_negative_ttl);
+        alloc_assert (_resolver);
+    }
+    return _resolver;
+}
+
+zmq::crypto_pool_t *zmq::ctx_t::get_crypto_pool ()
+{
+    scoped_lock_t locker (_opt_sync);
+    if (!_crypto_pool && _crypto_threads > 0) {
+        _crypto_pool = new (std::nothrow) crypto_pool_t (this, _crypto_threads);
+        alloc_assert (_crypto_pool);
+    }
+    return _crypto_pool;
+}
+
 zmq::thread_ctx_t::thread_ctx_t () :
     _thread_priority (ZMQ_THREAD_PRIORITY_DFLT),
     _thread_sched_policy (ZMQ_THREAD_SCHED_POLICY_DFLT)
@@ -528,10 +696,15 @@ zmq::thread_ctx_t::thread_ctx_t () :
 void zmq::thread_ctx_t::start_thread (thread_t &thread_,
                                       thread_fn *tfn_,
                                       void *arg_,
-                                      const char *name_) const
+                                      const char *name_,
+                                      int io_thread_) const
 {
-    thread_.setSchedulingParameters (_thread_priority, _thread_sched_policy,
-                                     _thread_affinity_cpus);
+    const io_thread_affinity_cpus_t::const_iterator it =
+      _io_thread_affinity_cpus.find (io_thread_);
+    thread_.setSchedulingParameters (
+      _thread_priority, _thread_sched_policy,
+      it != _io_thread_affinity_cpus.end () ? it->second
+                                            : _thread_affinity_cpus);
 
     char namebuf[16] = "";
     snprintf (namebuf, sizeof (namebuf), "%s%sZMQbg%s%s",
@@ -576,6 +749,34 @@ int zmq::thread_ctx_t::set (int option_, const void *optval_, size_t optvallen_)
             }
             break;
 
+        case ZMQ_IO_THREAD_AFFINITY_CPU_ADD:
+        case ZMQ_IO_THREAD_AFFINITY_CPU_REMOVE:
+            if (optvallen_ == sizeof (zmq_io_thread_cpu_t)) {
+                zmq_io_thread_cpu_t thread_cpu;
+                memcpy (&thread_cpu, optval_, sizeof thread_cpu);
+                if (thread_cpu.io_thread < 0 || thread_cpu.cpu < 0)
+                    break;
+                scoped_lock_t locker (_opt_sync);
+                if (option_ == ZMQ_IO_THREAD_AFFINITY_CPU_ADD) {
+                    _io_thread_affinity_cpus[thread_cpu.io_thread].insert (
+                      thread_cpu.cpu);
+                    return 0;
+                }
+                const io_thread_affinity_cpus_t::iterator it =
+                  _io_thread_affinity_cpus.find (thread_cpu.io_thread);
+                if (it == _io_thread_affinity_cpus.end ()
+                    || it->second.erase (thread_cpu.cpu) == 0) {
+                    errno = EINVAL;
+                    return -1;
+                }
+                //  With no CPUs of its own left, the thread takes those of
+                //  all threads again.
+                if (it->second.empty ())
+                    _io_thread_affinity_cpus.erase (it);
+                return 0;
+            }
+            break;
+
         case ZMQ_THREAD_PRIORITY:
             if (is_int && value >= 0) {
                 scoped_lock_t locker (_opt_sync);
@@ -649,14 +850,20 @@ zmq::io_thread_t *zmq::ctx_t::choose_io_thread (uint64_t affinity_)
     if (_io_threads.empty ())
         return NULL;
 
-    //  Find the I/O thread with minimum load.
+    //  Find the least busy I/O thread. Threads within 5% of each other
+    //  count as equally busy, and then the one with the fewest file
+    //  descriptors wins, as idle threads all report being 0% busy.
+    int min_busy = -1;
     int min_load = -1;
     io_thread_t *selected_io_thread = NULL;
     for (io_threads_t::size_type i = 0, size = _io_threads.size (); i != size;
          i++) {
         if (!affinity_ || (affinity_ & (uint64_t (1) << i))) {
+            const int busy = _io_threads[i]->get_busy () / 50;
             const int load = _io_threads[i]->get_load ();
-            if (selected_io_thread == NULL || load < min_load) {
+            if (selected_io_thread == NULL || busy < min_busy
+                || (busy == min_busy && load < min_load)) {
+                min_busy = busy;
                 min_load = load;
                 selected_io_thread = _io_threads[i];
             }
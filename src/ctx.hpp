@@ -15,6 +15,7 @@
 #include "stdint.hpp"
 #include "options.hpp"
 #include "atomic_counter.hpp"
+#include "atomic_ptr.hpp"
 #include "thread.hpp"
 
 namespace zmq
@@ -24,6 +25,9 @@ class io_thread_t;
 class socket_base_t;
 class reaper_t;
 class pipe_t;
+class i_msg_allocator;
+class resolver_t;
+class crypto_pool_t;
 
 //  Information associated with inproc endpoint. Note that endpoint options
 //  are registered as well so that the peer can access them without a need
@@ -39,11 +43,13 @@ class thread_ctx_t
   public:
     thread_ctx_t ();
 
-    //  Start a new thread with proper scheduling parameters.
+    //  Start a new thread with proper scheduling parameters. I/O threads
+    //  pass their index, to take the CPU affinity set for them, if any.
     void start_thread (thread_t &thread_,
                        thread_fn *tfn_,
                        void *arg_,
-                       const char *name_ = NULL) const;
+                       const char *name_ = NULL,
+                       int io_thread_ = -1) const;
 
     int set (int option_, const void *optval_, size_t optvallen_);
     int get (int option_, void *optval_, const size_t *optvallen_);
@@ -58,6 +64,11 @@ class thread_ctx_t
     int _thread_sched_policy;
     std::set<int> _thread_affinity_cpus;
     std::string _thread_name_prefix;
+
+    //  CPUs set for individual I/O threads, by index. These replace
+    //  _thread_affinity_cpus for those threads.
+    typedef std::map<int, std::set<int> > io_thread_affinity_cpus_t;
+    io_thread_affinity_cpus_t _io_thread_affinity_cpus;
 };
 
 //  Context object encapsulates all the global state associated with
@@ -107,6 +118,20 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
     //  Returns reaper thread object.
     zmq::object_t *get_reaper () const;
 
+    //  Returns the allocator for message contents and decoder buffers, or
+    //  NULL if malloc/free is to be used. The allocator cannot be changed
+    //  anymore once this function was called.
+    i_msg_allocator *get_msg_allocator ();
+
+    //  Returns the resolver looking up the host names connecters connect
+    //  to, creating it on first use.
+    resolver_t *get_resolver ();
+
+    //  Returns the pool of threads security mechanisms hand the expensive
+    //  steps of their handshakes to, creating it on first use. Returns
+    //  NULL if the context is not configured to have crypto threads.
+    crypto_pool_t *get_crypto_pool ();
+
     //  Management of inproc endpoints.
     int register_endpoint (const char *addr_, const endpoint_t &endpoint_);
     int unregister_endpoint (const std::string &addr_,
@@ -215,6 +240,33 @@ class ctx_t ZMQ_FINAL : public thread_ctx_t
     // Should we use zero copy message decoding in this context?
     bool _zero_copy;
 
+    //  User supplied functions to allocate message memory with.
+    zmq_msg_allocator_t _msg_allocator_fns;
+
+    //  Should message memory be recycled by a pool?
+    bool _msg_pool;
+
+    //  Allocator handed out to sockets and messages, and the allocator it
+    //  draws memory from, if different.
+    i_msg_allocator *_msg_allocator;
+    i_msg_allocator *_msg_allocator_backend;
+
+    //  Set once _msg_allocator has been handed out.
+    atomic_value_t _msg_allocator_fixed;
+
+    //  Times for which the resolver caches resolved host names and
+    //  failures to resolve them, in milliseconds.
+    int _dns_cache_ttl;
+    int _dns_negative_ttl;
+
+    //  Resolver handed out to the connecters, created on first use.
+    resolver_t *_resolver;
+
+    //  Number of threads of the crypto pool, which is created on first
+    //  use if this is not zero.
+    int _crypto_threads;
+    crypto_pool_t *_crypto_pool;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (ctx_t)
 
 #ifdef HAVE_FORK
@@ -10,7 +10,8 @@
 #ifdef ZMQ_HAVE_CURVE
 
 #ifdef ZMQ_USE_LIBSODIUM
-//  libsodium added crypto_box_easy_afternm and crypto_box_open_easy_afternm with
+//  libsodium added crypto_box_easy_afternm and crypto_box_open_easy_afternm,
+//  along with their detached variants, with
 //  https: //github.com/jedisct1/libsodium/commit/aaf5fbf2e53a33b18d8ea9bdf2c6f73d7acc8c3e
 #if SODIUM_LIBRARY_VERSION_MAJOR > 7                                           \
   || (SODIUM_LIBRARY_VERSION_MAJOR == 7 && SODIUM_LIBRARY_VERSION_MINOR >= 4)
@@ -124,20 +125,18 @@ int zmq::curve_encoding_t::encode (msg_t *msg_)
                                : zmq::msg_t::sub_cmd_name_size;
     }
 
-#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
+    //  The plaintext is assembled where the ciphertext goes, after the
+    //  command header and the MAC, and encrypted in place, so the message
+    //  is allocated and copied once.
     const size_t mlen = flags_len + sub_cancel_len + msg_->size ();
-    std::vector<uint8_t> message_plaintext (mlen);
-#else
-    const size_t mlen =
-      crypto_box_ZEROBYTES + flags_len + sub_cancel_len + msg_->size ();
-    std::vector<uint8_t> message_plaintext_with_zerobytes (mlen);
-    uint8_t *const message_plaintext =
-      &message_plaintext_with_zerobytes[crypto_box_ZEROBYTES];
+    msg_t msg_box;
+    int rc =
+      msg_box.init_size (message_header_len + crypto_box_MACBYTES + mlen);
+    zmq_assert (rc == 0);
 
-    std::fill (message_plaintext_with_zerobytes.begin (),
-               message_plaintext_with_zerobytes.begin () + crypto_box_ZEROBYTES,
-               0);
-#endif
+    uint8_t *const message = static_cast<uint8_t *> (msg_box.data ());
+    uint8_t *const message_plaintext =
+      message + message_header_len + crypto_box_MACBYTES;
 
     const uint8_t flags = msg_->flags () & flag_mask;
     message_plaintext[0] = flags;
@@ -157,50 +156,32 @@ int zmq::curve_encoding_t::encode (msg_t *msg_)
                 zmq::msg_t::cancel_cmd_name_size);
     }
 
-    // this is copying the data from insecure memory, so there is no point in
-    // using secure_allocator_t for message_plaintext
     if (msg_->size () > 0)
         memcpy (&message_plaintext[flags_len + sub_cancel_len], msg_->data (),
                 msg_->size ());
 
 #ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-    msg_t msg_box;
-    int rc =
-      msg_box.init_size (message_header_len + mlen + crypto_box_MACBYTES);
-    zmq_assert (rc == 0);
-
-    rc = crypto_box_easy_afternm (
-      static_cast<uint8_t *> (msg_box.data ()) + message_header_len,
-      &message_plaintext[0], mlen, message_nonce, _cn_precom);
-    zmq_assert (rc == 0);
-
-    msg_->move (msg_box);
-
-    uint8_t *const message = static_cast<uint8_t *> (msg_->data ());
+    rc = crypto_box_detached_afternm (
+      message_plaintext, message + message_header_len, message_plaintext, mlen,
+      message_nonce, _cn_precom);
 #else
-    std::vector<uint8_t> message_box (mlen);
-
-    int rc =
-      crypto_box_afternm (&message_box[0], &message_plaintext_with_zerobytes[0],
-                          mlen, message_nonce, _cn_precom);
-    zmq_assert (rc == 0);
-
-    rc = msg_->close ();
-    zmq_assert (rc == 0);
-
-    rc = msg_->init_size (16 + mlen - crypto_box_BOXZEROBYTES);
-    zmq_assert (rc == 0);
-
-    uint8_t *const message = static_cast<uint8_t *> (msg_->data ());
-
-    memcpy (message + message_header_len, &message_box[crypto_box_BOXZEROBYTES],
-            mlen - crypto_box_BOXZEROBYTES);
+    //  crypto_box_afternm wants zeros ahead of the plaintext and leaves
+    //  zeros ahead of the MAC. Both fit in the room of the command header,
+    //  which is written afterwards.
+    uint8_t *const message_box = message_plaintext - crypto_box_ZEROBYTES;
+    memset (message_box, 0, crypto_box_ZEROBYTES);
+    rc = crypto_box_afternm (message_box, message_box,
+                             crypto_box_ZEROBYTES + mlen, message_nonce,
+                             _cn_precom);
 #endif
+    zmq_assert (rc == 0);
 
     memcpy (message, message_command, message_command_len);
     memcpy (message + message_command_len, message_nonce + nonce_prefix_len,
             sizeof (nonce_t));
 
+    msg_->move (msg_box);
+
     return 0;
 }
 
@@ -218,61 +199,41 @@ int zmq::curve_encoding_t::decode (msg_t *msg_, int *error_event_code_)
     memcpy (message_nonce + nonce_prefix_len, message + message_command_len,
             sizeof (nonce_t));
 
-#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-    const size_t clen = msg_->size () - message_header_len;
-
-    uint8_t *const message_plaintext = message + message_header_len;
-
-    rc = crypto_box_open_easy_afternm (message_plaintext,
-                                       message + message_header_len, clen,
-                                       message_nonce, _cn_precom);
-#else
+    //  The ciphertext is decrypted in place, which leaves the flags and the
+    //  payload where encode assembled them.
     const size_t clen =
-      crypto_box_BOXZEROBYTES + msg_->size () - message_header_len;
-
-    std::vector<uint8_t> message_plaintext_with_zerobytes (clen);
-    std::vector<uint8_t> message_box (clen);
-
-    std::fill (message_box.begin (),
-               message_box.begin () + crypto_box_BOXZEROBYTES, 0);
-    memcpy (&message_box[crypto_box_BOXZEROBYTES], message + message_header_len,
-            msg_->size () - message_header_len);
+      msg_->size () - message_header_len - crypto_box_MACBYTES;
+    uint8_t *const message_plaintext =
+      message + message_header_len + crypto_box_MACBYTES;
 
-    rc = crypto_box_open_afternm (&message_plaintext_with_zerobytes[0],
-                                  &message_box[0], clen, message_nonce,
+#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
+    rc = crypto_box_open_detached_afternm (
+      message_plaintext, message_plaintext, message + message_header_len, clen,
+      message_nonce, _cn_precom);
+#else
+    //  crypto_box_open_afternm wants zeros ahead of the MAC, which fit in
+    //  the room of the command header.
+    uint8_t *const message_box = message_plaintext - crypto_box_ZEROBYTES;
+    memset (message_box, 0, crypto_box_BOXZEROBYTES);
+    rc = crypto_box_open_afternm (message_box, message_box,
+                                  crypto_box_ZEROBYTES + clen, message_nonce,
                                   _cn_precom);
-
-    const uint8_t *const message_plaintext =
-      &message_plaintext_with_zerobytes[crypto_box_ZEROBYTES];
 #endif
 
     if (rc == 0) {
         const uint8_t flags = message_plaintext[0];
-
-#ifdef ZMQ_HAVE_CRYPTO_BOX_EASY_FNS
-        const size_t plaintext_size = clen - flags_len - crypto_box_MACBYTES;
-
-        if (plaintext_size > 0) {
-            memmove (msg_->data (), &message_plaintext[flags_len],
-                     plaintext_size);
+        const size_t plaintext_size = clen - flags_len;
+
+        //  Messages in the decoder's buffer, and other long messages, start
+        //  at the payload from now on. Short ones are moved to the front.
+        if (!msg_->shrink_front (message_header_len + crypto_box_MACBYTES
+                                 + flags_len)) {
+            if (plaintext_size > 0)
+                memmove (msg_->data (), &message_plaintext[flags_len],
+                         plaintext_size);
+            msg_->shrink (plaintext_size);
         }
 
-        msg_->shrink (plaintext_size);
-#else
-        rc = msg_->close ();
-        zmq_assert (rc == 0);
-
-        rc = msg_->init_size (clen - flags_len - crypto_box_ZEROBYTES);
-        zmq_assert (rc == 0);
-
-        // this is copying the data to insecure memory, so there is no point in
-        // using secure_allocator_t for message_plaintext
-        if (msg_->size () > 0) {
-            memcpy (msg_->data (), &message_plaintext[flags_len],
-                    msg_->size ());
-        }
-#endif
-
         msg_->set_flags (flags & flag_mask);
     } else {
         // CURVE I : connection key used for MESSAGE is wrong
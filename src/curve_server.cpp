@@ -11,6 +11,311 @@
 #include "curve_server.hpp"
 #include "wire.hpp"
 #include "secure_allocator.hpp"
+#include "crypto_pool.hpp"
+#include "ctx.hpp"
+
+//  The jobs work on their own copies of the keys and commands, so that
+//  they do not depend on the mechanism, which may be gone by the time
+//  they are done.
+
+class zmq::curve_server_t::job_t : public crypto_job_t
+{
+  public:
+    //  Hands the result over to the mechanism.
+    virtual int done (curve_server_t *server_) const = 0;
+};
+
+//  Generates the short-term key pair, opens the HELLO box and produces
+//  the WELCOME command.
+class zmq::curve_server_t::hello_job_t ZMQ_FINAL : public job_t
+{
+  public:
+    hello_job_t (const uint8_t *secret_key_, const uint8_t *hello_);
+    ~hello_job_t ();
+
+    void execute ();
+    int done (curve_server_t *server_) const
+    {
+        return server_->hello_done (this);
+    }
+
+    //  Our secret key (s)
+    uint8_t secret_key[crypto_box_SECRETKEYBYTES];
+
+    //  Client's short-term public key (C')
+    uint8_t cn_client[crypto_box_PUBLICKEYBYTES];
+
+    uint8_t hello_nonce[8];
+    uint8_t hello_box[80];
+
+    //  The results, valid if the error code is 0.
+    int error_code;
+    uint8_t cn_public[crypto_box_PUBLICKEYBYTES];
+    uint8_t cn_secret[crypto_box_SECRETKEYBYTES];
+    uint8_t cookie_key[crypto_secretbox_KEYBYTES];
+    uint8_t welcome[168];
+};
+
+//  Opens the cookie, the INITIATE box and the vouch it contains, and
+//  precomputes the connection secret.
+class zmq::curve_server_t::initiate_job_t ZMQ_FINAL : public job_t
+{
+  public:
+    initiate_job_t (const uint8_t *cookie_key_,
+                    const uint8_t *cn_client_,
+                    const uint8_t *cn_secret_,
+                    const uint8_t *initiate_,
+                    size_t size_);
+    ~initiate_job_t ();
+
+    void execute ();
+    int done (curve_server_t *server_) const
+    {
+        return server_->initiate_done (this);
+    }
+
+    uint8_t cookie_key[crypto_secretbox_KEYBYTES];
+    uint8_t cn_client[crypto_box_PUBLICKEYBYTES];
+    uint8_t cn_secret[crypto_box_SECRETKEYBYTES];
+    std::vector<uint8_t> initiate;
+
+    //  The results, valid if the error code is 0. The plaintext starts
+    //  with crypto_box_ZEROBYTES zeros, followed by the client's long-term
+    //  public key (C), the vouch and the metadata.
+    int error_code;
+    size_t clen;
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > initiate_plaintext;
+    uint8_t precom[crypto_box_BEFORENMBYTES];
+};
+
+zmq::curve_server_t::hello_job_t::hello_job_t (const uint8_t *secret_key_,
+                                               const uint8_t *hello_) :
+    error_code (0)
+{
+    memcpy (secret_key, secret_key_, crypto_box_SECRETKEYBYTES);
+    memcpy (cn_client, hello_ + 80, 32);
+    memcpy (hello_nonce, hello_ + 112, 8);
+    memcpy (hello_box, hello_ + 120, 80);
+}
+
+zmq::curve_server_t::hello_job_t::~hello_job_t ()
+{
+    memset (secret_key, 0, sizeof secret_key);
+    memset (cn_secret, 0, sizeof cn_secret);
+    memset (cookie_key, 0, sizeof cookie_key);
+}
+
+void zmq::curve_server_t::hello_job_t::execute ()
+{
+    //  Generate short-term key pair
+    memset (cn_secret, 0, crypto_box_SECRETKEYBYTES);
+    memset (cn_public, 0, crypto_box_PUBLICKEYBYTES);
+    int rc = crypto_box_keypair (cn_public, cn_secret);
+    zmq_assert (rc == 0);
+
+    uint8_t nonce[crypto_box_NONCEBYTES];
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > hello_plaintext (
+      crypto_box_ZEROBYTES + 64);
+    uint8_t box[crypto_box_BOXZEROBYTES + 80];
+
+    memcpy (nonce, "CurveZMQHELLO---", 16);
+    memcpy (nonce + 16, hello_nonce, 8);
+
+    memset (box, 0, crypto_box_BOXZEROBYTES);
+    memcpy (box + crypto_box_BOXZEROBYTES, hello_box, 80);
+
+    //  Open Box [64 * %x0](C'->S)
+    rc = crypto_box_open (&hello_plaintext[0], box, sizeof box, nonce,
+                          cn_client, secret_key);
+    if (rc != 0) {
+        // CURVE I: cannot open client HELLO -- wrong server key?
+        error_code = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
+        return;
+    }
+
+    uint8_t cookie_nonce[crypto_secretbox_NONCEBYTES];
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > cookie_plaintext (
+      crypto_secretbox_ZEROBYTES + 64);
+    uint8_t cookie_ciphertext[crypto_secretbox_BOXZEROBYTES + 80];
+
+    //  Create full nonce for encryption
+    //  8-byte prefix plus 16-byte random nonce
+    memset (cookie_nonce, 0, crypto_secretbox_NONCEBYTES);
+    memcpy (cookie_nonce, "COOKIE--", 8);
+    randombytes (cookie_nonce + 8, 16);
+
+    //  Generate cookie = Box [C' + s'](t)
+    std::fill (cookie_plaintext.begin (),
+               cookie_plaintext.begin () + crypto_secretbox_ZEROBYTES, 0);
+    memcpy (&cookie_plaintext[crypto_secretbox_ZEROBYTES], cn_client, 32);
+    memcpy (&cookie_plaintext[crypto_secretbox_ZEROBYTES + 32], cn_secret, 32);
+
+    //  Generate fresh cookie key
+    memset (cookie_key, 0, crypto_secretbox_KEYBYTES);
+    randombytes (cookie_key, crypto_secretbox_KEYBYTES);
+
+    //  Encrypt using symmetric cookie key
+    rc = crypto_secretbox (cookie_ciphertext, &cookie_plaintext[0],
+                           cookie_plaintext.size (), cookie_nonce, cookie_key);
+    zmq_assert (rc == 0);
+
+    uint8_t welcome_nonce[crypto_box_NONCEBYTES];
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > welcome_plaintext (
+      crypto_box_ZEROBYTES + 128);
+    uint8_t welcome_ciphertext[crypto_box_BOXZEROBYTES + 144];
+
+    //  Create full nonce for encryption
+    //  8-byte prefix plus 16-byte random nonce
+    memset (welcome_nonce, 0, crypto_box_NONCEBYTES);
+    memcpy (welcome_nonce, "WELCOME-", 8);
+    randombytes (welcome_nonce + 8, crypto_box_NONCEBYTES - 8);
+
+    //  Create 144-byte Box [S' + cookie](S->C')
+    std::fill (welcome_plaintext.begin (),
+               welcome_plaintext.begin () + crypto_box_ZEROBYTES, 0);
+    memcpy (&welcome_plaintext[crypto_box_ZEROBYTES], cn_public, 32);
+    memcpy (&welcome_plaintext[crypto_box_ZEROBYTES + 32], cookie_nonce + 8,
+            16);
+    memcpy (&welcome_plaintext[crypto_box_ZEROBYTES + 48],
+            cookie_ciphertext + crypto_secretbox_BOXZEROBYTES, 80);
+
+    rc = crypto_box (welcome_ciphertext, &welcome_plaintext[0],
+                     welcome_plaintext.size (), welcome_nonce, cn_client,
+                     secret_key);
+
+    //  TODO I think we should change this back to zmq_assert (rc == 0);
+    //  as it was before https://github.com/zeromq/libzmq/pull/1832
+    //  The reason given there was that secret_key might be 0ed.
+    //  But if it were, we would never get this far, since we could
+    //  not have opened the client's hello box with a 0ed key.
+
+    if (rc == -1) {
+        error_code = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
+        return;
+    }
+
+    memcpy (welcome, "\x07WELCOME", 8);
+    memcpy (welcome + 8, welcome_nonce + 8, 16);
+    memcpy (welcome + 24, welcome_ciphertext + crypto_box_BOXZEROBYTES, 144);
+}
+
+zmq::curve_server_t::initiate_job_t::initiate_job_t (
+  const uint8_t *cookie_key_,
+  const uint8_t *cn_client_,
+  const uint8_t *cn_secret_,
+  const uint8_t *initiate_,
+  size_t size_) :
+    initiate (initiate_, initiate_ + size_),
+    error_code (0),
+    clen ((size_ - 113) + crypto_box_BOXZEROBYTES),
+    initiate_plaintext (crypto_box_ZEROBYTES + clen)
+{
+    memcpy (cookie_key, cookie_key_, crypto_secretbox_KEYBYTES);
+    memcpy (cn_client, cn_client_, crypto_box_PUBLICKEYBYTES);
+    memcpy (cn_secret, cn_secret_, crypto_box_SECRETKEYBYTES);
+}
+
+zmq::curve_server_t::initiate_job_t::~initiate_job_t ()
+{
+    memset (cookie_key, 0, sizeof cookie_key);
+    memset (cn_secret, 0, sizeof cn_secret);
+    memset (precom, 0, sizeof precom);
+}
+
+void zmq::curve_server_t::initiate_job_t::execute ()
+{
+    const uint8_t *const data = &initiate[0];
+
+    uint8_t cookie_nonce[crypto_secretbox_NONCEBYTES];
+    uint8_t cookie_plaintext[crypto_secretbox_ZEROBYTES + 64];
+    uint8_t cookie_box[crypto_secretbox_BOXZEROBYTES + 80];
+
+    //  Open Box [C' + s'](t)
+    memset (cookie_box, 0, crypto_secretbox_BOXZEROBYTES);
+    memcpy (cookie_box + crypto_secretbox_BOXZEROBYTES, data + 25, 80);
+
+    memcpy (cookie_nonce, "COOKIE--", 8);
+    memcpy (cookie_nonce + 8, data + 9, 16);
+
+    int rc = crypto_secretbox_open (cookie_plaintext, cookie_box,
+                                    sizeof cookie_box, cookie_nonce, cookie_key);
+    if (rc != 0) {
+        // CURVE I: cannot open client INITIATE cookie
+        error_code = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
+        return;
+    }
+
+    //  Check cookie plain text is as expected [C' + s']
+    if (memcmp (cookie_plaintext + crypto_secretbox_ZEROBYTES, cn_client, 32)
+        || memcmp (cookie_plaintext + crypto_secretbox_ZEROBYTES + 32,
+                   cn_secret, 32)) {
+        // TODO this case is very hard to test, as it would require a modified
+        //  client that knows the server's secret temporary cookie key
+
+        // CURVE I: client INITIATE cookie is not valid
+        error_code = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
+        return;
+    }
+
+    uint8_t initiate_nonce[crypto_box_NONCEBYTES];
+    std::vector<uint8_t> initiate_box (crypto_box_BOXZEROBYTES + clen);
+
+    //  Open Box [C + vouch + metadata](C'->S')
+    std::fill (initiate_box.begin (),
+               initiate_box.begin () + crypto_box_BOXZEROBYTES, 0);
+    memcpy (&initiate_box[crypto_box_BOXZEROBYTES], data + 113,
+            clen - crypto_box_BOXZEROBYTES);
+
+    memcpy (initiate_nonce, "CurveZMQINITIATE", 16);
+    memcpy (initiate_nonce + 16, data + 105, 8);
+
+    const uint8_t *client_key = &initiate_plaintext[crypto_box_ZEROBYTES];
+
+    rc = crypto_box_open (&initiate_plaintext[0], &initiate_box[0], clen,
+                          initiate_nonce, cn_client, cn_secret);
+    if (rc != 0) {
+        // CURVE I: cannot open client INITIATE
+        error_code = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
+        return;
+    }
+
+    uint8_t vouch_nonce[crypto_box_NONCEBYTES];
+    std::vector<uint8_t, secure_allocator_t<uint8_t> > vouch_plaintext (
+      crypto_box_ZEROBYTES + 64);
+    uint8_t vouch_box[crypto_box_BOXZEROBYTES + 80];
+
+    //  Open Box Box [C',S](C->S') and check contents
+    memset (vouch_box, 0, crypto_box_BOXZEROBYTES);
+    memcpy (vouch_box + crypto_box_BOXZEROBYTES,
+            &initiate_plaintext[crypto_box_ZEROBYTES + 48], 80);
+
+    memset (vouch_nonce, 0, crypto_box_NONCEBYTES);
+    memcpy (vouch_nonce, "VOUCH---", 8);
+    memcpy (vouch_nonce + 8, &initiate_plaintext[crypto_box_ZEROBYTES + 32],
+            16);
+
+    rc = crypto_box_open (&vouch_plaintext[0], vouch_box, sizeof vouch_box,
+                          vouch_nonce, client_key, cn_secret);
+    if (rc != 0) {
+        // CURVE I: cannot open client INITIATE vouch
+        error_code = ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC;
+        return;
+    }
+
+    //  What we decrypted must be the client's short-term public key
+    if (memcmp (&vouch_plaintext[crypto_box_ZEROBYTES], cn_client, 32)) {
+        // TODO this case is very hard to test, as it would require a modified
+        //  client that knows the server's secret short-term key
+
+        // CURVE I: invalid handshake from client (public key)
+        error_code = ZMQ_PROTOCOL_ERROR_ZMTP_KEY_EXCHANGE;
+        return;
+    }
+
+    //  Precompute connection secret from client key
+    rc = crypto_box_beforenm (precom, cn_client, cn_secret);
+    zmq_assert (rc == 0);
+}
 
 zmq::curve_server_t::curve_server_t (session_base_t *session_,
                                      const std::string &peer_address_,
@@ -23,21 +328,23 @@ zmq::curve_server_t::curve_server_t (session_base_t *session_,
                             options_,
                             "CurveZMQMESSAGES",
                             "CurveZMQMESSAGEC",
-                            downgrade_sub_)
+                            downgrade_sub_),
+    _job (NULL)
 {
-    int rc;
     //  Fetch our secret key from socket options
     memcpy (_secret_key, options_.curve_secret_key, crypto_box_SECRETKEYBYTES);
 
-    //  Generate short-term key pair
+    //  The short-term key pair is generated along with the HELLO box being
+    //  opened.
     memset (_cn_secret, 0, crypto_box_SECRETKEYBYTES);
     memset (_cn_public, 0, crypto_box_PUBLICKEYBYTES);
-    rc = crypto_box_keypair (_cn_public, _cn_secret);
-    zmq_assert (rc == 0);
 }
 
 zmq::curve_server_t::~curve_server_t ()
 {
+    //  The session drops the job once it is done.
+    if (_job)
+        _job->cancel ();
 }
 
 int zmq::curve_server_t::next_handshake_command (msg_t *msg_)
@@ -102,6 +409,29 @@ int zmq::curve_server_t::process_handshake_command (msg_t *msg_)
     return rc;
 }
 
+int zmq::curve_server_t::crypto_done (crypto_job_t *job_)
+{
+    zmq_assert (state == waiting_for_crypto && job_ == _job);
+    _job = NULL;
+    return static_cast<job_t *> (job_)->done (this);
+}
+
+int zmq::curve_server_t::run (job_t *job_)
+{
+    crypto_pool_t *const pool = session->get_ctx ()->get_crypto_pool ();
+    if (pool) {
+        _job = job_;
+        state = waiting_for_crypto;
+        pool->submit (session, job_);
+        return 0;
+    }
+
+    job_->execute ();
+    const int rc = job_->done (this);
+    LIBZMQ_DELETE (job_);
+    return rc;
+}
+
 int zmq::curve_server_t::encode (msg_t *msg_)
 {
     zmq_assert (state == ready);
@@ -152,104 +482,37 @@ int zmq::curve_server_t::process_hello (msg_t *msg_)
 
     //  Save client's short-term public key (C')
     memcpy (_cn_client, hello + 80, 32);
-
-    uint8_t hello_nonce[crypto_box_NONCEBYTES];
-    std::vector<uint8_t, secure_allocator_t<uint8_t> > hello_plaintext (
-      crypto_box_ZEROBYTES + 64);
-    uint8_t hello_box[crypto_box_BOXZEROBYTES + 80];
-
-    memcpy (hello_nonce, "CurveZMQHELLO---", 16);
-    memcpy (hello_nonce + 16, hello + 112, 8);
     set_peer_nonce (get_uint64 (hello + 112));
 
-    memset (hello_box, 0, crypto_box_BOXZEROBYTES);
-    memcpy (hello_box + crypto_box_BOXZEROBYTES, hello + 120, 80);
+    hello_job_t *const job =
+      new (std::nothrow) hello_job_t (_secret_key, hello);
+    alloc_assert (job);
+    return run (job);
+}
 
-    //  Open Box [64 * %x0](C'->S)
-    rc = crypto_box_open (&hello_plaintext[0], hello_box, sizeof hello_box,
-                          hello_nonce, _cn_client, _secret_key);
-    if (rc != 0) {
-        // CURVE I: cannot open client HELLO -- wrong server key?
+int zmq::curve_server_t::hello_done (const hello_job_t *job_)
+{
+    if (job_->error_code != 0) {
         session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
+          session->get_endpoint (), job_->error_code);
         errno = EPROTO;
         return -1;
     }
 
+    memcpy (_cn_public, job_->cn_public, crypto_box_PUBLICKEYBYTES);
+    memcpy (_cn_secret, job_->cn_secret, crypto_box_SECRETKEYBYTES);
+    memcpy (_cookie_key, job_->cookie_key, crypto_secretbox_KEYBYTES);
+    memcpy (_welcome, job_->welcome, sizeof _welcome);
+
     state = sending_welcome;
-    return rc;
+    return 0;
 }
 
 int zmq::curve_server_t::produce_welcome (msg_t *msg_)
 {
-    uint8_t cookie_nonce[crypto_secretbox_NONCEBYTES];
-    std::vector<uint8_t, secure_allocator_t<uint8_t> > cookie_plaintext (
-      crypto_secretbox_ZEROBYTES + 64);
-    uint8_t cookie_ciphertext[crypto_secretbox_BOXZEROBYTES + 80];
-
-    //  Create full nonce for encryption
-    //  8-byte prefix plus 16-byte random nonce
-    memset (cookie_nonce, 0, crypto_secretbox_NONCEBYTES);
-    memcpy (cookie_nonce, "COOKIE--", 8);
-    randombytes (cookie_nonce + 8, 16);
-
-    //  Generate cookie = Box [C' + s'](t)
-    std::fill (cookie_plaintext.begin (),
-               cookie_plaintext.begin () + crypto_secretbox_ZEROBYTES, 0);
-    memcpy (&cookie_plaintext[crypto_secretbox_ZEROBYTES], _cn_client, 32);
-    memcpy (&cookie_plaintext[crypto_secretbox_ZEROBYTES + 32], _cn_secret, 32);
-
-    //  Generate fresh cookie key
-    memset (_cookie_key, 0, crypto_secretbox_KEYBYTES);
-    randombytes (_cookie_key, crypto_secretbox_KEYBYTES);
-
-    //  Encrypt using symmetric cookie key
-    int rc =
-      crypto_secretbox (cookie_ciphertext, &cookie_plaintext[0],
-                        cookie_plaintext.size (), cookie_nonce, _cookie_key);
-    zmq_assert (rc == 0);
-
-    uint8_t welcome_nonce[crypto_box_NONCEBYTES];
-    std::vector<uint8_t, secure_allocator_t<uint8_t> > welcome_plaintext (
-      crypto_box_ZEROBYTES + 128);
-    uint8_t welcome_ciphertext[crypto_box_BOXZEROBYTES + 144];
-
-    //  Create full nonce for encryption
-    //  8-byte prefix plus 16-byte random nonce
-    memset (welcome_nonce, 0, crypto_box_NONCEBYTES);
-    memcpy (welcome_nonce, "WELCOME-", 8);
-    randombytes (welcome_nonce + 8, crypto_box_NONCEBYTES - 8);
-
-    //  Create 144-byte Box [S' + cookie](S->C')
-    std::fill (welcome_plaintext.begin (),
-               welcome_plaintext.begin () + crypto_box_ZEROBYTES, 0);
-    memcpy (&welcome_plaintext[crypto_box_ZEROBYTES], _cn_public, 32);
-    memcpy (&welcome_plaintext[crypto_box_ZEROBYTES + 32], cookie_nonce + 8,
-            16);
-    memcpy (&welcome_plaintext[crypto_box_ZEROBYTES + 48],
-            cookie_ciphertext + crypto_secretbox_BOXZEROBYTES, 80);
-
-    rc = crypto_box (welcome_ciphertext, &welcome_plaintext[0],
-                     welcome_plaintext.size (), welcome_nonce, _cn_client,
-                     _secret_key);
-
-    //  TODO I think we should change this back to zmq_assert (rc == 0);
-    //  as it was before https://github.com/zeromq/libzmq/pull/1832
-    //  The reason given there was that secret_key might be 0ed.
-    //  But if it were, we would never get this far, since we could
-    //  not have opened the client's hello box with a 0ed key.
-
-    if (rc == -1)
-        return -1;
-
-    rc = msg_->init_size (168);
+    const int rc = msg_->init_size (sizeof _welcome);
     errno_assert (rc == 0);
-
-    uint8_t *const welcome = static_cast<uint8_t *> (msg_->data ());
-    memcpy (welcome, "\x07WELCOME", 8);
-    memcpy (welcome + 8, welcome_nonce + 8, 16);
-    memcpy (welcome + 24, welcome_ciphertext + crypto_box_BOXZEROBYTES, 144);
-
+    memcpy (msg_->data (), _welcome, sizeof _welcome);
     return 0;
 }
 
@@ -277,117 +540,34 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
         return -1;
     }
 
-    uint8_t cookie_nonce[crypto_secretbox_NONCEBYTES];
-    uint8_t cookie_plaintext[crypto_secretbox_ZEROBYTES + 64];
-    uint8_t cookie_box[crypto_secretbox_BOXZEROBYTES + 80];
-
-    //  Open Box [C' + s'](t)
-    memset (cookie_box, 0, crypto_secretbox_BOXZEROBYTES);
-    memcpy (cookie_box + crypto_secretbox_BOXZEROBYTES, initiate + 25, 80);
-
-    memcpy (cookie_nonce, "COOKIE--", 8);
-    memcpy (cookie_nonce + 8, initiate + 9, 16);
-
-    rc = crypto_secretbox_open (cookie_plaintext, cookie_box, sizeof cookie_box,
-                                cookie_nonce, _cookie_key);
-    if (rc != 0) {
-        // CURVE I: cannot open client INITIATE cookie
-        session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
-        errno = EPROTO;
-        return -1;
-    }
-
-    //  Check cookie plain text is as expected [C' + s']
-    if (memcmp (cookie_plaintext + crypto_secretbox_ZEROBYTES, _cn_client, 32)
-        || memcmp (cookie_plaintext + crypto_secretbox_ZEROBYTES + 32,
-                   _cn_secret, 32)) {
-        // TODO this case is very hard to test, as it would require a modified
-        //  client that knows the server's secret temporary cookie key
-
-        // CURVE I: client INITIATE cookie is not valid
-        session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
-        errno = EPROTO;
-        return -1;
-    }
-
-    const size_t clen = (size - 113) + crypto_box_BOXZEROBYTES;
-
-    uint8_t initiate_nonce[crypto_box_NONCEBYTES];
-    std::vector<uint8_t, secure_allocator_t<uint8_t> > initiate_plaintext (
-      crypto_box_ZEROBYTES + clen);
-    std::vector<uint8_t> initiate_box (crypto_box_BOXZEROBYTES + clen);
-
-    //  Open Box [C + vouch + metadata](C'->S')
-    std::fill (initiate_box.begin (),
-               initiate_box.begin () + crypto_box_BOXZEROBYTES, 0);
-    memcpy (&initiate_box[crypto_box_BOXZEROBYTES], initiate + 113,
-            clen - crypto_box_BOXZEROBYTES);
-
-    memcpy (initiate_nonce, "CurveZMQINITIATE", 16);
-    memcpy (initiate_nonce + 16, initiate + 105, 8);
     set_peer_nonce (get_uint64 (initiate + 105));
 
-    const uint8_t *client_key = &initiate_plaintext[crypto_box_ZEROBYTES];
-
-    rc = crypto_box_open (&initiate_plaintext[0], &initiate_box[0], clen,
-                          initiate_nonce, _cn_client, _cn_secret);
-    if (rc != 0) {
-        // CURVE I: cannot open client INITIATE
-        session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
-        errno = EPROTO;
-        return -1;
-    }
-
-    uint8_t vouch_nonce[crypto_box_NONCEBYTES];
-    std::vector<uint8_t, secure_allocator_t<uint8_t> > vouch_plaintext (
-      crypto_box_ZEROBYTES + 64);
-    uint8_t vouch_box[crypto_box_BOXZEROBYTES + 80];
-
-    //  Open Box Box [C',S](C->S') and check contents
-    memset (vouch_box, 0, crypto_box_BOXZEROBYTES);
-    memcpy (vouch_box + crypto_box_BOXZEROBYTES,
-            &initiate_plaintext[crypto_box_ZEROBYTES + 48], 80);
-
-    memset (vouch_nonce, 0, crypto_box_NONCEBYTES);
-    memcpy (vouch_nonce, "VOUCH---", 8);
-    memcpy (vouch_nonce + 8, &initiate_plaintext[crypto_box_ZEROBYTES + 32],
-            16);
+    initiate_job_t *const job = new (std::nothrow)
+      initiate_job_t (_cookie_key, _cn_client, _cn_secret, initiate, size);
+    alloc_assert (job);
+    return run (job);
+}
 
-    rc = crypto_box_open (&vouch_plaintext[0], vouch_box, sizeof vouch_box,
-                          vouch_nonce, client_key, _cn_secret);
-    if (rc != 0) {
-        // CURVE I: cannot open client INITIATE vouch
+int zmq::curve_server_t::initiate_done (const initiate_job_t *job_)
+{
+    if (job_->error_code != 0) {
         session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_CRYPTOGRAPHIC);
+          session->get_endpoint (), job_->error_code);
         errno = EPROTO;
         return -1;
     }
 
-    //  What we decrypted must be the client's short-term public key
-    if (memcmp (&vouch_plaintext[crypto_box_ZEROBYTES], _cn_client, 32)) {
-        // TODO this case is very hard to test, as it would require a modified
-        //  client that knows the server's secret short-term key
+    memcpy (get_writable_precom_buffer (), job_->precom,
+            crypto_box_BEFORENMBYTES);
 
-        // CURVE I: invalid handshake from client (public key)
-        session->get_socket ()->event_handshake_failed_protocol (
-          session->get_endpoint (), ZMQ_PROTOCOL_ERROR_ZMTP_KEY_EXCHANGE);
-        errno = EPROTO;
-        return -1;
-    }
-
-    //  Precompute connection secret from client key
-    rc = crypto_box_beforenm (get_writable_precom_buffer (), _cn_client,
-                              _cn_secret);
-    zmq_assert (rc == 0);
+    const uint8_t *const client_key =
+      &job_->initiate_plaintext[crypto_box_ZEROBYTES];
 
     //  Given this is a backward-incompatible change, it's behind a socket
     //  option disabled by default.
     if (zap_required () || !options.zap_enforce_domain) {
         //  Use ZAP protocol (RFC 27) to authenticate the user.
-        rc = session->zap_connect ();
+        const int rc = session->zap_connect ();
         if (rc == 0) {
             send_zap_request (client_key);
             state = waiting_for_zap_reply;
@@ -412,8 +592,9 @@ int zmq::curve_server_t::process_initiate (msg_t *msg_)
         state = sending_ready;
     }
 
-    return parse_metadata (&initiate_plaintext[crypto_box_ZEROBYTES + 128],
-                           clen - crypto_box_ZEROBYTES - 128);
+    return parse_metadata (
+      &job_->initiate_plaintext[crypto_box_ZEROBYTES + 128],
+      job_->clen - crypto_box_ZEROBYTES - 128);
 }
 
 int zmq::curve_server_t::produce_ready (msg_t *msg_)
@@ -30,8 +30,18 @@ class curve_server_t ZMQ_FINAL : public zap_client_common_handshake_t,
     int process_handshake_command (msg_t *msg_);
     int encode (msg_t *msg_);
     int decode (msg_t *msg_);
+    int crypto_done (crypto_job_t *job_);
 
   private:
+    //  The steps of the handshake involving public key cryptography,
+    //  handed to the crypto pool of the context if it has one.
+    class job_t;
+    class hello_job_t;
+    class initiate_job_t;
+
+    //  Job the handshake is waiting for, if any.
+    job_t *_job;
+
     //  Our secret key (s)
     uint8_t _secret_key[crypto_box_SECRETKEYBYTES];
 
@@ -47,13 +57,22 @@ class curve_server_t ZMQ_FINAL : public zap_client_common_handshake_t,
     //  Key used to produce cookie
     uint8_t _cookie_key[crypto_secretbox_KEYBYTES];
 
+    //  WELCOME command, produced along with the HELLO box being opened
+    uint8_t _welcome[168];
+
     int process_hello (msg_t *msg_);
+    int hello_done (const hello_job_t *job_);
     int produce_welcome (msg_t *msg_);
     int process_initiate (msg_t *msg_);
+    int initiate_done (const initiate_job_t *job_);
     int produce_ready (msg_t *msg_);
     int produce_error (msg_t *msg_) const;
 
     void send_zap_request (const uint8_t *key_);
+
+    //  Runs the job, in the crypto pool of the context if it has one.
+    //  Otherwise it is run right away and its result returned.
+    int run (job_t *job_);
 };
 #ifdef _MSC_VER
 #pragma warning(pop)
@@ -81,6 +81,19 @@ int zmq::dealer_t::xrecv (msg_t *msg_)
     return recvpipe (msg_, NULL);
 }
 
+bool zmq::dealer_t::xbegin_batch (bool send_)
+{
+    if (send_)
+        _lb.begin_batch ();
+    return true;
+}
+
+void zmq::dealer_t::xend_batch (bool send_)
+{
+    if (send_)
+        _lb.end_batch ();
+}
+
 bool zmq::dealer_t::xhas_in ()
 {
     return _fq.has_in ();
@@ -32,6 +32,8 @@ class dealer_t : public socket_base_t
                      size_t optvallen_) ZMQ_OVERRIDE;
     int xsend (zmq::msg_t *msg_) ZMQ_OVERRIDE;
     int xrecv (zmq::msg_t *msg_) ZMQ_OVERRIDE;
+    bool xbegin_batch (bool send_) ZMQ_FINAL;
+    void xend_batch (bool send_) ZMQ_FINAL;
     bool xhas_in () ZMQ_OVERRIDE;
     bool xhas_out () ZMQ_OVERRIDE;
     void xread_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
@@ -36,6 +36,16 @@ class decoder_base_t : public i_decoder
         _buf = _allocator.allocate ();
     }
 
+    //  For allocator policies drawing memory from a message allocator.
+    decoder_base_t (const size_t buf_size_, i_msg_allocator *msg_allocator_) :
+        _next (NULL),
+        _read_pos (NULL),
+        _to_read (0),
+        _allocator (buf_size_, msg_allocator_)
+    {
+        _buf = _allocator.allocate ();
+    }
+
     ~decoder_base_t () ZMQ_OVERRIDE { _allocator.deallocate (); }
 
     //  Returns a buffer to be filled with binary data.
@@ -4,9 +4,13 @@
 #include "decoder_allocators.hpp"
 
 #include "msg.hpp"
+#include "i_msg_allocator.hpp"
+
+#include <string.h>
 
 zmq::shared_message_memory_allocator::shared_message_memory_allocator (
-  std::size_t bufsize_) :
+  std::size_t bufsize_, i_msg_allocator *msg_allocator_) :
+    _msg_allocator (msg_allocator_),
     _buf (NULL),
     _buf_size (0),
     _max_size (bufsize_),
@@ -16,7 +20,10 @@ zmq::shared_message_memory_allocator::shared_message_memory_allocator (
 }
 
 zmq::shared_message_memory_allocator::shared_message_memory_allocator (
-  std::size_t bufsize_, std::size_t max_messages_) :
+  std::size_t bufsize_,
+  std::size_t max_messages_,
+  i_msg_allocator *msg_allocator_) :
+    _msg_allocator (msg_allocator_),
     _buf (NULL),
     _buf_size (0),
     _max_size (bufsize_),
@@ -54,7 +61,7 @@ unsigned char *zmq::shared_message_memory_allocator::allocate ()
           _max_size + sizeof (zmq::atomic_counter_t)
           + _max_counters * sizeof (zmq::msg_t::content_t);
 
-        _buf = static_cast<unsigned char *> (std::malloc (allocationsize));
+        _buf = allocate_buffer (_msg_allocator, allocationsize);
         alloc_assert (_buf);
 
         new (_buf) atomic_counter_t (1);
@@ -76,7 +83,7 @@ void zmq::shared_message_memory_allocator::deallocate ()
     zmq::atomic_counter_t *c = reinterpret_cast<zmq::atomic_counter_t *> (_buf);
     if (_buf && !c->sub (1)) {
         c->~atomic_counter_t ();
-        std::free (_buf);
+        deallocate_buffer (_buf);
     }
     clear ();
 }
@@ -108,8 +115,7 @@ void zmq::shared_message_memory_allocator::call_dec_ref (void *, void *hint_)
 
     if (!c->sub (1)) {
         c->~atomic_counter_t ();
-        std::free (buf);
-        buf = NULL;
+        deallocate_buffer (buf);
     }
 }
 
@@ -123,3 +129,29 @@ unsigned char *zmq::shared_message_memory_allocator::data ()
 {
     return _buf + sizeof (zmq::atomic_counter_t);
 }
+
+unsigned char *zmq::shared_message_memory_allocator::allocate_buffer (
+  i_msg_allocator *msg_allocator_, std::size_t size_)
+{
+    const std::size_t prefix = sizeof (i_msg_allocator *);
+    unsigned char *raw = static_cast<unsigned char *> (
+      msg_allocator_ ? msg_allocator_->allocate (prefix + size_)
+                     : std::malloc (prefix + size_));
+    if (!raw)
+        return NULL;
+    memcpy (raw, &msg_allocator_, prefix);
+    return raw + prefix;
+}
+
+void zmq::shared_message_memory_allocator::deallocate_buffer (
+  unsigned char *buf_)
+{
+    const std::size_t prefix = sizeof (i_msg_allocator *);
+    unsigned char *raw = buf_ - prefix;
+    i_msg_allocator *msg_allocator;
+    memcpy (&msg_allocator, raw, prefix);
+    if (msg_allocator)
+        msg_allocator->deallocate (raw);
+    else
+        std::free (raw);
+}
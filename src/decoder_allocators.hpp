@@ -10,6 +10,11 @@
 #include "msg.hpp"
 #include "err.hpp"
 
+namespace zmq
+{
+class i_msg_allocator;
+}
+
 namespace zmq
 {
 // Static buffer policy.
@@ -50,14 +55,19 @@ class c_single_allocator
 // from zero to one, gets passed to the user application, processed in the user thread and deleted
 // which would then deallocate the buffer. The drawback is that the buffer may be allocated longer
 // than necessary because it is only deleted when allocate is called the next time.
+//
+// Buffers and the contents of messages which do not fit into the buffer are
+// obtained from msg_allocator_, or malloc-ed if it is NULL.
 class shared_message_memory_allocator
 {
   public:
-    explicit shared_message_memory_allocator (std::size_t bufsize_);
+    explicit shared_message_memory_allocator (
+      std::size_t bufsize_, i_msg_allocator *msg_allocator_ = NULL);
 
     // Create an allocator for a maximum number of messages
     shared_message_memory_allocator (std::size_t bufsize_,
-                                     std::size_t max_messages_);
+                                     std::size_t max_messages_,
+                                     i_msg_allocator *msg_allocator_ = NULL);
 
     ~shared_message_memory_allocator ();
 
@@ -92,9 +102,18 @@ class shared_message_memory_allocator
 
     void advance_content () { _msg_content++; }
 
+    i_msg_allocator *msg_allocator () const { return _msg_allocator; }
+
   private:
     void clear ();
 
+    //  Buffers are preceded by the allocator they were obtained from, so
+    //  that the last message referring to one can release it.
+    static unsigned char *allocate_buffer (i_msg_allocator *msg_allocator_,
+                                           std::size_t size_);
+    static void deallocate_buffer (unsigned char *buf_);
+
+    i_msg_allocator *const _msg_allocator;
     unsigned char *_buf;
     std::size_t _buf_size;
     const std::size_t _max_size;
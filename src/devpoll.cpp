@@ -154,8 +154,10 @@ void zmq::devpoll_t::loop ()
 #else
         poll_req.dp_nfds = max_io_events;
 #endif
+        timeout = begin_wait (timeout);
         poll_req.dp_timeout = timeout ? timeout : -1;
         int n = ioctl (devpoll_fd, DP_POLL, &poll_req);
+        end_wait ();
         if (n == -1 && errno == EINTR)
             continue;
         errno_assert (n != -1);
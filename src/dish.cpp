@@ -65,15 +65,13 @@ void zmq::dish_t::xhiccuped (pipe_t *pipe_)
 
 int zmq::dish_t::xjoin (const char *group_)
 {
-    const std::string group = std::string (group_);
-
-    if (group.length () > ZMQ_GROUP_MAX_LENGTH) {
+    if (strnlen (group_, ZMQ_GROUP_MAX_LENGTH + 1) > ZMQ_GROUP_MAX_LENGTH) {
         errno = EINVAL;
         return -1;
     }
 
     //  User cannot join same group twice
-    if (!_subscriptions.insert (group).second) {
+    if (!_subscriptions.insert (group_).second) {
         errno = EINVAL;
         return -1;
     }
@@ -98,14 +96,12 @@ int zmq::dish_t::xjoin (const char *group_)
 
 int zmq::dish_t::xleave (const char *group_)
 {
-    const std::string group = std::string (group_);
-
-    if (group.length () > ZMQ_GROUP_MAX_LENGTH) {
+    if (strnlen (group_, ZMQ_GROUP_MAX_LENGTH + 1) > ZMQ_GROUP_MAX_LENGTH) {
         errno = EINVAL;
         return -1;
     }
 
-    if (0 == _subscriptions.erase (group)) {
+    if (!_subscriptions.erase (group_)) {
         errno = EINVAL;
         return -1;
     }
@@ -167,7 +163,7 @@ int zmq::dish_t::xxrecv (msg_t *msg_)
             return -1;
 
         //  Skip non matching messages
-    } while (0 == _subscriptions.count (std::string (msg_->group ())));
+    } while (!_subscriptions.find (msg_->group ()));
 
     //  Found a matching message
     return 0;
@@ -200,7 +196,7 @@ void zmq::dish_t::send_subscriptions (pipe_t *pipe_)
         int rc = msg.init_join ();
         errno_assert (rc == 0);
 
-        rc = msg.set_group (it->c_str ());
+        rc = msg.set_group (it.group ());
         errno_assert (rc == 0);
 
         //  Send it to the pipe.
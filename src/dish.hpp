@@ -3,12 +3,11 @@
 #ifndef __ZMQ_DISH_HPP_INCLUDED__
 #define __ZMQ_DISH_HPP_INCLUDED__
 
-#include <string>
-
 #include "socket_base.hpp"
 #include "session_base.hpp"
 #include "dist.hpp"
 #include "fq.hpp"
+#include "group_table.hpp"
 #include "msg.hpp"
 
 namespace zmq
@@ -51,8 +50,8 @@ class dish_t ZMQ_FINAL : public socket_base_t
     //  Object for distributing the subscriptions upstream.
     dist_t _dist;
 
-    //  The repository of subscriptions.
-    typedef std::set<std::string> subscriptions_t;
+    //  The repository of subscriptions. Groups carry no value.
+    typedef group_table_t<bool> subscriptions_t;
     subscriptions_t _subscriptions;
 
     //  If true, 'message' contains a matching message to return on the
@@ -8,7 +8,7 @@
 #include "likely.hpp"
 
 zmq::dist_t::dist_t () :
-    _matching (0), _active (0), _eligible (0), _more (false)
+    _matching (0), _active (0), _eligible (0), _more (false), _batch (false)
 {
 }
 
@@ -52,9 +52,12 @@ void zmq::dist_t::match (pipe_t *pipe_)
     if (_pipes.index (pipe_) < _matching)
         return;
 
-    //  If the pipe isn't eligible, ignore it.
-    if (_pipes.index (pipe_) >= _eligible)
+    //  If the pipe isn't eligible, ignore it. It is at its high water mark,
+    //  so the message is dropped for it.
+    if (_pipes.index (pipe_) >= _eligible) {
+        pipe_->count_dropped ();
         return;
+    }
 
     //  Mark the pipe as matching.
     _pipes.swap (_pipes.index (pipe_), _matching);
@@ -120,6 +123,11 @@ void zmq::dist_t::activated (pipe_t *pipe_)
 
 int zmq::dist_t::send_to_all (msg_t *msg_)
 {
+    //  Pipes at their high water mark miss the message.
+    if (!_more)
+        for (pipes_t::size_type i = _eligible; i < _pipes.size (); ++i)
+            _pipes[i]->count_dropped ();
+
     _matching = _active;
     return send_to_matching (msg_);
 }
@@ -152,7 +160,9 @@ void zmq::dist_t::distribute (msg_t *msg_)
         return;
     }
 
-    if (msg_->is_vsm ()) {
+    //  A long group is shared between the copies, so it needs them to be
+    //  reference counted like the content of long messages.
+    if (msg_->is_vsm () && !msg_->has_long_group ()) {
         for (pipes_t::size_type i = 0; i < _matching;) {
             if (!write (_pipes[i], msg_)) {
                 //  Use same index again because entry will have been removed.
@@ -196,6 +206,7 @@ bool zmq::dist_t::has_out ()
 bool zmq::dist_t::write (pipe_t *pipe_, msg_t *msg_)
 {
     if (!pipe_->write (msg_)) {
+        pipe_->count_dropped ();
         _pipes.swap (_pipes.index (pipe_), _matching - 1);
         _matching--;
         _pipes.swap (_pipes.index (pipe_), _active - 1);
@@ -204,8 +215,12 @@ bool zmq::dist_t::write (pipe_t *pipe_, msg_t *msg_)
         _eligible--;
         return false;
     }
-    if (!(msg_->flags () & msg_t::more))
-        pipe_->flush ();
+    if (!(msg_->flags () & msg_t::more)) {
+        if (!_batch)
+            pipe_->flush ();
+        else if (pipe_->defer_flush ())
+            _batch_out.push_back (pipe_);
+    }
     return true;
 }
 
@@ -217,3 +232,18 @@ bool zmq::dist_t::check_hwm ()
 
     return true;
 }
+
+void zmq::dist_t::begin_batch ()
+{
+    _batch = true;
+}
+
+void zmq::dist_t::end_batch ()
+{
+    _batch = false;
+
+    for (std::vector<pipe_t *>::size_type i = 0, size = _batch_out.size ();
+         i != size; ++i)
+        _batch_out[i]->flush ();
+    _batch_out.clear ();
+}
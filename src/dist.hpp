@@ -54,6 +54,11 @@ class dist_t
     // check HWM of all pipes matching
     bool check_hwm ();
 
+    //  Between these calls, completed messages are not flushed to the pipes
+    //  one by one but all at once by end_batch.
+    void begin_batch ();
+    void end_batch ();
+
   private:
     //  Write the message to the pipe. Make the pipe inactive if writing
     //  fails. In such a case false is returned.
@@ -84,6 +89,12 @@ class dist_t
     //  True if last we are in the middle of a multipart message.
     bool _more;
 
+    //  True if flushing is deferred to the end of a batch. The pipes
+    //  written to are remembered as they are written, since they may be
+    //  deactivated before the batch ends.
+    bool _batch;
+    std::vector<pipe_t *> _batch_out;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (dist_t)
 };
 }
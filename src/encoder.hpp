@@ -16,6 +16,7 @@
 
 #include "err.hpp"
 #include "i_encoder.hpp"
+#include "iov_batch.hpp"
 #include "msg.hpp"
 
 namespace zmq
@@ -34,6 +35,7 @@ template <typename T> class encoder_base_t : public i_encoder
         _new_msg_flag (false),
         _buf_size (bufsize_),
         _buf (static_cast<unsigned char *> (malloc (bufsize_))),
+        _buf_used (0),
         _in_progress (NULL)
     {
         alloc_assert (_buf);
@@ -99,6 +101,57 @@ template <typename T> class encoder_base_t : public i_encoder
         return pos;
     }
 
+#if defined ZMQ_HAVE_UIO
+    size_t encode_iov (iov_batch_t &batch_, size_t ref_size_) ZMQ_FINAL
+    {
+        //  The chunks copied for the previous batch have been written.
+        if (batch_.empty ())
+            _buf_used = 0;
+
+        size_t pos = 0;
+        while (in_progress () != NULL && !batch_.full ()) {
+            if (!_to_write) {
+                if (_new_msg_flag) {
+                    int rc = _in_progress->close ();
+                    errno_assert (rc == 0);
+                    rc = _in_progress->init ();
+                    errno_assert (rc == 0);
+                    _in_progress = NULL;
+                    break;
+                }
+                (static_cast<T *> (this)->*_next) ();
+                continue;
+            }
+
+            //  Reference the message body rather than copying it. The data
+            //  of very small messages is stored in msg_t itself and would
+            //  move along with it.
+            if (_new_msg_flag && _to_write >= ref_size_
+                && _write_pos == _in_progress->data ()
+                && !_in_progress->is_vsm ()) {
+                batch_.reference (_in_progress);
+                pos += _to_write;
+                _write_pos = NULL;
+                _to_write = 0;
+                _in_progress = NULL;
+                break;
+            }
+
+            //  Copy data to the buffer. If the buffer is full, return.
+            const size_t to_copy = std::min (_to_write, _buf_size - _buf_used);
+            if (!to_copy)
+                break;
+            memcpy (_buf + _buf_used, _write_pos, to_copy);
+            batch_.append (_buf + _buf_used, to_copy);
+            _buf_used += to_copy;
+            pos += to_copy;
+            _write_pos += to_copy;
+            _to_write -= to_copy;
+        }
+        return pos;
+    }
+#endif
+
     void load_msg (msg_t *msg_) ZMQ_FINAL
     {
         zmq_assert (in_progress () == NULL);
@@ -142,6 +195,10 @@ template <typename T> class encoder_base_t : public i_encoder
     const size_t _buf_size;
     unsigned char *const _buf;
 
+    //  Part of the buffer referenced by the batch being built by
+    //  encode_iov.
+    size_t _buf_used;
+
     msg_t *_in_progress;
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (encoder_base_t)
@@ -154,8 +154,10 @@ void zmq::epoll_t::loop ()
         }
 
         //  Wait for events.
+        const int wait_timeout = begin_wait (timeout);
         const int n = epoll_wait (_epoll_fd, &ev_buf[0], max_io_events,
-                                  timeout ? timeout : -1);
+                                  wait_timeout ? wait_timeout : -1);
+        end_wait ();
         if (n == -1) {
             errno_assert (errno == EINTR);
             continue;
@@ -4,7 +4,8 @@
 #define __ZMQ_GENERIC_MTRIE_HPP_INCLUDED__
 
 #include <stddef.h>
-#include <set>
+#include <map>
+#include <vector>
 
 #include "macros.hpp"
 #include "stdint.hpp"
@@ -13,6 +14,9 @@
 namespace zmq
 {
 //  Multi-trie (prefix tree). Each node in the trie is a set of pointers.
+//  The pointers are given dense ids by the root, so that the nodes keep
+//  them as sorted arrays of small integers and a match can merge the
+//  arrays of all the matching nodes in a bitmap.
 template <typename T> class generic_mtrie_t
 {
   public:
@@ -49,8 +53,9 @@ template <typename T> class generic_mtrie_t
     rm_result rm (prefix_t prefix_, size_t size_, value_t *value_);
 
     //  Calls a callback function for all matching entries, i.e. any node
-    //  corresponding to data_ or a prefix of it. The arg_ argument
-    //  is passed through to the callback function.
+    //  corresponding to data_ or a prefix of it. The callback is called
+    //  once per value, even if the value is in several matching nodes.
+    //  The arg_ argument is passed through to the callback function.
     template <typename Arg>
     void match (prefix_t data_,
                 size_t size_,
@@ -64,9 +69,41 @@ template <typename T> class generic_mtrie_t
   private:
     bool is_redundant () const;
 
-    typedef std::set<value_t *> pipes_t;
+    //  Returns the id of the value, giving it a new one if it has none.
+    uint32_t acquire_id (value_t *value_);
+
+    //  Looks up the id of the value. Returns false if it has none.
+    bool find_id (value_t *value_, uint32_t &id_) const;
+
+    //  Adds or removes the id in the node's set, maintaining the count of
+    //  nodes holding it. Return false if nothing was changed.
+    bool insert_id (generic_mtrie_t *node_, uint32_t id_);
+    bool erase_id (generic_mtrie_t *node_, uint32_t id_);
+
+    //  Sets the bits of the node's ids in the match bitmap and extends
+    //  the range of bitmap words in use.
+    void merge_ids (const generic_mtrie_t *node_,
+                    size_t &first_word_,
+                    size_t &last_word_);
+
+    //  The ids of the values attached to this node, in ascending order.
+    typedef std::vector<uint32_t> pipes_t;
     pipes_t *_pipes;
 
+    //  Id assignment, only allocated in the root of the trie.
+    struct ids_t
+    {
+        std::map<value_t *, uint32_t> by_value;
+        std::vector<value_t *> values;
+        //  Number of nodes holding each id. The id is reused once no node
+        //  holds it anymore.
+        std::vector<uint32_t> refs;
+        std::vector<uint32_t> free_ids;
+        //  Scratch bitmap of the ids matched, left zeroed after a match.
+        std::vector<uint64_t> matches;
+    };
+    ids_t *_ids;
+
     atomic_counter_t _num_prefixes;
 
     unsigned char _min;
@@ -18,13 +18,19 @@ namespace zmq
 {
 template <typename T>
 generic_mtrie_t<T>::generic_mtrie_t () :
-    _pipes (0), _num_prefixes (0), _min (0), _count (0), _live_nodes (0)
+    _pipes (0),
+    _ids (0),
+    _num_prefixes (0),
+    _min (0),
+    _count (0),
+    _live_nodes (0)
 {
 }
 
 template <typename T> generic_mtrie_t<T>::~generic_mtrie_t ()
 {
     LIBZMQ_DELETE (_pipes);
+    LIBZMQ_DELETE (_ids);
 
     if (_count == 1) {
         zmq_assert (_next.node);
@@ -120,7 +126,7 @@ bool generic_mtrie_t<T>::add (prefix_t prefix_, size_t size_, value_t *pipe_)
 
         _num_prefixes.add (1);
     }
-    it->_pipes->insert (pipe_);
+    insert_id (it, acquire_id (pipe_));
 
     return result;
 }
@@ -144,6 +150,10 @@ void generic_mtrie_t<T>::rm (value_t *pipe_,
     //  determine if the pre- or post- children visit actions have to be taken.
     //  In the case of a node with (N > 1) children, the node has to be re-visited
     //  N times, in the correct order after each child visit.
+    uint32_t id;
+    if (!find_id (pipe_, id))
+        return;
+
     std::list<struct iter> stack;
     unsigned char *buff = NULL;
     size_t maxbuffsize = 0;
@@ -156,7 +166,7 @@ void generic_mtrie_t<T>::rm (value_t *pipe_,
 
         if (!it.processed_for_removal) {
             //  Remove the subscription from this node.
-            if (it.node->_pipes && it.node->_pipes->erase (pipe_)) {
+            if (it.node->_pipes && erase_id (it.node, id)) {
                 if (!call_on_uniq_ || it.node->_pipes->empty ()) {
                     func_ (buff, it.size, arg_);
                 }
@@ -385,6 +395,8 @@ generic_mtrie_t<T>::rm (prefix_t prefix_, size_t size_, value_t *pipe_)
     //  A boolean is used to record whether the node had already been visited and to
     //  determine if the pre- or post- children visit actions have to be taken.
     rm_result ret = not_found;
+    uint32_t id;
+    const bool known = find_id (pipe_, id);
     std::list<struct iter> stack;
     struct iter it = {this, NULL, prefix_, size_, 0, 0, 0, false};
     stack.push_back (it);
@@ -400,16 +412,15 @@ generic_mtrie_t<T>::rm (prefix_t prefix_, size_t size_, value_t *pipe_)
                     continue;
                 }
 
-                typename pipes_t::size_type erased =
-                  it.node->_pipes->erase (pipe_);
+                const bool erased = known && erase_id (it.node, id);
                 if (it.node->_pipes->empty ()) {
-                    zmq_assert (erased == 1);
+                    zmq_assert (erased);
                     LIBZMQ_DELETE (it.node->_pipes);
                     ret = last_value_removed;
                     continue;
                 }
 
-                ret = (erased == 1) ? values_remain : not_found;
+                ret = erased ? values_remain : not_found;
                 continue;
             }
 
@@ -525,13 +536,27 @@ void generic_mtrie_t<T>::match (prefix_t data_,
                                 void (*func_) (value_t *pipe_, Arg arg_),
                                 Arg arg_)
 {
+    //  The ids of a single matching node are signalled as they are. Once a
+    //  second node matches, the ids are merged in the bitmap instead, so
+    //  that each pipe is signalled once and in one pass over the bitmap.
+    const generic_mtrie_t *single = NULL;
+    bool merged = false;
+    size_t first_word = 0;
+    size_t last_word = 0;
+
     for (generic_mtrie_t *current = this; current; data_++, size_--) {
-        //  Signal the pipes attached to this node.
+        //  Collect the pipes attached to this node.
         if (current->_pipes) {
-            for (typename pipes_t::iterator it = current->_pipes->begin (),
-                                            end = current->_pipes->end ();
-                 it != end; ++it) {
-                func_ (*it, arg_);
+            if (!single && !merged)
+                single = current;
+            else {
+                if (single) {
+                    first_word = _ids->matches.size ();
+                    merge_ids (single, first_word, last_word);
+                    single = NULL;
+                }
+                merge_ids (current, first_word, last_word);
+                merged = true;
             }
         }
 
@@ -558,6 +583,128 @@ void generic_mtrie_t<T>::match (prefix_t data_,
             current = current->_next.table[data_[0] - current->_min];
         }
     }
+
+    if (single) {
+        for (typename pipes_t::const_iterator it = single->_pipes->begin (),
+                                              end = single->_pipes->end ();
+             it != end; ++it)
+            func_ (_ids->values[*it], arg_);
+        return;
+    }
+    if (!merged)
+        return;
+
+    uint64_t *const matches = &_ids->matches[0];
+    for (size_t word = first_word; word <= last_word; word++) {
+        uint64_t bits = matches[word];
+        matches[word] = 0;
+        while (bits) {
+#if defined __GNUC__
+            const unsigned int bit = __builtin_ctzll (bits);
+#else
+            unsigned int bit = 0;
+            while ((bits & (uint64_t (1) << bit)) == 0)
+                bit++;
+#endif
+            bits &= bits - 1;
+            func_ (_ids->values[word * 64 + bit], arg_);
+        }
+    }
+}
+
+template <typename T>
+uint32_t generic_mtrie_t<T>::acquire_id (value_t *value_)
+{
+    if (!_ids) {
+        _ids = new (std::nothrow) ids_t;
+        alloc_assert (_ids);
+    }
+
+    const std::pair<typename std::map<value_t *, uint32_t>::iterator, bool>
+      res = _ids->by_value.insert (std::make_pair (value_, 0u));
+    if (!res.second)
+        return res.first->second;
+
+    uint32_t id;
+    if (!_ids->free_ids.empty ()) {
+        id = _ids->free_ids.back ();
+        _ids->free_ids.pop_back ();
+        _ids->values[id] = value_;
+    } else {
+        id = static_cast<uint32_t> (_ids->values.size ());
+        _ids->values.push_back (value_);
+        _ids->refs.push_back (0);
+        _ids->matches.resize ((_ids->values.size () + 63) / 64, 0);
+    }
+    res.first->second = id;
+    return id;
+}
+
+template <typename T>
+bool generic_mtrie_t<T>::find_id (value_t *value_, uint32_t &id_) const
+{
+    if (!_ids)
+        return false;
+    const typename std::map<value_t *, uint32_t>::const_iterator it =
+      _ids->by_value.find (value_);
+    if (it == _ids->by_value.end ())
+        return false;
+    id_ = it->second;
+    return true;
+}
+
+template <typename T>
+bool generic_mtrie_t<T>::insert_id (generic_mtrie_t *node_, uint32_t id_)
+{
+    //  Ids are mostly handed out in ascending order, so appending is the
+    //  common case.
+    pipes_t &ids = *node_->_pipes;
+    if (ids.empty () || ids.back () < id_)
+        ids.push_back (id_);
+    else {
+        const typename pipes_t::iterator it =
+          std::lower_bound (ids.begin (), ids.end (), id_);
+        if (*it == id_)
+            return false;
+        ids.insert (it, id_);
+    }
+    ++_ids->refs[id_];
+    return true;
+}
+
+template <typename T>
+bool generic_mtrie_t<T>::erase_id (generic_mtrie_t *node_, uint32_t id_)
+{
+    pipes_t &ids = *node_->_pipes;
+    const typename pipes_t::iterator it =
+      std::lower_bound (ids.begin (), ids.end (), id_);
+    if (it == ids.end () || *it != id_)
+        return false;
+    ids.erase (it);
+
+    //  Release the id once the value is gone from the whole trie.
+    if (--_ids->refs[id_] == 0) {
+        _ids->by_value.erase (_ids->values[id_]);
+        _ids->values[id_] = NULL;
+        _ids->free_ids.push_back (id_);
+    }
+    return true;
+}
+
+template <typename T>
+void generic_mtrie_t<T>::merge_ids (const generic_mtrie_t *node_,
+                                    size_t &first_word_,
+                                    size_t &last_word_)
+{
+    const pipes_t &ids = *node_->_pipes;
+    uint64_t *const matches = &_ids->matches[0];
+    for (typename pipes_t::const_iterator it = ids.begin (), end = ids.end ();
+         it != end; ++it)
+        matches[*it / 64] |= uint64_t (1) << (*it % 64);
+
+    //  The ids are sorted, so the first and last bound the words touched.
+    first_word_ = std::min (first_word_, static_cast<size_t> (ids.front () / 64));
+    last_word_ = std::max (last_word_, static_cast<size_t> (ids.back () / 64));
 }
 
 template <typename T> bool generic_mtrie_t<T>::is_redundant () const
@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_GROUP_TABLE_HPP_INCLUDED__
+#define __ZMQ_GROUP_TABLE_HPP_INCLUDED__
+
+#include <string.h>
+#include <utility>
+
+#include "err.hpp"
+#include "hash_table.hpp"
+#include "macros.hpp"
+#include "random.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+//  Groups of RADIO and DISH sockets, each with a value of type T, in a
+//  hash_table_t. The groups are stored in the slots themselves, so that
+//  adding one does not allocate. Groups are looked up by their
+//  NUL-terminated bytes, as msg_t::group () returns them, and must not be
+//  longer than ZMQ_GROUP_MAX_LENGTH. The hash is seeded per table, as
+//  groups may come from the network.
+
+template <typename T> class group_table_t
+{
+  private:
+    struct slot_t
+    {
+        slot_t () : hash (slots_t::empty_hash), length (0), value ()
+        {
+            group[0] = '\0';
+        }
+
+        uint32_t hash;
+        unsigned char length;
+        char group[ZMQ_GROUP_MAX_LENGTH + 1];
+        T value;
+    };
+
+    typedef hash_table_t<slot_t> slots_t;
+
+  public:
+    //  Walks through all groups, in no particular order. Adding or removing
+    //  groups invalidates iterators.
+    class iterator
+    {
+      public:
+        const char *group () const { return (*_slots)[_index].group; }
+        T &value () const { return (*_slots)[_index].value; }
+
+        iterator &operator++ ()
+        {
+            ++_index;
+            skip_empty ();
+            return *this;
+        }
+
+        bool operator!= (const iterator &other_) const
+        {
+            return _index != other_._index;
+        }
+
+      private:
+        friend class group_table_t;
+
+        iterator (slots_t *slots_, size_t index_) :
+            _slots (slots_), _index (index_)
+        {
+            skip_empty ();
+        }
+
+        void skip_empty ()
+        {
+            while (_index != _slots->capacity ()
+                   && (*_slots)[_index].hash == slots_t::empty_hash)
+                ++_index;
+        }
+
+        slots_t *_slots;
+        size_t _index;
+    };
+
+    group_table_t () : _seed (generate_random ()) {}
+
+    bool empty () const { return _slots.empty (); }
+
+    size_t size () const { return _slots.size (); }
+
+    iterator begin () { return iterator (&_slots, 0); }
+
+    iterator end () { return iterator (&_slots, _slots.capacity ()); }
+
+    //  Returns the value of the group, or NULL if there is none.
+    T *find (const char *group_)
+    {
+        const size_t length = strlen (group_);
+        const size_t index =
+          _slots.find (hash_group (group_, length), matches_t (group_, length));
+        return index == slots_t::npos ? NULL : &_slots[index].value;
+    }
+
+    //  Adds the group with a default value, unless it is there already.
+    //  Returns its value, and whether the group was added.
+    std::pair<T *, bool> insert (const char *group_)
+    {
+        const size_t length = strlen (group_);
+        zmq_assert (length <= ZMQ_GROUP_MAX_LENGTH);
+        const uint32_t hash = hash_group (group_, length);
+        const size_t index = _slots.find (hash, matches_t (group_, length));
+        if (index != slots_t::npos)
+            return std::make_pair (&_slots[index].value, false);
+
+        slot_t &slot = _slots.insert (hash);
+        slot.length = static_cast<unsigned char> (length);
+        memcpy (slot.group, group_, length + 1);
+        return std::make_pair (&slot.value, true);
+    }
+
+    //  Removes the group. Returns false if there was none.
+    bool erase (const char *group_)
+    {
+        const size_t length = strlen (group_);
+        const size_t index =
+          _slots.find (hash_group (group_, length), matches_t (group_, length));
+        if (index == slots_t::npos)
+            return false;
+        _slots.erase (index);
+        return true;
+    }
+
+  private:
+    struct matches_t
+    {
+        matches_t (const char *group_, size_t length_) :
+            group (group_), length (length_)
+        {
+        }
+
+        bool operator() (const slot_t &slot_) const
+        {
+            return slot_.length == length
+                   && memcmp (slot_.group, group, length) == 0;
+        }
+
+        const char *group;
+        size_t length;
+    };
+
+    uint32_t hash_group (const char *group_, size_t length_) const
+    {
+        return slots_t::slot_hash (hash_bytes (group_, length_, _seed));
+    }
+
+    slots_t _slots;
+
+    const uint32_t _seed;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (group_table_t)
+};
+}
+
+#endif
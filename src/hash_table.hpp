@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_HASH_TABLE_HPP_INCLUDED__
+#define __ZMQ_HASH_TABLE_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+#include "macros.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+//  FNV-1a, then the finalizer of MurmurHash3 to spread the bits used as
+//  the index. The seed keeps peers from easily picking keys that all fall
+//  into the same slots.
+inline uint32_t hash_bytes (const void *data_, size_t size_, uint32_t seed_)
+{
+    const unsigned char *const data =
+      static_cast<const unsigned char *> (data_);
+    uint32_t hash = 2166136261u ^ seed_;
+    for (size_t i = 0; i != size_; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+//  Slots of a hash table with open addressing and linear probing. Slot
+//  holds an entry along with the hash of its key, in a member named hash,
+//  which is empty_hash in empty slots and only there; a default-constructed
+//  Slot is empty. Keys are compared by the owner of the table, only
+//  when the hashes are equal, so a lookup usually touches one cache line.
+//  Removal moves the following entries back rather than leaving
+//  tombstones, so that lookups of absent keys stay short as well. Entries
+//  move when others are added or removed, so pointers to them are only
+//  valid until then.
+
+template <typename Slot> class hash_table_t
+{
+  public:
+    static const uint32_t empty_hash = 0;
+    static const size_t npos = static_cast<size_t> (-1);
+
+    hash_table_t () : _slots (min_capacity), _size (0) {}
+
+    bool empty () const { return _size == 0; }
+
+    size_t size () const { return _size; }
+
+    //  Number of slots, used and empty.
+    size_t capacity () const { return _slots.size (); }
+
+    Slot &operator[] (size_t index_) { return _slots[index_]; }
+
+    const Slot &operator[] (size_t index_) const { return _slots[index_]; }
+
+    //  Hash to store for a key whose hash is hash_, never empty_hash.
+    static uint32_t slot_hash (uint32_t hash_)
+    {
+        return hash_ != empty_hash ? hash_ : 1;
+    }
+
+    //  Returns the index of the slot with the hash for which matches_
+    //  returns true, or npos if there is none.
+    template <typename Matches>
+    size_t find (uint32_t hash_, const Matches &matches_) const
+    {
+        const size_t mask = _slots.size () - 1;
+        for (size_t index = hash_ & mask; _slots[index].hash != empty_hash;
+             index = (index + 1) & mask)
+            if (_slots[index].hash == hash_ && matches_ (_slots[index]))
+                return index;
+        return npos;
+    }
+
+    //  Takes an empty slot for an entry of the hash and returns it, with
+    //  the hash set. The caller fills in the entry.
+    Slot &insert (uint32_t hash_)
+    {
+        if (2 * (_size + 1) > _slots.size ())
+            resize (2 * _slots.size ());
+        Slot &slot = _slots[place (hash_)];
+        slot.hash = hash_;
+        _size++;
+        return slot;
+    }
+
+    //  Empties the slot at the index.
+    void erase (size_t index_)
+    {
+        //  Move back each following entry that may take the freed slot
+        //  without being moved before its home slot, up to the next gap.
+        const size_t mask = _slots.size () - 1;
+        size_t gap = index_;
+        for (size_t index = (gap + 1) & mask; _slots[index].hash != empty_hash;
+             index = (index + 1) & mask) {
+            const size_t home = _slots[index].hash & mask;
+            const bool stays = gap <= index ? gap < home && home <= index
+                                            : gap < home || home <= index;
+            if (!stays) {
+                std::swap (_slots[gap], _slots[index]);
+                gap = index;
+            }
+        }
+        _slots[gap] = Slot ();
+        _size--;
+
+        if (_slots.size () > min_capacity && 8 * _size < _slots.size ())
+            resize (_slots.size () / 2);
+    }
+
+  private:
+    enum
+    {
+        min_capacity = 16
+    };
+
+    //  Returns the first empty slot from the home slot of the hash on.
+    size_t place (uint32_t hash_) const
+    {
+        const size_t mask = _slots.size () - 1;
+        size_t index = hash_ & mask;
+        while (_slots[index].hash != empty_hash)
+            index = (index + 1) & mask;
+        return index;
+    }
+
+    void resize (size_t capacity_)
+    {
+        std::vector<Slot> slots (capacity_);
+        slots.swap (_slots);
+        for (size_t i = 0, capacity = slots.size (); i != capacity; i++)
+            if (slots[i].hash != empty_hash)
+                std::swap (_slots[place (slots[i].hash)], slots[i]);
+    }
+
+    //  The number of slots is a power of two, at least twice the number of
+    //  entries.
+    std::vector<Slot> _slots;
+    size_t _size;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (hash_table_t)
+};
+}
+
+#endif
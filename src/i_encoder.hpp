@@ -10,6 +10,9 @@ namespace zmq
 {
 //  Forward declaration
 class msg_t;
+#if defined ZMQ_HAVE_UIO
+class iov_batch_t;
+#endif
 
 //  Interface to be implemented by message encoder.
 
@@ -23,6 +26,16 @@ struct i_encoder
     //  Function returns 0 when a new message is required.
     virtual size_t encode (unsigned char **data_, size_t size_) = 0;
 
+#if defined ZMQ_HAVE_UIO
+    //  Gather variant of encode. Appends the encoded data to batch_.
+    //  Message bodies of at least ref_size_ bytes are referenced in place
+    //  and their messages pinned to the batch, everything else is copied
+    //  to the encoder's own buffer, which is reused once the batch has
+    //  been written. Returns the number of bytes appended, 0 when a new
+    //  message is required or the batch is full.
+    virtual size_t encode_iov (iov_batch_t &batch_, size_t ref_size_) = 0;
+#endif
+
     //  Load a new message into encoder.
     virtual void load_msg (msg_t *msg_) = 0;
 };
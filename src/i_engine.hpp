@@ -9,6 +9,7 @@
 namespace zmq
 {
 class io_thread_t;
+class crypto_job_t;
 
 //  Abstract interface to be implemented by various engines.
 
@@ -48,7 +49,20 @@ struct i_engine
 
     virtual void zap_msg_available () = 0;
 
+    //  This method is called by the session to hand back a job the
+    //  engine's mechanism submitted to the crypto pool, once it is done.
+    virtual void crypto_done (crypto_job_t *job_) = 0;
+
     virtual const endpoint_uri_pair_t &get_endpoint () const = 0;
+
+    //  Returns true if the engine can be moved to another I/O thread.
+    virtual bool can_migrate () const = 0;
+
+    //  Moving the engine to another I/O thread: migrate_out detaches it
+    //  from the current one and migrate_in attaches it to the new one,
+    //  in the new I/O thread. Only called if can_migrate returned true.
+    virtual void migrate_out () = 0;
+    virtual void migrate_in (zmq::io_thread_t *io_thread_) = 0;
 };
 }
 
@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_I_MSG_ALLOCATOR_HPP_INCLUDED__
+#define __ZMQ_I_MSG_ALLOCATOR_HPP_INCLUDED__
+
+#include <stddef.h>
+
+#include "macros.hpp"
+
+namespace zmq
+{
+//  Interface to be implemented by allocators of message bodies and
+//  decoder buffers. Memory may be released from a different thread than
+//  the one which allocated it, so implementations must be thread-safe.
+
+class i_msg_allocator
+{
+  public:
+    virtual ~i_msg_allocator () ZMQ_DEFAULT;
+
+    //  Returns a block of at least size_ bytes aligned for any fundamental
+    //  type, or NULL if the memory is exhausted.
+    virtual void *allocate (size_t size_) = 0;
+
+    //  Releases a block previously returned by allocate.
+    virtual void deallocate (void *ptr_) = 0;
+};
+}
+
+#endif
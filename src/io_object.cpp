@@ -73,6 +73,11 @@ void zmq::io_object_t::cancel_timer (int id_)
     _poller->cancel_timer (this, id_);
 }
 
+int zmq::io_object_t::timer_left (int id_)
+{
+    return _poller->timer_left (this, id_);
+}
+
 void zmq::io_object_t::in_event ()
 {
     zmq_assert (false);
@@ -40,6 +40,7 @@ class io_object_t : public i_poll_events
     void reset_pollout (handle_t handle_);
     void add_timer (int timeout_, int id_);
     void cancel_timer (int id_);
+    int timer_left (int id_);
 
     //  i_poll_events interface implementation.
     void in_event () ZMQ_OVERRIDE;
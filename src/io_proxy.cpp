@@ -0,0 +1,277 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include <string.h>
+
+#include "io_proxy.hpp"
+#include "socket_base.hpp"
+#include "mailbox.hpp"
+#include "config.hpp"
+#include "likely.hpp"
+#include "err.hpp"
+
+zmq::io_proxy_t::io_proxy_t (io_thread_t *io_thread_,
+                             socket_base_t *frontend_,
+                             socket_base_t *backend_,
+                             socket_base_t *capture_,
+                             socket_base_t *control_) :
+    own_t (io_thread_, options_t ()),
+    io_object_t (io_thread_),
+    _state (active),
+    _direction_count (frontend_ == backend_ ? 1 : 2),
+    _capture (capture_),
+    _control (control_),
+    _control_replies (false),
+    _socket_count (0),
+    _signaler_handle (static_cast<handle_t> (NULL)),
+    _resuming (false)
+{
+    memset (_stats, 0, sizeof _stats);
+
+    for (int i = 0; i != 2; i++) {
+        direction_t &direction = _directions[i];
+        direction.from = i == 0 ? frontend_ : backend_;
+        direction.to = i == 0 ? backend_ : frontend_;
+        direction.from_stats = &_stats[i];
+        direction.to_stats = &_stats[1 - i];
+        direction.enabled = true;
+        direction.pending = false;
+        const int rc = direction.msg.init ();
+        errno_assert (rc == 0);
+    }
+
+    add_socket (frontend_);
+    add_socket (backend_);
+    add_socket (capture_);
+    add_socket (control_);
+
+    if (_control) {
+        int type;
+        size_t type_size = sizeof type;
+        _control_replies =
+          _control->getsockopt (ZMQ_TYPE, &type, &type_size) == 0
+          && type == ZMQ_REP;
+    }
+}
+
+zmq::io_proxy_t::~io_proxy_t ()
+{
+    for (int i = 0; i != 2; i++) {
+        const int rc = _directions[i].msg.close ();
+        errno_assert (rc == 0);
+    }
+}
+
+void zmq::io_proxy_t::add_socket (socket_base_t *socket_)
+{
+    if (!socket_)
+        return;
+    for (int i = 0; i != _socket_count; i++)
+        if (_sockets[i] == socket_)
+            return;
+    _sockets[_socket_count] = socket_;
+    _handles[_socket_count] = static_cast<handle_t> (NULL);
+    _socket_count++;
+}
+
+void zmq::io_proxy_t::process_plug ()
+{
+    for (int i = 0; i != _socket_count; i++) {
+        const mailbox_t *mailbox =
+          static_cast<mailbox_t *> (_sockets[i]->get_mailbox ());
+        _handles[i] = add_fd (mailbox->get_fd ());
+        set_pollin (_handles[i]);
+    }
+    _signaler_handle = add_fd (_signaler.get_fd ());
+    set_pollin (_signaler_handle);
+
+    //  Messages may have been queued before the sockets were handed over.
+    in_event ();
+}
+
+void zmq::io_proxy_t::in_event ()
+{
+    if (_resuming) {
+        _signaler.recv ();
+        _resuming = false;
+    }
+
+    if (!process ())
+        stop ();
+}
+
+bool zmq::io_proxy_t::process ()
+{
+    for (int i = 0; i != _socket_count; i++) {
+        int events;
+        size_t events_size = sizeof events;
+        if (_sockets[i]->getsockopt (ZMQ_EVENTS, &events, &events_size) != 0)
+            return false;
+    }
+
+    if (_control && handle_control () != 0)
+        return false;
+    if (_state == terminated)
+        return false;
+    if (_state == paused)
+        return true;
+
+    bool burst_used_up = false;
+    for (int i = 0; i != _direction_count; i++) {
+        if (!_directions[i].enabled)
+            continue;
+        const int rc = forward (_directions[i]);
+        if (rc < 0)
+            return false;
+        burst_used_up = burst_used_up || rc > 0;
+    }
+
+    if (burst_used_up) {
+        _signaler.send ();
+        _resuming = true;
+    }
+    return true;
+}
+
+int zmq::io_proxy_t::forward (direction_t &direction_)
+{
+    msg_t &msg = direction_.msg;
+
+    for (unsigned int i = 0; i != proxy_burst_size; i++) {
+        if (!direction_.pending) {
+            if (direction_.from->recv (&msg, ZMQ_DONTWAIT) != 0) {
+                if (errno == EAGAIN)
+                    return 0;
+
+                //  Sockets that cannot receive, such as a PUSH backend,
+                //  leave nothing to forward in their direction.
+                if (errno == ENOTSUP) {
+                    direction_.enabled = false;
+                    return 0;
+                }
+                return -1;
+            }
+            direction_.from_stats->msgs_in++;
+            direction_.from_stats->bytes_in += msg.size ();
+
+            if (unlikely (_capture != NULL) && capture (msg) != 0)
+                return -1;
+        }
+
+        const size_t size = msg.size ();
+        const int flags =
+          (msg.flags () & msg_t::more) ? ZMQ_SNDMORE | ZMQ_DONTWAIT
+                                       : ZMQ_DONTWAIT;
+        if (direction_.to->send (&msg, flags) != 0) {
+            //  Keep the part until the destination has room for it. Its
+            //  mailbox signals once it has.
+            direction_.pending = errno == EAGAIN;
+            return direction_.pending ? 0 : -1;
+        }
+        direction_.pending = false;
+        direction_.to_stats->msgs_out++;
+        direction_.to_stats->bytes_out += size;
+    }
+
+    return 1;
+}
+
+int zmq::io_proxy_t::capture (msg_t &msg_)
+{
+    msg_t copy;
+    int rc = copy.init ();
+    errno_assert (rc == 0);
+    rc = copy.copy (msg_);
+    errno_assert (rc == 0);
+
+    const int flags = (msg_.flags () & msg_t::more)
+                        ? ZMQ_SNDMORE | ZMQ_DONTWAIT
+                        : ZMQ_DONTWAIT;
+    rc = _capture->send (&copy, flags);
+    if (rc != 0) {
+        const int err = errno;
+        rc = copy.close ();
+        errno_assert (rc == 0);
+        if (err != EAGAIN) {
+            errno = err;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int zmq::io_proxy_t::handle_control ()
+{
+    msg_t msg;
+    int rc = msg.init ();
+    errno_assert (rc == 0);
+
+    while (_control->recv (&msg, ZMQ_DONTWAIT) == 0) {
+        const char *command = static_cast<const char *> (msg.data ());
+        const size_t size = msg.size ();
+
+        if (size == 10 && memcmp (command, "STATISTICS", 10) == 0) {
+            rc = reply_statistics ();
+        } else {
+            if (size == 5 && memcmp (command, "PAUSE", 5) == 0)
+                _state = paused;
+            else if (size == 6 && memcmp (command, "RESUME", 6) == 0)
+                _state = active;
+            else if (size == 9 && memcmp (command, "TERMINATE", 9) == 0)
+                _state = terminated;
+
+            if (_control_replies) {
+                rc = msg.close ();
+                errno_assert (rc == 0);
+                rc = msg.init ();
+                errno_assert (rc == 0);
+                rc = _control->send (&msg, ZMQ_DONTWAIT);
+            }
+        }
+        if (rc != 0)
+            return close_and_return (&msg, -1);
+    }
+
+    if (errno != EAGAIN)
+        return close_and_return (&msg, -1);
+    return close_and_return (&msg, 0);
+}
+
+int zmq::io_proxy_t::reply_statistics ()
+{
+    const uint64_t values[] = {
+      _stats[0].msgs_in, _stats[0].bytes_in, _stats[0].msgs_out,
+      _stats[0].bytes_out, _stats[1].msgs_in, _stats[1].bytes_in,
+      _stats[1].msgs_out, _stats[1].bytes_out};
+    const size_t count = sizeof values / sizeof values[0];
+
+    for (size_t i = 0; i != count; i++) {
+        msg_t msg;
+        int rc = msg.init_size (sizeof (uint64_t));
+        errno_assert (rc == 0);
+        memcpy (msg.data (), &values[i], sizeof (uint64_t));
+        rc = _control->send (
+          &msg, i + 1 < count ? ZMQ_SNDMORE | ZMQ_DONTWAIT : ZMQ_DONTWAIT);
+        if (rc != 0)
+            return close_and_return (&msg, -1);
+    }
+    return 0;
+}
+
+void zmq::io_proxy_t::stop ()
+{
+    for (int i = 0; i != _socket_count; i++) {
+        rm_fd (_handles[i]);
+        _handles[i] = static_cast<handle_t> (NULL);
+    }
+    rm_fd (_signaler_handle);
+    _signaler_handle = static_cast<handle_t> (NULL);
+
+    //  The sockets belong to the proxy, so closing them is up to it. Any
+    //  linger applies as usual, the reaper takes care of it. The frontend
+    //  terminates the proxy in turn.
+    for (int i = 0; i != _socket_count; i++) {
+        const int rc = _sockets[i]->close ();
+        errno_assert (rc == 0);
+    }
+}
@@ -0,0 +1,124 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_IO_PROXY_HPP_INCLUDED__
+#define __ZMQ_IO_PROXY_HPP_INCLUDED__
+
+#include "own.hpp"
+#include "io_object.hpp"
+#include "msg.hpp"
+#include "signaler.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+class io_thread_t;
+class socket_base_t;
+
+//  Proxy running in an I/O thread instead of an application thread. It
+//  takes the sockets over, polls their mailboxes and forwards messages
+//  between them without ever blocking. Once it stops, because the control
+//  socket said so, a socket failed or the context is being terminated, it
+//  closes all of the sockets. The proxy is a child of the frontend, which
+//  terminates it once closed.
+
+class io_proxy_t ZMQ_FINAL : public own_t, public io_object_t
+{
+  public:
+    io_proxy_t (zmq::io_thread_t *io_thread_,
+                zmq::socket_base_t *frontend_,
+                zmq::socket_base_t *backend_,
+                zmq::socket_base_t *capture_,
+                zmq::socket_base_t *control_);
+    ~io_proxy_t ();
+
+  private:
+    //  Message part counters of the frontend or the backend, as replied
+    //  to the STATISTICS command.
+    struct stats_t
+    {
+        uint64_t msgs_in;
+        uint64_t bytes_in;
+        uint64_t msgs_out;
+        uint64_t bytes_out;
+    };
+
+    //  Messages flow from the frontend to the backend and back again.
+    //  A message part that could not be sent stays in 'msg' until the
+    //  destination has room for it.
+    struct direction_t
+    {
+        zmq::socket_base_t *from;
+        zmq::socket_base_t *to;
+        stats_t *from_stats;
+        stats_t *to_stats;
+        msg_t msg;
+        bool enabled;
+        bool pending;
+    };
+
+    //  Handlers for incoming commands.
+    void process_plug ();
+
+    //  Handlers for I/O events.
+    void in_event ();
+
+    //  Processes the commands of the sockets, then the control messages,
+    //  then forwards. Returns false once the proxy has to terminate.
+    bool process ();
+
+    //  Forwards up to a burst of message parts in one direction. Returns
+    //  1 if the burst was used up, 0 if nothing is left to forward for
+    //  now and -1 if a socket failed.
+    int forward (direction_t &direction_);
+
+    //  Sends a copy of the message part to the capture socket, if any.
+    //  Parts the capture socket has no room for are dropped.
+    int capture (msg_t &msg_);
+
+    //  Handles the PAUSE, RESUME, TERMINATE and STATISTICS commands
+    //  queued on the control socket.
+    int handle_control ();
+    int reply_statistics ();
+
+    //  Stops polling and closes the sockets.
+    void stop ();
+
+    void add_socket (zmq::socket_base_t *socket_);
+
+    enum
+    {
+        active,
+        paused,
+        terminated
+    } _state;
+
+    direction_t _directions[2];
+    int _direction_count;
+
+    zmq::socket_base_t *_capture;
+    zmq::socket_base_t *_control;
+
+    //  Whether commands on the control socket are answered, as REP
+    //  sockets must.
+    bool _control_replies;
+
+    //  Frontend, backend, capture and control sockets, without duplicates,
+    //  and the handles of their mailboxes. All of them get commands, and
+    //  their mailboxes keep signalling until the commands are processed.
+    zmq::socket_base_t *_sockets[4];
+    handle_t _handles[4];
+    int _socket_count;
+
+    //  When a burst is used up, the proxy signals itself to forward the
+    //  rest once the other objects in the I/O thread had their turn.
+    signaler_t _signaler;
+    handle_t _signaler_handle;
+    bool _resuming;
+
+    stats_t _stats[2];
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (io_proxy_t)
+};
+}
+
+#endif
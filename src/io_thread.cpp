@@ -6,12 +6,17 @@
 
 #include "macros.hpp"
 #include "io_thread.hpp"
+#include "clock.hpp"
 #include "err.hpp"
 #include "ctx.hpp"
+#include "likely.hpp"
 
 zmq::io_thread_t::io_thread_t (ctx_t *ctx_, uint32_t tid_) :
     object_t (ctx_, tid_),
-    _mailbox_handle (static_cast<poller_t::handle_t> (NULL))
+    _mailbox_handle (static_cast<poller_t::handle_t> (NULL)),
+    _held_count (0),
+    _engine_calls (0),
+    _next_release (0)
 {
     _poller = new (std::nothrow) poller_t (*ctx_);
     alloc_assert (_poller);
@@ -29,11 +34,11 @@ zmq::io_thread_t::~io_thread_t ()
 
 void zmq::io_thread_t::start ()
 {
+    const int index = get_tid () - zmq::ctx_t::reaper_tid - 1;
     char name[16] = "";
-    snprintf (name, sizeof (name), "IO/%u",
-              get_tid () - zmq::ctx_t::reaper_tid - 1);
+    snprintf (name, sizeof (name), "IO/%d", index);
     //  Start the underlying I/O thread.
-    _poller->start (name);
+    _poller->start (name, index);
 }
 
 void zmq::io_thread_t::stop ()
@@ -51,6 +56,11 @@ int zmq::io_thread_t::get_load () const
     return _poller->get_load ();
 }
 
+int zmq::io_thread_t::get_busy () const
+{
+    return _poller->get_busy ();
+}
+
 void zmq::io_thread_t::in_event ()
 {
     //  TODO: Do we want to limit number of commands I/O thread can
@@ -60,14 +70,98 @@ void zmq::io_thread_t::in_event ()
     int rc = _mailbox.recv (&cmd, 0);
 
     while (rc == 0 || errno == EINTR) {
-        if (rc == 0)
-            cmd.destination->process_command (cmd);
+        if (rc == 0) {
+            if (unlikely (!_arriving.empty ()))
+                process_arriving (cmd);
+            else
+                cmd.destination->process_command (cmd);
+        }
         rc = _mailbox.recv (&cmd, 0);
     }
 
     errno_assert (rc != 0 && errno == EAGAIN);
 }
 
+void zmq::io_thread_t::process_arriving (const command_t &cmd_)
+{
+    if (cmd_.type != command_t::migrated) {
+        const arrival_t *const arrival = find_arrival (cmd_.destination);
+        if (!arrival)
+            cmd_.destination->process_command (cmd_);
+        else if (arrival->holding) {
+            _held.push ();
+            _held.back () = cmd_;
+            _held_count++;
+        } else
+            //  The session is still there, and the commands sent to it
+            //  there before are ahead of this one.
+            get_ctx ()->send_command (arrival->origin, cmd_);
+        return;
+    }
+
+    //  The session left its previous I/O thread, having processed all the
+    //  commands passed on, so only those held back are left.
+    for (arriving_t::iterator it = _arriving.begin (), end = _arriving.end ();
+         it != end; ++it)
+        if (it->session == cmd_.destination) {
+            _arriving.erase (it);
+            break;
+        }
+    if (!cmd_.args.migrated.cancelled)
+        cmd_.destination->process_command (cmd_);
+
+    //  Deliver the held commands, except those for other sessions still
+    //  on their way, which keep their order.
+    for (size_t count = _held_count; count; count--) {
+        const command_t held = _held.front ();
+        _held.pop ();
+        _held_count--;
+        if (find_arrival (held.destination)) {
+            _held.push ();
+            _held.back () = held;
+            _held_count++;
+        } else
+            held.destination->process_command (held);
+    }
+}
+
+zmq::io_thread_t::arrival_t *
+zmq::io_thread_t::find_arrival (const object_t *object_)
+{
+    for (arriving_t::iterator it = _arriving.begin (), end = _arriving.end ();
+         it != end; ++it)
+        if (it->session == object_ || it->pipe == object_)
+            return &*it;
+    return NULL;
+}
+
+void zmq::io_thread_t::process_migrate (object_t *session_, object_t *pipe_)
+{
+    const arrival_t arrival = {session_, pipe_, session_->get_tid (), false};
+    _arriving.push_back (arrival);
+    send_migrate_ack (session_, arrival.origin);
+}
+
+void zmq::io_thread_t::process_migrate_sync (object_t *session_,
+                                             uint32_t tid_)
+{
+    //  Whatever comes now is newer than what was passed on, and waits for
+    //  the session.
+    arrival_t *const arrival = find_arrival (session_);
+    zmq_assert (arrival && arrival->session == session_);
+    arrival->holding = true;
+    send_migrate_ack (session_, tid_);
+}
+
+bool zmq::io_thread_t::may_release_session ()
+{
+    const uint64_t now = clock_t::now_us ();
+    if (now < _next_release)
+        return false;
+    _next_release = now + 2 * poller_t::busy_window_us;
+    return true;
+}
+
 void zmq::io_thread_t::out_event ()
 {
     //  We are never polling for POLLOUT here. This function is never called.
@@ -3,11 +3,16 @@
 #ifndef __ZMQ_IO_THREAD_HPP_INCLUDED__
 #define __ZMQ_IO_THREAD_HPP_INCLUDED__
 
+#include <vector>
+
 #include "stdint.hpp"
 #include "object.hpp"
 #include "poller.hpp"
 #include "i_poll_events.hpp"
 #include "mailbox.hpp"
+#include "command.hpp"
+#include "config.hpp"
+#include "yqueue.hpp"
 
 namespace zmq
 {
@@ -44,11 +49,49 @@ class io_thread_t ZMQ_FINAL : public object_t, public i_poll_events
 
     //  Command handlers.
     void process_stop ();
+    void process_migrate (zmq::object_t *session_, zmq::object_t *pipe_);
+    void process_migrate_sync (zmq::object_t *session_, uint32_t tid_);
 
     //  Returns load experienced by the I/O thread.
     int get_load () const;
 
+    //  Returns the share of the recent time the I/O thread was busy, in
+    //  thousandths.
+    int get_busy () const;
+
+    //  Counts the reads and writes of the engines in the I/O thread.
+    //  Sessions compare their engine's count to it to estimate their share
+    //  of the load. May only be called from the I/O thread.
+    void count_engine_call () { _engine_calls++; }
+    uint64_t get_engine_calls () const { return _engine_calls; }
+
+    //  Returns true if a session may move away to another I/O thread now.
+    //  Only one may do so per measurement period, as the busy figures
+    //  reflect the move only after that. May only be called from the I/O
+    //  thread.
+    bool may_release_session ();
+
   private:
+    //  Sessions moving here, with their pipes and the I/O thread they
+    //  come from.
+    struct arrival_t
+    {
+        object_t *session;
+        object_t *pipe;
+        uint32_t origin;
+        bool holding;
+    };
+    typedef std::vector<arrival_t> arriving_t;
+
+    //  Processes a command while sessions are moving here. The commands to
+    //  them and their pipes are passed on to the I/O thread they come
+    //  from, and then held back until they arrive.
+    void process_arriving (const command_t &cmd_);
+
+    //  Returns the session moving here that the object is, or whose pipe
+    //  it is, if any.
+    arrival_t *find_arrival (const object_t *object_);
+
     //  I/O thread accesses incoming commands via this mailbox.
     mailbox_t _mailbox;
 
@@ -58,6 +101,18 @@ class io_thread_t ZMQ_FINAL : public object_t, public i_poll_events
     //  I/O multiplexing is performed using a poller object.
     poller_t *_poller;
 
+    arriving_t _arriving;
+
+    //  Commands held back for the sessions moving here, in the order they
+    //  came in.
+    yqueue_t<command_t, command_pipe_granularity> _held;
+    size_t _held_count;
+
+    uint64_t _engine_calls;
+
+    //  Time from which a session may move away again, in microseconds.
+    uint64_t _next_release;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (io_thread_t)
 };
 }
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#if defined ZMQ_HAVE_UIO
+#include "iov_batch.hpp"
+#include "err.hpp"
+
+zmq::iov_batch_t::iov_batch_t () : _pos (0), _count (0), _size (0), _pinned (0)
+{
+    for (int i = 0; i != max_pinned; i++) {
+        const int rc = _pinned_msgs[i].init ();
+        errno_assert (rc == 0);
+    }
+}
+
+zmq::iov_batch_t::~iov_batch_t ()
+{
+    for (int i = 0; i != max_pinned; i++) {
+        const int rc = _pinned_msgs[i].close ();
+        errno_assert (rc == 0);
+    }
+}
+
+void zmq::iov_batch_t::append (const void *data_, size_t size_)
+{
+    zmq_assert (_count < max_chunks);
+
+    unsigned char *const data =
+      static_cast<unsigned char *> (const_cast<void *> (data_));
+    if (_count > _pos && !_chunk_msgs[_count - 1]) {
+        iovec &last = _chunks[_count - 1];
+        if (static_cast<unsigned char *> (last.iov_base) + last.iov_len
+            == data) {
+            last.iov_len += size_;
+            _size += size_;
+            return;
+        }
+    }
+    _chunks[_count].iov_base = data;
+    _chunks[_count].iov_len = size_;
+    _chunk_msgs[_count] = NULL;
+    _count++;
+    _size += size_;
+}
+
+void zmq::iov_batch_t::reference (msg_t *msg_)
+{
+    zmq_assert (_count < max_chunks);
+    zmq_assert (_pinned < max_pinned);
+
+    msg_t &pinned = _pinned_msgs[_pinned++];
+    const int rc = pinned.move (*msg_);
+    errno_assert (rc == 0);
+
+    _chunks[_count].iov_base = pinned.data ();
+    _chunks[_count].iov_len = pinned.size ();
+    _chunk_msgs[_count] = &pinned;
+    _count++;
+    _size += pinned.size ();
+}
+
+void zmq::iov_batch_t::consume (size_t size_)
+{
+    zmq_assert (size_ <= _size);
+    _size -= size_;
+    while (size_) {
+        iovec &chunk = _chunks[_pos];
+        if (size_ < chunk.iov_len) {
+            chunk.iov_base = static_cast<unsigned char *> (chunk.iov_base) + size_;
+            chunk.iov_len -= size_;
+            return;
+        }
+        size_ -= chunk.iov_len;
+        _pos++;
+    }
+    if (_pos == _count)
+        clear ();
+}
+
+void zmq::iov_batch_t::clear ()
+{
+    for (int i = 0; i != _pinned; i++) {
+        int rc = _pinned_msgs[i].close ();
+        errno_assert (rc == 0);
+        rc = _pinned_msgs[i].init ();
+        errno_assert (rc == 0);
+    }
+    _pinned = 0;
+    _pos = 0;
+    _count = 0;
+    _size = 0;
+}
+
+#endif
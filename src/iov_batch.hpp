@@ -0,0 +1,81 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_IOV_BATCH_HPP_INCLUDED__
+#define __ZMQ_IOV_BATCH_HPP_INCLUDED__
+
+#if defined ZMQ_HAVE_UIO
+
+#include <stddef.h>
+#include <sys/uio.h>
+
+#include "macros.hpp"
+#include "msg.hpp"
+
+namespace zmq
+{
+//  List of chunks of encoded data to be written by a single writev call.
+//  Chunks may point straight into message bodies; such messages are
+//  pinned to the batch and closed once the batch has been written.
+
+class iov_batch_t
+{
+  public:
+    iov_batch_t ();
+    ~iov_batch_t ();
+
+    //  Appends a chunk. Merges it with the last chunk if they are
+    //  adjacent in memory.
+    void append (const void *data_, size_t size_);
+
+    //  Appends a chunk covering the body of the message and takes the
+    //  message over, leaving msg_ empty.
+    void reference (msg_t *msg_);
+
+    //  Marks size_ bytes as written. Once everything has been written the
+    //  pinned messages are released and the batch is empty again.
+    void consume (size_t size_);
+
+    //  Returns true if there is no room for another message, i.e. for a
+    //  header chunk and a body chunk.
+    bool full () const
+    {
+        return _count + 2 > max_chunks || _pinned == max_pinned;
+    }
+
+    bool empty () const { return _pos == _count; }
+
+    //  Number of bytes not written yet.
+    size_t size () const { return _size; }
+
+    const iovec *chunks () const { return _chunks + _pos; }
+    int chunk_count () const { return _count - _pos; }
+
+    //  Returns the message the index_-th unwritten chunk refers to, or NULL
+    //  if the chunk has been copied.
+    msg_t *chunk_msg (int index_) const { return _chunk_msgs[_pos + index_]; }
+
+  private:
+    void clear ();
+
+    enum
+    {
+        max_chunks = 64,
+        max_pinned = 32
+    };
+
+    iovec _chunks[max_chunks];
+    msg_t *_chunk_msgs[max_chunks];
+    int _pos;
+    int _count;
+    size_t _size;
+
+    msg_t _pinned_msgs[max_pinned];
+    int _pinned;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (iov_batch_t)
+};
+}
+
+#endif
+
+#endif
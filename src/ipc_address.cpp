@@ -52,21 +52,19 @@ int zmq::ipc_address_t::resolve (const char *path_)
     return 0;
 }
 
-int zmq::ipc_address_t::to_string (std::string &addr_) const
+int zmq::ipc_address_t::to_string (std::string &addr_,
+                                   const char *protocol_) const
 {
     if (_address.sun_family != AF_UNIX) {
         addr_.clear ();
         return -1;
     }
 
-    const char prefix[] = "ipc://";
-    char buf[sizeof prefix + sizeof _address.sun_path];
-    char *pos = buf;
-    memcpy (pos, prefix, sizeof prefix - 1);
-    pos += sizeof prefix - 1;
+    addr_.assign (protocol_);
+    addr_.append ("://");
     const char *src_pos = _address.sun_path;
     if (!_address.sun_path[0] && _address.sun_path[1]) {
-        *pos++ = '@';
+        addr_.push_back ('@');
         src_pos++;
     }
     // according to http://man7.org/linux/man-pages/man7/unix.7.html, NOTES
@@ -75,8 +73,7 @@ int zmq::ipc_address_t::to_string (std::string &addr_) const
     const size_t src_len =
       strnlen (src_pos, _addrlen - offsetof (sockaddr_un, sun_path)
                           - (src_pos - _address.sun_path));
-    memcpy (pos, src_pos, src_len);
-    addr_.assign (buf, pos - buf + src_len);
+    addr_.append (src_pos, src_len);
     return 0;
 }
 
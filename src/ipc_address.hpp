@@ -28,8 +28,8 @@ class ipc_address_t
     //  This function sets up the address for UNIX domain transport.
     int resolve (const char *path_);
 
-    //  The opposite to resolve()
-    int to_string (std::string &addr_) const;
+    //  The opposite to resolve(), with the endpoint named after protocol_.
+    int to_string (std::string &addr_, const char *protocol_ = "ipc") const;
 
     const sockaddr *addr () const;
     socklen_t addrlen () const;
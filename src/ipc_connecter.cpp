@@ -15,6 +15,9 @@
 #include "address.hpp"
 #include "ipc_address.hpp"
 #include "session_base.hpp"
+#include "config.hpp"
+#include "shm_engine.hpp"
+#include "shm_segment.hpp"
 
 #ifdef _MSC_VER
 #include <afunix.h>
@@ -33,7 +36,12 @@ zmq::ipc_connecter_t::ipc_connecter_t (class io_thread_t *io_thread_,
     stream_connecter_base_t (
       io_thread_, session_, options_, addr_, delayed_start_)
 {
+#if defined ZMQ_HAVE_SHM
+    zmq_assert (_addr->protocol == protocol_name::ipc
+                || _addr->protocol == protocol_name::shm);
+#else
     zmq_assert (_addr->protocol == protocol_name::ipc);
+#endif
 }
 
 void zmq::ipc_connecter_t::out_event ()
@@ -48,9 +56,42 @@ void zmq::ipc_connecter_t::out_event ()
         return;
     }
 
+#if defined ZMQ_HAVE_SHM
+    if (_addr->protocol == protocol_name::shm) {
+        create_engine (fd, get_shm_socket_name (fd, socket_end_local));
+        return;
+    }
+#endif
     create_engine (fd, get_socket_name<ipc_address_t> (fd, socket_end_local));
 }
 
+#if defined ZMQ_HAVE_SHM
+zmq::i_engine *
+zmq::ipc_connecter_t::make_engine (fd_t fd_,
+                                   const endpoint_uri_pair_t &endpoint_pair_)
+{
+    if (_addr->protocol != protocol_name::shm)
+        return stream_connecter_base_t::make_engine (fd_, endpoint_pair_);
+
+    shm_segment_t *segment = new (std::nothrow) shm_segment_t;
+    alloc_assert (segment);
+
+    //  Failing to set the segment up is handled like a failed connection.
+    if (segment->create (fd_, shm_ring_size) == -1) {
+        LIBZMQ_DELETE (segment);
+        _s = fd_;
+        close ();
+        add_reconnect_timer ();
+        return NULL;
+    }
+
+    i_engine *engine =
+      new (std::nothrow) shm_engine_t (fd_, options, endpoint_pair_, segment);
+    alloc_assert (engine);
+    return engine;
+}
+#endif
+
 void zmq::ipc_connecter_t::start_connecting ()
 {
     //  Open the connecting socket.
@@ -25,6 +25,13 @@ class ipc_connecter_t ZMQ_FINAL : public stream_connecter_base_t
     //  Handlers for I/O events.
     void out_event ();
 
+#if defined ZMQ_HAVE_SHM
+    //  Sends a shared memory segment to the peer of an shm:// connection
+    //  before creating the engine.
+    i_engine *make_engine (fd_t fd_,
+                           const endpoint_uri_pair_t &endpoint_pair_);
+#endif
+
     //  Internal function to start the actual connection establishment.
     void start_connecting ();
 
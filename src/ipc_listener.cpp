@@ -16,6 +16,8 @@
 #include "ip.hpp"
 #include "socket_base.hpp"
 #include "address.hpp"
+#include "session_base.hpp"
+#include "shm_engine.hpp"
 
 #ifdef _MSC_VER
 #ifdef ZMQ_IOTHREAD_POLLER_USE_SELECT
@@ -50,9 +52,15 @@
 
 zmq::ipc_listener_t::ipc_listener_t (io_thread_t *io_thread_,
                                      socket_base_t *socket_,
-                                     const options_t &options_) :
-    stream_listener_base_t (io_thread_, socket_, options_), _has_file (false)
+                                     const options_t &options_,
+                                     bool shm_) :
+    stream_listener_base_t (io_thread_, socket_, options_),
+    _has_file (false),
+    _shm (shm_)
 {
+#if !defined ZMQ_HAVE_SHM
+    zmq_assert (!_shm);
+#endif
 }
 
 void zmq::ipc_listener_t::in_event ()
@@ -75,9 +83,29 @@ std::string
 zmq::ipc_listener_t::get_socket_name (zmq::fd_t fd_,
                                       socket_end_t socket_end_) const
 {
+#if defined ZMQ_HAVE_SHM
+    if (_shm)
+        return zmq::get_shm_socket_name (fd_, socket_end_);
+#endif
     return zmq::get_socket_name<ipc_address_t> (fd_, socket_end_);
 }
 
+#if defined ZMQ_HAVE_SHM
+zmq::i_engine *
+zmq::ipc_listener_t::make_engine (fd_t fd_,
+                                  const endpoint_uri_pair_t &endpoint_pair_)
+{
+    if (!_shm)
+        return stream_listener_base_t::make_engine (fd_, endpoint_pair_);
+
+    //  The engine receives the shared memory segment from the peer.
+    i_engine *engine =
+      new (std::nothrow) shm_engine_t (fd_, options, endpoint_pair_, NULL);
+    alloc_assert (engine);
+    return engine;
+}
+#endif
+
 int zmq::ipc_listener_t::set_local_address (const char *addr_)
 {
     //  Create addr on stack for auto-cleanup
@@ -114,7 +142,12 @@ int zmq::ipc_listener_t::set_local_address (const char *addr_)
         return -1;
     }
 
-    address.to_string (_endpoint);
+#if defined ZMQ_HAVE_SHM
+    if (_shm)
+        address.to_string (_endpoint, protocol_name::shm);
+    else
+#endif
+        address.to_string (_endpoint);
 
     if (options.use_fd != -1) {
         _s = options.use_fd;
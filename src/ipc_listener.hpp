@@ -17,7 +17,8 @@ class ipc_listener_t ZMQ_FINAL : public stream_listener_base_t
   public:
     ipc_listener_t (zmq::io_thread_t *io_thread_,
                     zmq::socket_base_t *socket_,
-                    const options_t &options_);
+                    const options_t &options_,
+                    bool shm_);
 
     //  Set address to listen on.
     int set_local_address (const char *addr_);
@@ -25,6 +26,11 @@ class ipc_listener_t ZMQ_FINAL : public stream_listener_base_t
   protected:
     std::string get_socket_name (fd_t fd_, socket_end_t socket_end_) const;
 
+#if defined ZMQ_HAVE_SHM
+    i_engine *make_engine (fd_t fd_,
+                           const endpoint_uri_pair_t &endpoint_pair_);
+#endif
+
   private:
     //  Handlers for I/O events.
     void in_event ();
@@ -52,6 +58,9 @@ class ipc_listener_t ZMQ_FINAL : public stream_listener_base_t
     //  Name of the file associated with the UNIX domain address.
     std::string _filename;
 
+    //  True if the connections use the shm:// transport.
+    const bool _shm;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (ipc_listener_t)
 };
 }
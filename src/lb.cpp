@@ -6,7 +6,8 @@
 #include "err.hpp"
 #include "msg.hpp"
 
-zmq::lb_t::lb_t () : _active (0), _current (0), _more (false), _dropping (false)
+zmq::lb_t::lb_t () :
+    _active (0), _current (0), _more (false), _dropping (false), _batch (false)
 {
 }
 
@@ -117,7 +118,10 @@ int zmq::lb_t::sendpipe (msg_t *msg_, pipe_t **pipe_)
     //  continue round-robining (load balance).
     _more = (msg_->flags () & msg_t::more) != 0;
     if (!_more) {
-        _pipes[_current]->flush ();
+        if (!_batch)
+            _pipes[_current]->flush ();
+        else if (_pipes[_current]->defer_flush ())
+            _batch_out.push_back (_pipes[_current]);
 
         if (++_current >= _active)
             _current = 0;
@@ -151,3 +155,18 @@ bool zmq::lb_t::has_out ()
 
     return false;
 }
+
+void zmq::lb_t::begin_batch ()
+{
+    _batch = true;
+}
+
+void zmq::lb_t::end_batch ()
+{
+    _batch = false;
+
+    for (std::vector<pipe_t *>::size_type i = 0, size = _batch_out.size ();
+         i != size; ++i)
+        _batch_out[i]->flush ();
+    _batch_out.clear ();
+}
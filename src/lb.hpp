@@ -3,6 +3,8 @@
 #ifndef __ZMQ_LB_HPP_INCLUDED__
 #define __ZMQ_LB_HPP_INCLUDED__
 
+#include <vector>
+
 #include "array.hpp"
 
 namespace zmq
@@ -33,6 +35,11 @@ class lb_t
 
     bool has_out ();
 
+    //  Between these calls, completed messages are not flushed to the pipes
+    //  one by one but all at once by end_batch.
+    void begin_batch ();
+    void end_batch ();
+
   private:
     //  List of outbound pipes.
     typedef array_t<pipe_t, 2> pipes_t;
@@ -51,6 +58,12 @@ class lb_t
     //  True if we are dropping current message.
     bool _dropping;
 
+    //  True if flushing is deferred to the end of a batch. The pipes
+    //  written to are remembered as they are written, since they may be
+    //  deactivated before the batch ends.
+    bool _batch;
+    std::vector<pipe_t *> _batch_out;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (lb_t)
 };
 }
@@ -4,7 +4,146 @@
 #include "mailbox.hpp"
 #include "err.hpp"
 
-zmq::mailbox_t::mailbox_t ()
+#if defined ZMQ_USE_MPSC_MAILBOX && !defined ZMQ_HAVE_WINDOWS
+#include <sched.h>
+#endif
+
+#ifdef ZMQ_USE_MPSC_MAILBOX
+
+zmq::mailbox_t::mailbox_t () : _pending (0), _received (0), _active (false)
+{
+    //  Start in passive state. That way, if the users starts by polling on
+    //  the associated file descriptor it will get woken up when new command
+    //  is posted.
+}
+
+zmq::mailbox_t::~mailbox_t ()
+{
+    //  Work around problem that other threads might still be in our
+    //  send() method: they counted their commands before queueing them, so
+    //  wait until all of the commands counted have been read. Those never
+    //  received are dropped.
+    command_t cmd;
+    for (int attempt = 0; _pending.get () != _received; attempt++) {
+        if (_commands.read (&cmd))
+            _received++;
+        else
+            back_off (attempt);
+    }
+}
+
+zmq::fd_t zmq::mailbox_t::get_fd () const
+{
+    return _signaler.get_fd ();
+}
+
+void zmq::mailbox_t::send (const command_t &cmd_)
+{
+    //  Count the command before queueing it, so that the receiver never
+    //  gets hold of a command that is not accounted for yet. Only the first
+    //  command after the receiver went to sleep signals.
+    const bool wake = _pending.add (1) == 0;
+    _commands.write (cmd_);
+    if (wake)
+        _signaler.send ();
+}
+
+int zmq::mailbox_t::recv (command_t *cmd_, int timeout_)
+{
+    //  Try to get the command straight away.
+    if (_active) {
+        if (read (cmd_))
+            return 0;
+        _active = false;
+    }
+
+    //  Wait for signal from the command sender.
+    int rc = _signaler.wait (timeout_);
+    if (rc == -1) {
+        errno_assert (errno == EAGAIN || errno == EINTR);
+        return -1;
+    }
+
+    //  Receive the signal.
+    rc = _signaler.recv_failable ();
+    if (rc == -1) {
+        errno_assert (errno == EAGAIN);
+        return -1;
+    }
+
+    //  Switch into active state.
+    _active = true;
+
+    //  Get a command. The sender that signalled has counted one.
+    const bool ok = read (cmd_);
+    zmq_assert (ok);
+    return 0;
+}
+
+bool zmq::mailbox_t::read (command_t *cmd_)
+{
+    for (int attempt = 0;; attempt++) {
+        if (_commands.read (cmd_)) {
+            _received++;
+            return true;
+        }
+
+        //  No command is at hand. Unless more commands were counted in the
+        //  meantime, the receiver can go to sleep; the next sender will
+        //  signal. Otherwise their senders are still queueing them.
+        const bool more = _pending.sub (_received);
+        _received = 0;
+        if (!more)
+            return false;
+        back_off (attempt);
+    }
+}
+
+void zmq::mailbox_t::back_off (int attempt_)
+{
+    //  A sender is caught between counting its command and linking it into
+    //  the queue, which takes a few instructions unless it was preempted.
+    //  Let it run rather than spin through its time slice.
+    if (attempt_ >= max_spins) {
+#if defined ZMQ_HAVE_WINDOWS
+        SwitchToThread ();
+#else
+        sched_yield ();
+#endif
+    }
+}
+
+bool zmq::mailbox_t::spin_begin ()
+{
+    if (_active)
+        return false;
+
+    //  Senders that find the flag alone do not signal. If commands were
+    //  counted already, the first of them has signalled.
+    if (_pending.add (spinning) == 0)
+        return true;
+    _pending.sub (spinning);
+    return false;
+}
+
+bool zmq::mailbox_t::spin_check () const
+{
+    return _pending.get () != spinning;
+}
+
+bool zmq::mailbox_t::spin_end ()
+{
+    //  Commands counted while spinning come without a signal.
+    if (_pending.sub (spinning)) {
+        _active = true;
+        return true;
+    }
+    return false;
+}
+
+#else
+
+zmq::mailbox_t::mailbox_t () : _spinning (false), _spin_woken (0)
 {
     //  Get the pipe into passive state. That way, if the users starts by
     //  polling on the associated file descriptor it will get woken up when
@@ -33,7 +172,13 @@ void zmq::mailbox_t::send (const command_t &cmd_)
 {
     _sync.lock ();
     _cpipe.write (cmd_, false);
-    const bool ok = _cpipe.flush ();
+    bool ok = _cpipe.flush ();
+    if (!ok && _spinning) {
+        //  The spinning receiver reads the pipe without a signal.
+        _spinning = false;
+        _spin_woken.set (1);
+        ok = true;
+    }
     _sync.unlock ();
     if (!ok)
         _signaler.send ();
@@ -73,6 +218,40 @@ int zmq::mailbox_t::recv (command_t *cmd_, int timeout_)
     return 0;
 }
 
+bool zmq::mailbox_t::spin_begin ()
+{
+    if (_active)
+        return false;
+
+    //  A command written since the receiver went passive has signalled.
+    scoped_lock_t locker (_sync);
+    if (_cpipe.check_read ())
+        return false;
+    _spinning = true;
+    _spin_woken.set (0);
+    return true;
+}
+
+bool zmq::mailbox_t::spin_check () const
+{
+    return _spin_woken.get () != 0;
+}
+
+bool zmq::mailbox_t::spin_end ()
+{
+    {
+        scoped_lock_t locker (_sync);
+        _spinning = false;
+    }
+    if (_spin_woken.get ()) {
+        _active = true;
+        return true;
+    }
+    return false;
+}
+
+#endif
+
 bool zmq::mailbox_t::valid () const
 {
     return _signaler.valid ();
@@ -9,9 +9,14 @@
 #include "fd.hpp"
 #include "config.hpp"
 #include "command.hpp"
+#include "atomic_counter.hpp"
+#include "i_mailbox.hpp"
+#ifdef ZMQ_USE_MPSC_MAILBOX
+#include "mpsc_queue.hpp"
+#else
 #include "ypipe.hpp"
 #include "mutex.hpp"
-#include "i_mailbox.hpp"
+#endif
 
 namespace zmq
 {
@@ -27,6 +32,16 @@ class mailbox_t ZMQ_FINAL : public i_mailbox
 
     bool valid () const;
 
+    //  Lets the receiver busy-wait for commands instead of blocking in
+    //  recv. Senders do not signal while the receiver spins. spin_begin
+    //  returns false if there are commands to process already; otherwise
+    //  spin_end has to be called when done spinning, and returns true if
+    //  commands arrived in the meantime. Either way, recv then gets them
+    //  without waiting.
+    bool spin_begin ();
+    bool spin_check () const;
+    bool spin_end ();
+
 #ifdef HAVE_FORK
     // close the file descriptors in the signaller. This is used in a forked
     // child process to close the file descriptors so that they do not interfere
@@ -38,21 +53,60 @@ class mailbox_t ZMQ_FINAL : public i_mailbox
 #endif
 
   private:
+#ifdef ZMQ_USE_MPSC_MAILBOX
+    //  Gets a command from the queue, settling the commands received when
+    //  it runs dry. Returns false if there is none.
+    bool read (command_t *cmd_);
+
+    //  Waits a little for a sender that has counted its command but not
+    //  queued it yet.
+    static void back_off (int attempt_);
+
+    //  Flag added to the pending counter while the receiver spins.
+    static const atomic_counter_t::integer_t spinning = 0x80000000;
+
+    //  Attempts to get a command that has been counted before the receiver
+    //  yields the processor to its sender.
+    static const int max_spins = 16;
+
+    //  The queue to store actual commands. There's only one thread
+    //  receiving from the mailbox, but there is arbitrary number of threads
+    //  sending, none of which has to wait for the others. The pending
+    //  counter tells which of them are still in send.
+    mpsc_queue_t<command_t> _commands;
+
+    //  Number of commands sent but not yet accounted for by the receiver.
+    //  The receiver settles the commands it got only once it runs out of
+    //  them, and goes to sleep if that brings the counter back to zero.
+    //  The sender that raises it from zero wakes the receiver up. Thus a
+    //  burst of commands costs a single signal, no matter how many threads
+    //  it comes from.
+    atomic_counter_t _pending;
+
+    //  Commands received since the counter was last settled.
+    atomic_counter_t::integer_t _received;
+#else
     //  The pipe to store actual commands.
     typedef ypipe_t<command_t, command_pipe_granularity> cpipe_t;
     cpipe_t _cpipe;
 
-    //  Signaler to pass signals from writer thread to reader thread.
-    signaler_t _signaler;
-
     //  There's only one thread receiving from the mailbox, but there
     //  is arbitrary number of threads sending. Given that ypipe requires
     //  synchronised access on both of its endpoints, we have to synchronise
     //  the sending side.
     mutex_t _sync;
 
-    //  True if the underlying pipe is active, ie. when we are allowed to
-    //  read commands from it.
+    //  True while the receiver spins, protected by _sync. The sender that
+    //  would wake the receiver up sets _spin_woken instead of signalling.
+    bool _spinning;
+    atomic_counter_t _spin_woken;
+#endif
+
+    //  Signaler to pass signals from writer thread to reader thread.
+    signaler_t _signaler;
+
+    //  True if the receiver was woken up and has not run out of commands
+    //  since, ie. when we are allowed to read commands from the queue.
     bool _active;
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (mailbox_t)
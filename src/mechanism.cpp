@@ -137,6 +137,7 @@ size_t zmq::mechanism_t::property_len (const char *name_, size_t value_len_)
 
 #define ZMTP_PROPERTY_SOCKET_TYPE "Socket-Type"
 #define ZMTP_PROPERTY_IDENTITY "Identity"
+#define ZMTP_PROPERTY_MEMFD "Memfd"
 
 size_t zmq::mechanism_t::add_basic_properties (unsigned char *ptr_,
                                                size_t ptr_capacity_) const
@@ -156,6 +157,12 @@ size_t zmq::mechanism_t::add_basic_properties (unsigned char *ptr_,
                              options.routing_id_size);
     }
 
+#if defined ZMQ_HAVE_MEMFD
+    //  Add memfd property
+    if (accepts_memfd ())
+        ptr += add_property (ptr, ptr_capacity_ - (ptr - ptr_),
+                             ZMTP_PROPERTY_MEMFD, "1", 1);
+#endif
 
     for (std::map<std::string, std::string>::const_iterator
            it = options.app_metadata.begin (),
@@ -182,6 +189,11 @@ size_t zmq::mechanism_t::basic_properties_len () const
           property_len (it->first.c_str (), strlen (it->second.c_str ()));
     }
 
+#if defined ZMQ_HAVE_MEMFD
+    if (accepts_memfd ())
+        meta_len += property_len (ZMTP_PROPERTY_MEMFD, 1);
+#endif
+
     return property_len (ZMTP_PROPERTY_SOCKET_TYPE, strlen (socket_type))
            + meta_len
            + ((options.type == ZMQ_REQ || options.type == ZMQ_DEALER
@@ -262,6 +274,20 @@ int zmq::mechanism_t::parse_metadata (const unsigned char *ptr_,
     return 0;
 }
 
+#if defined ZMQ_HAVE_MEMFD
+bool zmq::mechanism_t::accepts_memfd () const
+{
+    return options.memfd_threshold >= 0
+           && (options.mechanism == ZMQ_NULL || options.mechanism == ZMQ_PLAIN);
+}
+
+bool zmq::mechanism_t::peer_accepts_memfd () const
+{
+    return _zmtp_properties.find (ZMTP_PROPERTY_MEMFD)
+           != _zmtp_properties.end ();
+}
+#endif
+
 int zmq::mechanism_t::property (const std::string & /* name_ */,
                                 const void * /* value_ */,
                                 size_t /* length_ */)
@@ -12,6 +12,7 @@ namespace zmq
 {
 class msg_t;
 class session_base_t;
+class crypto_job_t;
 
 //  Abstract class representing security mechanism.
 //  Different mechanism extends this class.
@@ -43,6 +44,10 @@ class mechanism_t
     //  Notifies mechanism about availability of ZAP message.
     virtual int zap_msg_available () { return 0; }
 
+    //  Hands back a job the mechanism submitted to the crypto pool of the
+    //  context, once it is done. The job is deallocated by the caller.
+    virtual int crypto_done (crypto_job_t *) { return 0; }
+
     //  Returns the status of this mechanism.
     virtual status_t status () const = 0;
 
@@ -64,6 +69,16 @@ class mechanism_t
         return _zap_properties;
     }
 
+#if defined ZMQ_HAVE_MEMFD
+    //  Returns true if this end takes message frames passed in a memfd,
+    //  which it tells the peer with the Memfd property. Such frames bypass
+    //  the mechanism, so only those leaving messages in clear text allow it.
+    bool accepts_memfd () const;
+
+    //  Returns true if the peer has told it takes them.
+    bool peer_accepts_memfd () const;
+#endif
+
   protected:
     //  Only used to identify the socket for the Socket-Type
     //  property in the wire protocol.
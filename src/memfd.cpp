@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "macros.hpp"
+#include "memfd.hpp"
+
+#if defined ZMQ_HAVE_MEMFD
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "err.hpp"
+
+#if defined F_ADD_SEALS
+static const int memfd_seals =
+  F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+#endif
+
+zmq::fd_t zmq::memfd_copy (const void *data_, size_t size_)
+{
+#if defined F_ADD_SEALS
+    const fd_t fd = memfd_create ("zmq-msg", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == retired_fd)
+        return retired_fd;
+
+    //  Writing to the memfd copies straight to its pages, without the page
+    //  faults of writing through a mapping.
+    const unsigned char *data = static_cast<const unsigned char *> (data_);
+    size_t written = 0;
+    while (written < size_) {
+        const ssize_t nbytes = write (fd, data + written, size_ - written);
+        if (nbytes == -1 && errno == EINTR)
+            continue;
+        if (nbytes <= 0)
+            break;
+        written += static_cast<size_t> (nbytes);
+    }
+
+    if (written != size_ || fcntl (fd, F_ADD_SEALS, memfd_seals) == -1) {
+        memfd_close (fd);
+        return retired_fd;
+    }
+    return fd;
+#else
+    //  Without seals the receiver could not trust the contents to stay put.
+    LIBZMQ_UNUSED (data_);
+    LIBZMQ_UNUSED (size_);
+    return retired_fd;
+#endif
+}
+
+void *zmq::memfd_map (fd_t fd_, size_t size_)
+{
+    void *data = NULL;
+    struct stat st;
+#if defined F_GET_SEALS
+    const int seals = fcntl (fd_, F_GET_SEALS);
+    if (size_ > 0 && seals != -1
+        && (seals & (F_SEAL_SHRINK | F_SEAL_WRITE))
+             == (F_SEAL_SHRINK | F_SEAL_WRITE)
+        && fstat (fd_, &st) == 0 && st.st_size == static_cast<off_t> (size_)) {
+        data = mmap (NULL, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_, 0);
+        if (data == MAP_FAILED)
+            data = NULL;
+    }
+#else
+    LIBZMQ_UNUSED (st);
+    LIBZMQ_UNUSED (size_);
+#endif
+    memfd_close (fd_);
+    return data;
+}
+
+void zmq::memfd_unmap (void *data_, void *hint_)
+{
+    const int rc = munmap (data_, reinterpret_cast<size_t> (hint_));
+    errno_assert (rc == 0);
+}
+
+void zmq::memfd_close (fd_t fd_)
+{
+    const int rc = close (fd_);
+    errno_assert (rc == 0);
+}
+
+#endif
@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_MEMFD_HPP_INCLUDED__
+#define __ZMQ_MEMFD_HPP_INCLUDED__
+
+#if defined ZMQ_HAVE_MEMFD
+
+#include <stddef.h>
+
+#include "fd.hpp"
+
+namespace zmq
+{
+//  Copies size_ bytes to a new memfd, sealed so that neither its size nor
+//  its contents can change any more. Returns retired_fd on failure.
+fd_t memfd_copy (const void *data_, size_t size_);
+
+//  Maps a memfd received from a peer, once checked that it holds exactly
+//  size_ bytes and is sealed against writes. The mapping is private, so
+//  that the receiver may modify it. The descriptor is closed in any case.
+//  Returns NULL on failure.
+void *memfd_map (fd_t fd_, size_t size_);
+
+//  Unmaps data mapped by memfd_map, hint_ holding its size. Suitable as
+//  the deallocation function of a message.
+void memfd_unmap (void *data_, void *hint_);
+
+//  Closes a memfd not passed on.
+void memfd_close (fd_t fd_);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,296 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_MPSC_QUEUE_HPP_INCLUDED__
+#define __ZMQ_MPSC_QUEUE_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <new>
+
+#include "err.hpp"
+#include "likely.hpp"
+#include "macros.hpp"
+#include "mutex.hpp"
+#include "stdint.hpp"
+
+#if !defined ZMQ_FORCE_MUTEXES                                                 \
+  && ((defined __cplusplus && __cplusplus >= 201103L)                          \
+      || (defined _MSC_VER && _MSC_VER >= 1900))
+#define ZMQ_MPSC_QUEUE_LOCK_FREE
+#include <atomic>
+#endif
+
+namespace zmq
+{
+//  Unbounded queue with an arbitrary number of writers and a single reader.
+//  T is the type of the object in the queue.
+//
+//  Each item lives in a node of its own. A writer appends its node by
+//  swapping it in as the new tail and then linking the previous tail to
+//  it, so writers never wait for each other nor for the reader. The reader
+//  owns everything before the tail. Between the two steps of a writer the
+//  queue is cut short at its node; the reader then finds no item, as if
+//  the queue were empty.
+//
+//  Nodes are carved from chunks, each twice as large as the one before,
+//  which are only freed along with the queue. The reader hands the nodes
+//  it is done with back in batches, on a free stack the writers take them
+//  from, the same way msg_pool_t recycles its blocks.
+//
+//  Without C++11 atomics both ends are protected by a mutex instead.
+//
+//  The queue does not wait for writers when it is destroyed; its owner
+//  has to make sure that none is left in write.
+
+template <typename T> class mpsc_queue_t
+{
+  public:
+    mpsc_queue_t () : _chunk_count (0), _spare_count (0)
+    {
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+        _free.store (0, std::memory_order_relaxed);
+#else
+        _free = 0;
+#endif
+
+        //  The head always is a node that was already read (or the initial
+        //  one), so that the queue is never empty of nodes.
+        node_t *node = grow ();
+        alloc_assert (node);
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+        node->next.store (NULL, std::memory_order_relaxed);
+        _tail.store (node, std::memory_order_relaxed);
+#else
+        node->next = NULL;
+        _tail = node;
+#endif
+        _head = node;
+    }
+
+    ~mpsc_queue_t ()
+    {
+        //  Items never read go along with their chunks.
+        for (uint32_t i = 0; i != _chunk_count; i++)
+            delete[] _chunks[i];
+    }
+
+    //  Appends an item to the queue. May be called from any thread.
+    void write (const T &value_)
+    {
+        node_t *node = pop ();
+        if (unlikely (!node)) {
+            node = grow ();
+            alloc_assert (node);
+        }
+        node->value = value_;
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+        node->next.store (NULL, std::memory_order_relaxed);
+        node_t *prev = _tail.exchange (node, std::memory_order_acq_rel);
+        prev->next.store (node, std::memory_order_release);
+#else
+        node->next = NULL;
+        scoped_lock_t locker (_sync);
+        _tail->next = node;
+        _tail = node;
+#endif
+    }
+
+    //  Reads the oldest item. Returns false if the queue is empty, or if
+    //  the writer of the oldest item has not linked it yet. Must only be
+    //  called by one thread at a time.
+    bool read (T *value_)
+    {
+        node_t *head = _head;
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+        node_t *next = head->next.load (std::memory_order_acquire);
+#else
+        node_t *next;
+        {
+            scoped_lock_t locker (_sync);
+            next = head->next;
+        }
+#endif
+        if (!next) {
+            //  Give the writers what is left over before going idle.
+            if (_spare_count)
+                release_spares ();
+            return false;
+        }
+        *value_ = next->value;
+        _head = next;
+
+        //  Nodes read are collected and given back in one go.
+        set_free_next (head, _spare_count ? _spare_first->index + 1 : 0);
+        if (!_spare_count)
+            _spare_last = head;
+        _spare_first = head;
+        if (++_spare_count == spare_batch)
+            release_spares ();
+        return true;
+    }
+
+  private:
+    struct node_t
+    {
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+        std::atomic<node_t *> next;
+#else
+        node_t *next;
+#endif
+        //  Position of the node in the chunks, and index (plus one) of the
+        //  next node on the free stack.
+        uint32_t index;
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+        std::atomic<uint32_t> free_next;
+#else
+        uint32_t free_next;
+#endif
+        T value;
+    };
+
+    enum
+    {
+        //  The first chunk holds chunk_base nodes, chunk k chunk_base << k.
+        chunk_base = 16,
+        max_chunks = 27,
+
+        //  Number of nodes the reader collects before giving them back.
+        spare_batch = 32
+    };
+
+    node_t *node (uint32_t index_) const
+    {
+        uint32_t chunk = 0;
+        for (uint32_t i = index_ / chunk_base + 1; i > 1; i >>= 1)
+            chunk++;
+        return &_chunks[chunk][index_ - chunk_base * ((1u << chunk) - 1)];
+    }
+
+    static void set_free_next (node_t *node_, uint32_t free_next_)
+    {
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+        node_->free_next.store (free_next_, std::memory_order_relaxed);
+#else
+        node_->free_next = free_next_;
+#endif
+    }
+
+    //  Takes a node from the free stack, or returns NULL if there is none.
+    node_t *pop ()
+    {
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+        uint64_t top = _free.load (std::memory_order_acquire);
+        while (true) {
+            const uint32_t index = static_cast<uint32_t> (top);
+            if (!index)
+                return NULL;
+            node_t *result = node (index - 1);
+
+            //  If another writer pops the node concurrently the value read
+            //  here may be stale, but then the tag has changed and the swap
+            //  fails.
+            const uint64_t next =
+              ((top >> 32) + 1) << 32
+              | result->free_next.load (std::memory_order_relaxed);
+            if (_free.compare_exchange_weak (top, next,
+                                             std::memory_order_acquire,
+                                             std::memory_order_acquire))
+                return result;
+        }
+#else
+        scoped_lock_t locker (_sync);
+        const uint32_t index = static_cast<uint32_t> (_free);
+        if (!index)
+            return NULL;
+        node_t *result = node (index - 1);
+        _free = ((_free >> 32) + 1) << 32 | result->free_next;
+        return result;
+#endif
+    }
+
+    //  Puts the chain of nodes from first_ to last_ on the free stack.
+    void push (node_t *first_, node_t *last_)
+    {
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+        uint64_t top = _free.load (std::memory_order_relaxed);
+        do {
+            set_free_next (last_, static_cast<uint32_t> (top));
+        } while (!_free.compare_exchange_weak (
+          top, ((top >> 32) + 1) << 32 | (first_->index + 1),
+          std::memory_order_release, std::memory_order_relaxed));
+#else
+        scoped_lock_t locker (_sync);
+        last_->free_next = static_cast<uint32_t> (_free);
+        _free = ((_free >> 32) + 1) << 32 | (first_->index + 1);
+#endif
+    }
+
+    void release_spares ()
+    {
+        push (_spare_first, _spare_last);
+        _spare_count = 0;
+    }
+
+    //  Allocates the next chunk, pushes all but one of its nodes on the
+    //  free stack and returns the remaining one. Returns NULL if no chunk
+    //  can be allocated.
+    node_t *grow ()
+    {
+        scoped_lock_t locker (_grow_sync);
+
+        //  Another writer may have grown the queue in the meantime.
+        node_t *result = pop ();
+        if (result || _chunk_count == max_chunks)
+            return result;
+
+        const uint32_t size = chunk_base << _chunk_count;
+        node_t *chunk = new (std::nothrow) node_t[size];
+        if (!chunk)
+            return NULL;
+        const uint32_t first = chunk_base * ((1u << _chunk_count) - 1);
+        for (uint32_t i = 0; i != size; i++) {
+            chunk[i].index = first + i;
+            set_free_next (&chunk[i], first + i + 2);
+        }
+        _chunks[_chunk_count++] = chunk;
+
+        //  The chunk is stored before any of its nodes can be popped.
+        if (size > 1)
+            push (&chunk[1], &chunk[size - 1]);
+        return &chunk[0];
+    }
+
+    //  Last node read. Only accessed by the reader.
+    node_t *_head;
+
+    //  Last node written.
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+    std::atomic<node_t *> _tail;
+#else
+    node_t *_tail;
+    mutex_t _sync;
+#endif
+
+    //  Chunks are only ever appended, under _grow_sync.
+    node_t *_chunks[max_chunks];
+    uint32_t _chunk_count;
+    mutex_t _grow_sync;
+
+    //  Free stack. The low 32 bits hold the index (plus one) of the top
+    //  node, the high 32 bits a tag incremented on every update to defeat
+    //  the ABA problem.
+#ifdef ZMQ_MPSC_QUEUE_LOCK_FREE
+    std::atomic<uint64_t> _free;
+#else
+    uint64_t _free;
+#endif
+
+    //  Nodes read and not given back yet. Only accessed by the reader.
+    node_t *_spare_first;
+    node_t *_spare_last;
+    uint32_t _spare_count;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (mpsc_queue_t)
+};
+}
+
+#endif
@@ -12,6 +12,8 @@
 #include "stdint.hpp"
 #include "likely.hpp"
 #include "metadata.hpp"
+#include "i_msg_allocator.hpp"
+#include "decoder_allocators.hpp"
 #include "err.hpp"
 
 //  Check whether the sizes of public representation of the message (zmq_msg_t)
@@ -59,7 +61,7 @@ int zmq::msg_t::init ()
     return 0;
 }
 
-int zmq::msg_t::init_size (size_t size_)
+int zmq::msg_t::init_size (size_t size_, i_msg_allocator *allocator_)
 {
     if (size_ <= max_vsm_size) {
         _u.vsm.metadata = NULL;
@@ -78,8 +80,9 @@ int zmq::msg_t::init_size (size_t size_)
         _u.lmsg.routing_id = 0;
         _u.lmsg.content = NULL;
         if (sizeof (content_t) + size_ > size_)
-            _u.lmsg.content =
-              static_cast<content_t *> (malloc (sizeof (content_t) + size_));
+            _u.lmsg.content = static_cast<content_t *> (
+              allocator_ ? allocator_->allocate (sizeof (content_t) + size_)
+                         : malloc (sizeof (content_t) + size_));
         if (unlikely (!_u.lmsg.content)) {
             errno = ENOMEM;
             return -1;
@@ -89,14 +92,17 @@ int zmq::msg_t::init_size (size_t size_)
         _u.lmsg.content->size = size_;
         _u.lmsg.content->ffn = NULL;
         _u.lmsg.content->hint = NULL;
+        _u.lmsg.content->allocator = allocator_;
         new (&_u.lmsg.content->refcnt) zmq::atomic_counter_t ();
     }
     return 0;
 }
 
-int zmq::msg_t::init_buffer (const void *buf_, size_t size_)
+int zmq::msg_t::init_buffer (const void *buf_,
+                             size_t size_,
+                             i_msg_allocator *allocator_)
 {
-    const int rc = init_size (size_);
+    const int rc = init_size (size_, allocator_);
     if (unlikely (rc < 0)) {
         return -1;
     }
@@ -129,6 +135,7 @@ int zmq::msg_t::init_external_storage (content_t *content_,
     _u.zclmsg.content->size = size_;
     _u.zclmsg.content->ffn = ffn_;
     _u.zclmsg.content->hint = hint_;
+    _u.zclmsg.content->allocator = NULL;
     new (&_u.zclmsg.content->refcnt) zmq::atomic_counter_t ();
 
     return 0;
@@ -171,6 +178,7 @@ int zmq::msg_t::init_data (void *data_,
         _u.lmsg.content->size = size_;
         _u.lmsg.content->ffn = ffn_;
         _u.lmsg.content->hint = hint_;
+        _u.lmsg.content->allocator = NULL;
         new (&_u.lmsg.content->refcnt) zmq::atomic_counter_t ();
     }
     return 0;
@@ -259,7 +267,10 @@ int zmq::msg_t::close ()
             if (_u.lmsg.content->ffn)
                 _u.lmsg.content->ffn (_u.lmsg.content->data,
                                       _u.lmsg.content->hint);
-            free (_u.lmsg.content);
+            if (_u.lmsg.content->allocator)
+                _u.lmsg.content->allocator->deallocate (_u.lmsg.content);
+            else
+                free (_u.lmsg.content);
         }
     }
 
@@ -425,6 +436,40 @@ void zmq::msg_t::shrink (size_t new_size_)
     }
 }
 
+bool zmq::msg_t::shrink_front (size_t size_)
+{
+    //  Check the validity of the message.
+    zmq_assert (check ());
+    zmq_assert (size_ <= size ());
+
+    if (_u.base.flags & msg_t::shared)
+        return false;
+
+    content_t *content;
+    switch (_u.base.type) {
+        case type_lmsg:
+            //  The data of messages built with init_data are handed back
+            //  to their owner by address.
+            content = _u.lmsg.content;
+            if (content->ffn)
+                return false;
+            break;
+        case type_zclmsg:
+            //  Messages in the decoder's shared buffer release the buffer
+            //  as a whole.
+            content = _u.zclmsg.content;
+            if (content->ffn != shared_message_memory_allocator::call_dec_ref)
+                return false;
+            break;
+        default:
+            return false;
+    }
+
+    content->data = static_cast<unsigned char *> (content->data) + size_;
+    content->size -= size_;
+    return true;
+}
+
 unsigned char zmq::msg_t::flags () const
 {
     return _u.base.flags;
@@ -569,6 +614,11 @@ void zmq::msg_t::add_refs (int refs_)
     if (!refs_)
         return;
 
+    //  Each copy holds a reference to a long group, whatever the type of
+    //  the message.
+    if (_u.base.group.type == group_type_long)
+        _u.base.group.lgroup.content->refcnt.add (refs_);
+
     //  VSMs, CMSGS and delimiters can be copied straight away. The only
     //  message type that needs special care are long messages.
     if (_u.base.type == type_lmsg || is_zcmsg ()) {
@@ -595,10 +645,20 @@ bool zmq::msg_t::rm_refs (int refs_)
     //  If there's only one reference close the message.
     if ((_u.base.type != type_zclmsg && _u.base.type != type_lmsg)
         || !(_u.base.flags & msg_t::shared)) {
+        //  Copies of the message may still share a long group, close ()
+        //  releases one of the references to it.
+        if (_u.base.group.type == group_type_long && refs_ > 1)
+            _u.base.group.lgroup.content->refcnt.sub (refs_ - 1);
         close ();
         return false;
     }
 
+    if (_u.base.group.type == group_type_long
+        && !_u.base.group.lgroup.content->refcnt.sub (refs_)) {
+        _u.base.group.lgroup.content->refcnt.~atomic_counter_t ();
+        free (_u.base.group.lgroup.content);
+    }
+
     //  The only message type that needs special care are long and zcopy messages.
     if (_u.base.type == type_lmsg && !_u.lmsg.content->refcnt.sub (refs_)) {
         //  We used "placement new" operator to initialize the reference
@@ -607,7 +667,10 @@ bool zmq::msg_t::rm_refs (int refs_)
 
         if (_u.lmsg.content->ffn)
             _u.lmsg.content->ffn (_u.lmsg.content->data, _u.lmsg.content->hint);
-        free (_u.lmsg.content);
+        if (_u.lmsg.content->allocator)
+            _u.lmsg.content->allocator->deallocate (_u.lmsg.content);
+        else
+            free (_u.lmsg.content);
 
         return false;
     }
@@ -646,6 +709,11 @@ int zmq::msg_t::reset_routing_id ()
     return 0;
 }
 
+bool zmq::msg_t::has_long_group () const
+{
+    return _u.base.group.type == group_type_long;
+}
+
 const char *zmq::msg_t::group () const
 {
     if (_u.base.group.type == group_type_long)
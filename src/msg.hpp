@@ -24,6 +24,8 @@ typedef void (msg_free_fn) (void *data_, void *hint_);
 
 namespace zmq
 {
+class i_msg_allocator;
+
 //  Note that this structure needs to be explicitly constructed
 //  (init functions) and destructed (close function).
 
@@ -39,13 +41,15 @@ class msg_t
     //  In the latter case, ffn member stores pointer to the function to be
     //  used to deallocate the data. If the buffer is actually shared (there
     //  are at least 2 references to it) refcount member contains number of
-    //  references.
+    //  references. If the structure was obtained from an allocator other
+    //  than malloc, allocator member points to it.
     struct content_t
     {
         void *data;
         size_t size;
         msg_free_fn *ffn;
         void *hint;
+        i_msg_allocator *allocator;
         zmq::atomic_counter_t refcnt;
     };
 
@@ -75,8 +79,11 @@ class msg_t
               void *hint_,
               content_t *content_ = NULL);
 
-    int init_size (size_t size_);
-    int init_buffer (const void *buf_, size_t size_);
+    //  If allocator_ is NULL, the content of large messages is malloc-ed.
+    int init_size (size_t size_, i_msg_allocator *allocator_ = NULL);
+    int init_buffer (const void *buf_,
+                     size_t size_,
+                     i_msg_allocator *allocator_ = NULL);
     int init_data (void *data_, size_t size_, msg_free_fn *ffn_, void *hint_);
     int init_external_storage (content_t *content_,
                                void *data_,
@@ -132,6 +139,9 @@ class msg_t
     const char *group () const;
     int set_group (const char *group_);
     int set_group (const char *, size_t length_);
+    //  True if the group is too long to be stored in the message itself,
+    //  and is shared with its copies instead.
+    bool has_long_group () const;
 
     //  After calling this function you can copy the message in POD-style
     //  refs_ times. No need to call copy.
@@ -143,6 +153,12 @@ class msg_t
 
     void shrink (size_t new_size_);
 
+    //  Drops the first size_ bytes of the message without moving the rest
+    //  of the data. This is only possible for long messages that own their
+    //  content alone and free it regardless of where the data starts;
+    //  false is returned and the message is left unchanged otherwise.
+    bool shrink_front (size_t size_);
+
     //  Size in bytes of the largest message that is still copied around
     //  rather than being reference-counted.
     enum
@@ -0,0 +1,316 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "msg_allocator.hpp"
+#include "likely.hpp"
+#include "err.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#if defined ZMQ_HAVE_LINUX && defined ZMQ_HAVE_SCHED_GETCPU
+#include <sched.h>
+#endif
+
+zmq::heap_msg_allocator_t::heap_msg_allocator_t (allocate_fn *allocate_,
+                                                  deallocate_fn *deallocate_,
+                                                  void *hint_) :
+    _allocate (allocate_),
+    _deallocate (deallocate_),
+    _hint (hint_)
+{
+    //  Either both functions are supplied or none of them.
+    zmq_assert ((_allocate == NULL) == (_deallocate == NULL));
+}
+
+void *zmq::heap_msg_allocator_t::allocate (size_t size_)
+{
+    if (_allocate)
+        return _allocate (size_, _hint);
+    return malloc (size_);
+}
+
+void zmq::heap_msg_allocator_t::deallocate (void *ptr_)
+{
+    if (_deallocate)
+        _deallocate (ptr_, _hint);
+    else
+        free (ptr_);
+}
+
+zmq::msg_pool_t::msg_pool_t (i_msg_allocator *backend_, int node_) :
+    _backend (backend_), _node (node_)
+{
+    zmq_assert (_backend);
+
+    for (uint32_t i = 0; i != class_count; i++) {
+        size_class_t &c = _classes[i];
+        c.block_size = size_t (1) << (min_class_shift + i);
+        c.slab_blocks = static_cast<uint32_t> (slab_size / c.block_size);
+        if (c.slab_blocks < min_slab_blocks)
+            c.slab_blocks = min_slab_blocks;
+        c.slab_count = 0;
+#ifdef ZMQ_MSG_POOL_LOCK_FREE
+        c.top.store (0, std::memory_order_relaxed);
+#else
+        c.top = 0;
+#endif
+    }
+}
+
+zmq::msg_pool_t::~msg_pool_t ()
+{
+    for (uint32_t i = 0; i != class_count; i++) {
+        const size_class_t &c = _classes[i];
+        for (uint32_t j = 0; j != c.slab_count; j++)
+            _backend->deallocate (c.slabs[j]);
+    }
+}
+
+void *zmq::msg_pool_t::allocate (size_t size_)
+{
+    const size_t total = size_ + sizeof (header_t);
+    if (unlikely (total < size_))
+        return NULL;
+
+    const uint32_t size_class = size_class_of (total);
+    if (likely (size_class != unpooled)) {
+        size_class_t &c = _classes[size_class];
+        header_t *header = pop (c);
+        if (unlikely (!header))
+            header = grow (c);
+        if (likely (header != NULL))
+            return header + 1;
+    }
+
+    //  Too large for the pool, or the size class ran out of slabs.
+    header_t *header = static_cast<header_t *> (_backend->allocate (total));
+    if (!header)
+        return NULL;
+    header->size_class = unpooled;
+    header->node = _node < 0 ? 0 : _node;
+    return header + 1;
+}
+
+void zmq::msg_pool_t::deallocate (void *ptr_)
+{
+    if (!ptr_)
+        return;
+
+    header_t *header = static_cast<header_t *> (ptr_) - 1;
+    if (unlikely (header->size_class == unpooled)) {
+        _backend->deallocate (header);
+        return;
+    }
+
+    push (_classes[header->size_class], header->index, header->index);
+}
+
+int zmq::msg_pool_t::node_of (void *ptr_)
+{
+    return (static_cast<header_t *> (ptr_) - 1)->node;
+}
+
+uint32_t zmq::msg_pool_t::size_class_of (size_t size_)
+{
+    uint32_t size_class = 0;
+    for (size_t block_size = size_t (1) << min_class_shift; block_size < size_;
+         block_size <<= 1)
+        if (++size_class == class_count)
+            return unpooled;
+    return size_class;
+}
+
+zmq::msg_pool_t::header_t *
+zmq::msg_pool_t::block (const size_class_t &class_, uint32_t index_) const
+{
+    return reinterpret_cast<header_t *> (
+      class_.slabs[index_ / class_.slab_blocks]
+      + (index_ % class_.slab_blocks) * class_.block_size);
+}
+
+zmq::msg_pool_t::header_t *zmq::msg_pool_t::pop (size_class_t &class_)
+{
+#ifdef ZMQ_MSG_POOL_LOCK_FREE
+    uint64_t top = class_.top.load (std::memory_order_acquire);
+    while (true) {
+        const uint32_t index = static_cast<uint32_t> (top);
+        if (!index)
+            return NULL;
+        header_t *header = block (class_, index - 1);
+
+        //  If another thread pops the block concurrently the value read here
+        //  may be stale, but then the tag has changed and the swap fails.
+        const uint64_t next =
+          ((top >> 32) + 1) << 32
+          | header->next.load (std::memory_order_relaxed);
+        if (class_.top.compare_exchange_weak (top, next,
+                                              std::memory_order_acquire,
+                                              std::memory_order_acquire))
+            return header;
+    }
+#else
+    scoped_lock_t locker (_sync);
+    const uint32_t index = static_cast<uint32_t> (class_.top);
+    if (!index)
+        return NULL;
+    header_t *header = block (class_, index - 1);
+    class_.top = ((class_.top >> 32) + 1) << 32 | header->next;
+    return header;
+#endif
+}
+
+void zmq::msg_pool_t::push (size_class_t &class_,
+                            uint32_t first_,
+                            uint32_t last_)
+{
+    header_t *last = block (class_, last_);
+#ifdef ZMQ_MSG_POOL_LOCK_FREE
+    uint64_t top = class_.top.load (std::memory_order_relaxed);
+    do {
+        last->next.store (static_cast<uint32_t> (top),
+                          std::memory_order_relaxed);
+    } while (!class_.top.compare_exchange_weak (
+      top, ((top >> 32) + 1) << 32 | (first_ + 1), std::memory_order_release,
+      std::memory_order_relaxed));
+#else
+    scoped_lock_t locker (_sync);
+    last->next = static_cast<uint32_t> (class_.top);
+    class_.top = ((class_.top >> 32) + 1) << 32 | (first_ + 1);
+#endif
+}
+
+zmq::msg_pool_t::header_t *zmq::msg_pool_t::grow (size_class_t &class_)
+{
+    uint32_t first;
+    {
+        scoped_lock_t locker (_grow_sync);
+
+        if (class_.slab_count == max_slabs)
+            return NULL;
+        unsigned char *slab = static_cast<unsigned char *> (
+          _backend->allocate (class_.block_size * class_.slab_blocks));
+        if (!slab)
+            return NULL;
+        if (_node >= 0)
+            memset (slab, 0, class_.block_size * class_.slab_blocks);
+
+        first = class_.slab_count * class_.slab_blocks;
+        class_.slabs[class_.slab_count] = slab;
+
+        const uint32_t size_class =
+          static_cast<uint32_t> (&class_ - &_classes[0]);
+        for (uint32_t i = 0; i != class_.slab_blocks; i++) {
+            header_t *header = new (slab + i * class_.block_size) header_t;
+            header->size_class = size_class;
+            header->index = first + i;
+            header->node = _node < 0 ? 0 : _node;
+#ifdef ZMQ_MSG_POOL_LOCK_FREE
+            header->next.store (first + i + 2, std::memory_order_relaxed);
+#else
+            header->next = first + i + 2;
+#endif
+        }
+        class_.slab_count++;
+    }
+
+    //  Keep the first block for the caller and publish the rest.
+    if (class_.slab_blocks > 1)
+        push (class_, first + 1, first + class_.slab_blocks - 1);
+    return block (class_, first);
+}
+
+zmq::numa_msg_pool_t::numa_msg_pool_t (i_msg_allocator *backend_,
+                                        const std::vector<int> &cpu_nodes_) :
+    _cpu_nodes (cpu_nodes_)
+{
+    int nodes = 1;
+    for (size_t i = 0, size = _cpu_nodes.size (); i != size; i++)
+        if (_cpu_nodes[i] >= nodes)
+            nodes = _cpu_nodes[i] + 1;
+    for (int node = 0; node != nodes; node++) {
+        msg_pool_t *const pool = new (std::nothrow) msg_pool_t (backend_, node);
+        alloc_assert (pool);
+        _pools.push_back (pool);
+    }
+}
+
+zmq::numa_msg_pool_t::~numa_msg_pool_t ()
+{
+    for (size_t i = 0, size = _pools.size (); i != size; i++)
+        LIBZMQ_DELETE (_pools[i]);
+}
+
+void *zmq::numa_msg_pool_t::allocate (size_t size_)
+{
+    int node = 0;
+#if defined ZMQ_HAVE_LINUX && defined ZMQ_HAVE_SCHED_GETCPU
+    const int cpu = sched_getcpu ();
+    if (likely (cpu >= 0 && static_cast<size_t> (cpu) < _cpu_nodes.size ()))
+        node = _cpu_nodes[cpu];
+#endif
+    return _pools[node]->allocate (size_);
+}
+
+void zmq::numa_msg_pool_t::deallocate (void *ptr_)
+{
+    if (ptr_)
+        _pools[msg_pool_t::node_of (ptr_)]->deallocate (ptr_);
+}
+
+#if defined ZMQ_HAVE_LINUX && defined ZMQ_HAVE_SCHED_GETCPU
+//  Reads a list of numbers in the format of sysfs, such as "0-3,8-11".
+static bool read_list (const char *path_, std::vector<int> &values_)
+{
+    FILE *file = fopen (path_, "r");
+    if (!file)
+        return false;
+    char buffer[4096];
+    const bool ok = fgets (buffer, sizeof buffer, file) != NULL;
+    fclose (file);
+    if (!ok)
+        return false;
+
+    for (const char *p = buffer; *p >= '0' && *p <= '9';) {
+        char *end;
+        const long first = strtol (p, &end, 10);
+        long last = first;
+        if (*end == '-')
+            last = strtol (end + 1, &end, 10);
+        if (first < 0 || last < first || last >= 65536)
+            return false;
+        for (long value = first; value <= last; value++)
+            values_.push_back (static_cast<int> (value));
+        p = *end == ',' ? end + 1 : end;
+    }
+    return true;
+}
+#endif
+
+std::vector<int> zmq::numa_msg_pool_t::cpu_nodes ()
+{
+    std::vector<int> cpu_nodes;
+#if defined ZMQ_HAVE_LINUX && defined ZMQ_HAVE_SCHED_GETCPU
+    std::vector<int> nodes;
+    if (!read_list ("/sys/devices/system/node/online", nodes)
+        || nodes.size () < 2)
+        return cpu_nodes;
+
+    for (size_t i = 0, size = nodes.size (); i != size; i++) {
+        char path[64];
+        snprintf (path, sizeof path, "/sys/devices/system/node/node%d/cpulist",
+                  nodes[i]);
+        std::vector<int> cpus;
+        if (!read_list (path, cpus))
+            return std::vector<int> ();
+        for (size_t j = 0, count = cpus.size (); j != count; j++) {
+            if (static_cast<size_t> (cpus[j]) >= cpu_nodes.size ())
+                cpu_nodes.resize (cpus[j] + 1, 0);
+            cpu_nodes[cpus[j]] = nodes[i];
+        }
+    }
+#endif
+    return cpu_nodes;
+}
@@ -0,0 +1,181 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_MSG_ALLOCATOR_HPP_INCLUDED__
+#define __ZMQ_MSG_ALLOCATOR_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <vector>
+
+#include "i_msg_allocator.hpp"
+#include "macros.hpp"
+#include "mutex.hpp"
+#include "stdint.hpp"
+
+#if !defined ZMQ_FORCE_MUTEXES                                                 \
+  && ((defined __cplusplus && __cplusplus >= 201103L)                          \
+      || (defined _MSC_VER && _MSC_VER >= 1900))
+#define ZMQ_MSG_POOL_LOCK_FREE
+#include <atomic>
+#endif
+
+namespace zmq
+{
+//  Allocator forwarding to a pair of user supplied functions, or to
+//  malloc/free when none are given.
+
+class heap_msg_allocator_t ZMQ_FINAL : public i_msg_allocator
+{
+  public:
+    typedef void *(allocate_fn) (size_t size_, void *hint_);
+    typedef void (deallocate_fn) (void *ptr_, void *hint_);
+
+    heap_msg_allocator_t (allocate_fn *allocate_ = NULL,
+                          deallocate_fn *deallocate_ = NULL,
+                          void *hint_ = NULL);
+
+    //  i_msg_allocator interface implementation.
+    void *allocate (size_t size_) ZMQ_FINAL;
+    void deallocate (void *ptr_) ZMQ_FINAL;
+
+  private:
+    allocate_fn *const _allocate;
+    deallocate_fn *const _deallocate;
+    void *const _hint;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (heap_msg_allocator_t)
+};
+
+//  Pool of fixed-size blocks grouped in power-of-two size classes. Each
+//  class keeps its free blocks on a lock-free stack, so that allocations
+//  and releases never block, no matter whether the block is released by
+//  the thread that allocated it (typical for the I/O thread recycling its
+//  own buffers) or by another one (typical for messages handed over
+//  between application and I/O threads). Blocks are carved from slabs
+//  obtained from the backend allocator and are only returned to it when
+//  the pool is destroyed. Requests larger than the largest class are
+//  passed to the backend directly.
+//
+//  A pool serving a single NUMA node touches each slab as it carves it, so
+//  that the kernel places its pages on the node of the carving thread.
+
+class msg_pool_t ZMQ_FINAL : public i_msg_allocator
+{
+  public:
+    explicit msg_pool_t (i_msg_allocator *backend_, int node_ = -1);
+    ~msg_pool_t () ZMQ_OVERRIDE;
+
+    //  i_msg_allocator interface implementation.
+    void *allocate (size_t size_) ZMQ_FINAL;
+    void deallocate (void *ptr_) ZMQ_FINAL;
+
+    //  Returns the node of the pool the memory was allocated from, 0 for
+    //  a pool serving no particular node.
+    static int node_of (void *ptr_);
+
+  private:
+    enum
+    {
+        //  Blocks of 128B up to 64kB, including the block header.
+        min_class_shift = 7,
+        class_count = 10,
+
+        //  Slabs hold at least min_slab_blocks blocks and are at least
+        //  slab_size bytes large.
+        slab_size = 65536,
+        min_slab_blocks = 8,
+        max_slabs = 1024,
+
+        //  Class of blocks allocated from the backend one by one.
+        unpooled = 0xffffffff
+    };
+
+    //  Precedes every block handed out by the pool. Its size keeps the
+    //  user part aligned the same way as the memory from the backend.
+    struct header_t
+    {
+        //  Index (plus one) of the next block on the free stack.
+#ifdef ZMQ_MSG_POOL_LOCK_FREE
+        std::atomic<uint32_t> next;
+#else
+        uint32_t next;
+#endif
+        uint32_t size_class;
+        //  Position of the block within its class.
+        uint32_t index;
+        uint32_t node;
+    };
+
+    struct size_class_t
+    {
+        size_t block_size;
+        uint32_t slab_blocks;
+
+        //  Slabs are only ever appended, under _grow_sync. A slot is
+        //  written before any block of the slab becomes reachable through
+        //  the free stack, so readers do not need additional fencing.
+        unsigned char *slabs[max_slabs];
+        uint32_t slab_count;
+
+        //  Free stack. The low 32 bits hold the index (plus one) of the top
+        //  block, the high 32 bits a tag incremented on every update to
+        //  defeat the ABA problem.
+#ifdef ZMQ_MSG_POOL_LOCK_FREE
+        std::atomic<uint64_t> top;
+#else
+        uint64_t top;
+#endif
+    };
+
+    static uint32_t size_class_of (size_t size_);
+    header_t *block (const size_class_t &class_, uint32_t index_) const;
+
+    header_t *pop (size_class_t &class_);
+    void push (size_class_t &class_, uint32_t first_, uint32_t last_);
+
+    //  Allocates a new slab for the class, pushes all but one of its blocks
+    //  on the free stack and returns the remaining one. Returns NULL if the
+    //  class is exhausted or the backend failed.
+    header_t *grow (size_class_t &class_);
+
+    i_msg_allocator *const _backend;
+    const int _node;
+    size_class_t _classes[class_count];
+    mutex_t _grow_sync;
+
+#ifndef ZMQ_MSG_POOL_LOCK_FREE
+    mutex_t _sync;
+#endif
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (msg_pool_t)
+};
+
+//  Pools for each NUMA node, allocating from the pool of the node the
+//  calling thread runs on. I/O threads pinned to the CPUs of a node thus
+//  decode messages into memory local to it. Memory goes back to the pool
+//  it came from, whichever thread releases it.
+
+class numa_msg_pool_t ZMQ_FINAL : public i_msg_allocator
+{
+  public:
+    //  cpu_nodes_ holds the node of each CPU.
+    numa_msg_pool_t (i_msg_allocator *backend_,
+                     const std::vector<int> &cpu_nodes_);
+    ~numa_msg_pool_t () ZMQ_OVERRIDE;
+
+    //  i_msg_allocator interface implementation.
+    void *allocate (size_t size_) ZMQ_FINAL;
+    void deallocate (void *ptr_) ZMQ_FINAL;
+
+    //  Returns the node of each CPU of the machine, or nothing if it has a
+    //  single node, or its nodes are not known.
+    static std::vector<int> cpu_nodes ();
+
+  private:
+    const std::vector<int> _cpu_nodes;
+    std::vector<msg_pool_t *> _pools;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (numa_msg_pool_t)
+};
+}
+
+#endif
@@ -54,6 +54,12 @@ class norm_engine_t ZMQ_FINAL : public io_object_t, public i_engine
 
     void zap_msg_available () ZMQ_FINAL {}
 
+    void crypto_done (crypto_job_t *) ZMQ_FINAL {}
+
+    bool can_migrate () const ZMQ_FINAL { return false; }
+    void migrate_out () ZMQ_FINAL {}
+    void migrate_in (zmq::io_thread_t *) ZMQ_FINAL {}
+
     const endpoint_uri_pair_t &get_endpoint () const ZMQ_FINAL;
 
     // i_poll_events interface implementation.
@@ -137,6 +137,35 @@ void zmq::object_t::process_command (const command_t &cmd_)
             process_conn_failed ();
             break;
 
+        case command_t::resolved:
+            process_resolved (cmd_.args.resolved.address,
+                              cmd_.args.resolved.error);
+            process_seqnum ();
+            break;
+
+        case command_t::crypto_done:
+            process_crypto_done (cmd_.args.crypto_done.job);
+            process_seqnum ();
+            break;
+
+        case command_t::migrate:
+            process_migrate (cmd_.args.migrate.session,
+                             cmd_.args.migrate.pipe);
+            break;
+
+        case command_t::migrate_sync:
+            process_migrate_sync (cmd_.args.migrate_sync.session,
+                                  cmd_.args.migrate_sync.tid);
+            break;
+
+        case command_t::migrate_ack:
+            process_migrate_ack ();
+            break;
+
+        case command_t::migrated:
+            process_migrated (cmd_.args.migrated.cancelled);
+            break;
+
         case command_t::done:
         default:
             zmq_assert (false);
@@ -408,6 +437,49 @@ void zmq::object_t::send_done ()
     _ctx->send_command (ctx_t::term_tid, cmd);
 }
 
+void zmq::object_t::send_migrate (io_thread_t *destination_,
+                                  object_t *session_,
+                                  object_t *pipe_)
+{
+    command_t cmd;
+    cmd.destination = destination_;
+    cmd.type = command_t::migrate;
+    cmd.args.migrate.session = session_;
+    cmd.args.migrate.pipe = pipe_;
+    send_command (cmd);
+}
+
+void zmq::object_t::send_migrate_sync (object_t *destination_,
+                                       object_t *session_,
+                                       uint32_t tid_)
+{
+    command_t cmd;
+    cmd.destination = destination_;
+    cmd.type = command_t::migrate_sync;
+    cmd.args.migrate_sync.session = session_;
+    cmd.args.migrate_sync.tid = tid_;
+    send_command (cmd);
+}
+
+void zmq::object_t::send_migrate_ack (object_t *destination_, uint32_t tid_)
+{
+    command_t cmd;
+    cmd.destination = destination_;
+    cmd.type = command_t::migrate_ack;
+    _ctx->send_command (tid_, cmd);
+}
+
+void zmq::object_t::send_migrated (object_t *destination_,
+                                   uint32_t tid_,
+                                   bool cancelled_)
+{
+    command_t cmd;
+    cmd.destination = destination_;
+    cmd.type = command_t::migrated;
+    cmd.args.migrated.cancelled = cancelled_;
+    _ctx->send_command (tid_, cmd);
+}
+
 void zmq::object_t::process_stop ()
 {
     zmq_assert (false);
@@ -517,6 +589,39 @@ void zmq::object_t::process_conn_failed ()
     zmq_assert (false);
 }
 
+void zmq::object_t::process_resolved (tcp_address_t *, int)
+{
+    zmq_assert (false);
+}
+
+void zmq::object_t::process_crypto_done (crypto_job_t *)
+{
+    zmq_assert (false);
+}
+
+void zmq::object_t::process_migrate (object_t *, object_t *)
+{
+    zmq_assert (false);
+}
+
+void zmq::object_t::process_migrate_sync (object_t *session_, uint32_t tid_)
+{
+    //  Any object sending commands to a moving session gets this. Commands
+    //  it sent before are ahead of the acknowledgement, later ones go to
+    //  the new thread of the session.
+    send_migrate_ack (session_, tid_);
+}
+
+void zmq::object_t::process_migrate_ack ()
+{
+    zmq_assert (false);
+}
+
+void zmq::object_t::process_migrated (bool)
+{
+    zmq_assert (false);
+}
+
 void zmq::object_t::send_command (const command_t &cmd_)
 {
     _ctx->send_command (cmd_.destination->get_tid (), cmd_);
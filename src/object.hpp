@@ -21,6 +21,8 @@ class socket_base_t;
 class session_base_t;
 class io_thread_t;
 class own_t;
+class tcp_address_t;
+class crypto_job_t;
 
 //  Base class for all objects that participate in inter-thread
 //  communication.
@@ -91,6 +93,20 @@ class object_t
     void send_reaped ();
     void send_done ();
     void send_conn_failed (zmq::session_base_t *destination_);
+    void send_migrate (zmq::io_thread_t *destination_,
+                       zmq::object_t *session_,
+                       zmq::object_t *pipe_);
+    void send_migrate_sync (zmq::object_t *destination_,
+                            zmq::object_t *session_,
+                            uint32_t tid_);
+
+    //  Unlike other commands, these are sent to the thread tid_ rather
+    //  than to the one the destination belongs to, as a moving session
+    //  tells its thread apart from the one it moves to with them.
+    void send_migrate_ack (zmq::object_t *destination_, uint32_t tid_);
+    void send_migrated (zmq::object_t *destination_,
+                        uint32_t tid_,
+                        bool cancelled_);
 
 
     //  These handlers can be overridden by the derived objects. They are
@@ -120,6 +136,13 @@ class object_t
     virtual void process_reap (zmq::socket_base_t *socket_);
     virtual void process_reaped ();
     virtual void process_conn_failed ();
+    virtual void process_resolved (zmq::tcp_address_t *address_, int error_);
+    virtual void process_crypto_done (zmq::crypto_job_t *job_);
+    virtual void process_migrate (zmq::object_t *session_,
+                                  zmq::object_t *pipe_);
+    virtual void process_migrate_sync (zmq::object_t *session_, uint32_t tid_);
+    virtual void process_migrate_ack ();
+    virtual void process_migrated (bool cancelled_);
 
 
     //  Special handler called after a command that requires a seqnum
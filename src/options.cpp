@@ -220,7 +220,18 @@ zmq::options_t::options_t () :
     multicast_loop (true),
     in_batch_size (8192),
     out_batch_size (8192),
+    out_iov_threshold (1024),
+    zerocopy_threshold (-1),
+    udp_batch_size (16),
+    spin_time (0),
+    spin_adaptive (false),
+    cork_delay (0),
+    cork_size (8192),
+    memfd_threshold (-1),
+    rebalance_ivl (0),
+    shm_spin (0),
     zero_copy (true),
+    msg_allocator (NULL),
     router_notify (0),
     monitor_event_version (1),
     wss_trust_system (false),
@@ -792,6 +803,74 @@ int zmq::options_t::setsockopt (int option_,
                 return 0;
             }
             break;
+
+        case ZMQ_OUT_IOV_THRESHOLD:
+            if (is_int && value >= -1) {
+                out_iov_threshold = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_ZEROCOPY_THRESHOLD:
+            if (is_int && value >= -1) {
+                zerocopy_threshold = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_UDP_BATCH_SIZE:
+            //  Linux caps the batch at UIO_MAXIOV datagrams.
+            if (is_int && value > 0 && value <= 1024) {
+                udp_batch_size = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_SPIN_TIME:
+            if (is_int && value >= 0) {
+                spin_time = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_SPIN_ADAPTIVE:
+            return do_setsockopt_int_as_bool_strict (optval_, optvallen_,
+                                                     &spin_adaptive);
+
+        case ZMQ_CORK_DELAY:
+            if (is_int && value >= 0) {
+                cork_delay = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CORK_SIZE:
+            if (is_int && value > 0) {
+                cork_size = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_MEMFD_THRESHOLD:
+            if (is_int && value >= -1) {
+                memfd_threshold = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_REBALANCE_IVL:
+            if (is_int && value >= 0) {
+                rebalance_ivl = value;
+                return 0;
+            }
+            break;
+
+        case ZMQ_SHM_SPIN:
+            if (is_int && value >= 0) {
+                shm_spin = value;
+                return 0;
+            }
+            break;
 #ifdef ZMQ_HAVE_WSS
         case ZMQ_WSS_KEY_PEM:
             // TODO: check if valid certificate
@@ -1346,6 +1425,76 @@ int zmq::options_t::getsockopt (int option_,
             }
             break;
 
+        case ZMQ_OUT_IOV_THRESHOLD:
+            if (is_int) {
+                *value = out_iov_threshold;
+                return 0;
+            }
+            break;
+
+        case ZMQ_ZEROCOPY_THRESHOLD:
+            if (is_int) {
+                *value = zerocopy_threshold;
+                return 0;
+            }
+            break;
+
+        case ZMQ_UDP_BATCH_SIZE:
+            if (is_int) {
+                *value = udp_batch_size;
+                return 0;
+            }
+            break;
+
+        case ZMQ_SPIN_TIME:
+            if (is_int) {
+                *value = spin_time;
+                return 0;
+            }
+            break;
+
+        case ZMQ_SPIN_ADAPTIVE:
+            if (is_int) {
+                *value = spin_adaptive;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CORK_DELAY:
+            if (is_int) {
+                *value = cork_delay;
+                return 0;
+            }
+            break;
+
+        case ZMQ_CORK_SIZE:
+            if (is_int) {
+                *value = cork_size;
+                return 0;
+            }
+            break;
+
+        case ZMQ_MEMFD_THRESHOLD:
+            if (is_int) {
+                *value = memfd_threshold;
+                return 0;
+            }
+            break;
+
+        case ZMQ_REBALANCE_IVL:
+            if (is_int) {
+                *value = rebalance_ivl;
+                return 0;
+            }
+            break;
+
+        case ZMQ_SHM_SPIN:
+            if (is_int) {
+                *value = shm_spin;
+                return 0;
+            }
+            break;
+
 #ifdef ZMQ_HAVE_NORM
         case ZMQ_NORM_MODE:
             if (is_int) {
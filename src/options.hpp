@@ -31,6 +31,8 @@
 
 namespace zmq
 {
+class i_msg_allocator;
+
 struct options_t
 {
     options_t ();
@@ -255,9 +257,55 @@ struct options_t
     //  unnecessary network stack traversals.
     int out_batch_size;
 
+    //  Message bodies of at least this size are written to the wire
+    //  straight from the message instead of being copied to the output
+    //  batch. -1 means bodies are always copied.
+    int out_iov_threshold;
+
+    //  Message bodies of at least this size are sent over TCP without
+    //  copying them into the kernel (MSG_ZEROCOPY). -1 disables it.
+    int zerocopy_threshold;
+
+    //  Maximal number of datagrams sent or received by a single system
+    //  call on UDP sockets.
+    int udp_batch_size;
+
+    //  Maximal time, in microseconds, a blocking receive spins waiting for
+    //  a message before going to sleep. 0 means no spinning.
+    int spin_time;
+
+    //  If true, the spin time is tuned to how long the socket usually
+    //  waits for messages, up to spin_time.
+    bool spin_adaptive;
+
+    //  Maximal time, in microseconds, stream engines hold back small
+    //  batches of outgoing messages waiting for more to write together.
+    //  0 means batches are written at once.
+    int cork_delay;
+
+    //  Held back batches are written as soon as they reach this size.
+    int cork_size;
+
+    //  Message frames of at least this size are passed to ipc:// peers in
+    //  a memfd rather than through the socket. -1 disables it.
+    int memfd_threshold;
+
+    //  Interval, in milliseconds, at which sessions check whether their
+    //  engine would be better off on a less busy I/O thread. 0 disables
+    //  moving engines between I/O threads.
+    int rebalance_ivl;
+
+    //  Microseconds an shm:// engine spins on an empty ring before waiting
+    //  for its peer to signal it. 0 disables spinning.
+    int shm_spin;
+
     // Use zero copy strategy for storing message content when decoding.
     bool zero_copy;
 
+    //  Allocator for message contents and decoder buffers, owned by the
+    //  context. NULL means malloc/free.
+    i_msg_allocator *msg_allocator;
+
     // Router socket ZMQ_NOTIFY_CONNECT/ZMQ_NOTIFY_DISCONNECT notifications
     int router_notify;
 
@@ -125,6 +125,16 @@ bool zmq::own_t::is_terminating () const
     return _terminating;
 }
 
+zmq::own_t *zmq::own_t::get_owner () const
+{
+    return _owner;
+}
+
+bool zmq::own_t::is_settled () const
+{
+    return _owned.empty () && _processed_seqnum == _sent_seqnum.get ();
+}
+
 void zmq::own_t::process_term (int linger_)
 {
     //  Double termination should never happen.
@@ -59,6 +59,13 @@ class own_t : public object_t
     //  Returns true if the object is in process of termination.
     bool is_terminating () const;
 
+    //  Returns the object owning this one.
+    own_t *get_owner () const;
+
+    //  Returns true if the object owns no other objects and has processed
+    //  all the commands announced by inc_seqnum.
+    bool is_settled () const;
+
     //  Derived object destroys own_t. There's no point in allowing
     //  others to invoke the destructor. At the same time, it has to be
     //  virtual so that generic own_t deallocation mechanism destroys
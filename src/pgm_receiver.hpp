@@ -34,6 +34,10 @@ class pgm_receiver_t ZMQ_FINAL : public io_object_t, public i_engine
     bool restart_input ();
     void restart_output ();
     void zap_msg_available () {}
+    void crypto_done (crypto_job_t *) {}
+    bool can_migrate () const { return false; }
+    void migrate_out () {}
+    void migrate_in (zmq::io_thread_t *) {}
     const endpoint_uri_pair_t &get_endpoint () const;
 
     //  i_poll_events interface implementation.
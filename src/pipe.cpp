@@ -36,11 +36,14 @@ int zmq::pipepair (object_t *parents_[2],
         upipe2 = new (std::nothrow) upipe_normal_t ();
     alloc_assert (upipe2);
 
-    pipes_[0] = new (std::nothrow)
-      pipe_t (parents_[0], upipe1, upipe2, hwms_[1], hwms_[0], conflate_[0]);
+    pipe_stats_t *stats = new (std::nothrow) pipe_stats_t;
+    alloc_assert (stats);
+
+    pipes_[0] = new (std::nothrow) pipe_t (parents_[0], upipe1, upipe2, hwms_[1],
+                                           hwms_[0], conflate_[0], stats, 0);
     alloc_assert (pipes_[0]);
-    pipes_[1] = new (std::nothrow)
-      pipe_t (parents_[1], upipe2, upipe1, hwms_[0], hwms_[1], conflate_[1]);
+    pipes_[1] = new (std::nothrow) pipe_t (parents_[1], upipe2, upipe1, hwms_[0],
+                                           hwms_[1], conflate_[1], stats, 1);
     alloc_assert (pipes_[1]);
 
     pipes_[0]->set_peer (pipes_[1]);
@@ -77,7 +80,9 @@ zmq::pipe_t::pipe_t (object_t *parent_,
                      upipe_t *outpipe_,
                      int inhwm_,
                      int outhwm_,
-                     bool conflate_) :
+                     bool conflate_,
+                     pipe_stats_t *stats_,
+                     int end_) :
     object_t (parent_),
     _in_pipe (inpipe_),
     _out_pipe (outpipe_),
@@ -94,15 +99,23 @@ zmq::pipe_t::pipe_t (object_t *parent_,
     _sink (NULL),
     _state (active),
     _delay (true),
+    _flush_deferred (false),
     _server_socket_routing_id (0),
-    _conflate (conflate_)
+    _conflate (conflate_),
+    _stats (stats_),
+    _own_stats (stats_->ends[end_]),
+    _peer_stats (stats_->ends[1 - end_])
 {
     _disconnect_msg.init ();
+    _own_stats.conflate = conflate_;
 }
 
 zmq::pipe_t::~pipe_t ()
 {
     _disconnect_msg.close ();
+
+    if (!_stats->refs.sub (1))
+        LIBZMQ_DELETE (_stats);
 }
 
 void zmq::pipe_t::set_peer (pipe_t *peer_)
@@ -167,6 +180,13 @@ bool zmq::pipe_t::check_read ()
     return true;
 }
 
+//  Join and leave commands of DISH sockets travel through the pipes as
+//  well, but carry no data.
+static size_t data_size (const zmq::msg_t *msg_)
+{
+    return msg_->is_join () || msg_->is_leave () ? 0 : msg_->size ();
+}
+
 bool zmq::pipe_t::read (msg_t *msg_)
 {
     if (unlikely (!_in_active))
@@ -195,8 +215,11 @@ bool zmq::pipe_t::read (msg_t *msg_)
         return false;
     }
 
-    if (!(msg_->flags () & msg_t::more) && !msg_->is_routing_id ())
+    if (!(msg_->flags () & msg_t::more) && !msg_->is_routing_id ()) {
         _msgs_read++;
+        _own_stats.msgs_read.add (1);
+    }
+    _own_stats.bytes_read.add (data_size (msg_));
 
     if (_lwm > 0 && _msgs_read % _lwm == 0)
         send_activate_write (_peer, _msgs_read);
@@ -213,6 +236,7 @@ bool zmq::pipe_t::check_write ()
 
     if (unlikely (full)) {
         _out_active = false;
+        _own_stats.hwm_hits.add (1);
         return false;
     }
 
@@ -226,9 +250,12 @@ bool zmq::pipe_t::write (const msg_t *msg_)
 
     const bool more = (msg_->flags () & msg_t::more) != 0;
     const bool is_routing_id = msg_->is_routing_id ();
+    _own_stats.bytes_written.add (data_size (msg_));
     _out_pipe->write (*msg_, more);
-    if (!more && !is_routing_id)
+    if (!more && !is_routing_id) {
         _msgs_written++;
+        _own_stats.msgs_written.add (1);
+    }
 
     return true;
 }
@@ -248,6 +275,8 @@ void zmq::pipe_t::rollback () const
 
 void zmq::pipe_t::flush ()
 {
+    _flush_deferred = false;
+
     //  The peer does not exist anymore at this point.
     if (_state == term_ack_sent)
         return;
@@ -256,6 +285,14 @@ void zmq::pipe_t::flush ()
         send_activate_read (_peer);
 }
 
+bool zmq::pipe_t::defer_flush ()
+{
+    if (_flush_deferred)
+        return false;
+    _flush_deferred = true;
+    return true;
+}
+
 void zmq::pipe_t::process_activate_read ()
 {
     if (!_in_active && (_state == active || _state == waiting_for_delimiter)) {
@@ -283,8 +320,10 @@ void zmq::pipe_t::process_hiccup (void *pipe_)
     _out_pipe->flush ();
     msg_t msg;
     while (_out_pipe->read (&msg)) {
-        if (!(msg.flags () & msg_t::more))
+        if (!(msg.flags () & msg_t::more)) {
             _msgs_written--;
+            _own_stats.msgs_discarded.add (1);
+        }
         const int rc = msg.close ();
         errno_assert (rc == 0);
     }
@@ -384,6 +423,11 @@ void zmq::pipe_t::set_nodelay ()
     this->_delay = false;
 }
 
+bool zmq::pipe_t::is_active () const
+{
+    return _state == active;
+}
+
 void zmq::pipe_t::terminate (bool delay_)
 {
     //  Overload the value specified at pipe creation.
@@ -600,3 +644,49 @@ void zmq::pipe_t::send_hiccup_msg (const std::vector<unsigned char> &hiccup_)
         flush ();
     }
 }
+
+void zmq::pipe_t::count_dropped ()
+{
+    _own_stats.msgs_dropped.add (1);
+}
+
+void zmq::pipe_t::count_engine_read ()
+{
+    _own_stats.engine_reads.add (1);
+}
+
+void zmq::pipe_t::count_engine_write ()
+{
+    _own_stats.engine_writes.add (1);
+}
+
+//  Number of messages written to one end and not yet read at the other.
+static uint64_t queued (const zmq::pipe_end_stats_t &writer_,
+                        const zmq::pipe_end_stats_t &reader_)
+{
+    //  Read the reader first so that racing with both ends does not make
+    //  the queue look negative.
+    const uint64_t read = reader_.msgs_read.get ();
+    const uint64_t written =
+      writer_.msgs_written.get () - writer_.msgs_discarded.get ();
+    if (written <= read)
+        return 0;
+    return reader_.conflate ? 1 : written - read;
+}
+
+void zmq::pipe_t::get_stats (zmq_socket_stats_t *stats_) const
+{
+    stats_->msgs_in = _own_stats.msgs_read.get ();
+    stats_->bytes_in = _own_stats.bytes_read.get ();
+    stats_->msgs_out = _own_stats.msgs_written.get ();
+    stats_->bytes_out = _own_stats.bytes_written.get ();
+    stats_->queued_in = queued (_peer_stats, _own_stats);
+    stats_->queued_out = queued (_own_stats, _peer_stats);
+    stats_->hwm_hits = _own_stats.hwm_hits.get ();
+    stats_->drops =
+      _own_stats.msgs_dropped.get () + _own_stats.msgs_discarded.get ();
+
+    //  The engine, if any, feeds the other end of the pipe.
+    stats_->engine_reads = _peer_stats.engine_reads.get ();
+    stats_->engine_writes = _peer_stats.engine_writes.get ();
+}
@@ -12,6 +12,7 @@
 #include "options.hpp"
 #include "endpoint.hpp"
 #include "msg.hpp"
+#include "pipe_stats.hpp"
 
 namespace zmq
 {
@@ -89,6 +90,11 @@ class pipe_t ZMQ_FINAL : public object_t,
     //  Flush the messages downstream.
     void flush ();
 
+    //  Marks the pipe to be flushed at the end of a batch of sends.
+    //  Returns false if it is marked already. The mark is cleared by
+    //  flush.
+    bool defer_flush ();
+
     //  Temporarily disconnects the inbound message stream and drops
     //  all the messages on the fly. Causes 'hiccuped' event to be generated
     //  in the peer.
@@ -97,6 +103,9 @@ class pipe_t ZMQ_FINAL : public object_t,
     //  Ensure the pipe won't block on receiving pipe_term.
     void set_nodelay ();
 
+    //  Returns true if the termination of the pipe has not begun.
+    bool is_active () const;
+
     //  Ask pipe to terminate. The termination will happen asynchronously
     //  and user will be notified about actual deallocation by 'terminated'
     //  event. If delay is true, the pending messages will be processed
@@ -120,6 +129,18 @@ class pipe_t ZMQ_FINAL : public object_t,
 
     void send_stats_to_peer (own_t *socket_base_);
 
+    //  Counts a message not written to the pipe because it was full.
+    void count_dropped ();
+
+    //  Count system calls of the engine feeding this end of the pipe.
+    void count_engine_read ();
+    void count_engine_write ();
+
+    //  Fills in the statistics as seen from this end of the pipe. Unlike
+    //  all other methods, this one may be called from any thread as long
+    //  as the pipe is not deallocated meanwhile.
+    void get_stats (zmq_socket_stats_t *stats_) const;
+
     void send_disconnect_msg ();
     void set_disconnect_msg (const std::vector<unsigned char> &disconnect_);
 
@@ -151,7 +172,9 @@ class pipe_t ZMQ_FINAL : public object_t,
             upipe_t *outpipe_,
             int inhwm_,
             int outhwm_,
-            bool conflate_);
+            bool conflate_,
+            pipe_stats_t *stats_,
+            int end_);
 
     //  Pipepair uses this function to let us know about
     //  the peer pipe object.
@@ -218,6 +241,10 @@ class pipe_t ZMQ_FINAL : public object_t,
     //  asks us to.
     bool _delay;
 
+    //  True if messages were written during a batch and the pipe was
+    //  not flushed since.
+    bool _flush_deferred;
+
     //  Routing id of the writer. Used uniquely by the reader side.
     blob_t _router_socket_routing_id;
 
@@ -238,6 +265,11 @@ class pipe_t ZMQ_FINAL : public object_t,
     // Disconnect msg
     msg_t _disconnect_msg;
 
+    //  Statistics shared with the peer, and the counters of either end.
+    pipe_stats_t *_stats;
+    pipe_end_stats_t &_own_stats;
+    const pipe_end_stats_t &_peer_stats;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (pipe_t)
 };
 
@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_PIPE_STATS_HPP_INCLUDED__
+#define __ZMQ_PIPE_STATS_HPP_INCLUDED__
+
+#include "atomic_counter.hpp"
+#include "macros.hpp"
+#include "stdint.hpp"
+
+#if !defined ZMQ_FORCE_MUTEXES                                                 \
+  && ((defined __cplusplus && __cplusplus >= 201103L)                          \
+      || (defined _MSC_VER && _MSC_VER >= 1900))
+#define ZMQ_STATS_COUNTER_CXX11
+#include <atomic>
+#endif
+
+namespace zmq
+{
+//  Statistics counter written by a single thread and read by any thread.
+//  As there is only one writer, updating it needs no read-modify-write
+//  instruction; all accesses are relaxed. Readers get a recent value, not
+//  one that is consistent with other counters.
+//
+//  Without C++11 atomics the counter is a plain volatile integer, so on
+//  32-bit platforms readers may see a torn value.
+
+class stats_counter_t
+{
+  public:
+    stats_counter_t () ZMQ_NOEXCEPT : _value (0) {}
+
+    //  Must only be called by the thread owning the counter.
+    void add (uint64_t increment_) ZMQ_NOEXCEPT
+    {
+#ifdef ZMQ_STATS_COUNTER_CXX11
+        _value.store (_value.load (std::memory_order_relaxed) + increment_,
+                      std::memory_order_relaxed);
+#else
+        _value = _value + increment_;
+#endif
+    }
+
+    uint64_t get () const ZMQ_NOEXCEPT
+    {
+#ifdef ZMQ_STATS_COUNTER_CXX11
+        return _value.load (std::memory_order_relaxed);
+#else
+        return _value;
+#endif
+    }
+
+  private:
+#ifdef ZMQ_STATS_COUNTER_CXX11
+    std::atomic<uint64_t> _value;
+#else
+    volatile uint64_t _value;
+#endif
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (stats_counter_t)
+};
+
+//  Counters of one end of a pipe pair. They are written by the thread
+//  owning that end: the socket, or the session for connections over
+//  a transport.
+struct pipe_end_stats_t
+{
+    //  Complete messages and bytes of all the message parts.
+    stats_counter_t msgs_written;
+    stats_counter_t bytes_written;
+    stats_counter_t msgs_read;
+    stats_counter_t bytes_read;
+
+    //  Times writing found the pipe at its high water mark.
+    stats_counter_t hwm_hits;
+
+    //  Messages that were not written because the pipe was full, and
+    //  written messages discarded again on reconnection.
+    stats_counter_t msgs_dropped;
+    stats_counter_t msgs_discarded;
+
+    //  System calls of the engine attached to the session.
+    stats_counter_t engine_reads;
+    stats_counter_t engine_writes;
+
+    //  Whether the inbound pipe of this end keeps only the last message.
+    bool conflate;
+};
+
+//  Statistics of a pipe pair, shared by its two pipes and freed when both
+//  of them are gone.
+struct pipe_stats_t
+{
+    pipe_stats_t () : refs (2) {}
+
+    pipe_end_stats_t ends[2];
+    atomic_counter_t refs;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (pipe_stats_t)
+};
+}
+
+#endif
@@ -125,8 +125,10 @@ void zmq::poll_t::loop ()
         }
 
         //  Wait for events.
+        timeout = begin_wait (timeout);
         int rc = poll (&pollset[0], static_cast<nfds_t> (pollset.size ()),
                        timeout ? timeout : -1);
+        end_wait ();
         if (rc == -1) {
             errno_assert (errno == EINTR);
             continue;
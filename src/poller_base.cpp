@@ -5,6 +5,11 @@
 #include "i_poll_events.hpp"
 #include "err.hpp"
 
+zmq::poller_base_t::poller_base_t () : _busy_time (0)
+{
+    _window_start = _busy_start = clock_t::now_us ();
+}
+
 zmq::poller_base_t::~poller_base_t ()
 {
     //  Make sure there is no more load on the shutdown.
@@ -16,6 +21,11 @@ int zmq::poller_base_t::get_load () const
     return _load.get ();
 }
 
+int zmq::poller_base_t::get_busy () const
+{
+    return _busy.get ();
+}
+
 void zmq::poller_base_t::adjust_load (int amount_)
 {
     if (amount_ > 0)
@@ -26,20 +36,21 @@ void zmq::poller_base_t::adjust_load (int amount_)
 
 void zmq::poller_base_t::add_timer (int timeout_, i_poll_events *sink_, int id_)
 {
-    uint64_t expiration = _clock.now_ms () + timeout_;
-    timer_info_t info = {sink_, id_};
-    _timers.insert (timers_t::value_type (expiration, info));
+    const uint64_t now = _clock.now_ms ();
+    timer_wheel_t::node_t *timer =
+      new (std::nothrow) timer_wheel_t::node_t (sink_, id_);
+    alloc_assert (timer);
+    _timers.add (timer, now + timeout_, now);
 }
 
 void zmq::poller_base_t::cancel_timer (i_poll_events *sink_, int id_)
 {
-    //  Complexity of this operation is O(n). We assume it is rarely used.
-    for (timers_t::iterator it = _timers.begin (), end = _timers.end ();
-         it != end; ++it)
-        if (it->second.sink == sink_ && it->second.id == id_) {
-            _timers.erase (it);
-            return;
-        }
+    timer_wheel_t::node_t *timer = _timers.find (sink_, id_);
+    if (timer) {
+        _timers.remove (timer);
+        LIBZMQ_DELETE (timer);
+        return;
+    }
 
     //  We should generally never get here. Calling 'cancel_timer ()' on
     //  an already expired or canceled timer (or even worse - on a timer which
@@ -51,6 +62,16 @@ void zmq::poller_base_t::cancel_timer (i_poll_events *sink_, int id_)
     //  As soon as that is resolved an 'assert (false)' should be put here.
 }
 
+int zmq::poller_base_t::timer_left (i_poll_events *sink_, int id_)
+{
+    const timer_wheel_t::node_t *timer = _timers.find (sink_, id_);
+    if (!timer)
+        return 0;
+    const uint64_t now = _clock.now_ms ();
+    return timer->expiry () > now ? static_cast<int> (timer->expiry () - now)
+                                  : 1;
+}
+
 uint64_t zmq::poller_base_t::execute_timers ()
 {
     //  Fast track.
@@ -60,35 +81,51 @@ uint64_t zmq::poller_base_t::execute_timers ()
     //  Get the current time.
     const uint64_t current = _clock.now_ms ();
 
-    //  Execute the timers that are already due.
-    uint64_t res = 0;
-    timer_info_t timer_temp;
-    timers_t::iterator it;
-
-    do {
-        it = _timers.begin ();
-
-        //  If we have to wait to execute the item, same will be true for
-        //  all the following items because multimap is sorted. Thus we can
-        //  stop checking the subsequent timers.
-        if (it->first > current) {
-            res = it->first - current;
-            break;
-        }
-
-        //  Save and remove the timer because timer_event() call might delete
-        //  exactly this timer and then the iterator will be invalid.
-        timer_temp = it->second;
-        _timers.erase (it);
+    //  Execute the timers that are already due. Each timer is unlinked
+    //  before it is triggered because timer_event() may add or cancel
+    //  timers, including ones due at the same time.
+    timer_wheel_t::node_t *timer;
+    while ((timer = _timers.pop_due (current)) != NULL) {
+        i_poll_events *const sink = static_cast<i_poll_events *> (timer->owner);
+        const int id = timer->id;
+        LIBZMQ_DELETE (timer);
 
         //  Trigger the timer.
-        timer_temp.sink->timer_event (timer_temp.id);
-
-    } while (!_timers.empty ());
+        sink->timer_event (id);
+    }
 
     //  Return the time to wait for the next timer (at least 1ms), or 0, if
     //  there are no more timers.
-    return res;
+    if (_timers.empty ())
+        return 0;
+    return _timers.next_expiry () - current;
+}
+
+int zmq::poller_base_t::begin_wait (int timeout_)
+{
+    const uint64_t now = clock_t::now_us ();
+    _busy_time += now - _busy_start;
+
+    const uint64_t elapsed = now - _window_start;
+    if (elapsed >= busy_window_us) {
+        const uint64_t busy =
+          _busy_time >= elapsed ? 1000 : _busy_time * 1000 / elapsed;
+        _busy.set (static_cast<atomic_counter_t::integer_t> (busy));
+        _window_start = now;
+        _busy_time = 0;
+    }
+
+    //  Wake up by the end of the window to report the idle time.
+    if (_busy.get () == 0)
+        return timeout_;
+    const int window_left = static_cast<int> (
+      (_window_start + busy_window_us - now) / 1000 + 1);
+    return timeout_ && timeout_ < window_left ? timeout_ : window_left;
+}
+
+void zmq::poller_base_t::end_wait ()
+{
+    _busy_start = clock_t::now_us ();
 }
 
 zmq::worker_poller_base_t::worker_poller_base_t (const thread_ctx_t &ctx_) :
@@ -101,10 +138,10 @@ void zmq::worker_poller_base_t::stop_worker ()
     _worker.stop ();
 }
 
-void zmq::worker_poller_base_t::start (const char *name_)
+void zmq::worker_poller_base_t::start (const char *name_, int io_thread_)
 {
     zmq_assert (get_load () > 0);
-    _ctx.start_thread (_worker, worker_routine, this, name_);
+    _ctx.start_thread (_worker, worker_routine, this, name_, io_thread_);
 }
 
 void zmq::worker_poller_base_t::check_thread () const
@@ -3,11 +3,10 @@
 #ifndef __ZMQ_POLLER_BASE_HPP_INCLUDED__
 #define __ZMQ_POLLER_BASE_HPP_INCLUDED__
 
-#include <map>
-
 #include "clock.hpp"
 #include "atomic_counter.hpp"
 #include "ctx.hpp"
+#include "timer_wheel.hpp"
 
 namespace zmq
 {
@@ -25,6 +24,10 @@ struct i_poll_events;
 //   Returns load of the poller.
 // int get_load() const;
 //
+//   Returns the share of the recent time the poller spent handling events
+//   and timers rather than waiting for them, in thousandths.
+// int get_busy() const;
+//
 //   Add a timeout to expire in timeout_ milliseconds. After the
 //   expiration, timer_event on sink_ object will be called with
 //   argument set to id_.
@@ -33,6 +36,11 @@ struct i_poll_events;
 //   Cancel the timer created by sink_ object with ID equal to id_.
 // void cancel_timer(zmq::i_poll_events *sink_, int id_);
 //
+//   Returns the number of milliseconds until the timer created by sink_
+//   object with ID equal to id_ expires, at least 1, or 0 if there is no
+//   such timer.
+// int timer_left(zmq::i_poll_events *sink_, int id_);
+//
 //   Adds a fd to the poller. Initially, no events are activated. These must
 //   be activated by the set_* methods using the returned handle_.
 // handle_t add_fd(fd_t fd_, zmq::i_poll_events *events_);
@@ -67,7 +75,7 @@ struct i_poll_events;
 // Most of the methods may only be called from a zmq::i_poll_events callback
 // function when invoked by the poller (and, therefore, typically from the
 // poller's worker thread), with the following exceptions:
-// - get_load may be called from outside
+// - get_load and get_busy may be called from outside
 // - add_fd and add_timer may be called from outside before start
 // - start may be called from outside once
 //
@@ -95,13 +103,19 @@ struct i_poll_events;
 class poller_base_t
 {
   public:
-    poller_base_t () ZMQ_DEFAULT;
+    poller_base_t ();
     virtual ~poller_base_t ();
 
     // Methods from the poller concept.
     int get_load () const;
+    int get_busy () const;
     void add_timer (int timeout_, zmq::i_poll_events *sink_, int id_);
     void cancel_timer (zmq::i_poll_events *sink_, int id_);
+    int timer_left (zmq::i_poll_events *sink_, int id_);
+
+    //  Length of the window over which the busy share is measured, in
+    //  microseconds.
+    static const uint64_t busy_window_us = 100000;
 
   protected:
     //  Called by individual poller implementations to manage the load.
@@ -111,23 +125,34 @@ class poller_base_t
     //  to wait to match the next timer or 0 meaning "no timers".
     uint64_t execute_timers ();
 
+    //  Called by individual poller implementations around the wait for
+    //  events, to measure how busy the poller is. begin_wait returns the
+    //  timeout to wait with instead of timeout_ (0 meaning "no timeout"),
+    //  which is shortened while the poller is reported busy, so that the
+    //  figure drops once the poller goes idle.
+    int begin_wait (int timeout_);
+    void end_wait ();
+
   private:
     //  Clock instance private to this I/O thread.
     clock_t _clock;
 
-    //  List of active timers.
-    struct timer_info_t
-    {
-        zmq::i_poll_events *sink;
-        int id;
-    };
-    typedef std::multimap<uint64_t, timer_info_t> timers_t;
-    timers_t _timers;
+    //  Active timers, keyed by their sink and id.
+    timer_wheel_t _timers;
 
     //  Load of the poller. Currently the number of file descriptors
     //  registered.
     atomic_counter_t _load;
 
+    //  Start of the current measurement window, start of the current
+    //  busy period and time spent busy within the window, in microseconds.
+    uint64_t _window_start;
+    uint64_t _busy_start;
+    uint64_t _busy_time;
+
+    //  Busy share of the last complete window, in thousandths.
+    atomic_counter_t _busy;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (poller_base_t)
 };
 
@@ -137,8 +162,9 @@ class worker_poller_base_t : public poller_base_t
   public:
     worker_poller_base_t (const thread_ctx_t &ctx_);
 
-    // Methods from the poller concept.
-    void start (const char *name = NULL);
+    // Methods from the poller concept. The worker thread of I/O thread
+    // io_thread_ takes the CPU affinity set for it, if any.
+    void start (const char *name = NULL, int io_thread_ = -1);
 
   protected:
     //  Checks whether the currently executing thread is the worker thread
@@ -184,8 +184,10 @@ void zmq::pollset_t::loop ()
         int timeout = (int) execute_timers ();
 
         //  Wait for events.
+        timeout = begin_wait (timeout);
         int n = pollset_poll (pollset_fd, polldata_array, max_io_events,
                               timeout ? timeout : -1);
+        end_wait ();
         if (n == -1) {
             errno_assert (errno == EINTR);
             continue;
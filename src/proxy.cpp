@@ -17,6 +17,8 @@
 // dependency chain
 #include "socket_base.hpp"
 #include "err.hpp"
+#include "ctx.hpp"
+#include "io_proxy.hpp"
 
 #ifdef ZMQ_HAVE_POLLER
 
@@ -408,3 +410,58 @@ int zmq::proxy (class socket_base_t *frontend_,
 }
 
 #endif //  ZMQ_HAVE_POLLER
+
+int zmq::proxy_detached (class socket_base_t *frontend_,
+                         class socket_base_t *backend_,
+                         class socket_base_t *capture_,
+                         class socket_base_t *control_)
+{
+    //  The proxy takes the sockets over, it cannot share them with itself
+    //  except for the frontend and the backend being the same socket.
+    if ((capture_ && (capture_ == frontend_ || capture_ == backend_))
+        || (control_
+            && (control_ == frontend_ || control_ == backend_
+                || control_ == capture_))) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    //  It polls the mailboxes of the sockets, which thread safe sockets
+    //  do not have.
+    ctx_t *const ctx = frontend_->get_ctx ();
+    socket_base_t *const sockets[] = {frontend_, backend_, capture_,
+                                      control_};
+    for (size_t i = 0; i != sizeof sockets / sizeof sockets[0]; i++) {
+        if (!sockets[i])
+            continue;
+        if (sockets[i]->get_ctx () != ctx) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (sockets[i]->is_thread_safe ()) {
+            errno = ENOTSUP;
+            return -1;
+        }
+    }
+
+    uint64_t affinity;
+    size_t affinity_size = sizeof affinity;
+    int rc = frontend_->getsockopt (ZMQ_AFFINITY, &affinity, &affinity_size);
+    if (rc != 0)
+        return -1;
+
+    io_thread_t *io_thread = ctx->choose_io_thread (affinity);
+    if (!io_thread) {
+        errno = EMTHREAD;
+        return -1;
+    }
+
+    io_proxy_t *proxy = new (std::nothrow)
+      io_proxy_t (io_thread, frontend_, backend_, capture_, control_);
+    alloc_assert (proxy);
+
+    //  The frontend owns the proxy, so that the proxy is terminated when
+    //  it closes the frontend, and the context waits for that.
+    frontend_->launch_owned (proxy);
+    return 0;
+}
@@ -8,6 +8,13 @@ namespace zmq
 int proxy (class socket_base_t *frontend_,
            class socket_base_t *backend_,
            class socket_base_t *capture_);
+
+//  Starts a proxy in an I/O thread of the sockets' context, handing the
+//  sockets over to it.
+int proxy_detached (class socket_base_t *frontend_,
+                    class socket_base_t *backend_,
+                    class socket_base_t *capture_,
+                    class socket_base_t *control_);
 }
 
 #endif
@@ -43,6 +43,11 @@ int zmq::pull_t::xrecv (msg_t *msg_)
     return _fq.recv (msg_);
 }
 
+bool zmq::pull_t::xbegin_batch (bool send_)
+{
+    return !send_;
+}
+
 bool zmq::pull_t::xhas_in ()
 {
     return _fq.has_in ();
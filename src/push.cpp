@@ -47,6 +47,18 @@ int zmq::push_t::xsend (msg_t *msg_)
     return _lb.send (msg_);
 }
 
+bool zmq::push_t::xbegin_batch (bool send_)
+{
+    if (send_)
+        _lb.begin_batch ();
+    return send_;
+}
+
+void zmq::push_t::xend_batch (bool)
+{
+    _lb.end_batch ();
+}
+
 bool zmq::push_t::xhas_out ()
 {
     return _lb.has_out ();
@@ -26,6 +26,8 @@ class push_t ZMQ_FINAL : public socket_base_t
                        bool subscribe_to_all_,
                        bool locally_initiated_);
     int xsend (zmq::msg_t *msg_);
+    bool xbegin_batch (bool send_);
+    void xend_batch (bool send_);
     bool xhas_out ();
     void xwrite_activated (zmq::pipe_t *pipe_);
     void xpipe_terminated (zmq::pipe_t *pipe_);
@@ -48,22 +48,18 @@ void zmq::radio_t::xread_activated (pipe_t *pipe_)
     msg_t msg;
     while (pipe_->read (&msg)) {
         //  Apply the subscription to the trie
-        if (msg.is_join () || msg.is_leave ()) {
-            std::string group = std::string (msg.group ());
-
-            if (msg.is_join ())
-                _subscriptions.ZMQ_MAP_INSERT_OR_EMPLACE (ZMQ_MOVE (group),
-                                                          pipe_);
-            else {
-                std::pair<subscriptions_t::iterator, subscriptions_t::iterator>
-                  range = _subscriptions.equal_range (group);
-
-                for (subscriptions_t::iterator it = range.first;
-                     it != range.second; ++it) {
-                    if (it->second == pipe_) {
-                        _subscriptions.erase (it);
-                        break;
-                    }
+        if (msg.is_join ())
+            _subscriptions.insert (msg.group ()).first->push_back (pipe_);
+        else if (msg.is_leave ()) {
+            pipes_t *const pipes = _subscriptions.find (msg.group ());
+            if (pipes) {
+                const pipes_t::iterator it =
+                  std::find (pipes->begin (), pipes->end (), pipe_);
+                if (it != pipes->end ()) {
+                    *it = pipes->back ();
+                    pipes->pop_back ();
+                    if (pipes->empty ())
+                        _subscriptions.erase (msg.group ());
                 }
             }
         }
@@ -94,19 +90,21 @@ int zmq::radio_t::xsetsockopt (int option_,
 
 void zmq::radio_t::xpipe_terminated (pipe_t *pipe_)
 {
+    //  Groups left without pipes are removed once the walk is over.
+    std::vector<std::string> unused_groups;
     for (subscriptions_t::iterator it = _subscriptions.begin (),
                                    end = _subscriptions.end ();
-         it != end;) {
-        if (it->second == pipe_) {
-#if __cplusplus >= 201103L || (defined _MSC_VER && _MSC_VER >= 1700)
-            it = _subscriptions.erase (it);
-#else
-            _subscriptions.erase (it++);
-#endif
-        } else {
-            ++it;
-        }
+         it != end; ++it) {
+        pipes_t &pipes = it.value ();
+        pipes.erase (std::remove (pipes.begin (), pipes.end (), pipe_),
+                     pipes.end ());
+        if (pipes.empty ())
+            unused_groups.push_back (it.group ());
     }
+    for (std::vector<std::string>::const_iterator it = unused_groups.begin (),
+                                                  end = unused_groups.end ();
+         it != end; ++it)
+        _subscriptions.erase (it->c_str ());
 
     {
         const udp_pipes_t::iterator end = _udp_pipes.end ();
@@ -129,11 +127,11 @@ int zmq::radio_t::xsend (msg_t *msg_)
 
     _dist.unmatch ();
 
-    const std::pair<subscriptions_t::iterator, subscriptions_t::iterator>
-      range = _subscriptions.equal_range (std::string (msg_->group ()));
-
-    for (subscriptions_t::iterator it = range.first; it != range.second; ++it)
-        _dist.match (it->second);
+    const pipes_t *const pipes = _subscriptions.find (msg_->group ());
+    if (pipes)
+        for (pipes_t::const_iterator it = pipes->begin (), end = pipes->end ();
+             it != end; ++it)
+            _dist.match (*it);
 
     for (udp_pipes_t::iterator it = _udp_pipes.begin (),
                                end = _udp_pipes.end ();
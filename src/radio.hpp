@@ -3,13 +3,12 @@
 #ifndef __ZMQ_RADIO_HPP_INCLUDED__
 #define __ZMQ_RADIO_HPP_INCLUDED__
 
-#include <map>
-#include <string>
 #include <vector>
 
 #include "socket_base.hpp"
 #include "session_base.hpp"
 #include "dist.hpp"
+#include "group_table.hpp"
 #include "msg.hpp"
 
 namespace zmq
@@ -38,8 +37,10 @@ class radio_t ZMQ_FINAL : public socket_base_t
     void xpipe_terminated (zmq::pipe_t *pipe_);
 
   private:
-    //  List of all subscriptions mapped to corresponding pipes.
-    typedef std::multimap<std::string, pipe_t *> subscriptions_t;
+    //  List of all subscriptions mapped to corresponding pipes. A pipe
+    //  appears once per join of the group.
+    typedef std::vector<pipe_t *> pipes_t;
+    typedef group_table_t<pipes_t> subscriptions_t;
     subscriptions_t _subscriptions;
 
     //  List of udp pipes
@@ -0,0 +1,194 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include <new>
+
+#include "resolver.hpp"
+#include "command.hpp"
+#include "config.hpp"
+#include "ctx.hpp"
+#include "err.hpp"
+#include "own.hpp"
+
+zmq::resolver_t::resolver_t (ctx_t *ctx_, int ttl_, int negative_ttl_) :
+    _ctx (ctx_),
+    _ttl (ttl_),
+    _negative_ttl (negative_ttl_),
+    _started (false),
+    _stopping (false)
+{
+}
+
+zmq::resolver_t::~resolver_t ()
+{
+    stop ();
+}
+
+void zmq::resolver_t::set_ttl (int ttl_, int negative_ttl_)
+{
+    scoped_lock_t locker (_sync);
+    _ttl = ttl_;
+    _negative_ttl = negative_ttl_;
+}
+
+void zmq::resolver_t::stop ()
+{
+    {
+        scoped_lock_t locker (_sync);
+        if (!_started || _stopping)
+            return;
+        _stopping = true;
+        _cv.broadcast ();
+    }
+    _worker.stop ();
+}
+
+int zmq::resolver_t::resolve (own_t *destination_,
+                              const std::string &name_,
+                              bool ipv6_,
+                              tcp_address_t *address_)
+{
+    const std::string key = make_key (name_, ipv6_);
+
+    scoped_lock_t locker (_sync);
+    zmq_assert (!_stopping);
+
+    const entry_t *const entry = lookup (key);
+    if (entry) {
+        if (entry->error != 0) {
+            errno = entry->error;
+            return -1;
+        }
+        *address_ = entry->address;
+        return 0;
+    }
+
+    if (!_started) {
+        _ctx->start_thread (_worker, worker_routine, this, "Resolver");
+        _started = true;
+    }
+
+    //  The requester cannot be deallocated before it got the reply.
+    destination_->inc_seqnum ();
+    const request_t request = {destination_, name_, ipv6_};
+    _requests.push_back (request);
+    _cv.broadcast ();
+
+    errno = EAGAIN;
+    return -1;
+}
+
+int zmq::resolver_t::resolve_name (tcp_address_t *address_,
+                                   const char *name_,
+                                   bool ipv6_)
+{
+    return address_->resolve (name_, false, ipv6_);
+}
+
+void zmq::resolver_t::reply (own_t *destination_,
+                             tcp_address_t *address_,
+                             int error_)
+{
+    command_t cmd;
+    cmd.destination = destination_;
+    cmd.type = command_t::resolved;
+    cmd.args.resolved.address = address_;
+    cmd.args.resolved.error = error_;
+    _ctx->send_command (destination_->get_tid (), cmd);
+}
+
+void zmq::resolver_t::worker_routine (void *arg_)
+{
+    static_cast<resolver_t *> (arg_)->loop ();
+}
+
+void zmq::resolver_t::loop ()
+{
+    _sync.lock ();
+    while (true) {
+        if (_requests.empty ()) {
+            if (_stopping)
+                break;
+            const int rc = _cv.wait (&_sync, -1);
+            errno_assert (rc == 0);
+            continue;
+        }
+
+        const request_t request = _requests.front ();
+        _requests.pop_front ();
+        const std::string key = make_key (request.name, request.ipv6);
+
+        //  Requests queued for the same name before it was looked up are
+        //  answered from the cache.
+        tcp_address_t address;
+        int error;
+        const entry_t *const entry = lookup (key);
+        if (entry) {
+            address = entry->address;
+            error = entry->error;
+        } else {
+            _sync.unlock ();
+            error = resolve_name (&address, request.name.c_str (),
+                                  request.ipv6) == 0
+                      ? 0
+                      : errno;
+            _sync.lock ();
+            store (key, address, error);
+        }
+
+        tcp_address_t *result = NULL;
+        if (error == 0) {
+            result = new (std::nothrow) tcp_address_t (address);
+            alloc_assert (result);
+        }
+        reply (request.destination, result, error);
+    }
+    _sync.unlock ();
+}
+
+const zmq::resolver_t::entry_t *
+zmq::resolver_t::lookup (const std::string &key_)
+{
+    const cache_t::iterator it = _cache.find (key_);
+    if (it == _cache.end ())
+        return NULL;
+    if (it->second.expiry <= _clock.now_ms ()) {
+        _cache.erase (it);
+        return NULL;
+    }
+    return &it->second;
+}
+
+void zmq::resolver_t::store (const std::string &key_,
+                             const tcp_address_t &address_,
+                             int error_)
+{
+    const int ttl = error_ == 0 ? _ttl : _negative_ttl;
+    if (ttl <= 0)
+        return;
+
+    const uint64_t now = _clock.now_ms ();
+
+    //  Make room by dropping the expired entries, or all of them if none
+    //  has expired yet.
+    if (_cache.size () >= resolver_cache_size) {
+        for (cache_t::iterator it = _cache.begin (); it != _cache.end ();) {
+            if (it->second.expiry <= now)
+                _cache.erase (it++);
+            else
+                ++it;
+        }
+        if (_cache.size () >= resolver_cache_size)
+            _cache.clear ();
+    }
+
+    entry_t &entry = _cache[key_];
+    entry.address = address_;
+    entry.error = error_;
+    entry.expiry = now + ttl;
+}
+
+std::string zmq::resolver_t::make_key (const std::string &name_, bool ipv6_)
+{
+    return (ipv6_ ? "6:" : "4:") + name_;
+}
@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_RESOLVER_HPP_INCLUDED__
+#define __ZMQ_RESOLVER_HPP_INCLUDED__
+
+#include <deque>
+#include <map>
+#include <string>
+
+#include "clock.hpp"
+#include "condition_variable.hpp"
+#include "macros.hpp"
+#include "mutex.hpp"
+#include "stdint.hpp"
+#include "tcp_address.hpp"
+#include "thread.hpp"
+
+namespace zmq
+{
+class ctx_t;
+class own_t;
+
+//  Resolves the addresses TCP and WebSocket connecters connect to in a
+//  worker thread of the context, so that slow name lookups do not stall
+//  the I/O threads. The results, including failures, are cached for a
+//  while as reconnecting peers keep asking for the same names.
+
+class resolver_t
+{
+  public:
+    //  The TTLs are in milliseconds, zero disables the caching.
+    resolver_t (ctx_t *ctx_, int ttl_, int negative_ttl_);
+    virtual ~resolver_t ();
+
+    void set_ttl (int ttl_, int negative_ttl_);
+
+    //  Resolves the remote address 'name_'. If the result is cached, the
+    //  address is stored to 'address_' and 0 returned, or -1 with errno
+    //  set if it could not be resolved. Otherwise -1 is returned with
+    //  errno set to EAGAIN, and 'destination_' is sent a resolved command
+    //  once the worker thread looked the name up.
+    int resolve (own_t *destination_,
+                 const std::string &name_,
+                 bool ipv6_,
+                 tcp_address_t *address_);
+
+  protected:
+    //  Looks the name up, in the worker thread. Tests override it to
+    //  stub the system resolver out.
+    virtual int
+    resolve_name (tcp_address_t *address_, const char *name_, bool ipv6_);
+
+    //  Hands the result over to the requester. The address is NULL if the
+    //  name could not be resolved, and belongs to the requester otherwise.
+    virtual void
+    reply (own_t *destination_, tcp_address_t *address_, int error_);
+
+    //  Stops the worker thread once all requests are handled. Must be
+    //  called by the destructor of classes overriding the functions above.
+    void stop ();
+
+  private:
+    struct request_t
+    {
+        own_t *destination;
+        std::string name;
+        bool ipv6;
+    };
+
+    struct entry_t
+    {
+        tcp_address_t address;
+        int error;
+        uint64_t expiry;
+    };
+
+    typedef std::map<std::string, entry_t> cache_t;
+
+    static void worker_routine (void *arg_);
+    void loop ();
+
+    //  Returns the fresh cache entry for the key, or NULL. Must be called
+    //  with _sync locked.
+    const entry_t *lookup (const std::string &key_);
+
+    //  Caches the result for the key, if caching is enabled. Must be
+    //  called with _sync locked.
+    void store (const std::string &key_,
+                const tcp_address_t &address_,
+                int error_);
+
+    static std::string make_key (const std::string &name_, bool ipv6_);
+
+    ctx_t *const _ctx;
+
+    //  Protects everything below, the worker thread waits for requests
+    //  on _cv.
+    mutex_t _sync;
+    condition_variable_t _cv;
+
+    std::deque<request_t> _requests;
+    cache_t _cache;
+    clock_t _clock;
+
+    int _ttl;
+    int _negative_ttl;
+
+    //  The worker thread is only started once the first name has to be
+    //  looked up.
+    bool _started;
+    bool _stopping;
+    thread_t _worker;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (resolver_t)
+};
+}
+
+#endif
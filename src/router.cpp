@@ -18,6 +18,7 @@ zmq::router_t::router_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
     _more_in (false),
     _current_out (NULL),
     _more_out (false),
+    _batch (false),
     _next_integral_routing_id (generate_random ()),
     _mandatory (false),
     //  raw_socket functionality in ROUTER is deprecated
@@ -186,6 +187,8 @@ int zmq::router_t::xsend (msg_t *msg_)
                     // Check whether pipe is full or not
                     const bool pipe_full = !_current_out->check_hwm ();
                     out_pipe->active = false;
+                    if (!_mandatory)
+                        _current_out->count_dropped ();
                     _current_out = NULL;
 
                     if (_mandatory) {
@@ -244,7 +247,11 @@ int zmq::router_t::xsend (msg_t *msg_)
             _current_out = NULL;
         } else {
             if (!_more_out) {
-                _current_out->flush ();
+                if (_batch) {
+                    if (_current_out->defer_flush ())
+                        _batch_out.push_back (_current_out);
+                } else
+                    _current_out->flush ();
                 _current_out = NULL;
             }
         }
@@ -260,6 +267,24 @@ int zmq::router_t::xsend (msg_t *msg_)
     return 0;
 }
 
+bool zmq::router_t::xbegin_batch (bool send_)
+{
+    _batch = send_;
+    return true;
+}
+
+void zmq::router_t::xend_batch (bool send_)
+{
+    if (!send_)
+        return;
+    _batch = false;
+
+    for (std::vector<pipe_t *>::size_type i = 0, size = _batch_out.size ();
+         i != size; ++i)
+        _batch_out[i]->flush ();
+    _batch_out.clear ();
+}
+
 int zmq::router_t::xrecv (msg_t *msg_)
 {
     if (_prefetched) {
@@ -406,7 +431,7 @@ int zmq::router_t::get_peer_state (const void *routing_id_,
 {
     int res = 0;
 
-    // TODO remove the const_cast, see comment in lookup_out_pipe
+    // TODO remove the const_cast, blob_t cannot reference const data
     const blob_t routing_id_blob (
       static_cast<unsigned char *> (const_cast<void *> (routing_id_)),
       routing_id_size_, reference_tag_t ());
@@ -484,7 +509,7 @@ bool zmq::router_t::identify_peer (pipe_t *pipe_, bool locally_initiated_)
 
                 erase_out_pipe (old_pipe);
                 old_pipe->set_router_socket_routing_id (new_routing_id);
-                add_out_pipe (ZMQ_MOVE (new_routing_id), old_pipe);
+                add_out_pipe (old_pipe);
 
                 if (old_pipe == _current_in)
                     _terminate_current_in = true;
@@ -495,7 +520,7 @@ bool zmq::router_t::identify_peer (pipe_t *pipe_, bool locally_initiated_)
     }
 
     pipe_->set_router_socket_routing_id (routing_id);
-    add_out_pipe (ZMQ_MOVE (routing_id), pipe_);
+    add_out_pipe (pipe_);
 
     return true;
 }
@@ -4,6 +4,7 @@
 #define __ZMQ_ROUTER_HPP_INCLUDED__
 
 #include <map>
+#include <vector>
 
 #include "socket_base.hpp"
 #include "session_base.hpp"
@@ -32,6 +33,8 @@ class router_t : public routing_socket_base_t
     xsetsockopt (int option_, const void *optval_, size_t optvallen_) ZMQ_FINAL;
     int xsend (zmq::msg_t *msg_) ZMQ_OVERRIDE;
     int xrecv (zmq::msg_t *msg_) ZMQ_OVERRIDE;
+    bool xbegin_batch (bool send_) ZMQ_FINAL;
+    void xend_batch (bool send_) ZMQ_FINAL;
     bool xhas_in () ZMQ_OVERRIDE;
     bool xhas_out () ZMQ_OVERRIDE;
     void xread_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
@@ -81,6 +84,11 @@ class router_t : public routing_socket_base_t
     //  If true, more outgoing message parts are expected.
     bool _more_out;
 
+    //  True while sending a batch. The pipes written to are flushed at
+    //  the end of it, each once.
+    bool _batch;
+    std::vector<pipe_t *> _batch_out;
+
     //  Routing IDs are generated. It's a simple increment and wrap-over
     //  algorithm. This value is the next ID to use (if not used already).
     uint32_t _next_integral_routing_id;
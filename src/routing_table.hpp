@@ -0,0 +1,186 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_ROUTING_TABLE_HPP_INCLUDED__
+#define __ZMQ_ROUTING_TABLE_HPP_INCLUDED__
+
+#include <string.h>
+
+#include "blob.hpp"
+#include "err.hpp"
+#include "hash_table.hpp"
+#include "macros.hpp"
+#include "pipe.hpp"
+#include "random.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+//  Outbound pipe of a routing socket, with whether it can take messages.
+struct out_pipe_t
+{
+    pipe_t *pipe;
+    bool active;
+};
+
+//  Routing ids of ROUTER and STREAM peers. The hash is seeded per table, so
+//  that peers cannot easily pick routing ids that all fall into the same
+//  slots.
+struct blob_routing_id_t
+{
+    typedef const blob_t &key_t;
+
+    static uint32_t hash (key_t routing_id_, uint32_t seed_)
+    {
+        return hash_bytes (routing_id_.data (), routing_id_.size (), seed_);
+    }
+
+    static bool matches (const pipe_t *pipe_, key_t routing_id_)
+    {
+        const blob_t &pipe_routing_id = pipe_->get_routing_id ();
+        return pipe_routing_id.size () == routing_id_.size ()
+               && memcmp (pipe_routing_id.data (), routing_id_.data (),
+                          routing_id_.size ())
+                    == 0;
+    }
+
+    static key_t key_of (const pipe_t *pipe_)
+    {
+        return pipe_->get_routing_id ();
+    }
+};
+
+//  Routing ids of SERVER peers. They are handed out in sequence, so they
+//  serve as their own hash: consecutive ids take consecutive slots, and
+//  the table works as a vector indexed by routing id.
+struct integral_routing_id_t
+{
+    typedef uint32_t key_t;
+
+    static uint32_t hash (key_t routing_id_, uint32_t) { return routing_id_; }
+
+    static bool matches (const pipe_t *pipe_, key_t routing_id_)
+    {
+        return pipe_->get_server_socket_routing_id () == routing_id_;
+    }
+
+    static key_t key_of (const pipe_t *pipe_)
+    {
+        return pipe_->get_server_socket_routing_id ();
+    }
+};
+
+//  Outbound pipes of a routing socket, indexed by the routing ids of the
+//  peers, in a hash_table_t. The routing ids are not copied into the table
+//  but read from the pipes.
+
+template <typename Id> class routing_table_t
+{
+  public:
+    typedef typename Id::key_t key_t;
+
+    routing_table_t () : _seed (generate_random ()) {}
+
+    bool empty () const { return _slots.empty (); }
+
+    size_t size () const { return _slots.size (); }
+
+    //  Adds the pipe under its routing id, which must not be taken.
+    void add (pipe_t *pipe_)
+    {
+        const key_t routing_id = Id::key_of (pipe_);
+        const uint32_t hash = slot_hash (routing_id);
+        zmq_assert (_slots.find (hash, matches_t (routing_id))
+                    == slots_t::npos);
+        slot_t &slot = _slots.insert (hash);
+        slot.out_pipe.pipe = pipe_;
+        slot.out_pipe.active = true;
+    }
+
+    //  Returns the entry of the routing id, or NULL if there is none.
+    out_pipe_t *find (key_t routing_id_)
+    {
+        const size_t index = find_slot (routing_id_);
+        return index == slots_t::npos ? NULL : &_slots[index].out_pipe;
+    }
+
+    const out_pipe_t *find (key_t routing_id_) const
+    {
+        const size_t index = find_slot (routing_id_);
+        return index == slots_t::npos ? NULL : &_slots[index].out_pipe;
+    }
+
+    //  Returns the entry of the pipe, or NULL if it is not in the table.
+    out_pipe_t *find (const pipe_t *pipe_)
+    {
+        out_pipe_t *const out_pipe = find (Id::key_of (pipe_));
+        return out_pipe && out_pipe->pipe == pipe_ ? out_pipe : NULL;
+    }
+
+    //  Removes the entry of the routing id, returning it. The pipe of the
+    //  returned entry is NULL if there was none.
+    out_pipe_t erase (key_t routing_id_)
+    {
+        out_pipe_t out_pipe = {NULL, false};
+        const size_t index = find_slot (routing_id_);
+        if (index != slots_t::npos) {
+            out_pipe = _slots[index].out_pipe;
+            _slots.erase (index);
+        }
+        return out_pipe;
+    }
+
+    template <typename Func> bool any_of (Func func_)
+    {
+        for (size_t i = 0, capacity = _slots.capacity (); i != capacity; i++)
+            if (_slots[i].hash != slots_t::empty_hash
+                && func_ (*_slots[i].out_pipe.pipe))
+                return true;
+        return false;
+    }
+
+  private:
+    struct slot_t
+    {
+        slot_t () : hash (slots_t::empty_hash)
+        {
+            out_pipe.pipe = NULL;
+            out_pipe.active = false;
+        }
+
+        uint32_t hash;
+        out_pipe_t out_pipe;
+    };
+
+    typedef hash_table_t<slot_t> slots_t;
+
+    struct matches_t
+    {
+        explicit matches_t (key_t routing_id_) : routing_id (routing_id_) {}
+
+        bool operator() (const slot_t &slot_) const
+        {
+            return Id::matches (slot_.out_pipe.pipe, routing_id);
+        }
+
+        key_t routing_id;
+    };
+
+    uint32_t slot_hash (key_t routing_id_) const
+    {
+        return slots_t::slot_hash (Id::hash (routing_id_, _seed));
+    }
+
+    size_t find_slot (key_t routing_id_) const
+    {
+        return _slots.find (slot_hash (routing_id_), matches_t (routing_id_));
+    }
+
+    slots_t _slots;
+
+    const uint32_t _seed;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (routing_table_t)
+};
+}
+
+#endif
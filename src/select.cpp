@@ -296,6 +296,7 @@ void zmq::select_t::loop ()
             continue;
         }
 
+        timeout = begin_wait (timeout);
 #if defined ZMQ_HAVE_OSX
         struct timeval tv = {(long) (timeout / 1000), timeout % 1000 * 1000};
 #else
@@ -364,6 +365,7 @@ void zmq::select_t::loop ()
 
             rc = WSAWaitForMultipleEvents (4, wsa_events.events, FALSE,
                                            timeout ? timeout : INFINITE, FALSE);
+            end_wait ();
             wsa_assert (rc != (int) WSA_WAIT_FAILED);
             zmq_assert (rc != WSA_WAIT_IO_COMPLETION);
 
@@ -405,6 +407,7 @@ void zmq::select_t::select_family_entry (family_entry_t &family_entry_,
     fds_set_t local_fds_set = family_entry_.fds_set;
     int rc = select (max_fd_, &local_fds_set.read, &local_fds_set.write,
                      &local_fds_set.error, use_timeout_ ? &tv_ : NULL);
+    end_wait ();
 
 #if defined ZMQ_HAVE_WINDOWS
     wsa_assert (rc != SOCKET_ERROR);
@@ -38,20 +38,16 @@ void zmq::server_t::xattach_pipe (pipe_t *pipe_,
 
     pipe_->set_server_socket_routing_id (routing_id);
     //  Add the record into output pipes lookup table
-    outpipe_t outpipe = {pipe_, true};
-    const bool ok =
-      _out_pipes.ZMQ_MAP_INSERT_OR_EMPLACE (routing_id, outpipe).second;
-    zmq_assert (ok);
+    _out_pipes.add (pipe_);
 
     _fq.attach (pipe_);
 }
 
 void zmq::server_t::xpipe_terminated (pipe_t *pipe_)
 {
-    const out_pipes_t::iterator it =
-      _out_pipes.find (pipe_->get_server_socket_routing_id ());
-    zmq_assert (it != _out_pipes.end ());
-    _out_pipes.erase (it);
+    const out_pipe_t erased =
+      _out_pipes.erase (pipe_->get_server_socket_routing_id ());
+    zmq_assert (erased.pipe == pipe_);
     _fq.pipe_terminated (pipe_);
 }
 
@@ -62,15 +58,10 @@ void zmq::server_t::xread_activated (pipe_t *pipe_)
 
 void zmq::server_t::xwrite_activated (pipe_t *pipe_)
 {
-    const out_pipes_t::iterator end = _out_pipes.end ();
-    out_pipes_t::iterator it;
-    for (it = _out_pipes.begin (); it != end; ++it)
-        if (it->second.pipe == pipe_)
-            break;
-
-    zmq_assert (it != _out_pipes.end ());
-    zmq_assert (!it->second.active);
-    it->second.active = true;
+    out_pipe_t *const out_pipe = _out_pipes.find (pipe_);
+    zmq_assert (out_pipe);
+    zmq_assert (!out_pipe->active);
+    out_pipe->active = true;
 }
 
 int zmq::server_t::xsend (msg_t *msg_)
@@ -82,11 +73,11 @@ int zmq::server_t::xsend (msg_t *msg_)
     }
     //  Find the pipe associated with the routing stored in the message.
     const uint32_t routing_id = msg_->get_routing_id ();
-    out_pipes_t::iterator it = _out_pipes.find (routing_id);
+    out_pipe_t *const out_pipe = _out_pipes.find (routing_id);
 
-    if (it != _out_pipes.end ()) {
-        if (!it->second.pipe->check_write ()) {
-            it->second.active = false;
+    if (out_pipe) {
+        if (!out_pipe->pipe->check_write ()) {
+            out_pipe->active = false;
             errno = EAGAIN;
             return -1;
         }
@@ -99,13 +90,13 @@ int zmq::server_t::xsend (msg_t *msg_)
     int rc = msg_->reset_routing_id ();
     errno_assert (rc == 0);
 
-    const bool ok = it->second.pipe->write (msg_);
+    const bool ok = out_pipe->pipe->write (msg_);
     if (unlikely (!ok)) {
         // Message failed to send - we must close it ourselves.
         rc = msg_->close ();
         errno_assert (rc == 0);
     } else
-        it->second.pipe->flush ();
+        out_pipe->pipe->flush ();
 
     //  Detach the message from the data buffer.
     rc = msg_->init ();
@@ -3,13 +3,12 @@
 #ifndef __ZMQ_SERVER_HPP_INCLUDED__
 #define __ZMQ_SERVER_HPP_INCLUDED__
 
-#include <map>
-
 #include "socket_base.hpp"
 #include "session_base.hpp"
 #include "stdint.hpp"
 #include "blob.hpp"
 #include "fq.hpp"
+#include "routing_table.hpp"
 
 namespace zmq
 {
@@ -40,15 +39,8 @@ class server_t : public socket_base_t
     //  Fair queueing object for inbound pipes.
     fq_t _fq;
 
-    struct outpipe_t
-    {
-        zmq::pipe_t *pipe;
-        bool active;
-    };
-
     //  Outbound pipes indexed by the peer IDs.
-    typedef std::map<uint32_t, outpipe_t> out_pipes_t;
-    out_pipes_t _out_pipes;
+    routing_table_t<integral_routing_id_t> _out_pipes;
 
     //  Routing IDs are generated. It's a simple increment and wrap-over
     //  algorithm. This value is the next ID to use (if not used already).
@@ -4,6 +4,7 @@
 #include "macros.hpp"
 #include "session_base.hpp"
 #include "i_engine.hpp"
+#include "io_thread.hpp"
 #include "err.hpp"
 #include "pipe.hpp"
 #include "likely.hpp"
@@ -18,6 +19,7 @@
 #include "address.hpp"
 #include "norm_engine.hpp"
 #include "udp_engine.hpp"
+#include "crypto_pool.hpp"
 
 #include "ctx.hpp"
 #include "req.hpp"
@@ -101,6 +103,16 @@ zmq::session_base_t::session_base_t (class io_thread_t *io_thread_,
     _socket (socket_),
     _io_thread (io_thread_),
     _has_linger_timer (false),
+    _linger (options_.linger.load ()),
+    _has_rebalance_timer (false),
+    _migration_target (NULL),
+    _migration_step (0),
+    _migration_acks (0),
+    _linger_left (0),
+    _reconnect_pending (false),
+    _engine_calls (0),
+    _rebalance_engine_calls (0),
+    _rebalance_thread_calls (0),
     _addr (addr_)
 #ifdef ZMQ_HAVE_WSS
     ,
@@ -125,6 +137,11 @@ zmq::session_base_t::~session_base_t ()
         _has_linger_timer = false;
     }
 
+    if (_has_rebalance_timer) {
+        cancel_timer (rebalance_timer_id);
+        _has_rebalance_timer = false;
+    }
+
     //  Close the engine.
     if (_engine)
         _engine->terminate ();
@@ -209,6 +226,22 @@ void zmq::session_base_t::flush ()
         _pipe->flush ();
 }
 
+void zmq::session_base_t::count_engine_read ()
+{
+    _engine_calls++;
+    _io_thread->count_engine_call ();
+    if (_pipe)
+        _pipe->count_engine_read ();
+}
+
+void zmq::session_base_t::count_engine_write ()
+{
+    _engine_calls++;
+    _io_thread->count_engine_call ();
+    if (_pipe)
+        _pipe->count_engine_write ();
+}
+
 void zmq::session_base_t::rollback ()
 {
     if (_pipe)
@@ -318,8 +351,16 @@ zmq::socket_base_t *zmq::session_base_t::get_socket () const
     return _socket;
 }
 
+int zmq::session_base_t::get_linger () const
+{
+    return _linger;
+}
+
 void zmq::session_base_t::process_plug ()
 {
+    if (options.rebalance_ivl > 0)
+        start_rebalance_timer ();
+
     if (_active)
         start_connecting (false);
 }
@@ -456,7 +497,12 @@ void zmq::session_base_t::engine_error (bool handshaked_,
             /* FALLTHROUGH */
         case i_engine::connection_error:
             if (_active) {
-                reconnect ();
+                //  A session on the move reconnects once it has arrived,
+                //  as the connecter's commands would not find it.
+                if (_migration_target)
+                    _reconnect_pending = true;
+                else
+                    reconnect ();
                 break;
             }
 
@@ -483,6 +529,7 @@ void zmq::session_base_t::engine_error (bool handshaked_,
 void zmq::session_base_t::process_term (int linger_)
 {
     zmq_assert (!_pending);
+    _linger = linger_;
 
     //  If the termination of the pipe happens before the term command is
     //  delivered there's nothing much to do. We can proceed with the
@@ -521,6 +568,13 @@ void zmq::session_base_t::process_term (int linger_)
 
 void zmq::session_base_t::timer_event (int id_)
 {
+    if (id_ == rebalance_timer_id) {
+        _has_rebalance_timer = false;
+        if (!is_terminating ())
+            rebalance ();
+        return;
+    }
+
     //  Linger period expired. We can proceed with termination even though
     //  there are still pending messages to be sent.
     zmq_assert (id_ == linger_timer_id);
@@ -538,6 +592,168 @@ void zmq::session_base_t::process_conn_failed ()
     send_term_endpoint (_socket, ep);
 }
 
+void zmq::session_base_t::process_crypto_done (crypto_job_t *job_)
+{
+    //  Jobs of engines that are gone were cancelled, so any other job
+    //  belongs to the current engine.
+    if (!job_->cancelled ()) {
+        zmq_assert (_engine);
+        _engine->crypto_done (job_);
+    }
+    LIBZMQ_DELETE (job_);
+}
+
+void zmq::session_base_t::start_rebalance_timer ()
+{
+    zmq_assert (!_has_rebalance_timer);
+    add_timer (options.rebalance_ivl, rebalance_timer_id);
+    _has_rebalance_timer = true;
+}
+
+void zmq::session_base_t::rebalance ()
+{
+    const uint64_t calls = _engine_calls - _rebalance_engine_calls;
+    const uint64_t thread_calls =
+      _io_thread->get_engine_calls () - _rebalance_thread_calls;
+    _rebalance_engine_calls = _engine_calls;
+    _rebalance_thread_calls = _io_thread->get_engine_calls ();
+
+    //  Only sessions with a working engine and a single pipe to the socket
+    //  move, and only while no other object may send them commands.
+    io_thread_t *target = NULL;
+    if (calls > 0 && _engine && _engine->can_migrate () && _pipe
+        && _pipe->is_active () && !_zap_pipe && _terminating_pipes.empty ()
+        && !_pending && is_settled ())
+        target = choose_io_thread (options.affinity);
+
+    if (target && target != _io_thread) {
+        //  The engine takes its share of the busy time along, estimated
+        //  from its share of the reads and writes in this I/O thread.
+        const int busy = _io_thread->get_busy ();
+        const int share = static_cast<int> (busy * calls / thread_calls);
+        if (target->get_busy () + share + rebalance_margin < busy
+            && _io_thread->may_release_session ()) {
+            migrate (target);
+            return;
+        }
+    }
+
+    start_rebalance_timer ();
+}
+
+//  A session moves to another I/O thread in four steps:
+//  1. The target I/O thread is told that the session is coming, and
+//     passes the commands to the session and its pipe back to the current
+//     one until told otherwise.
+//  2. The session and its pipe take the thread id of the target, so that
+//     commands go there. The socket and the owner, who send these
+//     commands, are synchronised with, so that they use the new id.
+//  3. Once they have acknowledged, no more commands are on their way to
+//     the current I/O thread directly. The target is synchronised with, to
+//     hold back the commands from then on.
+//  4. Once it has acknowledged, the commands it passed back have been
+//     processed. The session unplugs itself and its engine, and sends
+//     itself a command through the target, which delivers it and then the
+//     commands held back. The session plugs itself and its engine in.
+//  The session keeps working where it is until it leaves, so it does not
+//  depend on the socket to acknowledge soon, and stays around until it has
+//  arrived, even if it is terminated meanwhile.
+
+void zmq::session_base_t::migrate (io_thread_t *io_thread_)
+{
+    _migration_target = io_thread_;
+    _migration_step = 1;
+    _migration_acks = 1;
+    register_term_acks (1);
+    send_migrate (io_thread_, this, _pipe);
+}
+
+void zmq::session_base_t::process_migrate_ack ()
+{
+    zmq_assert (_migration_target);
+    if (--_migration_acks > 0)
+        return;
+
+    const uint32_t tid = _migration_target->get_tid ();
+    const uint32_t origin = _io_thread->get_tid ();
+    switch (_migration_step++) {
+        case 1: {
+            //  The socket might be gone before acknowledging once the pipe
+            //  is being terminated. Stay then.
+            if (is_terminating () || !_engine || !_pipe
+                || !_pipe->is_active ()) {
+                send_migrated (this, tid, true);
+                end_migration ();
+                return;
+            }
+
+            set_tid (tid);
+            _pipe->set_tid (tid);
+            _migration_acks = 1;
+            send_migrate_sync (_socket, this, origin);
+            own_t *const owner = get_owner ();
+            if (owner != _socket) {
+                _migration_acks++;
+                send_migrate_sync (owner, this, origin);
+            }
+            break;
+        }
+
+        case 2:
+            _migration_acks = 1;
+            send_migrate_sync (_migration_target, this, origin);
+            break;
+
+        case 3:
+            if (_engine)
+                _engine->migrate_out ();
+            if (_has_linger_timer) {
+                _linger_left = timer_left (linger_timer_id);
+                cancel_timer (linger_timer_id);
+                _has_linger_timer = false;
+            }
+            io_object_t::unplug ();
+            send_migrated (this, tid, false);
+            break;
+
+        default:
+            zmq_assert (false);
+    }
+}
+
+void zmq::session_base_t::process_migrated (bool)
+{
+    _io_thread = _migration_target;
+    io_object_t::plug (_io_thread);
+    if (_engine)
+        _engine->migrate_in (_io_thread);
+    if (_linger_left > 0) {
+        add_timer (_linger_left, linger_timer_id);
+        _has_linger_timer = true;
+        _linger_left = 0;
+    }
+    end_migration ();
+}
+
+void zmq::session_base_t::end_migration ()
+{
+    _migration_target = NULL;
+    _migration_step = 0;
+    _rebalance_engine_calls = _engine_calls;
+    _rebalance_thread_calls = _io_thread->get_engine_calls ();
+
+    if (_reconnect_pending) {
+        _reconnect_pending = false;
+        reconnect ();
+    }
+
+    if (!is_terminating ())
+        start_rebalance_timer ();
+
+    //  This may deallocate the session.
+    unregister_term_ack ();
+}
+
 void zmq::session_base_t::reconnect ()
 {
     //  For delayed connect situations, terminate the pipe
@@ -612,7 +828,12 @@ void zmq::session_base_t::start_connecting (bool wait_)
         }
     }
 #if defined ZMQ_HAVE_IPC
+#if defined ZMQ_HAVE_SHM
+    else if (_addr->protocol == protocol_name::ipc
+             || _addr->protocol == protocol_name::shm) {
+#else
     else if (_addr->protocol == protocol_name::ipc) {
+#endif
         connecter = new (std::nothrow)
           ipc_connecter_t (io_thread, this, options, _addr, wait_);
     }
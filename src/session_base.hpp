@@ -38,6 +38,10 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     void engine_error (bool handshaked_, zmq::i_engine::error_reason_t reason_);
     void engine_ready ();
 
+    //  Count the system calls of the engine in the pipe's statistics.
+    void count_engine_read ();
+    void count_engine_write ();
+
     //  i_pipe_events interface implementation.
     void read_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
     void write_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
@@ -69,6 +73,10 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     socket_base_t *get_socket () const;
     const endpoint_uri_pair_t &get_endpoint () const;
 
+    //  Linger period the socket was closed with, or the one it had when
+    //  the session was created if it has not been closed.
+    int get_linger () const;
+
   protected:
     session_base_t (zmq::io_thread_t *io_thread_,
                     bool active_,
@@ -82,11 +90,21 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
 
     void reconnect ();
 
+    //  Moves the session with its engine to a less busy I/O thread, if
+    //  there is one, see ZMQ_REBALANCE_IVL.
+    void rebalance ();
+    void start_rebalance_timer ();
+    void migrate (zmq::io_thread_t *io_thread_);
+    void end_migration ();
+
     //  Handlers for incoming commands.
     void process_plug () ZMQ_FINAL;
     void process_attach (zmq::i_engine *engine_) ZMQ_FINAL;
     void process_term (int linger_) ZMQ_FINAL;
     void process_conn_failed () ZMQ_OVERRIDE;
+    void process_crypto_done (zmq::crypto_job_t *job_) ZMQ_FINAL;
+    void process_migrate_ack () ZMQ_FINAL;
+    void process_migrated (bool cancelled_) ZMQ_FINAL;
 
     //  i_poll_events handlers.
     void timer_event (int id_) ZMQ_FINAL;
@@ -135,6 +153,46 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     //  True is linger timer is running.
     bool _has_linger_timer;
 
+    //  See get_linger.
+    int _linger;
+
+    //  ID of the timer checking whether to move to another I/O thread.
+    enum
+    {
+        rebalance_timer_id = 0x21
+    };
+
+    //  True if the rebalance timer is running.
+    bool _has_rebalance_timer;
+
+    //  Another I/O thread is to be clearly less busy than the current one
+    //  for the session to move there, by this much in thousandths.
+    enum
+    {
+        rebalance_margin = 100
+    };
+
+    //  I/O thread the session is moving to, NULL if it is not moving.
+    zmq::io_thread_t *_migration_target;
+
+    //  Step of the move the session is at, and the number of
+    //  acknowledgements to wait for before taking the next one.
+    int _migration_step;
+    int _migration_acks;
+
+    //  Time the linger timer had left when the session moved, or 0.
+    int _linger_left;
+
+    //  True if the engine failed while the session was moving, and the
+    //  session is to reconnect once it has arrived.
+    bool _reconnect_pending;
+
+    //  Reads and writes made by the engines of the session, and this
+    //  count and the one of the I/O thread at the last rebalance check.
+    uint64_t _engine_calls;
+    uint64_t _rebalance_engine_calls;
+    uint64_t _rebalance_thread_calls;
+
     //  Protocol and address to use when connecting.
     address_t *_addr;
 
@@ -0,0 +1,231 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "shm_engine.hpp"
+
+#if defined ZMQ_HAVE_SHM
+
+#include <new>
+
+#include "shm_segment.hpp"
+#include "clock.hpp"
+#include "err.hpp"
+#include "likely.hpp"
+#include "tcp.hpp"
+
+zmq::shm_engine_t::shm_engine_t (
+  fd_t fd_,
+  const options_t &options_,
+  const endpoint_uri_pair_t &endpoint_uri_pair_,
+  shm_segment_t *segment_) :
+    zmtp_engine_t (fd_, options_, endpoint_uri_pair_),
+    _control (fd_),
+    _segment (segment_),
+    _doorbell_handle (static_cast<handle_t> (NULL)),
+    _doorbell_rung (false),
+    _peer_closed (false),
+    _output_blocked (false),
+    _spin_time (options_.shm_spin)
+{
+}
+
+zmq::shm_engine_t::~shm_engine_t ()
+{
+    LIBZMQ_DELETE (_segment);
+}
+
+void zmq::shm_engine_t::plug_internal ()
+{
+    if (_segment)
+        plug_doorbell ();
+    zmtp_engine_t::plug_internal ();
+}
+
+void zmq::shm_engine_t::unplug_internal ()
+{
+    if (_doorbell_handle) {
+        rm_fd (_doorbell_handle);
+        _doorbell_handle = static_cast<handle_t> (NULL);
+    }
+}
+
+void zmq::shm_engine_t::plug_doorbell ()
+{
+    _doorbell_handle = add_fd (_segment->doorbell ());
+    io_object_t::set_pollin (_doorbell_handle);
+}
+
+bool zmq::shm_engine_t::handshake ()
+{
+    if (unlikely (!_segment)) {
+        shm_segment_t *segment = new (std::nothrow) shm_segment_t;
+        alloc_assert (segment);
+        if (segment->receive (_control) == -1) {
+            const bool pending = errno == EAGAIN;
+            LIBZMQ_DELETE (segment);
+            if (!pending)
+                error (connection_error);
+            return false;
+        }
+        _segment = segment;
+        plug_doorbell ();
+
+        //  Write the greeting held back until now.
+        out_event ();
+    }
+    return zmtp_engine_t::handshake ();
+}
+
+void zmq::shm_engine_t::in_event ()
+{
+    //  The poller does not tell whether it is the doorbell or the socket
+    //  that is ready.
+    if (likely (_segment != NULL)) {
+        //  The ring is read again once the session takes messages.
+        if (_input_stopped)
+            silence_doorbell ();
+
+        if (_output_blocked && _segment->writable ())
+            out_event ();
+
+        if (_input_stopped)
+            return;
+    }
+    stream_engine_base_t::in_event ();
+}
+
+void zmq::shm_engine_t::out_event ()
+{
+    if (_output_blocked) {
+        if (!_segment || !_segment->writable ()) {
+            reset_pollout ();
+            return;
+        }
+        _output_blocked = false;
+        set_pollout ();
+    }
+
+    //  The engine may be gone afterwards, see write for the rest.
+    stream_engine_base_t::out_event ();
+}
+
+void zmq::shm_engine_t::block_output ()
+{
+    //  The socket is always writable, the doorbell tells when the ring is.
+    _output_blocked = true;
+    reset_pollout ();
+}
+
+void zmq::shm_engine_t::check_peer ()
+{
+    //  Nothing but the segment is sent over the socket, anything else is
+    //  dropped.
+    unsigned char buf[64];
+    const int rc = tcp_read (_control, buf, sizeof buf);
+    if (rc == 0 || (rc == -1 && errno != EAGAIN))
+        _peer_closed = true;
+}
+
+void zmq::shm_engine_t::ring_doorbell ()
+{
+    if (!_doorbell_rung) {
+        _segment->ring ();
+        _doorbell_rung = true;
+    }
+}
+
+bool zmq::shm_engine_t::silence_doorbell ()
+{
+    const bool rung = _segment->answer ();
+    _doorbell_rung = false;
+
+    //  Space may have been what the peer rang for.
+    if (_output_blocked && _segment->writable ())
+        ring_doorbell ();
+    return rung;
+}
+
+int zmq::shm_engine_t::read (void *data_, size_t size_)
+{
+    zmq_assert (_segment);
+
+    int nbytes = _segment->read (data_, size_);
+    if (nbytes == 0 && _spin_time > 0) {
+        const uint64_t deadline = clock_t::now_us () + _spin_time;
+        while (nbytes == 0 && clock_t::now_us () < deadline)
+            nbytes = _segment->read (data_, size_);
+    }
+    if (nbytes == -1) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    //  Come back for whatever is left, or to spin again when spinning.
+    //  The poller keeps calling back for as long as the doorbell stays
+    //  rung, which costs less than ringing it again.
+    if (nbytes > 0 && (_spin_time > 0 || _segment->readable ())) {
+        ring_doorbell ();
+        return nbytes;
+    }
+
+    //  Going idle. The peer rings once it has written more.
+    const bool rung = silence_doorbell ();
+    if (!_segment->wait_for_data ())
+        ring_doorbell ();
+    if (nbytes > 0)
+        return nbytes;
+
+    //  A wake-up not coming from the doorbell may be the peer leaving.
+    if (!rung && !_peer_closed)
+        check_peer ();
+    if (_peer_closed) {
+        errno = EPIPE;
+        return -1;
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+int zmq::shm_engine_t::write (const void *data_, size_t size_)
+{
+    //  The outbound ring is not there until the segment is received.
+    if (unlikely (!_segment)) {
+        block_output ();
+        return 0;
+    }
+
+    const unsigned char *data = static_cast<const unsigned char *> (data_);
+    size_t written = 0;
+    while (written < size_) {
+        const int nbytes = _segment->write (data + written, size_ - written);
+        if (nbytes == -1) {
+            errno = EPROTO;
+            return -1;
+        }
+        written += nbytes;
+        if (written < size_ && _segment->wait_for_space ()) {
+            block_output ();
+            break;
+        }
+    }
+    return static_cast<int> (written);
+}
+
+#if defined ZMQ_HAVE_UIO
+int zmq::shm_engine_t::writev (const iovec *iov_, int iovcnt_)
+{
+    //  Message bodies are copied straight to the ring.
+    int written = 0;
+    for (int i = 0; i != iovcnt_; i++) {
+        const int nbytes = write (iov_[i].iov_base, iov_[i].iov_len);
+        if (nbytes == -1)
+            return -1;
+        written += nbytes;
+        if (static_cast<size_t> (nbytes) < iov_[i].iov_len)
+            break;
+    }
+    return written;
+}
+#endif
+
+#endif
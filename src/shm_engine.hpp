@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_SHM_ENGINE_HPP_INCLUDED__
+#define __ZMQ_SHM_ENGINE_HPP_INCLUDED__
+
+#if defined ZMQ_HAVE_SHM
+
+#include <stddef.h>
+
+#include "fd.hpp"
+#include "zmtp_engine.hpp"
+
+namespace zmq
+{
+class shm_segment_t;
+
+//  Engine of the shm:// transport. It speaks ZMTP like the ipc:// one, but
+//  over the rings of a shared memory segment. The UNIX domain socket of the
+//  connection only carries the segment, and tells when the peer is gone.
+
+class shm_engine_t ZMQ_FINAL : public zmtp_engine_t
+{
+  public:
+    //  The connecting end passes the segment it has created and sent, the
+    //  other end receives it during the handshake.
+    shm_engine_t (fd_t fd_,
+                  const options_t &options_,
+                  const endpoint_uri_pair_t &endpoint_uri_pair_,
+                  shm_segment_t *segment_);
+    ~shm_engine_t ();
+
+    //  The doorbell is polled besides the socket, so the engine stays
+    //  with its I/O thread.
+    bool can_migrate () const ZMQ_FINAL { return false; }
+
+    //  i_poll_events interface implementation.
+    void in_event () ZMQ_FINAL;
+    void out_event () ZMQ_FINAL;
+
+  protected:
+    bool handshake () ZMQ_FINAL;
+    void plug_internal () ZMQ_FINAL;
+    void unplug_internal () ZMQ_FINAL;
+
+    int read (void *data_, size_t size_) ZMQ_FINAL;
+    int write (const void *data_, size_t size_) ZMQ_FINAL;
+#if defined ZMQ_HAVE_UIO
+    int writev (const iovec *iov_, int iovcnt_) ZMQ_FINAL;
+#endif
+
+  private:
+    //  Starts polling the doorbell of the segment.
+    void plug_doorbell ();
+
+    //  Makes the poller call back until the doorbell is silenced.
+    void ring_doorbell ();
+
+    //  Silences the doorbell, returning whether it had been rung.
+    bool silence_doorbell ();
+
+    //  Stops writing until the ring has space again.
+    void block_output ();
+
+    //  Checks whether the peer has closed the socket.
+    void check_peer ();
+
+    //  The UNIX domain socket of the connection.
+    const fd_t _control;
+
+    shm_segment_t *_segment;
+
+    handle_t _doorbell_handle;
+
+    //  True if this end has rung its own doorbell, or has not silenced it
+    //  since being woken up by the peer.
+    bool _doorbell_rung;
+
+    //  True once the peer has closed the socket. What it has written to
+    //  the ring before is still read.
+    bool _peer_closed;
+
+    //  True iff the outbound ring is full, or not received yet. The engine
+    //  then waits for the doorbell rather than for the socket, which is
+    //  always writable.
+    bool _output_blocked;
+
+    //  Microseconds spent spinning on an empty ring before waiting for the
+    //  doorbell, see ZMQ_SHM_SPIN.
+    const int _spin_time;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (shm_engine_t)
+};
+}
+
+#endif
+
+#endif
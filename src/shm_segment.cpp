@@ -0,0 +1,381 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "shm_segment.hpp"
+
+#if defined ZMQ_HAVE_SHM
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "err.hpp"
+
+//  Fields written by different ends live on different cache lines.
+static const size_t line_size = 64;
+
+//  The header and the ring positions take the first page, the data of the
+//  inbound and outbound rings follow.
+static const size_t control_size = 4096;
+
+static const uint32_t segment_magic = 0x7a6d7173;
+static const uint32_t segment_version = 1;
+
+static const size_t min_ring_size = 4096;
+static const size_t max_ring_size = static_cast<size_t> (1) << 30;
+
+namespace
+{
+struct header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ring_size;
+};
+}
+
+struct zmq::shm_segment_t::ring_t
+{
+    //  Bytes written to the ring so far, advanced by the producer.
+    uint64_t head;
+    unsigned char pad0[line_size - sizeof (uint64_t)];
+
+    //  Bytes read from the ring so far, advanced by the consumer.
+    uint64_t tail;
+    unsigned char pad1[line_size - sizeof (uint64_t)];
+
+    //  Set by the consumer once it has run out of data, cleared by the
+    //  producer when it rings the consumer's doorbell.
+    uint32_t reader_waiting;
+    unsigned char pad2[line_size - sizeof (uint32_t)];
+
+    //  Set by the producer once it has run out of space, cleared by the
+    //  consumer when it rings the producer's doorbell.
+    uint32_t writer_waiting;
+    unsigned char pad3[line_size - sizeof (uint32_t)];
+};
+
+static void close_fd (zmq::fd_t fd_)
+{
+    if (fd_ != zmq::retired_fd) {
+        const int rc = close (fd_);
+        errno_assert (rc == 0);
+    }
+}
+
+zmq::shm_segment_t::shm_segment_t () :
+    _base (NULL),
+    _mapped_size (0),
+    _in (NULL),
+    _out (NULL),
+    _in_data (NULL),
+    _out_data (NULL),
+    _ring_size (0),
+    _in_tail (0),
+    _out_head (0),
+    _doorbell (retired_fd),
+    _peer_doorbell (retired_fd)
+{
+}
+
+zmq::shm_segment_t::~shm_segment_t ()
+{
+    if (_base) {
+        const int rc = munmap (_base, _mapped_size);
+        errno_assert (rc == 0);
+    }
+    close_fd (_doorbell);
+    close_fd (_peer_doorbell);
+}
+
+int zmq::shm_segment_t::create (fd_t s_, size_t ring_size_)
+{
+    zmq_assert (_base == NULL);
+    zmq_assert (ring_size_ >= min_ring_size && ring_size_ <= max_ring_size
+                && (ring_size_ & (ring_size_ - 1)) == 0);
+
+    const fd_t memfd = memfd_create ("zmq-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd == retired_fd)
+        return -1;
+
+    //  Once sealed, the peer cannot shrink the segment under our feet.
+    int rc = ftruncate (memfd, control_size + 2 * ring_size_);
+#if defined F_ADD_SEALS
+    if (rc == 0)
+        rc = fcntl (memfd, F_ADD_SEALS,
+                    F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+#endif
+    if (rc == 0)
+        rc = map (memfd, ring_size_, true);
+    if (rc == 0) {
+        _doorbell = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+        _peer_doorbell = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_doorbell == retired_fd || _peer_doorbell == retired_fd)
+            rc = -1;
+    }
+
+    //  Hand the segment and both doorbells over to the peer.
+    if (rc == 0) {
+        unsigned char byte = 0;
+        iovec iov = {&byte, 1};
+        union
+        {
+            cmsghdr align;
+            char buf[CMSG_SPACE (3 * sizeof (int))];
+        } control;
+        memset (&control, 0, sizeof control);
+
+        msghdr msg;
+        memset (&msg, 0, sizeof msg);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof control.buf;
+
+        cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN (3 * sizeof (int));
+        const int fds[3] = {memfd, _peer_doorbell, _doorbell};
+        memcpy (CMSG_DATA (cmsg), fds, sizeof fds);
+
+        //  The socket has just been connected, so there is room for this.
+        const ssize_t nbytes = sendmsg (s_, &msg, MSG_NOSIGNAL);
+        if (nbytes != 1)
+            rc = -1;
+    }
+
+    const int err = errno;
+    close_fd (memfd);
+    errno = err;
+    return rc;
+}
+
+int zmq::shm_segment_t::receive (fd_t s_)
+{
+    zmq_assert (_base == NULL);
+
+    unsigned char byte;
+    iovec iov = {&byte, 1};
+    union
+    {
+        cmsghdr align;
+        char buf[CMSG_SPACE (3 * sizeof (int))];
+    } control;
+
+    msghdr msg;
+    memset (&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof control.buf;
+
+    const ssize_t nbytes = recvmsg (s_, &msg, MSG_CMSG_CLOEXEC);
+    if (nbytes == -1)
+        return -1;
+    if (nbytes == 0) {
+        errno = ECONNRESET;
+        return -1;
+    }
+
+    int fds[3] = {retired_fd, retired_fd, retired_fd};
+    size_t fd_count = 0;
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR (&msg); cmsg;
+         cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+        const size_t count = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+        for (size_t i = 0; i != count; i++) {
+            int fd;
+            memcpy (&fd, CMSG_DATA (cmsg) + i * sizeof (int), sizeof fd);
+            if (fd_count < 3)
+                fds[fd_count] = fd;
+            else
+                close_fd (fd);
+            fd_count++;
+        }
+    }
+
+    int rc = 0;
+    if (fd_count != 3 || (msg.msg_flags & MSG_CTRUNC))
+        rc = -1;
+
+    //  Both rings must fit in the segment, which must not be allowed to
+    //  shrink.
+    size_t ring_size = 0;
+    if (rc == 0) {
+        struct stat st;
+        rc = fstat (fds[0], &st);
+        if (rc == 0 && st.st_size > static_cast<off_t> (control_size))
+            ring_size = (static_cast<size_t> (st.st_size) - control_size) / 2;
+        if (ring_size < min_ring_size || ring_size > max_ring_size
+            || (ring_size & (ring_size - 1)) != 0
+            || control_size + 2 * ring_size
+                 != static_cast<size_t> (st.st_size))
+            rc = -1;
+    }
+#if defined F_GET_SEALS
+    if (rc == 0 && !(fcntl (fds[0], F_GET_SEALS) & F_SEAL_SHRINK))
+        rc = -1;
+#endif
+    if (rc == 0)
+        rc = map (fds[0], ring_size, false);
+    if (rc == 0) {
+        const header_t *header = reinterpret_cast<const header_t *> (_base);
+        if (header->magic != segment_magic
+            || header->version != segment_version
+            || header->ring_size != ring_size)
+            rc = -1;
+    }
+
+    close_fd (fds[0]);
+    if (rc == -1) {
+        close_fd (fds[1]);
+        close_fd (fds[2]);
+        errno = EPROTO;
+        return -1;
+    }
+    _doorbell = fds[1];
+    _peer_doorbell = fds[2];
+    return 0;
+}
+
+int zmq::shm_segment_t::map (fd_t memfd_, size_t ring_size_, bool create_)
+{
+    const size_t size = control_size + 2 * ring_size_;
+    void *const base =
+      mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd_, 0);
+    if (base == MAP_FAILED)
+        return -1;
+
+    _base = static_cast<unsigned char *> (base);
+    _mapped_size = size;
+    _ring_size = ring_size_;
+
+    if (create_) {
+        header_t *header = reinterpret_cast<header_t *> (_base);
+        header->magic = segment_magic;
+        header->version = segment_version;
+        header->ring_size = ring_size_;
+    }
+
+    //  The first ring carries the data of the connecting end.
+    ring_t *const rings = reinterpret_cast<ring_t *> (_base + line_size);
+    unsigned char *const data = _base + control_size;
+    _out = create_ ? &rings[0] : &rings[1];
+    _in = create_ ? &rings[1] : &rings[0];
+    _out_data = create_ ? data : data + ring_size_;
+    _in_data = create_ ? data + ring_size_ : data;
+    return 0;
+}
+
+int zmq::shm_segment_t::read (void *data_, size_t size_)
+{
+    const uint64_t head = __atomic_load_n (&_in->head, __ATOMIC_ACQUIRE);
+    const uint64_t available = head - _in_tail;
+    if (available > _ring_size)
+        return -1;
+
+    const size_t nbytes =
+      available < size_ ? static_cast<size_t> (available) : size_;
+    if (nbytes == 0)
+        return 0;
+
+    const size_t pos = static_cast<size_t> (_in_tail & (_ring_size - 1));
+    const size_t first = nbytes < _ring_size - pos ? nbytes : _ring_size - pos;
+    memcpy (data_, _in_data + pos, first);
+    memcpy (static_cast<unsigned char *> (data_) + first, _in_data,
+            nbytes - first);
+    _in_tail += nbytes;
+    __atomic_store_n (&_in->tail, _in_tail, __ATOMIC_RELEASE);
+
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    if (__atomic_load_n (&_in->writer_waiting, __ATOMIC_RELAXED)
+        && __atomic_exchange_n (&_in->writer_waiting, 0, __ATOMIC_SEQ_CST))
+        ring_peer ();
+    return static_cast<int> (nbytes);
+}
+
+int zmq::shm_segment_t::write (const void *data_, size_t size_)
+{
+    const uint64_t tail = __atomic_load_n (&_out->tail, __ATOMIC_ACQUIRE);
+    const uint64_t used = _out_head - tail;
+    if (used > _ring_size)
+        return -1;
+
+    const size_t space = _ring_size - static_cast<size_t> (used);
+    const size_t nbytes = space < size_ ? space : size_;
+    if (nbytes == 0)
+        return 0;
+
+    const size_t pos = static_cast<size_t> (_out_head & (_ring_size - 1));
+    const size_t first = nbytes < _ring_size - pos ? nbytes : _ring_size - pos;
+    memcpy (_out_data + pos, data_, first);
+    memcpy (_out_data, static_cast<const unsigned char *> (data_) + first,
+            nbytes - first);
+    _out_head += nbytes;
+    __atomic_store_n (&_out->head, _out_head, __ATOMIC_RELEASE);
+
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    if (__atomic_load_n (&_out->reader_waiting, __ATOMIC_RELAXED)
+        && __atomic_exchange_n (&_out->reader_waiting, 0, __ATOMIC_SEQ_CST))
+        ring_peer ();
+    return static_cast<int> (nbytes);
+}
+
+bool zmq::shm_segment_t::readable () const
+{
+    return __atomic_load_n (&_in->head, __ATOMIC_ACQUIRE) != _in_tail;
+}
+
+bool zmq::shm_segment_t::writable () const
+{
+    //  A corrupted ring counts as writable, for write to report it.
+    return _out_head - __atomic_load_n (&_out->tail, __ATOMIC_ACQUIRE)
+           != _ring_size;
+}
+
+bool zmq::shm_segment_t::wait_for_data ()
+{
+    __atomic_store_n (&_in->reader_waiting, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    return !readable ();
+}
+
+bool zmq::shm_segment_t::wait_for_space ()
+{
+    __atomic_store_n (&_out->writer_waiting, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    return !writable ();
+}
+
+void zmq::shm_segment_t::ring ()
+{
+    const uint64_t one = 1;
+    const ssize_t rc = ::write (_doorbell, &one, sizeof one);
+    errno_assert (rc == sizeof one || errno == EAGAIN);
+}
+
+bool zmq::shm_segment_t::answer ()
+{
+    uint64_t count;
+    const ssize_t rc = ::read (_doorbell, &count, sizeof count);
+    if (rc == -1) {
+        errno_assert (errno == EAGAIN);
+        return false;
+    }
+    return true;
+}
+
+void zmq::shm_segment_t::ring_peer ()
+{
+    const uint64_t one = 1;
+    const ssize_t rc = ::write (_peer_doorbell, &one, sizeof one);
+    errno_assert (rc == sizeof one || errno == EAGAIN);
+}
+
+#endif
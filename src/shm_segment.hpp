@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_SHM_SEGMENT_HPP_INCLUDED__
+#define __ZMQ_SHM_SEGMENT_HPP_INCLUDED__
+
+#if defined ZMQ_HAVE_SHM
+
+#include <stddef.h>
+
+#include "fd.hpp"
+#include "macros.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+//  Memory shared by the two ends of an shm:// connection. It holds a pair
+//  of single producer, single consumer byte rings, one for each direction.
+//
+//  The connecting end creates the segment together with an eventfd for
+//  each end, its doorbell, and sends them to the other end over the UNIX
+//  domain socket of the connection. An end rings the doorbell of its peer
+//  only when the peer has run out of data to read or of space to write
+//  to, and said so in the ring.
+//
+//  The peer may be another process and is not trusted: whatever it writes
+//  to the segment is checked before being used.
+
+class shm_segment_t
+{
+  public:
+    shm_segment_t ();
+    ~shm_segment_t ();
+
+    //  Creates a segment with rings of ring_size_ bytes, a power of two,
+    //  and sends it to the peer. Returns -1 and sets errno on failure.
+    int create (fd_t s_, size_t ring_size_);
+
+    //  Receives the segment created by the peer. Returns -1 with errno set
+    //  to EAGAIN if it has not arrived yet.
+    int receive (fd_t s_);
+
+    //  Copies up to size_ bytes from the inbound ring. Returns the number
+    //  of bytes copied, or -1 if the peer has corrupted the ring.
+    int read (void *data_, size_t size_);
+
+    //  Copies up to size_ bytes to the outbound ring. Returns the number of
+    //  bytes copied, or -1 if the peer has corrupted the ring.
+    int write (const void *data_, size_t size_);
+
+    bool readable () const;
+    bool writable () const;
+
+    //  Ask the peer to ring the doorbell once there is data to read or
+    //  space to write to. Return false if there is already, in which case
+    //  the peer may or may not ring.
+    bool wait_for_data ();
+    bool wait_for_space ();
+
+    //  The doorbell of this end, readable once it has been rung.
+    fd_t doorbell () const { return _doorbell; }
+
+    //  Rings the doorbell of this end, to be called back from the poller.
+    void ring ();
+
+    //  Returns whether the doorbell of this end has been rung, silencing
+    //  it.
+    bool answer ();
+
+  private:
+    struct ring_t;
+
+    int map (fd_t memfd_, size_t ring_size_, bool create_);
+    void ring_peer ();
+
+    //  Rings, as mapped, and their data.
+    unsigned char *_base;
+    size_t _mapped_size;
+    ring_t *_in;
+    ring_t *_out;
+    unsigned char *_in_data;
+    unsigned char *_out_data;
+    size_t _ring_size;
+
+    //  Positions of this end in the rings, as they are not to be read back
+    //  from shared memory.
+    uint64_t _in_tail;
+    uint64_t _out_head;
+
+    fd_t _doorbell;
+    fd_t _peer_doorbell;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (shm_segment_t)
+};
+}
+
+#endif
+
+#endif
@@ -223,17 +223,26 @@ zmq::socket_base_t::socket_base_t (ctx_t *parent_,
     _handle (static_cast<poller_t::handle_t> (NULL)),
     _last_tsc (0),
     _ticks (0),
+    _spin_wait_avg (0),
+    _spin_adapted (0),
+    _spin_wasted (false),
+    _spin_backoff (0),
+    _spin_skip (0),
     _rcvmore (false),
     _monitor_socket (NULL),
     _monitor_events (0),
     _thread_safe (thread_safe_),
     _reaper_signaler (NULL),
-    _monitor_sync ()
+    _monitor_sync (),
+    _stats_sync ()
 {
+    memset (&_retired_stats, 0, sizeof (_retired_stats));
+
     options.socket_id = sid_;
     options.ipv6 = (parent_->get (ZMQ_IPV6) != 0);
     options.linger.store (parent_->get (ZMQ_BLOCKY) ? -1 : 0);
     options.zero_copy = parent_->get (ZMQ_ZERO_COPY_RECV) != 0;
+    options.msg_allocator = parent_->get_msg_allocator ();
 
     if (_thread_safe) {
         _mailbox = new (std::nothrow) mailbox_safe_t (&_sync);
@@ -251,6 +260,80 @@ zmq::socket_base_t::socket_base_t (ctx_t *parent_,
     }
 }
 
+static void add_stats (zmq_socket_stats_t *to_, const zmq_socket_stats_t &from_)
+{
+    to_->msgs_in += from_.msgs_in;
+    to_->bytes_in += from_.bytes_in;
+    to_->msgs_out += from_.msgs_out;
+    to_->bytes_out += from_.bytes_out;
+    to_->queued_in += from_.queued_in;
+    to_->queued_out += from_.queued_out;
+    to_->hwm_hits += from_.hwm_hits;
+    to_->drops += from_.drops;
+    to_->engine_reads += from_.engine_reads;
+    to_->engine_writes += from_.engine_writes;
+}
+
+static void copy_endpoint (char *to_, const std::string &from_)
+{
+    const size_t size = std::min (from_.size (),
+                                  static_cast<size_t> (ZMQ_STATS_ENDPOINT_MAX - 1));
+    memcpy (to_, from_.data (), size);
+    to_[size] = 0;
+}
+
+int zmq::socket_base_t::get_stats (zmq_socket_stats_t *stats_,
+                                   zmq_pipe_stats_t *pipes_,
+                                   size_t *pipe_count_)
+{
+    if (pipes_ && !pipe_count_) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    scoped_lock_t lock (_stats_sync);
+
+    zmq_socket_stats_t totals = _retired_stats;
+    for (pipes_t::size_type i = 0, size = _pipes.size (); i != size; ++i) {
+        zmq_socket_stats_t pipe_stats;
+        _pipes[i]->get_stats (&pipe_stats);
+        add_stats (&totals, pipe_stats);
+
+        if (pipes_ && i < *pipe_count_) {
+            const endpoint_uri_pair_t &endpoint_pair =
+              _pipes[i]->get_endpoint_pair ();
+            copy_endpoint (pipes_[i].local_endpoint, endpoint_pair.local);
+            copy_endpoint (pipes_[i].remote_endpoint, endpoint_pair.remote);
+            pipes_[i].stats = pipe_stats;
+        }
+    }
+
+    if (stats_)
+        *stats_ = totals;
+    if (pipe_count_)
+        *pipe_count_ = _pipes.size ();
+    return 0;
+}
+
+void zmq::socket_base_t::retire_pipe (pipe_t *pipe_)
+{
+    scoped_lock_t lock (_stats_sync);
+
+    //  Messages still queued are gone with the pipe.
+    zmq_socket_stats_t pipe_stats;
+    pipe_->get_stats (&pipe_stats);
+    pipe_stats.queued_in = 0;
+    pipe_stats.queued_out = 0;
+    add_stats (&_retired_stats, pipe_stats);
+
+    _pipes.erase (pipe_);
+}
+
+void zmq::socket_base_t::launch_owned (own_t *object_)
+{
+    launch_child (object_);
+}
+
 int zmq::socket_base_t::get_peer_state (const void *routing_id_,
                                         size_t routing_id_size_) const
 {
@@ -320,6 +403,9 @@ int zmq::socket_base_t::check_protocol (const std::string &protocol_) const
     if (protocol_ != protocol_name::inproc
 #if defined ZMQ_HAVE_IPC
         && protocol_ != protocol_name::ipc
+#endif
+#if defined ZMQ_HAVE_SHM
+        && protocol_ != protocol_name::shm
 #endif
         && protocol_ != protocol_name::tcp
 #ifdef ZMQ_HAVE_WS
@@ -374,6 +460,14 @@ int zmq::socket_base_t::check_protocol (const std::string &protocol_) const
         return -1;
     }
 
+#if defined ZMQ_HAVE_SHM
+    //  Raw connections have no framing to carry over the rings.
+    if (protocol_ == protocol_name::shm && options.type == ZMQ_STREAM) {
+        errno = ENOCOMPATPROTO;
+        return -1;
+    }
+#endif
+
     //  Protocol is available.
     return 0;
 }
@@ -384,7 +478,10 @@ void zmq::socket_base_t::attach_pipe (pipe_t *pipe_,
 {
     //  First, register the pipe so that we can terminate it later on.
     pipe_->set_event_sink (this);
-    _pipes.push_back (pipe_);
+    {
+        scoped_lock_t lock (_stats_sync);
+        _pipes.push_back (pipe_);
+    }
 
     //  Let the derived socket type know about new pipe.
     xattach_pipe (pipe_, subscribe_to_all_, locally_initiated_);
@@ -676,9 +773,15 @@ int zmq::socket_base_t::bind (const char *endpoint_uri_)
 #endif
 
 #if defined ZMQ_HAVE_IPC
+#if defined ZMQ_HAVE_SHM
+    if (protocol == protocol_name::ipc || protocol == protocol_name::shm) {
+        ipc_listener_t *listener = new (std::nothrow) ipc_listener_t (
+          io_thread, this, options, protocol == protocol_name::shm);
+#else
     if (protocol == protocol_name::ipc) {
         ipc_listener_t *listener =
-          new (std::nothrow) ipc_listener_t (io_thread, this, options);
+          new (std::nothrow) ipc_listener_t (io_thread, this, options, false);
+#endif
         alloc_assert (listener);
         int rc = listener->set_local_address (address.c_str ());
         if (rc != 0) {
@@ -964,7 +1067,12 @@ int zmq::socket_base_t::connect_internal (const char *endpoint_uri_)
 #endif
 
 #if defined ZMQ_HAVE_IPC
+#if defined ZMQ_HAVE_SHM
+    else if (protocol == protocol_name::ipc
+             || protocol == protocol_name::shm) {
+#else
     else if (protocol == protocol_name::ipc) {
+#endif
         paddr->resolved.ipc_addr = new (std::nothrow) ipc_address_t ();
         alloc_assert (paddr->resolved.ipc_addr);
         int rc = paddr->resolved.ipc_addr->resolve (address.c_str ());
@@ -1129,8 +1237,10 @@ void zmq::socket_base_t::add_endpoint (
     _endpoints.ZMQ_MAP_INSERT_OR_EMPLACE (endpoint_pair_.identifier (),
                                           endpoint_pipe_t (endpoint_, pipe_));
 
-    if (pipe_ != NULL)
+    if (pipe_ != NULL) {
+        scoped_lock_t lock (_stats_sync);
         pipe_->set_endpoint_pair (endpoint_pair_);
+    }
 }
 
 int zmq::socket_base_t::term_endpoint (const char *endpoint_uri_)
@@ -1356,16 +1466,25 @@ int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
     int timeout = options.rcvtimeo;
     const uint64_t end = timeout < 0 ? 0 : (_clock.now_ms () + timeout);
 
+    //  Measure the wait if the spin time is tuned to it.
+    const uint64_t wait_start = spin_adaptive () ? _clock.now_us () : 0;
+
     //  In blocking scenario, commands are processed over and over again until
     //  we are able to fetch a message.
     bool block = (_ticks != 0);
     while (true) {
+        //  Before going to sleep, spin for a while to see whether commands
+        //  arrive.
+        if (block && spin (timeout))
+            block = false;
         if (unlikely (process_commands (block ? timeout : 0, false) != 0)) {
             return -1;
         }
         rc = xrecv (msg_);
         if (rc == 0) {
             _ticks = 0;
+            if (wait_start)
+                adapt_spin (_clock.now_us () - wait_start);
             break;
         }
         if (unlikely (errno != EAGAIN)) {
@@ -1385,6 +1504,186 @@ int zmq::socket_base_t::recv (msg_t *msg_, int flags_)
     return 0;
 }
 
+int zmq::socket_base_t::send_batch (msg_t *msgs_, size_t count_, int flags_)
+{
+    scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+
+    //  Check whether the context hasn't been shut down yet.
+    if (unlikely (_ctx_terminated)) {
+        errno = ETERM;
+        return -1;
+    }
+
+    //  Check whether messages passed to the function are valid.
+    if (unlikely (count_
+                  > static_cast<size_t> (std::numeric_limits<int>::max ()))) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (unlikely (!msgs_ && count_ > 0)) {
+        errno = EFAULT;
+        return -1;
+    }
+    for (size_t i = 0; i != count_; i++)
+        if (unlikely (!msgs_[i].check ())) {
+            errno = EFAULT;
+            return -1;
+        }
+    if (count_ == 0)
+        return 0;
+
+    //  Process pending commands, if any, once for the whole batch.
+    int rc = process_commands (0, true);
+    if (unlikely (rc != 0)) {
+        return -1;
+    }
+
+    //  Unlike with send, the more flags of the messages are kept as they
+    //  are, as they delimit the messages of the batch.
+    for (size_t i = 0; i != count_; i++)
+        msgs_[i].reset_metadata ();
+
+    rc = try_send_batch (msgs_, count_);
+    if (rc > 0) {
+        return rc;
+    }
+    //  As in send, a dead pipe in the middle of a multi-part message to
+    //  a ZMQ_PUSH socket drops the part silently in blocking mode.
+    if (unlikely (rc == -2)) {
+        if (!((flags_ & ZMQ_DONTWAIT) || options.sndtimeo == 0)) {
+            rc = msgs_[0].close ();
+            errno_assert (rc == 0);
+            rc = msgs_[0].init ();
+            errno_assert (rc == 0);
+            return 1;
+        }
+    }
+    if (unlikely (errno != EAGAIN)) {
+        return -1;
+    }
+
+    //  In case of non-blocking send we'll simply propagate
+    //  the error - including EAGAIN - up the stack.
+    if ((flags_ & ZMQ_DONTWAIT) || options.sndtimeo == 0) {
+        return -1;
+    }
+
+    //  Compute the time when the timeout should occur.
+    //  If the timeout is infinite, don't care.
+    int timeout = options.sndtimeo;
+    const uint64_t end = timeout < 0 ? 0 : (_clock.now_ms () + timeout);
+
+    //  Nothing could be sent. Wait until the first message can be, and
+    //  then send as many as possible, as above.
+    while (true) {
+        if (unlikely (process_commands (timeout, false) != 0)) {
+            return -1;
+        }
+        rc = try_send_batch (msgs_, count_);
+        if (rc > 0)
+            break;
+        if (unlikely (errno != EAGAIN)) {
+            return -1;
+        }
+        if (timeout > 0) {
+            timeout = static_cast<int> (end - _clock.now_ms ());
+            if (timeout <= 0) {
+                errno = EAGAIN;
+                return -1;
+            }
+        }
+    }
+
+    return rc;
+}
+
+int zmq::socket_base_t::recv_batch (msg_t *msgs_, size_t count_, int flags_)
+{
+    scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
+
+    //  Check whether the context hasn't been shut down yet.
+    if (unlikely (_ctx_terminated)) {
+        errno = ETERM;
+        return -1;
+    }
+
+    //  Check whether messages passed to the function are valid.
+    if (unlikely (count_
+                  > static_cast<size_t> (std::numeric_limits<int>::max ()))) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (unlikely (!msgs_ && count_ > 0)) {
+        errno = EFAULT;
+        return -1;
+    }
+    for (size_t i = 0; i != count_; i++)
+        if (unlikely (!msgs_[i].check ())) {
+            errno = EFAULT;
+            return -1;
+        }
+    if (count_ == 0)
+        return 0;
+
+    //  Process pending commands, if any, once for the whole batch. As
+    //  with send, this is throttled rather than done every few messages.
+    if (unlikely (process_commands (0, true) != 0)) {
+        return -1;
+    }
+    _ticks = 0;
+
+    int rc = try_recv_batch (msgs_, count_);
+    if (rc < 0) {
+        if (unlikely (errno != EAGAIN)) {
+            return -1;
+        }
+
+        //  Nothing was there to receive. Get the first message the way
+        //  recv does, which includes waiting for it, and then whatever
+        //  arrived along with it.
+        if (recv (&msgs_[0], flags_) != 0) {
+            return -1;
+        }
+        rc = 1;
+        if (count_ > 1) {
+            const int more = try_recv_batch (msgs_ + 1, count_ - 1);
+            if (more > 0)
+                rc += more;
+        }
+    }
+
+    for (int i = 0; i != rc; i++)
+        extract_flags (&msgs_[i]);
+    return rc;
+}
+
+int zmq::socket_base_t::try_send_batch (msg_t *msgs_, size_t count_)
+{
+    if (unlikely (!xbegin_batch (true))) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    size_t sent = 0;
+    int rc = 0;
+    while (sent != count_ && (rc = xsend (&msgs_[sent])) == 0)
+        sent++;
+    xend_batch (true);
+    return sent > 0 ? static_cast<int> (sent) : rc;
+}
+
+int zmq::socket_base_t::try_recv_batch (msg_t *msgs_, size_t count_)
+{
+    if (unlikely (!xbegin_batch (false))) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    size_t received = 0;
+    while (received != count_ && xrecv (&msgs_[received]) == 0)
+        received++;
+    xend_batch (false);
+    return received > 0 ? static_cast<int> (received) : -1;
+}
+
 int zmq::socket_base_t::close ()
 {
     scoped_optional_lock_t sync_lock (_thread_safe ? &_sync : NULL);
@@ -1448,6 +1747,89 @@ void zmq::socket_base_t::start_reaping (poller_t *poller_)
     check_destroy ();
 }
 
+int zmq::socket_base_t::spin_time () const
+{
+    //  Thread-safe sockets may not hold their lock while spinning.
+    if (_thread_safe || options.spin_time == 0)
+        return 0;
+    if (!options.spin_adaptive)
+        return options.spin_time;
+    return _spin_skip ? 0 : _spin_adapted;
+}
+
+bool zmq::socket_base_t::spin_begin ()
+{
+    zmq_assert (!_thread_safe);
+    return static_cast<mailbox_t *> (_mailbox)->spin_begin ();
+}
+
+bool zmq::socket_base_t::spin_check () const
+{
+    return static_cast<const mailbox_t *> (_mailbox)->spin_check ();
+}
+
+bool zmq::socket_base_t::spin_end ()
+{
+    const bool arrived = static_cast<mailbox_t *> (_mailbox)->spin_end ();
+    _spin_wasted = !arrived;
+    return arrived;
+}
+
+bool zmq::socket_base_t::spin_adaptive () const
+{
+    return options.spin_adaptive && options.spin_time != 0 && !_thread_safe;
+}
+
+void zmq::socket_base_t::adapt_spin (uint64_t waited_us_)
+{
+    if (!spin_adaptive ())
+        return;
+
+    //  Spinning did not pay off, possibly because it kept the sender from
+    //  running. The wait tells little then; rather back off for a while.
+    if (_spin_wasted) {
+        _spin_wasted = false;
+        _spin_backoff = std::min (_spin_backoff * 2 + 1,
+                                  static_cast<int> (max_spin_backoff));
+        _spin_skip = _spin_backoff;
+        return;
+    }
+    if (_spin_skip)
+        _spin_skip--;
+    else
+        _spin_backoff = 0;
+
+    //  Waits longer than twice the limit all mean that spinning is useless;
+    //  clipping them lets the average recover quickly after idle periods.
+    const uint64_t limit = static_cast<uint64_t> (options.spin_time);
+    if (waited_us_ > 2 * limit)
+        waited_us_ = 2 * limit;
+    _spin_wait_avg = (_spin_wait_avg * 7 + waited_us_) / 8;
+
+    //  Spin somewhat longer than the typical wait, as long as that stays
+    //  within the limit.
+    if (_spin_wait_avg > limit)
+        _spin_adapted = 0;
+    else
+        _spin_adapted = static_cast<int> (std::min (2 * _spin_wait_avg, limit));
+}
+
+bool zmq::socket_base_t::spin (int timeout_)
+{
+    uint64_t spin = static_cast<uint64_t> (spin_time ());
+    if (spin == 0)
+        return false;
+    if (timeout_ >= 0 && spin > static_cast<uint64_t> (timeout_) * 1000)
+        spin = static_cast<uint64_t> (timeout_) * 1000;
+
+    if (!spin_begin ())
+        return true;
+    const uint64_t end = _clock.now_us () + spin;
+    while (!spin_check () && _clock.now_us () < end)
+        ;
+    return spin_end ();
+}
+
 int zmq::socket_base_t::process_commands (int timeout_, bool throttle_)
 {
     if (timeout_ == 0) {
@@ -1617,6 +1999,15 @@ int zmq::socket_base_t::xsend (msg_t *)
     return -1;
 }
 
+bool zmq::socket_base_t::xbegin_batch (bool)
+{
+    return false;
+}
+
+void zmq::socket_base_t::xend_batch (bool)
+{
+}
+
 bool zmq::socket_base_t::xhas_in ()
 {
     return false;
@@ -1731,7 +2122,7 @@ void zmq::socket_base_t::pipe_terminated (pipe_t *pipe_)
 
     //  Remove the pipe from the list of attached pipes and confirm its
     //  termination if we are already shutting down.
-    _pipes.erase (pipe_);
+    retire_pipe (pipe_);
 
     // Remove the pipe from _endpoints (set it to NULL).
     const std::string &identifier = pipe_->get_endpoint_pair ().identifier ();
@@ -2079,15 +2470,10 @@ int zmq::routing_socket_base_t::xsetsockopt (int option_,
 
 void zmq::routing_socket_base_t::xwrite_activated (pipe_t *pipe_)
 {
-    const out_pipes_t::iterator end = _out_pipes.end ();
-    out_pipes_t::iterator it;
-    for (it = _out_pipes.begin (); it != end; ++it)
-        if (it->second.pipe == pipe_)
-            break;
-
-    zmq_assert (it != end);
-    zmq_assert (!it->second.active);
-    it->second.active = true;
+    out_pipe_t *const out_pipe = _out_pipes.find (pipe_);
+    zmq_assert (out_pipe);
+    zmq_assert (!out_pipe->active);
+    out_pipe->active = true;
 }
 
 std::string zmq::routing_socket_base_t::extract_connect_routing_id ()
@@ -2102,52 +2488,37 @@ bool zmq::routing_socket_base_t::connect_routing_id_is_set () const
     return !_connect_routing_id.empty ();
 }
 
-void zmq::routing_socket_base_t::add_out_pipe (blob_t routing_id_,
-                                               pipe_t *pipe_)
+void zmq::routing_socket_base_t::add_out_pipe (pipe_t *pipe_)
 {
     //  Add the record into output pipes lookup table
-    const out_pipe_t outpipe = {pipe_, true};
-    const bool ok =
-      _out_pipes.ZMQ_MAP_INSERT_OR_EMPLACE (ZMQ_MOVE (routing_id_), outpipe)
-        .second;
-    zmq_assert (ok);
+    _out_pipes.add (pipe_);
 }
 
 bool zmq::routing_socket_base_t::has_out_pipe (const blob_t &routing_id_) const
 {
-    return 0 != _out_pipes.count (routing_id_);
+    return _out_pipes.find (routing_id_) != NULL;
 }
 
-zmq::routing_socket_base_t::out_pipe_t *
+zmq::out_pipe_t *
 zmq::routing_socket_base_t::lookup_out_pipe (const blob_t &routing_id_)
 {
-    // TODO we could probably avoid constructor a temporary blob_t to call this function
-    out_pipes_t::iterator it = _out_pipes.find (routing_id_);
-    return it == _out_pipes.end () ? NULL : &it->second;
+    return _out_pipes.find (routing_id_);
 }
 
-const zmq::routing_socket_base_t::out_pipe_t *
+const zmq::out_pipe_t *
 zmq::routing_socket_base_t::lookup_out_pipe (const blob_t &routing_id_) const
 {
-    // TODO we could probably avoid constructor a temporary blob_t to call this function
-    const out_pipes_t::const_iterator it = _out_pipes.find (routing_id_);
-    return it == _out_pipes.end () ? NULL : &it->second;
+    return _out_pipes.find (routing_id_);
 }
 
 void zmq::routing_socket_base_t::erase_out_pipe (const pipe_t *pipe_)
 {
-    const size_t erased = _out_pipes.erase (pipe_->get_routing_id ());
-    zmq_assert (erased);
+    const out_pipe_t erased = _out_pipes.erase (pipe_->get_routing_id ());
+    zmq_assert (erased.pipe);
 }
 
-zmq::routing_socket_base_t::out_pipe_t
+zmq::out_pipe_t
 zmq::routing_socket_base_t::try_erase_out_pipe (const blob_t &routing_id_)
 {
-    const out_pipes_t::iterator it = _out_pipes.find (routing_id_);
-    out_pipe_t res = {NULL, false};
-    if (it != _out_pipes.end ()) {
-        res = it->second;
-        _out_pipes.erase (it);
-    }
-    return res;
+    return _out_pipes.erase (routing_id_);
 }
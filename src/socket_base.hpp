@@ -5,6 +5,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <stdarg.h>
 
 #include "own.hpp"
@@ -17,6 +18,7 @@
 #include "clock.hpp"
 #include "pipe.hpp"
 #include "endpoint.hpp"
+#include "routing_table.hpp"
 
 extern "C" {
 void zmq_free_event (void *data_, void *hint_);
@@ -61,6 +63,8 @@ class socket_base_t : public own_t,
     int term_endpoint (const char *endpoint_uri_);
     int send (zmq::msg_t *msg_, int flags_);
     int recv (zmq::msg_t *msg_, int flags_);
+    int send_batch (zmq::msg_t *msgs_, size_t count_, int flags_);
+    int recv_batch (zmq::msg_t *msgs_, size_t count_, int flags_);
     void add_signaler (signaler_t *s_);
     void remove_signaler (signaler_t *s_);
     int close ();
@@ -70,6 +74,20 @@ class socket_base_t : public own_t,
     bool has_in ();
     bool has_out ();
 
+    //  Busy-waiting for commands before blocking, see ZMQ_SPIN_TIME.
+    //  spin_time returns the current spin time in microseconds, 0 if the
+    //  socket does not spin. The other functions follow mailbox_t.
+    int spin_time () const;
+    bool spin_begin ();
+    bool spin_check () const;
+    bool spin_end ();
+
+    //  Tunes the adaptive spin time to the time the socket had to wait
+    //  for a message, and to whether the last spin got any commands.
+    //  Does nothing unless spin_adaptive returns true.
+    bool spin_adaptive () const;
+    void adapt_spin (uint64_t waited_us_);
+
     //  Joining and leaving groups
     int join (const char *group_);
     int leave (const char *group_);
@@ -138,6 +156,18 @@ class socket_base_t : public own_t,
     //  be enabled.
     int query_pipes_stats ();
 
+    //  Fills in the counters of the socket and of up to *pipe_count_ of
+    //  its pipes, and sets *pipe_count_ to the number of pipes. May be
+    //  called from any thread.
+    int get_stats (zmq_socket_stats_t *stats_,
+                   zmq_pipe_stats_t *pipes_,
+                   size_t *pipe_count_);
+
+    //  Launches an object that has taken the socket over, such as a
+    //  detached proxy, as a child of the socket. Closing the socket
+    //  terminates the object.
+    void launch_owned (own_t *object_);
+
     bool is_disconnected () const;
 
   protected:
@@ -172,6 +202,14 @@ class socket_base_t : public own_t,
     virtual bool xhas_in ();
     virtual int xrecv (zmq::msg_t *msg_);
 
+    //  Called before and after the parts of a batch are sent (send_ is
+    //  true) or received one by one with xsend or xrecv. Sockets use them
+    //  to flush the pipes written to once at the end of the batch.
+    //  xbegin_batch returns false if the socket type does not support
+    //  batches in that direction, which the default implementation assumes.
+    virtual bool xbegin_batch (bool send_);
+    virtual void xend_batch (bool send_);
+
     //  i_pipe_events will be forwarded to these functions.
     virtual void xread_activated (pipe_t *pipe_);
     virtual void xwrite_activated (pipe_t *pipe_);
@@ -238,6 +276,12 @@ class socket_base_t : public own_t,
     //  to be later retrieved by getsockopt.
     void extract_flags (const msg_t *msg_);
 
+    //  Send or receive message parts until count_ of them are done or one
+    //  fails. Return the number of parts done, or the result of xsend or
+    //  xrecv for the first one.
+    int try_send_batch (msg_t *msgs_, size_t count_);
+    int try_recv_batch (msg_t *msgs_, size_t count_);
+
     //  Used to check whether the object is a socket.
     uint32_t _tag;
 
@@ -268,6 +312,11 @@ class socket_base_t : public own_t,
     //  in a predefined time period.
     int process_commands (int timeout_, bool throttle_);
 
+    //  Spins until commands arrive, for at most the spin time and the
+    //  timeout in milliseconds. Returns true if there are commands to
+    //  process.
+    bool spin (int timeout_);
+
     //  Handlers for incoming commands.
     void process_stop () ZMQ_FINAL;
     void process_bind (zmq::pipe_t *pipe_) ZMQ_FINAL;
@@ -300,6 +349,21 @@ class socket_base_t : public own_t,
     //  Number of messages received since last command processing.
     int _ticks;
 
+    //  Moving average of the time blocking receives had to wait, and the
+    //  spin time derived from it, in microseconds.
+    uint64_t _spin_wait_avg;
+    int _spin_adapted;
+
+    //  Spinning in vain makes the socket skip spinning for a number of
+    //  waits, which doubles with every further spin in vain.
+    enum
+    {
+        max_spin_backoff = 1023
+    };
+    bool _spin_wasted;
+    int _spin_backoff;
+    int _spin_skip;
+
     //  True if the last message received had MORE flag set.
     bool _rcvmore;
 
@@ -324,6 +388,16 @@ class socket_base_t : public own_t,
     // Mutex to synchronize access to the monitor Pair socket
     mutex_t _monitor_sync;
 
+    //  Removes a terminated pipe from the attached pipes and adds its
+    //  counters to the retired totals.
+    void retire_pipe (pipe_t *pipe_);
+
+    //  The totals of the pipes already gone. As get_stats may be called
+    //  from any thread, they are guarded by _stats_sync, and so are the
+    //  changes to _pipes and to the endpoints of the pipes in it.
+    zmq_socket_stats_t _retired_stats;
+    mutex_t _stats_sync;
+
     ZMQ_NON_COPYABLE_NOR_MOVABLE (socket_base_t)
 
     // Add a flag for mark disconnect action
@@ -346,13 +420,8 @@ class routing_socket_base_t : public socket_base_t
     std::string extract_connect_routing_id ();
     bool connect_routing_id_is_set () const;
 
-    struct out_pipe_t
-    {
-        pipe_t *pipe;
-        bool active;
-    };
-
-    void add_out_pipe (blob_t routing_id_, pipe_t *pipe_);
+    //  Adds the pipe under the routing id it has been given.
+    void add_out_pipe (pipe_t *pipe_);
     bool has_out_pipe (const blob_t &routing_id_) const;
     out_pipe_t *lookup_out_pipe (const blob_t &routing_id_);
     const out_pipe_t *lookup_out_pipe (const blob_t &routing_id_) const;
@@ -360,20 +429,12 @@ class routing_socket_base_t : public socket_base_t
     out_pipe_t try_erase_out_pipe (const blob_t &routing_id_);
     template <typename Func> bool any_of_out_pipes (Func func_)
     {
-        bool res = false;
-        for (out_pipes_t::iterator it = _out_pipes.begin (),
-                                   end = _out_pipes.end ();
-             it != end && !res; ++it) {
-            res |= func_ (*it->second.pipe);
-        }
-
-        return res;
+        return _out_pipes.any_of (func_);
     }
 
   private:
     //  Outbound pipes indexed by the peer IDs.
-    typedef std::map<blob_t, out_pipe_t> out_pipes_t;
-    out_pipes_t _out_pipes;
+    routing_table_t<blob_routing_id_t> _out_pipes;
 
     // Next assigned name on a zmq_connect() call used by ROUTER and STREAM socket types
     std::string _connect_routing_id;
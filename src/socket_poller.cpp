@@ -494,6 +494,56 @@ int zmq::socket_poller_t::adjust_timeout (zmq::clock_t &clock_,
     return 1;
 }
 
+bool zmq::socket_poller_t::spin (long timeout_, uint64_t &wait_start_)
+{
+    //  Only sockets can be checked without a system call, and thread-safe
+    //  ones may not be spun on.
+    uint64_t spin = 0;
+    bool adaptive = false;
+    for (items_t::iterator it = _items.begin (), end = _items.end (); it != end;
+         ++it) {
+        if (!it->socket || is_thread_safe (*it->socket))
+            return false;
+        spin = std::max (spin,
+                         static_cast<uint64_t> (it->socket->spin_time ()));
+        adaptive = adaptive || it->socket->spin_adaptive ();
+    }
+    if (adaptive && !wait_start_)
+        wait_start_ = clock_t::now_us ();
+    if (spin == 0)
+        return false;
+    if (timeout_ >= 0 && spin > static_cast<uint64_t> (timeout_) * 1000)
+        spin = static_cast<uint64_t> (timeout_) * 1000;
+
+    //  Stop at the first socket that has commands already.
+    items_t::iterator last = _items.begin ();
+    while (last != _items.end () && last->socket->spin_begin ())
+        ++last;
+    bool arrived = last != _items.end ();
+
+    const uint64_t end = clock_t::now_us () + spin;
+    while (!arrived && clock_t::now_us () < end)
+        for (items_t::iterator it = _items.begin (); it != last; ++it)
+            if (it->socket->spin_check ()) {
+                arrived = true;
+                break;
+            }
+
+    for (items_t::iterator it = _items.begin (); it != last; ++it)
+        if (it->socket->spin_end ())
+            arrived = true;
+    return arrived;
+}
+
+void zmq::socket_poller_t::adapt_spin (uint64_t wait_start_)
+{
+    const uint64_t waited = clock_t::now_us () - wait_start_;
+    for (items_t::iterator it = _items.begin (), end = _items.end (); it != end;
+         ++it)
+        if (it->socket)
+            it->socket->adapt_spin (waited);
+}
+
 int zmq::socket_poller_t::wait (zmq::socket_poller_t::event_t *events_,
                                 int n_events_,
                                 long timeout_)
@@ -550,12 +600,16 @@ int zmq::socket_poller_t::wait (zmq::socket_poller_t::event_t *events_,
     uint64_t end = 0;
 
     bool first_pass = true;
+    uint64_t wait_start = 0;
 
     while (true) {
         //  Compute the timeout for the subsequent poll.
         int timeout;
         if (first_pass)
             timeout = 0;
+        else if (spin (timeout_ < 0 ? -1 : static_cast<long> (end - now),
+                       wait_start))
+            timeout = 0;
         else if (timeout_ < 0)
             timeout = -1;
         else
@@ -578,6 +632,8 @@ int zmq::socket_poller_t::wait (zmq::socket_poller_t::event_t *events_,
         if (found) {
             if (found > 0)
                 zero_trail_events (events_, n_events_, found);
+            if (wait_start)
+                adapt_spin (wait_start);
             return found;
         }
 
@@ -595,6 +651,7 @@ int zmq::socket_poller_t::wait (zmq::socket_poller_t::event_t *events_,
     uint64_t end = 0;
 
     bool first_pass = true;
+    uint64_t wait_start = 0;
 
     optimized_fd_set_t inset (_pollset_size);
     optimized_fd_set_t outset (_pollset_size);
@@ -604,7 +661,9 @@ int zmq::socket_poller_t::wait (zmq::socket_poller_t::event_t *events_,
         //  Compute the timeout for the subsequent poll.
         timeval timeout;
         timeval *ptimeout;
-        if (first_pass) {
+        if (first_pass
+            || spin (timeout_ < 0 ? -1 : static_cast<long> (end - now),
+                     wait_start)) {
             timeout.tv_sec = 0;
             timeout.tv_usec = 0;
             ptimeout = &timeout;
@@ -647,6 +706,8 @@ int zmq::socket_poller_t::wait (zmq::socket_poller_t::event_t *events_,
         if (found) {
             if (found > 0)
                 zero_trail_events (events_, n_events_, found);
+            if (wait_start)
+                adapt_spin (wait_start);
             return found;
         }
 
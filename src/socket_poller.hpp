@@ -81,6 +81,14 @@ class socket_poller_t
                                uint64_t &now_,
                                uint64_t &end_,
                                bool &first_pass_);
+
+    //  Busy-waits for commands to arrive on the sockets before blocking,
+    //  see ZMQ_SPIN_TIME. The start of the wait is stored in wait_start_
+    //  if it is needed to tune adaptive spin times. Returns true if
+    //  commands arrived.
+    bool spin (long timeout_, uint64_t &wait_start_);
+    void adapt_spin (uint64_t wait_start_);
+
     static bool is_socket (const item_t &item, const socket_base_t *socket_)
     {
         return item.socket == socket_;
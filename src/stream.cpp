@@ -260,5 +260,5 @@ void zmq::stream_t::identify_peer (pipe_t *pipe_, bool locally_initiated_)
           static_cast<unsigned char> (routing_id.size ());
     }
     pipe_->set_router_socket_routing_id (routing_id);
-    add_out_pipe (ZMQ_MOVE (routing_id), pipe_);
+    add_out_pipe (pipe_);
 }
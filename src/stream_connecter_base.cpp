@@ -7,6 +7,9 @@
 #include "random.hpp"
 #include "zmtp_engine.hpp"
 #include "raw_engine.hpp"
+#include "resolver.hpp"
+#include "tcp_address.hpp"
+#include "ctx.hpp"
 
 #ifndef ZMQ_HAVE_WINDOWS
 #include <unistd.h>
@@ -83,6 +86,37 @@ void zmq::stream_connecter_base_t::add_reconnect_timer ()
     }
 }
 
+void zmq::stream_connecter_base_t::resolve_and_connect (bool ipv6_)
+{
+    //  Literal addresses are resolved right away. Host names are left to
+    //  the resolver, which replies with a resolved command unless it has
+    //  the name cached, as looking it up may block for a while.
+    tcp_address_t address;
+    int rc = address.resolve (_addr->address.c_str (), false, ipv6_, false);
+    if (rc != 0)
+        rc = get_ctx ()->get_resolver ()->resolve (this, _addr->address,
+                                                   ipv6_, &address);
+    if (rc == 0)
+        connect_to (&address);
+    else if (errno != EAGAIN)
+        connect_to (NULL);
+}
+
+void zmq::stream_connecter_base_t::connect_to (const tcp_address_t *)
+{
+    zmq_assert (false);
+}
+
+void zmq::stream_connecter_base_t::process_resolved (tcp_address_t *address_,
+                                                     int error_)
+{
+    if (!is_terminating ()) {
+        errno = error_;
+        connect_to (address_);
+    }
+    LIBZMQ_DELETE (address_);
+}
+
 int zmq::stream_connecter_base_t::get_new_reconnect_ivl ()
 {
     if (options.reconnect_ivl_max > 0) {
@@ -151,12 +185,9 @@ void zmq::stream_connecter_base_t::create_engine (
                                              endpoint_type_connect);
 
     //  Create the engine object for this connection.
-    i_engine *engine;
-    if (options.raw_socket)
-        engine = new (std::nothrow) raw_engine_t (fd_, options, endpoint_pair);
-    else
-        engine = new (std::nothrow) zmtp_engine_t (fd_, options, endpoint_pair);
-    alloc_assert (engine);
+    i_engine *engine = make_engine (fd_, endpoint_pair);
+    if (!engine)
+        return;
 
     //  Attach the engine to the corresponding session object.
     send_attach (_session, engine);
@@ -167,6 +198,18 @@ void zmq::stream_connecter_base_t::create_engine (
     _socket->event_connected (endpoint_pair, fd_);
 }
 
+zmq::i_engine *zmq::stream_connecter_base_t::make_engine (
+  fd_t fd_, const endpoint_uri_pair_t &endpoint_pair_)
+{
+    i_engine *engine;
+    if (options.raw_socket)
+        engine = new (std::nothrow) raw_engine_t (fd_, options, endpoint_pair_);
+    else
+        engine = new (std::nothrow) zmtp_engine_t (fd_, options, endpoint_pair_);
+    alloc_assert (engine);
+    return engine;
+}
+
 void zmq::stream_connecter_base_t::timer_event (int id_)
 {
     zmq_assert (id_ == reconnect_timer_id);
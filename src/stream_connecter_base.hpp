@@ -6,11 +6,14 @@
 #include "fd.hpp"
 #include "own.hpp"
 #include "io_object.hpp"
+#include "endpoint.hpp"
 
 namespace zmq
 {
 class io_thread_t;
 class session_base_t;
+class i_engine;
+class tcp_address_t;
 struct address_t;
 
 class stream_connecter_base_t : public own_t, public io_object_t
@@ -30,6 +33,8 @@ class stream_connecter_base_t : public own_t, public io_object_t
     //  Handlers for incoming commands.
     void process_plug () ZMQ_FINAL;
     void process_term (int linger_) ZMQ_OVERRIDE;
+    void process_resolved (zmq::tcp_address_t *address_,
+                           int error_) ZMQ_FINAL;
 
     //  Handlers for I/O events.
     void in_event () ZMQ_OVERRIDE;
@@ -38,9 +43,24 @@ class stream_connecter_base_t : public own_t, public io_object_t
     //  Internal function to create the engine after connection was established.
     virtual void create_engine (fd_t fd, const std::string &local_address_);
 
+    //  Creates the engine for the established connection, a ZMTP or raw
+    //  one by default. Returns NULL if the connection cannot be used, in
+    //  which case it has been closed and a reconnect scheduled.
+    virtual i_engine *make_engine (fd_t fd_,
+                                   const endpoint_uri_pair_t &endpoint_pair_);
+
     //  Internal function to add a reconnect timer
     void add_reconnect_timer ();
 
+    //  Resolves the TCP address to connect to and passes it to
+    //  connect_to (), right away or once the resolver of the context
+    //  looked the host name up.
+    void resolve_and_connect (bool ipv6_);
+
+    //  Connects to the resolved address, or handles the failure to resolve
+    //  it if the address is NULL, with errno set.
+    virtual void connect_to (const tcp_address_t *address_);
+
     //  Removes the handle from the poller.
     void rm_handle ();
 
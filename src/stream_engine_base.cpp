@@ -12,6 +12,7 @@
 
 #include <new>
 #include <sstream>
+#include <algorithm>
 
 #include "stream_engine_base.hpp"
 #include "io_thread.hpp"
@@ -35,6 +36,8 @@
 #include "tcp.hpp"
 #include "likely.hpp"
 #include "wire.hpp"
+#include "clock.hpp"
+#include "memfd.hpp"
 
 static std::string get_peer_address (zmq::fd_t s_)
 {
@@ -72,6 +75,34 @@ static std::string get_peer_address (zmq::fd_t s_)
     return peer_address;
 }
 
+#if defined ZMQ_HAVE_MEMFD
+//  MEMFD command: the name, the flags of the frame and its size.
+static const char memfd_command_name[] = "\5MEMFD";
+static const size_t memfd_command_name_size = sizeof memfd_command_name - 1;
+static const size_t memfd_command_size = memfd_command_name_size + 1 + 8;
+static const unsigned char memfd_flag_more = 1;
+
+//  Frames are only passed in a memfd between the ends of an ipc://
+//  connection, and only where the mechanism lets them through, see
+//  mechanism_t::accepts_memfd.
+static bool memfd_accepted (const zmq::options_t &options_,
+                            const zmq::endpoint_uri_pair_t &endpoint_uri_pair_)
+{
+    return options_.memfd_threshold >= 0
+           && (options_.mechanism == ZMQ_NULL
+               || options_.mechanism == ZMQ_PLAIN)
+           && endpoint_uri_pair_.identifier ().compare (0, 6, "ipc://") == 0;
+}
+
+static bool is_memfd_command (zmq::msg_t *msg_)
+{
+    return msg_->size () >= memfd_command_name_size
+           && memcmp (msg_->data (), memfd_command_name,
+                      memfd_command_name_size)
+                == 0;
+}
+#endif
+
 zmq::stream_engine_base_t::stream_engine_base_t (
   fd_t fd_,
   const options_t &options_,
@@ -85,6 +116,7 @@ zmq::stream_engine_base_t::stream_engine_base_t (
     _outsize (0),
     _encoder (NULL),
     _mechanism (NULL),
+    _out_iov_threshold (options_.out_iov_threshold),
     _next_msg (NULL),
     _process_msg (NULL),
     _metadata (NULL),
@@ -100,7 +132,31 @@ zmq::stream_engine_base_t::stream_engine_base_t (
     _handle (static_cast<handle_t> (NULL)),
     _plugged (false),
     _handshaking (true),
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    _zerocopy_threshold (
+      options_.zerocopy_threshold >= 0 && tcp_zerocopy_enabled (fd_)
+        ? options_.zerocopy_threshold
+        : -1),
+    _zerocopy_polls_left (0),
+    _has_zerocopy_timer (false),
+#endif
+#if defined ZMQ_HAVE_MEMFD
+    _memfd_accepted (memfd_accepted (options_, endpoint_uri_pair_)),
+    _memfd_threshold (-1),
+#endif
+    _cork_delay (options_.cork_delay),
+    _cork_size (static_cast<size_t> (
+      std::min (options_.cork_size, options_.out_batch_size))),
+    _corked (false),
+    _cork_deadline (0),
+    _has_cork_timer (false),
+    _lingering (false),
+    _has_linger_timer (false),
     _io_error (false),
+    _heartbeat_ivl_left (0),
+    _heartbeat_timeout_left (0),
+    _heartbeat_ttl_left (0),
+    _cork_left (0),
     _session (NULL),
     _socket (NULL),
     _has_handshake_stage (has_handshake_stage_)
@@ -110,12 +166,30 @@ zmq::stream_engine_base_t::stream_engine_base_t (
 
     //  Put the socket into non-blocking mode.
     unblock_socket (_s);
+
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    //  Bodies can only be sent in place if they are not copied to the
+    //  encoder buffer in the first place.
+    if (_zerocopy_threshold >= 0
+        && (_out_iov_threshold < 0
+            || _out_iov_threshold > _zerocopy_threshold))
+        _out_iov_threshold = _zerocopy_threshold;
+#endif
 }
 
 zmq::stream_engine_base_t::~stream_engine_base_t ()
 {
     zmq_assert (!_plugged);
 
+#if defined ZMQ_HAVE_MEMFD
+    for (std::deque<fd_t>::iterator it = _memfds_in.begin ();
+         it != _memfds_in.end (); ++it)
+        memfd_close (*it);
+    for (std::vector<fd_t>::iterator it = _memfds_out.begin ();
+         it != _memfds_out.end (); ++it)
+        memfd_close (*it);
+#endif
+
     if (_s != retired_fd) {
 #ifdef ZMQ_HAVE_WINDOWS
         const int rc = closesocket (_s);
@@ -174,7 +248,23 @@ void zmq::stream_engine_base_t::unplug ()
     zmq_assert (_plugged);
     _plugged = false;
 
+    unplug_internal ();
+
     //  Cancel all timers.
+    cancel_timers ();
+
+    //  Cancel all fd subscriptions.
+    if (!_io_error)
+        rm_fd (_handle);
+
+    //  Disconnect from I/O threads poller object.
+    io_object_t::unplug ();
+
+    _session = NULL;
+}
+
+void zmq::stream_engine_base_t::cancel_timers ()
+{
     if (_has_handshake_timer) {
         cancel_timer (handshake_timer_id);
         _has_handshake_timer = false;
@@ -194,24 +284,116 @@ void zmq::stream_engine_base_t::unplug ()
         cancel_timer (heartbeat_ivl_timer_id);
         _has_heartbeat_timer = false;
     }
-    //  Cancel all fd subscriptions.
-    if (!_io_error)
-        rm_fd (_handle);
 
-    //  Disconnect from I/O threads poller object.
+    if (_has_cork_timer) {
+        cancel_timer (cork_timer_id);
+        _has_cork_timer = false;
+    }
+
+    if (_has_linger_timer) {
+        cancel_timer (linger_timer_id);
+        _has_linger_timer = false;
+    }
+
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    if (_has_zerocopy_timer) {
+        cancel_timer (zerocopy_timer_id);
+        _has_zerocopy_timer = false;
+    }
+#endif
+}
+
+int zmq::stream_engine_base_t::stop_timer (bool &running_, int id_)
+{
+    if (!running_)
+        return 0;
+    const int left = timer_left (id_);
+    cancel_timer (id_);
+    running_ = false;
+    return left;
+}
+
+void zmq::stream_engine_base_t::restart_timer (bool &running_,
+                                               int left_,
+                                               int id_)
+{
+    if (left_ > 0) {
+        add_timer (left_, id_);
+        running_ = true;
+    }
+}
+
+bool zmq::stream_engine_base_t::can_migrate () const
+{
+    //  Only engines past the handshake move, as the handshake may involve
+    //  the ZAP handler and the crypto pool.
+    return _plugged && !_handshaking && !_io_error && !_has_handshake_timer
+           && (_mechanism == NULL
+               || _mechanism->status () == mechanism_t::ready);
+}
+
+void zmq::stream_engine_base_t::migrate_out ()
+{
+    zmq_assert (can_migrate ());
+
+    //  Timers belong to the poller of the I/O thread. They start again
+    //  in the new one with the time they had left.
+    _heartbeat_ivl_left =
+      stop_timer (_has_heartbeat_timer, heartbeat_ivl_timer_id);
+    _heartbeat_timeout_left =
+      stop_timer (_has_timeout_timer, heartbeat_timeout_timer_id);
+    _heartbeat_ttl_left = stop_timer (_has_ttl_timer, heartbeat_ttl_timer_id);
+    _cork_left = stop_timer (_has_cork_timer, cork_timer_id);
+
+    rm_fd (_handle);
     io_object_t::unplug ();
+}
 
-    _session = NULL;
+void zmq::stream_engine_base_t::migrate_in (io_thread_t *io_thread_)
+{
+    io_object_t::plug (io_thread_);
+    _handle = add_fd (_s);
+    if (!_input_stopped)
+        set_pollin ();
+    if (!_output_stopped)
+        set_pollout ();
+
+    restart_timer (_has_heartbeat_timer, _heartbeat_ivl_left,
+                   heartbeat_ivl_timer_id);
+    restart_timer (_has_timeout_timer, _heartbeat_timeout_left,
+                   heartbeat_timeout_timer_id);
+    restart_timer (_has_ttl_timer, _heartbeat_ttl_left, heartbeat_ttl_timer_id);
+    restart_timer (_has_cork_timer, _cork_left, cork_timer_id);
 }
 
 void zmq::stream_engine_base_t::terminate ()
 {
-    unplug ();
-    delete this;
+    //  The session has handed over all its messages by now, some of them
+    //  may still be held back. They are written unless the socket is
+    //  closed without linger.
+    if (_corked && !_io_error && _session->get_linger () != 0) {
+        start_linger ();
+        return;
+    }
+    destroy ();
 }
 
 void zmq::stream_engine_base_t::in_event ()
 {
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    //  Completions of zero-copy sends are signalled like socket errors.
+    //  They must not be taken for a failure while input is stopped.
+    if (!_zerocopy_sends.empty () && reap_zerocopy () && _input_stopped)
+        return;
+#endif
+
+    //  Input is not polled for once the session has gone, a hang-up or an
+    //  error shows up here though and fails the next write.
+    if (unlikely (_lingering)) {
+        out_event ();
+        return;
+    }
+
     // ignore errors
     const bool res = in_event_internal ();
     LIBZMQ_UNUSED (res);
@@ -260,6 +442,7 @@ bool zmq::stream_engine_base_t::in_event_internal ()
         _decoder->get_buffer (&_inpos, &bufsize);
 
         const int rc = read (_inpos, bufsize);
+        _session->count_engine_read ();
 
         if (rc == -1) {
             if (errno != EAGAIN) {
@@ -309,8 +492,25 @@ void zmq::stream_engine_base_t::out_event ()
 {
     zmq_assert (!_io_error);
 
+    if (unlikely (_lingering)) {
+        if (linger_out ())
+            destroy ();
+        return;
+    }
+
+#if defined ZMQ_HAVE_UIO
+    //  Once the handshake data have been sent, all the output goes
+    //  through the gathered write path if it is enabled.
+    if (_out_iov_threshold >= 0 && !_handshaking && !_outsize) {
+        out_event_iov ();
+        return;
+    }
+#endif
+
     //  If write buffer is empty, try to read new data from the encoder.
-    if (!_outsize) {
+    //  A held back buffer has not been written from yet and keeps being
+    //  filled.
+    if (!_outsize || _corked) {
         //  Even when we stop polling as soon as there is no
         //  data to send, the poller may invoke out_event one
         //  more time due to 'speculative write' optimisation.
@@ -319,8 +519,10 @@ void zmq::stream_engine_base_t::out_event ()
             return;
         }
 
-        _outpos = NULL;
-        _outsize = _encoder->encode (&_outpos, 0);
+        if (!_outsize) {
+            _outpos = NULL;
+            _outsize = _encoder->encode (&_outpos, 0);
+        }
 
         while (_outsize < static_cast<size_t> (_options.out_batch_size)) {
             if ((this->*_next_msg) (&_tx_msg) == -1) {
@@ -347,6 +549,9 @@ void zmq::stream_engine_base_t::out_event ()
             reset_pollout ();
             return;
         }
+
+        if (cork (_outsize, false))
+            return;
     }
 
     //  If there are any data to write in write buffer, write as much as
@@ -355,6 +560,7 @@ void zmq::stream_engine_base_t::out_event ()
     //  limited transmission buffer and thus the actual number of bytes
     //  written should be reasonably modest.
     const int nbytes = write (_outpos, _outsize);
+    _session->count_engine_write ();
 
     //  IO error has occurred. We stop waiting for output events.
     //  The engine is not terminated until we detect input error;
@@ -374,6 +580,256 @@ void zmq::stream_engine_base_t::out_event ()
             reset_pollout ();
 }
 
+#if defined ZMQ_HAVE_UIO
+void zmq::stream_engine_base_t::out_event_iov ()
+{
+    //  If write batch is empty, try to read new data from the encoder.
+    //  A held back batch keeps being filled.
+    if (_out_iov.empty () || _corked) {
+        if (unlikely (_encoder == NULL))
+            return;
+
+        const size_t ref_size = static_cast<size_t> (_out_iov_threshold);
+        _encoder->encode_iov (_out_iov, ref_size);
+
+        //  Referenced message bodies do not take space in the encoder
+        //  buffer, so the batch may grow beyond out_batch_size when large
+        //  messages are sent.
+        while (_out_iov.size () < static_cast<size_t> (_options.out_batch_size)
+               && !_out_iov.full ()) {
+            if ((this->*_next_msg) (&_tx_msg) == -1) {
+                //  ws_engine can cause an engine error and delete it, so
+                //  bail out immediately to avoid use-after-free
+                if (errno == ECONNRESET)
+                    return;
+                else
+                    break;
+            }
+            _encoder->load_msg (&_tx_msg);
+            const size_t n = _encoder->encode_iov (_out_iov, ref_size);
+            zmq_assert (n > 0);
+        }
+
+        //  If there is no data to send, stop polling for output.
+        if (_out_iov.empty ()) {
+            _output_stopped = true;
+            reset_pollout ();
+            return;
+        }
+
+        if (cork (_out_iov.size (), _out_iov.full ()))
+            return;
+    }
+
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    const int nbytes =
+      _zerocopy_threshold >= 0
+        ? writev_zerocopy ()
+        : writev (_out_iov.chunks (), _out_iov.chunk_count ());
+#else
+    const int nbytes = writev (_out_iov.chunks (), _out_iov.chunk_count ());
+#endif
+    _session->count_engine_write ();
+
+    //  IO error has occurred. We stop waiting for output events.
+    //  The engine is not terminated until we detect input error;
+    //  this is necessary to prevent losing incoming messages.
+    if (nbytes == -1) {
+        reset_pollout ();
+        return;
+    }
+
+    _out_iov.consume (nbytes);
+}
+#endif
+
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+int zmq::stream_engine_base_t::writev_zerocopy ()
+{
+    const size_t threshold = static_cast<size_t> (_zerocopy_threshold);
+    const iovec *chunks = _out_iov.chunks ();
+    const int count = _out_iov.chunk_count ();
+
+    //  Large bodies are sent on their own. Everything else is copied by the
+    //  kernel as usual, so that the encoder buffer can be reused as soon as
+    //  it has been written.
+    msg_t *msg = _out_iov.chunk_msg (0);
+    if (msg == NULL || msg->size () < threshold) {
+        int n = 1;
+        while (n != count
+               && (_out_iov.chunk_msg (n) == NULL
+                   || _out_iov.chunk_msg (n)->size () < threshold))
+            n++;
+        return writev (chunks, n);
+    }
+
+    const int nbytes = tcp_writev_zerocopy (_s, chunks, 1);
+    if (nbytes == -1 && errno == ENOBUFS)
+        return writev (chunks, 1);
+
+    //  Keep the body alive until the kernel reports completion.
+    if (nbytes > 0)
+        _zerocopy_sends.add (msg);
+    return nbytes;
+}
+
+bool zmq::stream_engine_base_t::reap_zerocopy ()
+{
+    bool reaped = false;
+    uint32_t first;
+    uint32_t last;
+    bool copied;
+    while (!_zerocopy_sends.empty ()
+           && tcp_zerocopy_completion (_s, &first, &last, &copied)) {
+        reaped = true;
+
+        //  The kernel had to copy the data anyway, e.g. on loopback. Sending
+        //  in place only adds overhead then.
+        if (copied)
+            _zerocopy_threshold = -1;
+
+        _zerocopy_sends.complete (first, last);
+    }
+    return reaped;
+}
+
+void zmq::stream_engine_base_t::await_zerocopy ()
+{
+    //  The engine is done but for the completions. The socket is not
+    //  polled anymore, there is nothing to do with it but to look at the
+    //  error queue now and then.
+    _lingering = true;
+    _session = NULL;
+    cancel_timers ();
+    if (!_io_error) {
+        rm_fd (_handle);
+        _io_error = true;
+    }
+    _zerocopy_polls_left = zerocopy_drain_polls;
+    add_timer (zerocopy_drain_interval, zerocopy_timer_id);
+    _has_zerocopy_timer = true;
+}
+#endif
+
+void zmq::stream_engine_base_t::destroy ()
+{
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    //  The kernel goes on transmitting from the bodies of zero-copy sends
+    //  after the socket is closed. Wait for their completions without
+    //  blocking the I/O thread, so that their memory is not reused while
+    //  still in flight.
+    if (!_zerocopy_sends.empty ()) {
+        reap_zerocopy ();
+        if (!_zerocopy_sends.empty ()) {
+            await_zerocopy ();
+            return;
+        }
+    }
+#endif
+    unplug ();
+    delete this;
+}
+
+bool zmq::stream_engine_base_t::cork (size_t size_, bool full_)
+{
+    if (_cork_delay == 0 || _handshaking || full_ || size_ >= _cork_size) {
+        if (_has_cork_timer) {
+            cancel_timer (cork_timer_id);
+            _has_cork_timer = false;
+        }
+        _corked = false;
+        return false;
+    }
+
+    //  The delay runs from the first message held back. It is checked to
+    //  the microsecond whenever more messages come in. The timer, which
+    //  only has a resolution of a millisecond, writes the batch if none do.
+    const uint64_t now = clock_t::now_us ();
+    if (!_corked)
+        _cork_deadline = now + _cork_delay;
+    else if (now >= _cork_deadline) {
+        if (_has_cork_timer) {
+            cancel_timer (cork_timer_id);
+            _has_cork_timer = false;
+        }
+        _corked = false;
+        return false;
+    }
+    if (!_has_cork_timer) {
+        add_timer ((_cork_delay + 999) / 1000, cork_timer_id);
+        _has_cork_timer = true;
+    }
+    _corked = true;
+
+    //  Wait for more messages rather than for the socket to be writable.
+    _output_stopped = true;
+    reset_pollout ();
+    return true;
+}
+
+void zmq::stream_engine_base_t::start_linger ()
+{
+    _lingering = true;
+    _corked = false;
+    const int linger = _session->get_linger ();
+    cancel_timers ();
+    _session = NULL;
+
+    if (!_input_stopped) {
+        reset_pollin (_handle);
+        _input_stopped = true;
+    }
+    if (_output_stopped) {
+        set_pollout ();
+        _output_stopped = false;
+    }
+    if (linger > 0) {
+        add_timer (linger, linger_timer_id);
+        _has_linger_timer = true;
+    }
+    out_event ();
+}
+
+bool zmq::stream_engine_base_t::linger_out ()
+{
+    //  No more messages are loaded, the encoder only has the rest of the
+    //  last one, if any.
+    while (true) {
+#if defined ZMQ_HAVE_UIO
+        if (_out_iov_threshold >= 0 && !_outsize) {
+            if (_out_iov.empty ())
+                _encoder->encode_iov (
+                  _out_iov, static_cast<size_t> (_out_iov_threshold));
+            if (_out_iov.empty ())
+                return true;
+            const int nbytes =
+              writev (_out_iov.chunks (), _out_iov.chunk_count ());
+            if (nbytes == -1)
+                return true;
+            _out_iov.consume (nbytes);
+            if (!_out_iov.empty ())
+                return false;
+            continue;
+        }
+#endif
+        if (!_outsize) {
+            _outpos = NULL;
+            _outsize = _encoder->encode (&_outpos, 0);
+        }
+        if (!_outsize)
+            return true;
+        const int nbytes = write (_outpos, _outsize);
+        if (nbytes == -1)
+            return true;
+        _outpos += nbytes;
+        _outsize -= nbytes;
+
+        //  Wait for the socket to take more.
+        if (_outsize)
+            return false;
+    }
+}
+
 void zmq::stream_engine_base_t::restart_output ()
 {
     if (unlikely (_io_error))
@@ -498,6 +954,22 @@ void zmq::stream_engine_base_t::zap_msg_available ()
         restart_output ();
 }
 
+void zmq::stream_engine_base_t::crypto_done (crypto_job_t *job_)
+{
+    zmq_assert (_mechanism != NULL);
+
+    const int rc = _mechanism->crypto_done (job_);
+    if (rc == -1) {
+        error (protocol_error);
+        return;
+    }
+    if (_input_stopped)
+        if (!restart_input ())
+            return;
+    if (_output_stopped)
+        restart_output ();
+}
+
 const zmq::endpoint_uri_pair_t &zmq::stream_engine_base_t::get_endpoint () const
 {
     return _endpoint_uri_pair;
@@ -572,6 +1044,11 @@ void zmq::stream_engine_base_t::mechanism_ready ()
         _has_handshake_timer = false;
     }
 
+#if defined ZMQ_HAVE_MEMFD
+    if (_memfd_accepted && _mechanism->peer_accepts_memfd ())
+        _memfd_threshold = _options.memfd_threshold;
+#endif
+
     _socket->event_handshake_succeeded (_endpoint_uri_pair, 0);
 }
 
@@ -604,11 +1081,86 @@ int zmq::stream_engine_base_t::pull_and_encode (msg_t *msg_)
 
     if (_session->pull_msg (msg_) == -1)
         return -1;
+#if defined ZMQ_HAVE_MEMFD
+    if (unlikely (_memfd_threshold >= 0)
+        && msg_->size () >= static_cast<size_t> (_memfd_threshold))
+        pass_in_memfd (msg_);
+#endif
     if (_mechanism->encode (msg_) == -1)
         return -1;
     return 0;
 }
 
+#if defined ZMQ_HAVE_MEMFD
+void zmq::stream_engine_base_t::pass_in_memfd (msg_t *msg_)
+{
+    //  Once the next write carries as many memfds as it can, further
+    //  frames go through the socket.
+    const size_t size = msg_->size ();
+    if (size == 0 || (msg_->flags () & msg_t::command)
+        || msg_->is_subscribe () || msg_->is_cancel ()
+        || _memfds_out.size () == max_memfds_out)
+        return;
+
+    const fd_t fd = memfd_copy (msg_->data (), size);
+    if (fd == retired_fd)
+        return;
+    _memfds_out.push_back (fd);
+
+    const unsigned char flags =
+      (msg_->flags () & msg_t::more) ? memfd_flag_more : 0;
+    int rc = msg_->close ();
+    errno_assert (rc == 0);
+    rc = msg_->init_size (memfd_command_size);
+    errno_assert (rc == 0);
+    msg_->set_flags (msg_t::command);
+
+    unsigned char *ptr = static_cast<unsigned char *> (msg_->data ());
+    memcpy (ptr, memfd_command_name, memfd_command_name_size);
+    ptr += memfd_command_name_size;
+    *ptr++ = flags;
+    put_uint64 (ptr, size);
+}
+
+int zmq::stream_engine_base_t::receive_memfd (msg_t *msg_)
+{
+    if (!_memfd_accepted || msg_->size () != memfd_command_size
+        || _memfds_in.empty ()) {
+        errno = EPROTO;
+        return -1;
+    }
+    const unsigned char *ptr =
+      static_cast<const unsigned char *> (msg_->data ())
+      + memfd_command_name_size;
+    const bool more = (*ptr & memfd_flag_more) != 0;
+    const uint64_t size = get_uint64 (ptr + 1);
+    const fd_t fd = _memfds_in.front ();
+    _memfds_in.pop_front ();
+
+    if ((_options.maxmsgsize >= 0
+         && size > static_cast<uint64_t> (_options.maxmsgsize))
+        || static_cast<uint64_t> (static_cast<size_t> (size)) != size) {
+        memfd_close (fd);
+        errno = EMSGSIZE;
+        return -1;
+    }
+    void *const data = memfd_map (fd, static_cast<size_t> (size));
+    if (data == NULL) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    int rc = msg_->close ();
+    errno_assert (rc == 0);
+    rc = msg_->init_data (data, static_cast<size_t> (size), memfd_unmap,
+                          reinterpret_cast<void *> (size));
+    errno_assert (rc == 0);
+    if (more)
+        msg_->set_flags (msg_t::more);
+    return 0;
+}
+#endif
+
 int zmq::stream_engine_base_t::decode_and_push (msg_t *msg_)
 {
     zmq_assert (_mechanism != NULL);
@@ -627,7 +1179,13 @@ int zmq::stream_engine_base_t::decode_and_push (msg_t *msg_)
     }
 
     if (msg_->flags () & msg_t::command) {
-        process_command_message (msg_);
+#if defined ZMQ_HAVE_MEMFD
+        if (unlikely (is_memfd_command (msg_))) {
+            if (receive_memfd (msg_) == -1)
+                return -1;
+        } else
+#endif
+            process_command_message (msg_);
     }
 
     if (_metadata)
@@ -696,8 +1254,7 @@ void zmq::stream_engine_base_t::error (error_reason_t reason_)
         && (_mechanism == NULL
             || _mechanism->status () != mechanism_t::handshaking),
       reason_);
-    unplug ();
-    delete this;
+    destroy ();
 }
 
 void zmq::stream_engine_base_t::set_handshake_timer ()
@@ -742,6 +1299,33 @@ void zmq::stream_engine_base_t::timer_event (int id_)
     } else if (id_ == heartbeat_timeout_timer_id) {
         _has_timeout_timer = false;
         error (timeout_error);
+    } else if (id_ == linger_timer_id) {
+        //  The rest of the output is dropped.
+        _has_linger_timer = false;
+        destroy ();
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    } else if (id_ == zerocopy_timer_id) {
+        _has_zerocopy_timer = false;
+        reap_zerocopy ();
+        if (!_zerocopy_sends.empty () && --_zerocopy_polls_left) {
+            add_timer (zerocopy_drain_interval, zerocopy_timer_id);
+            _has_zerocopy_timer = true;
+            return;
+        }
+
+        //  Messages still waiting are released by the destructor.
+        unplug ();
+        delete this;
+#endif
+    } else if (id_ == cork_timer_id) {
+        //  Write the held back batch, however small it is.
+        _has_cork_timer = false;
+        _corked = false;
+        if (_output_stopped) {
+            set_pollout ();
+            _output_stopped = false;
+        }
+        out_event ();
     } else
         // There are no other valid timer ids!
         assert (false);
@@ -749,7 +1333,25 @@ void zmq::stream_engine_base_t::timer_event (int id_)
 
 int zmq::stream_engine_base_t::read (void *data_, size_t size_)
 {
+#if defined ZMQ_HAVE_MEMFD
+    int rc;
+    if (_memfd_accepted) {
+        fd_t fds[max_memfds_in];
+        int fd_count;
+        rc = zmq::tcp_read_fds (_s, data_, size_, fds, max_memfds_in,
+                                &fd_count);
+        _memfds_in.insert (_memfds_in.end (), fds, fds + fd_count);
+
+        //  The peer is not followed in passing memfds without commands.
+        if (_memfds_in.size () > max_memfds_in) {
+            errno = EPROTO;
+            return -1;
+        }
+    } else
+        rc = zmq::tcp_read (_s, data_, size_);
+#else
     const int rc = zmq::tcp_read (_s, data_, size_);
+#endif
 
     if (rc == 0) {
         // connection closed by peer
@@ -762,5 +1364,40 @@ int zmq::stream_engine_base_t::read (void *data_, size_t size_)
 
 int zmq::stream_engine_base_t::write (const void *data_, size_t size_)
 {
+#if defined ZMQ_HAVE_MEMFD
+    if (unlikely (!_memfds_out.empty ())) {
+        iovec iov = {const_cast<void *> (data_), size_};
+        return writev_memfds (&iov, 1);
+    }
+#endif
     return zmq::tcp_write (_s, data_, size_);
 }
+
+#if defined ZMQ_HAVE_UIO
+int zmq::stream_engine_base_t::writev (const iovec *iov_, int iovcnt_)
+{
+#if defined ZMQ_HAVE_MEMFD
+    if (unlikely (!_memfds_out.empty ()))
+        return writev_memfds (iov_, iovcnt_);
+#endif
+    return zmq::tcp_writev (_s, iov_, iovcnt_);
+}
+#endif
+
+#if defined ZMQ_HAVE_MEMFD
+int zmq::stream_engine_base_t::writev_memfds (const iovec *iov_, int iovcnt_)
+{
+    //  The memfds go with the first byte written, so they reach the peer
+    //  no later than their commands.
+    const int nbytes =
+      zmq::tcp_writev_fds (_s, iov_, iovcnt_, &_memfds_out[0],
+                           static_cast<int> (_memfds_out.size ()));
+    if (nbytes > 0) {
+        for (std::vector<fd_t>::iterator it = _memfds_out.begin ();
+             it != _memfds_out.end (); ++it)
+            memfd_close (*it);
+        _memfds_out.clear ();
+    }
+    return nbytes;
+}
+#endif
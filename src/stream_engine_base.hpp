@@ -4,6 +4,12 @@
 #define __ZMQ_STREAM_ENGINE_BASE_HPP_INCLUDED__
 
 #include <stddef.h>
+#if defined ZMQ_HAVE_MEMFD
+#include <deque>
+#endif
+#if defined ZMQ_HAVE_MEMFD
+#include <vector>
+#endif
 
 #include "fd.hpp"
 #include "i_engine.hpp"
@@ -15,6 +21,8 @@
 #include "metadata.hpp"
 #include "msg.hpp"
 #include "tcp.hpp"
+#include "iov_batch.hpp"
+#include "zerocopy_sends.hpp"
 
 namespace zmq
 {
@@ -42,10 +50,14 @@ class stream_engine_base_t : public io_object_t, public i_engine
     bool restart_input () ZMQ_FINAL;
     void restart_output () ZMQ_FINAL;
     void zap_msg_available () ZMQ_FINAL;
+    void crypto_done (crypto_job_t *job_) ZMQ_FINAL;
     const endpoint_uri_pair_t &get_endpoint () const ZMQ_FINAL;
+    bool can_migrate () const ZMQ_OVERRIDE;
+    void migrate_out () ZMQ_FINAL;
+    void migrate_in (zmq::io_thread_t *io_thread_) ZMQ_FINAL;
 
     //  i_poll_events interface implementation.
-    void in_event () ZMQ_FINAL;
+    void in_event () ZMQ_OVERRIDE;
     void out_event () ZMQ_OVERRIDE;
     void timer_event (int id_) ZMQ_FINAL;
 
@@ -70,6 +82,7 @@ class stream_engine_base_t : public io_object_t, public i_engine
 
     virtual bool handshake () { return true; };
     virtual void plug_internal (){};
+    virtual void unplug_internal (){};
 
     virtual int process_command_message (msg_t *msg_)
     {
@@ -94,6 +107,9 @@ class stream_engine_base_t : public io_object_t, public i_engine
 
     virtual int read (void *data, size_t size_);
     virtual int write (const void *data_, size_t size_);
+#if defined ZMQ_HAVE_UIO
+    virtual int writev (const iovec *iov_, int iovcnt_);
+#endif
 
     void reset_pollout () { io_object_t::reset_pollout (_handle); }
     void set_pollout () { io_object_t::set_pollout (_handle); }
@@ -113,6 +129,11 @@ class stream_engine_base_t : public io_object_t, public i_engine
 
     mechanism_t *_mechanism;
 
+    //  Message bodies of at least this size are written straight from the
+    //  message using writev rather than copied to the encoder buffer. -1
+    //  disables gathered writes.
+    int _out_iov_threshold;
+
     int (stream_engine_base_t::*_next_msg) (msg_t *msg_);
     int (stream_engine_base_t::*_process_msg) (msg_t *msg_);
 
@@ -154,9 +175,69 @@ class stream_engine_base_t : public io_object_t, public i_engine
   private:
     bool in_event_internal ();
 
+    //  Decides whether a batch of size_ bytes is held back to be written
+    //  together with the messages sent next, starting the cork timer if
+    //  needed. Returns false if the batch is to be written now.
+    bool cork (size_t size_, bool full_);
+
+    //  Keeps the engine, detached from the session, until the held back
+    //  batch has been written, the connection fails or the linger period
+    //  of the socket has passed.
+    void start_linger ();
+
+    //  Writes what is left of the output once the session has gone. Returns
+    //  true if all of it has been written or the connection has failed.
+    bool linger_out ();
+
+    void cancel_timers ();
+
+#if defined ZMQ_HAVE_UIO
+    //  Variant of out_event building and writing an iov_batch_t.
+    void out_event_iov ();
+#endif
+
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    //  Writes the leading chunks of _out_iov, sending large message bodies
+    //  without copying them.
+    int writev_zerocopy ();
+
+    //  Releases the messages of completed zero-copy sends. Returns true if
+    //  the kernel has reported any completion.
+    bool reap_zerocopy ();
+
+    //  Keeps the engine, detached from the session and the socket, until
+    //  the zero-copy sends have completed or the time allowed has passed.
+    void await_zerocopy ();
+#endif
+
+    //  Unplugs and deletes the engine, unless it waits for zero-copy sends
+    //  to complete first.
+    void destroy ();
+
+#if defined ZMQ_HAVE_MEMFD
+    //  Replaces a message frame pulled from the session by a MEMFD command
+    //  passing it in a memfd. The frame is left alone if it does not
+    //  qualify or no memfd can be made for it.
+    void pass_in_memfd (msg_t *msg_);
+
+    //  Replaces a MEMFD command by the message frame it passes.
+    int receive_memfd (msg_t *msg_);
+
+    //  Writes the chunks, passing the memfds of the MEMFD commands encoded
+    //  so far along with them.
+    int writev_memfds (const iovec *iov_, int iovcnt_);
+#endif
+
     //  Unplug the engine from the session.
     void unplug ();
 
+    //  Cancels the timer if it is running, returning the time it had left
+    //  or 0.
+    int stop_timer (bool &running_, int id_);
+
+    //  Restarts a timer stopped by stop_timer.
+    void restart_timer (bool &running_, int left_, int id_);
+
     int write_credential (msg_t *msg_);
 
     void mechanism_ready ();
@@ -175,8 +256,109 @@ class stream_engine_base_t : public io_object_t, public i_engine
 
     msg_t _tx_msg;
 
+#if defined ZMQ_HAVE_UIO
+    //  Encoded data being written by out_event_iov.
+    iov_batch_t _out_iov;
+#endif
+
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    //  Message bodies of at least this size are sent without copying. -1 if
+    //  zero-copy sending is not used on this connection.
+    int _zerocopy_threshold;
+
+    //  Sends waiting for completion.
+    zerocopy_sends_t _zerocopy_sends;
+
+    //  Bounds the time the engine waits for pending completions once it is
+    //  done otherwise, see await_zerocopy.
+    enum
+    {
+        zerocopy_drain_polls = 10,
+        zerocopy_drain_interval = 10
+    };
+
+    //  Number of times left to look for completions.
+    int _zerocopy_polls_left;
+
+    //  True iff the timer looking for completions is running.
+    bool _has_zerocopy_timer;
+
+    //  ID of the timer looking for completions.
+    enum
+    {
+        zerocopy_timer_id = 0x92
+    };
+#endif
+
+#if defined ZMQ_HAVE_MEMFD
+    //  True iff the peer may pass message frames in a memfd, see
+    //  ZMQ_MEMFD_THRESHOLD.
+    const bool _memfd_accepted;
+
+    //  Message frames of at least this size are passed in a memfd. -1
+    //  unless both ends take them.
+    int _memfd_threshold;
+
+    //  Memfds received, waiting for their MEMFD commands to be decoded.
+    //  The peer passes each memfd along with the data preceding its command
+    //  at the latest.
+    std::deque<fd_t> _memfds_in;
+
+    //  Memfds of the MEMFD commands encoded, to be passed with the next
+    //  write.
+    std::vector<fd_t> _memfds_out;
+
+    //  Bounds the memfds passed with one write, and those received ahead
+    //  of their commands.
+    enum
+    {
+        max_memfds_out = 16,
+        max_memfds_in = 4 * max_memfds_out
+    };
+#endif
+
+    //  Settings of the write coalescing, see ZMQ_CORK_DELAY and
+    //  ZMQ_CORK_SIZE. A delay of 0 disables it.
+    const int _cork_delay;
+    const size_t _cork_size;
+
+    //  True iff the output batch is held back waiting for more messages.
+    bool _corked;
+
+    //  Time, from clock_t::now_us, at which the held back batch is due.
+    uint64_t _cork_deadline;
+
+    //  True iff the cork timer is running.
+    bool _has_cork_timer;
+
+    //  ID of the cork timer.
+    enum
+    {
+        cork_timer_id = 0x90
+    };
+
+    //  True iff the session has gone and the engine only writes what is
+    //  left of the output, see start_linger.
+    bool _lingering;
+
+    //  True iff the linger timer is running.
+    bool _has_linger_timer;
+
+    //  ID of the linger timer.
+    enum
+    {
+        linger_timer_id = 0x91
+    };
+
     bool _io_error;
 
+    //  Time left to the timers when the engine moved to another I/O
+    //  thread, 0 for those not running.
+    int _heartbeat_ivl_left;
+    int _heartbeat_timeout_left;
+    int _heartbeat_ttl_left;
+    int _cork_left;
+
     //  The session this engine is attached to.
     zmq::session_base_t *_session;
 
@@ -76,12 +76,7 @@ void zmq::stream_listener_base_t::create_engine (fd_t fd_)
       get_socket_name (fd_, socket_end_local),
       get_socket_name (fd_, socket_end_remote), endpoint_type_bind);
 
-    i_engine *engine;
-    if (options.raw_socket)
-        engine = new (std::nothrow) raw_engine_t (fd_, options, endpoint_pair);
-    else
-        engine = new (std::nothrow) zmtp_engine_t (fd_, options, endpoint_pair);
-    alloc_assert (engine);
+    i_engine *engine = make_engine (fd_, endpoint_pair);
 
     //  Choose I/O thread to run connecter in. Given that we are already
     //  running in an I/O thread, there must be at least one available.
@@ -98,3 +93,16 @@ void zmq::stream_listener_base_t::create_engine (fd_t fd_)
 
     _socket->event_accepted (endpoint_pair, fd_);
 }
+
+zmq::i_engine *
+zmq::stream_listener_base_t::make_engine (fd_t fd_,
+                                          const endpoint_uri_pair_t &endpoint_pair_)
+{
+    i_engine *engine;
+    if (options.raw_socket)
+        engine = new (std::nothrow) raw_engine_t (fd_, options, endpoint_pair_);
+    else
+        engine = new (std::nothrow) zmtp_engine_t (fd_, options, endpoint_pair_);
+    alloc_assert (engine);
+    return engine;
+}
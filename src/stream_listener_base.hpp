@@ -10,11 +10,13 @@
 #include "stdint.hpp"
 #include "io_object.hpp"
 #include "address.hpp"
+#include "endpoint.hpp"
 
 namespace zmq
 {
 class io_thread_t;
 class socket_base_t;
+class i_engine;
 
 class stream_listener_base_t : public own_t, public io_object_t
 {
@@ -42,6 +44,11 @@ class stream_listener_base_t : public own_t, public io_object_t
 
     virtual void create_engine (fd_t fd);
 
+    //  Creates the engine for an accepted connection, a ZMTP or raw one
+    //  by default.
+    virtual i_engine *make_engine (fd_t fd_,
+                                   const endpoint_uri_pair_t &endpoint_pair_);
+
     //  Underlying socket.
     fd_t _s;
 
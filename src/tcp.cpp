@@ -19,6 +19,18 @@
 #endif
 #endif
 
+#if defined ZMQ_HAVE_UIO
+#include <sys/uio.h>
+#endif
+
+#if defined ZMQ_HAVE_SO_ZEROCOPY || defined ZMQ_HAVE_MEMFD
+#include <string.h>
+#endif
+
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+#include <linux/errqueue.h>
+#endif
+
 #if defined ZMQ_HAVE_OPENVMS
 #include <ioctl.h>
 #endif
@@ -183,6 +195,37 @@ int zmq::tune_tcp_maxrt (fd_t sockfd_, int timeout_)
 #endif
 }
 
+#if !defined ZMQ_HAVE_WINDOWS
+//  Translates the result of a non-blocking send on a stream socket.
+static int tcp_write_result (ssize_t nbytes_)
+{
+    //  Several errors are OK. When speculative write is being done we may not
+    //  be able to write a single byte from the socket. Also, SIGSTOP issued
+    //  by a debugging tool can result in EINTR error.
+    if (nbytes_ == -1
+        && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return 0;
+
+    //  Signalise peer failure.
+    if (nbytes_ == -1) {
+#if !defined(TARGET_OS_IPHONE) || !TARGET_OS_IPHONE
+        errno_assert (errno != EACCES && errno != EBADF && errno != EDESTADDRREQ
+                      && errno != EFAULT && errno != EISCONN
+                      && errno != EMSGSIZE && errno != ENOMEM
+                      && errno != ENOTSOCK && errno != EOPNOTSUPP);
+#else
+        errno_assert (errno != EACCES && errno != EDESTADDRREQ
+                      && errno != EFAULT && errno != EISCONN
+                      && errno != EMSGSIZE && errno != ENOMEM
+                      && errno != ENOTSOCK && errno != EOPNOTSUPP);
+#endif
+        return -1;
+    }
+
+    return static_cast<int> (nbytes_);
+}
+#endif
+
 int zmq::tcp_write (fd_t s_, const void *data_, size_t size_)
 {
 #ifdef ZMQ_HAVE_WINDOWS
@@ -212,36 +255,101 @@ int zmq::tcp_write (fd_t s_, const void *data_, size_t size_)
     return nbytes;
 
 #else
-    ssize_t nbytes = send (s_, static_cast<const char *> (data_), size_, 0);
+    const ssize_t nbytes =
+      send (s_, static_cast<const char *> (data_), size_, 0);
+    return tcp_write_result (nbytes);
+#endif
+}
 
-    //  Several errors are OK. When speculative write is being done we may not
-    //  be able to write a single byte from the socket. Also, SIGSTOP issued
-    //  by a debugging tool can result in EINTR error.
-    if (nbytes == -1
-        && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
-        return 0;
+#if defined ZMQ_HAVE_UIO
+int zmq::tcp_writev (fd_t s_, const struct iovec *iov_, int iovcnt_)
+{
+    return tcp_write_result (writev (s_, iov_, iovcnt_));
+}
+#endif
 
-    //  Signalise peer failure.
-    if (nbytes == -1) {
-#if !defined(TARGET_OS_IPHONE) || !TARGET_OS_IPHONE
-        errno_assert (errno != EACCES && errno != EBADF && errno != EDESTADDRREQ
-                      && errno != EFAULT && errno != EISCONN
-                      && errno != EMSGSIZE && errno != ENOMEM
-                      && errno != ENOTSOCK && errno != EOPNOTSUPP);
+int zmq::tune_tcp_zerocopy (fd_t s_, int threshold_)
+{
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    if (threshold_ >= 0) {
+        //  Older kernels and other address families reject the option;
+        //  the connection then simply uses the copying path.
+        int zerocopy = 1;
+        setsockopt (s_, SOL_SOCKET, SO_ZEROCOPY, &zerocopy, sizeof (int));
+    }
 #else
-        errno_assert (errno != EACCES && errno != EDESTADDRREQ
-                      && errno != EFAULT && errno != EISCONN
-                      && errno != EMSGSIZE && errno != ENOMEM
-                      && errno != ENOTSOCK && errno != EOPNOTSUPP);
+    LIBZMQ_UNUSED (s_);
+    LIBZMQ_UNUSED (threshold_);
 #endif
-        return -1;
-    }
-
-    return static_cast<int> (nbytes);
+    return 0;
+}
 
+bool zmq::tcp_zerocopy_enabled (fd_t s_)
+{
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+    int zerocopy = 0;
+    socklen_t len = sizeof (zerocopy);
+    const int rc = getsockopt (s_, SOL_SOCKET, SO_ZEROCOPY, &zerocopy, &len);
+    return rc == 0 && zerocopy != 0;
+#else
+    LIBZMQ_UNUSED (s_);
+    return false;
 #endif
 }
 
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+int zmq::tcp_writev_zerocopy (fd_t s_, const struct iovec *iov_, int iovcnt_)
+{
+    struct msghdr msg;
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_iov = const_cast<struct iovec *> (iov_);
+    msg.msg_iovlen = iovcnt_;
+
+    const ssize_t nbytes = sendmsg (s_, &msg, MSG_ZEROCOPY);
+
+    //  Too many sends are waiting for completion (see optmem_max).
+    if (nbytes == -1 && errno == ENOBUFS)
+        return -1;
+    return tcp_write_result (nbytes);
+}
+
+int zmq::tcp_zerocopy_completion (fd_t s_,
+                                  uint32_t *first_,
+                                  uint32_t *last_,
+                                  bool *copied_)
+{
+    while (true) {
+        char control[CMSG_SPACE (sizeof (struct sock_extended_err))];
+        struct msghdr msg;
+        memset (&msg, 0, sizeof (msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof (control);
+
+        const ssize_t rc = recvmsg (s_, &msg, MSG_ERRQUEUE);
+        if (rc == -1)
+            return 0;
+
+        //  Skip anything else queued on the error queue.
+        const struct cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+        if (!cmsg
+            || !((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+                 || (cmsg->cmsg_level == SOL_IPV6
+                     && cmsg->cmsg_type == IPV6_RECVERR)))
+            continue;
+        const struct sock_extended_err *err =
+          reinterpret_cast<const struct sock_extended_err *> (
+            CMSG_DATA (cmsg));
+        if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+            continue;
+
+        *first_ = err->ee_info;
+        *last_ = err->ee_data;
+        *copied_ = (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+        return 1;
+    }
+}
+#endif
+
 int zmq::tcp_read (fd_t s_, void *data_, size_t size_)
 {
 #ifdef ZMQ_HAVE_WINDOWS
@@ -290,6 +398,84 @@ int zmq::tcp_read (fd_t s_, void *data_, size_t size_)
 #endif
 }
 
+#if defined ZMQ_HAVE_MEMFD
+int zmq::tcp_writev_fds (fd_t s_,
+                         const struct iovec *iov_,
+                         int iovcnt_,
+                         const fd_t *fds_,
+                         int fd_count_)
+{
+    zmq_assert (fd_count_ > 0 && fd_count_ <= 253);
+    union
+    {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE (253 * sizeof (int))];
+    } control;
+
+    struct msghdr msg;
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_iov = const_cast<struct iovec *> (iov_);
+    msg.msg_iovlen = iovcnt_;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = CMSG_SPACE (fd_count_ * sizeof (int));
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN (fd_count_ * sizeof (int));
+    memcpy (CMSG_DATA (cmsg), fds_, fd_count_ * sizeof (int));
+
+    return tcp_write_result (sendmsg (s_, &msg, MSG_NOSIGNAL));
+}
+
+int zmq::tcp_read_fds (
+  fd_t s_, void *data_, size_t size_, fd_t *fds_, int max_fds_, int *fd_count_)
+{
+    zmq_assert (max_fds_ > 0 && max_fds_ <= 253);
+    union
+    {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE (253 * sizeof (int))];
+    } control;
+
+    struct iovec iov = {data_, size_};
+    struct msghdr msg;
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = CMSG_SPACE (max_fds_ * sizeof (int));
+
+    *fd_count_ = 0;
+    const ssize_t rc = recvmsg (s_, &msg, MSG_CMSG_CLOEXEC);
+    if (rc == -1) {
+        errno_assert (errno != EBADF && errno != EFAULT && errno != ENOMEM
+                      && errno != ENOTSOCK);
+        if (errno == EWOULDBLOCK || errno == EINTR)
+            errno = EAGAIN;
+        return -1;
+    }
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR (&msg); cmsg;
+         cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+        const int count =
+          static_cast<int> ((cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int));
+        for (int i = 0; i != count && *fd_count_ < max_fds_; i++)
+            memcpy (&fds_[(*fd_count_)++], CMSG_DATA (cmsg) + i * sizeof (int),
+                    sizeof (int));
+    }
+
+    //  Descriptors that did not fit are lost, and so is the stream.
+    if (msg.msg_flags & MSG_CTRUNC) {
+        errno = EPROTO;
+        return -1;
+    }
+    return static_cast<int> (rc);
+}
+#endif
+
 void zmq::tcp_tune_loopback_fast_path (const fd_t socket_)
 {
 #if defined ZMQ_HAVE_WINDOWS && defined SIO_LOOPBACK_FAST_PATH
@@ -341,7 +527,7 @@ zmq::fd_t zmq::tcp_open_socket (const char *address_,
         return retired_fd;
 
     //  Create the socket.
-    fd_t s = open_socket (out_tcp_addr_->family (), SOCK_STREAM, IPPROTO_TCP);
+    fd_t s = tcp_create_socket (*out_tcp_addr_, options_);
 
     //  IPv6 address family not supported, try automatic downgrade to IPv4.
     if (s == retired_fd && fallback_to_ipv4_
@@ -351,16 +537,25 @@ zmq::fd_t zmq::tcp_open_socket (const char *address_,
         if (rc != 0) {
             return retired_fd;
         }
-        s = open_socket (AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        s = tcp_create_socket (*out_tcp_addr_, options_);
     }
 
+    return s;
+}
+
+zmq::fd_t zmq::tcp_create_socket (const zmq::tcp_address_t &address_,
+                                  const zmq::options_t &options_)
+{
+    const fd_t s = open_socket (address_.family (), SOCK_STREAM, IPPROTO_TCP);
     if (s == retired_fd) {
         return retired_fd;
     }
 
+    int rc;
+
     //  On some systems, IPv4 mapping in IPv6 sockets is disabled by default.
     //  Switch it on in such cases.
-    if (out_tcp_addr_->family () == AF_INET6)
+    if (address_.family () == AF_INET6)
         enable_ipv4_mapping (s);
 
     // Set the IP Type-Of-Service priority for this socket
@@ -4,6 +4,7 @@
 #define __ZMQ_TCP_HPP_INCLUDED__
 
 #include "fd.hpp"
+#include "stdint.hpp"
 
 namespace zmq
 {
@@ -34,11 +35,57 @@ int tune_tcp_maxrt (fd_t sockfd_, int timeout_);
 //  of error or orderly shutdown by the other peer -1 is returned.
 int tcp_write (fd_t s_, const void *data_, size_t size_);
 
+#if defined ZMQ_HAVE_UIO
+//  Gather variant of tcp_write.
+int tcp_writev (fd_t s_, const struct iovec *iov_, int iovcnt_);
+#endif
+
+//  Enables sending without copying on the socket if threshold_ is not
+//  negative. The kernel may not support it, which is not an error.
+int tune_tcp_zerocopy (fd_t s_, int threshold_);
+
+//  Returns true if sending without copying is enabled on the socket.
+bool tcp_zerocopy_enabled (fd_t s_);
+
+#if defined ZMQ_HAVE_SO_ZEROCOPY
+//  Variant of tcp_writev leaving the data in place. The data must not be
+//  modified or released until the kernel has reported completion of the
+//  send. Each call that writes at least one byte is assigned the next
+//  number of a per-socket sequence starting at zero. Returns -1 with errno
+//  set to ENOBUFS if the kernel cannot track more sends at the moment.
+int tcp_writev_zerocopy (fd_t s_, const struct iovec *iov_, int iovcnt_);
+
+//  Retrieves the next completion of zero-copy sends. On success returns 1
+//  and stores the range of completed sends. copied_ is set if the kernel
+//  had to copy the data after all. Returns 0 if no completion is pending.
+int tcp_zerocopy_completion (fd_t s_,
+                             uint32_t *first_,
+                             uint32_t *last_,
+                             bool *copied_);
+#endif
+
 //  Reads data from the socket (up to 'size' bytes).
 //  Returns the number of bytes actually read or -1 on error.
 //  Zero indicates the peer has closed the connection.
 int tcp_read (fd_t s_, void *data_, size_t size_);
 
+#if defined ZMQ_HAVE_MEMFD
+//  Variant of tcp_writev for UNIX domain sockets, passing the file
+//  descriptors along with the first byte written. They are only passed if
+//  at least one byte is written.
+int tcp_writev_fds (fd_t s_,
+                    const struct iovec *iov_,
+                    int iovcnt_,
+                    const fd_t *fds_,
+                    int fd_count_);
+
+//  Variant of tcp_read for UNIX domain sockets, storing up to max_fds_ file
+//  descriptors received along with the data in fds_, and their number in
+//  fd_count_. Fails with EPROTO if more descriptors were passed.
+int tcp_read_fds (
+  fd_t s_, void *data_, size_t size_, fd_t *fds_, int max_fds_, int *fd_count_);
+#endif
+
 void tcp_tune_loopback_fast_path (fd_t socket_);
 
 void tune_tcp_busy_poll (fd_t socket_, int busy_poll_);
@@ -53,6 +100,12 @@ fd_t tcp_open_socket (const char *address_,
                       bool local_,
                       bool fallback_to_ipv4_,
                       tcp_address_t *out_tcp_addr_);
+
+//  Opens a socket for the already resolved address_ and sets socket options
+//  according to the passed options_. Returns the socket descriptor, or
+//  retired_fd with errno set in case of an error.
+fd_t tcp_create_socket (const tcp_address_t &address_,
+                        const options_t &options_);
 }
 
 #endif
@@ -107,9 +107,14 @@ void zmq::tcp_connecter_t::timer_event (int id_)
 }
 
 void zmq::tcp_connecter_t::start_connecting ()
+{
+    resolve_and_connect (options.ipv6);
+}
+
+void zmq::tcp_connecter_t::connect_to (const tcp_address_t *address_)
 {
     //  Open the connecting socket.
-    const int rc = open ();
+    const int rc = address_ ? open (*address_) : -1;
 
     //  Connect may succeed in synchronous manner.
     if (rc == 0) {
@@ -128,6 +133,11 @@ void zmq::tcp_connecter_t::start_connecting ()
         add_connect_timer ();
     }
 
+    //  IPv6 address family not supported, try automatic downgrade to IPv4.
+    else if (_s == retired_fd && errno == EAFNOSUPPORT && address_
+             && address_->family () == AF_INET6 && options.ipv6)
+        resolve_and_connect (false);
+
     //  Handle any other error condition by eventual reconnect.
     else {
         if (_s != retired_fd)
@@ -144,26 +154,22 @@ void zmq::tcp_connecter_t::add_connect_timer ()
     }
 }
 
-int zmq::tcp_connecter_t::open ()
+int zmq::tcp_connecter_t::open (const tcp_address_t &address_)
 {
     zmq_assert (_s == retired_fd);
 
-    //  Resolve the address
     if (_addr->resolved.tcp_addr != NULL) {
         LIBZMQ_DELETE (_addr->resolved.tcp_addr);
     }
 
-    _addr->resolved.tcp_addr = new (std::nothrow) tcp_address_t ();
-    alloc_assert (_addr->resolved.tcp_addr);
-    _s = tcp_open_socket (_addr->address.c_str (), options, false, true,
-                          _addr->resolved.tcp_addr);
+    _s = tcp_create_socket (address_, options);
     if (_s == retired_fd) {
         //  TODO we should emit some event in this case!
-
-        LIBZMQ_DELETE (_addr->resolved.tcp_addr);
         return -1;
     }
-    zmq_assert (_addr->resolved.tcp_addr != NULL);
+
+    _addr->resolved.tcp_addr = new (std::nothrow) tcp_address_t (address_);
+    alloc_assert (_addr->resolved.tcp_addr);
 
     // Set the socket to non-blocking mode so that we get async connect().
     unblock_socket (_s);
@@ -281,6 +287,7 @@ bool zmq::tcp_connecter_t::tune_socket (const fd_t fd_)
                    | tune_tcp_keepalives (
                      fd_, options.tcp_keepalive, options.tcp_keepalive_cnt,
                      options.tcp_keepalive_idle, options.tcp_keepalive_intvl)
-                   | tune_tcp_maxrt (fd_, options.tcp_maxrt);
+                   | tune_tcp_maxrt (fd_, options.tcp_maxrt)
+                   | tune_tcp_zerocopy (fd_, options.zerocopy_threshold);
     return rc == 0;
 }
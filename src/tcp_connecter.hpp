@@ -38,13 +38,16 @@ class tcp_connecter_t ZMQ_FINAL : public stream_connecter_base_t
     //  Internal function to start the actual connection establishment.
     void start_connecting ();
 
+    //  Opens the connecting socket once the address is resolved.
+    void connect_to (const tcp_address_t *address_);
+
     //  Internal function to add a connect timer
     void add_connect_timer ();
 
     //  Open TCP connecting socket. Returns -1 in case of error,
     //  0 if connect was successful immediately. Returns -1 with
     //  EAGAIN errno if async connect was launched.
-    int open ();
+    int open (const tcp_address_t &address_);
 
     //  Get the file descriptor of newly created connection. Returns
     //  retired_fd if the connection was unsuccessful.
@@ -0,0 +1,302 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "timer_wheel.hpp"
+#include "err.hpp"
+
+#include <string.h>
+
+zmq::timer_wheel_t::node_t::node_t (void *owner_, int id_) :
+    owner (owner_),
+    id (id_),
+    _expiry (0),
+    _prev (NULL),
+    _next (NULL),
+    _hash_next (NULL),
+    _hash_link (NULL),
+    _slot (0)
+{
+}
+
+zmq::timer_wheel_t::node_t::~node_t ()
+{
+}
+
+zmq::timer_wheel_t::timer_wheel_t () :
+    _current (0),
+    _count (0),
+    _next (0),
+    _next_valid (false),
+    _buckets (64, static_cast<node_t *> (NULL))
+{
+    memset (_slots, 0, sizeof _slots);
+    memset (_occupied, 0, sizeof _occupied);
+}
+
+zmq::timer_wheel_t::~timer_wheel_t ()
+{
+    for (size_t i = 0; i != _buckets.size (); ++i) {
+        node_t *node = _buckets[i];
+        while (node) {
+            node_t *next = node->_hash_next;
+            LIBZMQ_DELETE (node);
+            node = next;
+        }
+    }
+}
+
+void zmq::timer_wheel_t::add (node_t *node_, uint64_t expiry_, uint64_t now_)
+{
+    //  With no timers in the wheel there is nothing to catch up with.
+    if (_count == 0 && now_ > _current)
+        _current = now_;
+
+    node_->_expiry = expiry_;
+    file (node_);
+
+    if (_count >= _buckets.size ())
+        rehash (_buckets.size () * 2);
+    link_hash (node_, &_buckets[bucket (node_->owner, node_->id)]);
+
+    if (_count == 0 || (_next_valid && expiry_ < _next)) {
+        _next = expiry_;
+        _next_valid = true;
+    }
+    _count++;
+}
+
+void zmq::timer_wheel_t::remove (node_t *node_)
+{
+    unlink (node_);
+
+    *node_->_hash_link = node_->_hash_next;
+    if (node_->_hash_next)
+        node_->_hash_next->_hash_link = node_->_hash_link;
+    node_->_hash_next = NULL;
+    node_->_hash_link = NULL;
+
+    _count--;
+    if (_next_valid && node_->_expiry <= _next)
+        _next_valid = false;
+}
+
+zmq::timer_wheel_t::node_t *zmq::timer_wheel_t::find (const void *owner_,
+                                                      int id_) const
+{
+    for (node_t *node = _buckets[bucket (owner_, id_)]; node;
+         node = node->_hash_next)
+        if (node->owner == owner_ && node->id == id_)
+            return node;
+    return NULL;
+}
+
+zmq::timer_wheel_t::node_t *zmq::timer_wheel_t::pop_due (uint64_t now_)
+{
+    while (_current <= now_) {
+        if (_count == 0) {
+            _current = now_;
+            return NULL;
+        }
+
+        const unsigned int index =
+          static_cast<unsigned int> (_current & slot_mask);
+        node_t *node = _slots[index];
+        if (node) {
+            remove (node);
+            return node;
+        }
+        if (_current == now_)
+            break;
+
+        //  Skip the empty slots, stopping at the end of the rotation where
+        //  the higher levels have to be cascaded.
+        const int next = find_slot (0, index + 1);
+        uint64_t target = _current - index + slots_per_level;
+        if (next != -1)
+            target = _current - index + static_cast<unsigned int> (next);
+        if (target > now_)
+            target = now_;
+        _current = target;
+        if ((_current & slot_mask) == 0)
+            cascade ();
+    }
+    return NULL;
+}
+
+uint64_t zmq::timer_wheel_t::next_expiry ()
+{
+    zmq_assert (_count > 0);
+    if (!_next_valid) {
+        _next = earliest_expiry ();
+        _next_valid = true;
+    }
+    return _next;
+}
+
+void zmq::timer_wheel_t::file (node_t *node_)
+{
+    uint64_t when = node_->_expiry < _current ? _current : node_->_expiry;
+    const uint64_t delta = when - _current;
+
+    unsigned int level = 0;
+    while (level < levels - 1 && (delta >> (level_bits * (level + 1))) != 0)
+        level++;
+    if ((delta >> (level_bits * levels)) != 0)
+        when = _current + (uint64_t (1) << (level_bits * levels)) - 1;
+
+    const unsigned int slot =
+      static_cast<unsigned int> ((when >> (level_bits * level)) & slot_mask);
+    node_->_slot = level * slots_per_level + slot;
+
+    node_t *&head = _slots[node_->_slot];
+    if (head) {
+        node_->_next = head;
+        node_->_prev = head->_prev;
+        head->_prev->_next = node_;
+        head->_prev = node_;
+    } else {
+        node_->_next = node_;
+        node_->_prev = node_;
+        head = node_;
+        _occupied[level][slot / 64] |= uint64_t (1) << (slot % 64);
+    }
+}
+
+void zmq::timer_wheel_t::unlink (node_t *node_)
+{
+    node_t *&head = _slots[node_->_slot];
+    if (node_->_next == node_) {
+        head = NULL;
+        const unsigned int level = node_->_slot / slots_per_level;
+        const unsigned int slot = node_->_slot % slots_per_level;
+        _occupied[level][slot / 64] &= ~(uint64_t (1) << (slot % 64));
+    } else {
+        node_->_prev->_next = node_->_next;
+        node_->_next->_prev = node_->_prev;
+        if (head == node_)
+            head = node_->_next;
+    }
+    node_->_prev = NULL;
+    node_->_next = NULL;
+}
+
+void zmq::timer_wheel_t::cascade ()
+{
+    //  Start from the top so that the timers coming down from a higher
+    //  level are cascaded again if their new slot starts now as well.
+    for (unsigned int level = levels - 1; level > 0; level--) {
+        const unsigned int shift = level * level_bits;
+        if ((_current & ((uint64_t (1) << shift) - 1)) != 0)
+            continue;
+
+        const unsigned int slot =
+          static_cast<unsigned int> ((_current >> shift) & slot_mask);
+        node_t *&head = _slots[level * slots_per_level + slot];
+        node_t *node = head;
+        if (!node)
+            continue;
+        head = NULL;
+        _occupied[level][slot / 64] &= ~(uint64_t (1) << (slot % 64));
+
+        //  Refile the timers in their original order.
+        node_t *const last = node->_prev;
+        while (true) {
+            node_t *const next = node->_next;
+            const bool done = node == last;
+            file (node);
+            if (done)
+                break;
+            node = next;
+        }
+    }
+}
+
+int zmq::timer_wheel_t::find_slot (unsigned int level_, unsigned int from_) const
+{
+    for (unsigned int word = from_ / 64; word < bitmap_words; word++) {
+        uint64_t bits = _occupied[level_][word];
+        if (word == from_ / 64)
+            bits &= ~uint64_t (0) << (from_ % 64);
+        if (bits == 0)
+            continue;
+#if defined __GNUC__
+        return static_cast<int> (word * 64 + __builtin_ctzll (bits));
+#else
+        unsigned int bit = 0;
+        while ((bits & (uint64_t (1) << bit)) == 0)
+            bit++;
+        return static_cast<int> (word * 64 + bit);
+#endif
+    }
+    return -1;
+}
+
+uint64_t zmq::timer_wheel_t::earliest_expiry () const
+{
+    //  Level 0 slots hold a single tick each. Any timer between the current
+    //  tick and the end of the rotation precedes the higher levels.
+    const unsigned int index = static_cast<unsigned int> (_current & slot_mask);
+    int slot = find_slot (0, index);
+    if (slot != -1)
+        return _current - index + static_cast<unsigned int> (slot);
+
+    uint64_t res = ~uint64_t (0);
+    slot = find_slot (0, 0);
+    if (slot != -1)
+        res = _current - index + slots_per_level
+              + static_cast<unsigned int> (slot);
+
+    //  Otherwise the earliest timer of each level is in the first non-empty
+    //  slot the wheel is going to reach. The slot the wheel is in at the
+    //  moment has been cascaded already and comes around last.
+    for (unsigned int level = 1; level < levels; level++) {
+        const unsigned int current = static_cast<unsigned int> (
+          (_current >> (level * level_bits)) & slot_mask);
+        slot = find_slot (level, current + 1);
+        if (slot == -1)
+            slot = find_slot (level, 0);
+        if (slot == -1)
+            continue;
+        const node_t *const head =
+          _slots[level * slots_per_level + static_cast<unsigned int> (slot)];
+        const node_t *node = head;
+        do {
+            if (node->_expiry < res)
+                res = node->_expiry;
+            node = node->_next;
+        } while (node != head);
+    }
+
+    return res;
+}
+
+size_t zmq::timer_wheel_t::bucket (const void *owner_, int id_) const
+{
+    uint64_t hash = reinterpret_cast<size_t> (owner_);
+    hash ^= static_cast<uint64_t> (static_cast<unsigned int> (id_)) << 32;
+    hash *= 0x9e3779b97f4a7c15ULL;
+    return static_cast<size_t> (hash >> 32) & (_buckets.size () - 1);
+}
+
+void zmq::timer_wheel_t::link_hash (node_t *node_, node_t **head_)
+{
+    node_->_hash_next = *head_;
+    node_->_hash_link = head_;
+    if (*head_)
+        (*head_)->_hash_link = &node_->_hash_next;
+    *head_ = node_;
+}
+
+void zmq::timer_wheel_t::rehash (size_t buckets_)
+{
+    std::vector<node_t *> old (buckets_, static_cast<node_t *> (NULL));
+    _buckets.swap (old);
+    for (size_t i = 0; i != old.size (); ++i) {
+        node_t *node = old[i];
+        while (node) {
+            node_t *next = node->_hash_next;
+            link_hash (node, &_buckets[bucket (node->owner, node->id)]);
+            node = next;
+        }
+    }
+}
@@ -0,0 +1,137 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_TIMER_WHEEL_HPP_INCLUDED__
+#define __ZMQ_TIMER_WHEEL_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <vector>
+
+#include "stdint.hpp"
+#include "macros.hpp"
+
+namespace zmq
+{
+//  Hierarchical timing wheel holding timers identified by an (owner, id)
+//  pair. Time is measured in milliseconds. There are four levels of 256
+//  slots and a slot at level N spans 256^N milliseconds. A timer is filed
+//  at the lowest level covering its distance from the wheel's current tick
+//  and moves down as the wheel reaches the start of its slot, so adding and
+//  cancelling timers are O(1). Timers further away than the top level
+//  covers wait in its last slot and are filed again when it comes around.
+
+class timer_wheel_t
+{
+  public:
+    //  A timer linked into the wheel. Users may derive from it to carry
+    //  their own data. Timers still linked when the wheel is destroyed
+    //  are deleted with it.
+    class node_t
+    {
+      public:
+        node_t (void *owner_, int id_);
+        virtual ~node_t ();
+
+        void *const owner;
+        const int id;
+
+        //  Absolute expiry time in milliseconds.
+        uint64_t expiry () const { return _expiry; }
+
+      private:
+        uint64_t _expiry;
+
+        //  Neighbours in the slot's circular list.
+        node_t *_prev;
+        node_t *_next;
+
+        //  Next timer in the same bucket of the (owner, id) index and
+        //  the pointer referring to this timer there.
+        node_t *_hash_next;
+        node_t **_hash_link;
+
+        //  Index of the slot the timer is filed in.
+        unsigned int _slot;
+
+        friend class timer_wheel_t;
+
+        ZMQ_NON_COPYABLE_NOR_MOVABLE (node_t)
+    };
+
+    timer_wheel_t ();
+    ~timer_wheel_t ();
+
+    //  Links the timer into the wheel to expire at expiry_. now_ is the
+    //  current time. The wheel takes ownership of the timer.
+    void add (node_t *node_, uint64_t expiry_, uint64_t now_);
+
+    //  Unlinks the timer from the wheel and hands it back to the caller.
+    void remove (node_t *node_);
+
+    //  Returns the timer with given owner and id, or NULL if there is none.
+    node_t *find (const void *owner_, int id_) const;
+
+    //  Unlinks and returns a timer that has expired at now_, or NULL if
+    //  there is none. Timers expiring at the same time are returned in
+    //  the order they were added. The caller takes ownership of the timer.
+    node_t *pop_due (uint64_t now_);
+
+    //  Returns the expiry time of the earliest timer. The wheel must not
+    //  be empty.
+    uint64_t next_expiry ();
+
+    bool empty () const { return _count == 0; }
+    size_t size () const { return _count; }
+
+  private:
+    enum
+    {
+        level_bits = 8,
+        slots_per_level = 1 << level_bits,
+        slot_mask = slots_per_level - 1,
+        levels = 4,
+        bitmap_words = slots_per_level / 64
+    };
+
+    //  Files the timer into the slot matching its expiry time.
+    void file (node_t *node_);
+
+    //  Removes the timer from its slot.
+    void unlink (node_t *node_);
+
+    //  Moves timers from the higher level slots starting at the current
+    //  tick down the wheel.
+    void cascade ();
+
+    //  Returns the first non-empty slot of the level at or after from_,
+    //  or -1 if there is none.
+    int find_slot (unsigned int level_, unsigned int from_) const;
+
+    uint64_t earliest_expiry () const;
+
+    size_t bucket (const void *owner_, int id_) const;
+    void link_hash (node_t *node_, node_t **head_);
+    void rehash (size_t buckets_);
+
+    //  Timers by slot, level after level.
+    node_t *_slots[levels * slots_per_level];
+
+    //  Non-empty slots, one bit per slot.
+    uint64_t _occupied[levels][bitmap_words];
+
+    //  All timers expiring before this tick have been handed out.
+    uint64_t _current;
+
+    size_t _count;
+
+    //  Cached result of next_expiry ().
+    uint64_t _next;
+    bool _next_valid;
+
+    //  Index of the timers by (owner, id).
+    std::vector<node_t *> _buckets;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (timer_wheel_t)
+};
+}
+
+#endif
@@ -4,8 +4,6 @@
 #include "timers.hpp"
 #include "err.hpp"
 
-#include <algorithm>
-
 zmq::timers_t::timers_t () : _tag (0xCAFEDADA), _next_timer_id (0)
 {
 }
@@ -28,130 +26,101 @@ int zmq::timers_t::add (size_t interval_, timers_timer_fn handler_, void *arg_)
         return -1;
     }
 
-    uint64_t when = _clock.now_ms () + interval_;
-    timer_t timer = {++_next_timer_id, interval_, handler_, arg_};
-    _timers.insert (timersmap_t::value_type (when, timer));
+    const uint64_t now = _clock.now_ms ();
+    timer_t *timer = new (std::nothrow)
+      timer_t (++_next_timer_id, interval_, handler_, arg_);
+    alloc_assert (timer);
+    _timers.add (timer, now + interval_, now);
 
-    return timer.timer_id;
+    return timer->id;
 }
 
-struct zmq::timers_t::match_by_id
+zmq::timers_t::timer_t::timer_t (int timer_id_,
+                                 size_t interval_,
+                                 timers_timer_fn *handler_,
+                                 void *arg_) :
+    node_t (NULL, timer_id_),
+    interval (interval_),
+    handler (handler_),
+    arg (arg_)
 {
-    match_by_id (int timer_id_) : _timer_id (timer_id_) {}
-
-    bool operator() (timersmap_t::value_type const &entry_) const
-    {
-        return entry_.second.timer_id == _timer_id;
-    }
+}
 
-  private:
-    int _timer_id;
-};
+zmq::timers_t::timer_t *zmq::timers_t::find (int timer_id_) const
+{
+    return static_cast<timer_t *> (_timers.find (NULL, timer_id_));
+}
 
 int zmq::timers_t::cancel (int timer_id_)
 {
-    // check first if timer exists at all
-    if (_timers.end ()
-        == std::find_if (_timers.begin (), _timers.end (),
-                         match_by_id (timer_id_))) {
+    timer_t *timer = find (timer_id_);
+    if (!timer) {
         errno = EINVAL;
         return -1;
     }
 
-    // check if timer was already canceled
-    if (_cancelled_timers.count (timer_id_)) {
-        errno = EINVAL;
-        return -1;
-    }
-
-    _cancelled_timers.insert (timer_id_);
+    _timers.remove (timer);
+    LIBZMQ_DELETE (timer);
 
     return 0;
 }
 
 int zmq::timers_t::set_interval (int timer_id_, size_t interval_)
 {
-    const timersmap_t::iterator end = _timers.end ();
-    const timersmap_t::iterator it =
-      std::find_if (_timers.begin (), end, match_by_id (timer_id_));
-    if (it != end) {
-        timer_t timer = it->second;
-        timer.interval = interval_;
-        uint64_t when = _clock.now_ms () + interval_;
-        _timers.erase (it);
-        _timers.insert (timersmap_t::value_type (when, timer));
-
-        return 0;
+    timer_t *timer = find (timer_id_);
+    if (!timer) {
+        errno = EINVAL;
+        return -1;
     }
 
-    errno = EINVAL;
-    return -1;
+    timer->interval = interval_;
+    return reset (timer_id_);
 }
 
 int zmq::timers_t::reset (int timer_id_)
 {
-    const timersmap_t::iterator end = _timers.end ();
-    const timersmap_t::iterator it =
-      std::find_if (_timers.begin (), end, match_by_id (timer_id_));
-    if (it != end) {
-        timer_t timer = it->second;
-        uint64_t when = _clock.now_ms () + timer.interval;
-        _timers.erase (it);
-        _timers.insert (timersmap_t::value_type (when, timer));
-
-        return 0;
+    timer_t *timer = find (timer_id_);
+    if (!timer) {
+        errno = EINVAL;
+        return -1;
     }
 
-    errno = EINVAL;
-    return -1;
+    const uint64_t now = _clock.now_ms ();
+    _timers.remove (timer);
+    _timers.add (timer, now + timer->interval, now);
+
+    return 0;
 }
 
 long zmq::timers_t::timeout ()
 {
-    const uint64_t now = _clock.now_ms ();
-    long res = -1;
-
-    const timersmap_t::iterator begin = _timers.begin ();
-    const timersmap_t::iterator end = _timers.end ();
-    timersmap_t::iterator it = begin;
-    for (; it != end; ++it) {
-        if (0 == _cancelled_timers.erase (it->second.timer_id)) {
-            //  Live timer, lets return the timeout
-            res = std::max (static_cast<long> (it->first - now), 0l);
-            break;
-        }
-    }
-
-    //  Remove timed-out timers
-    _timers.erase (begin, it);
+    if (_timers.empty ())
+        return -1;
 
-    return res;
+    const uint64_t now = _clock.now_ms ();
+    const uint64_t next = _timers.next_expiry ();
+    return next > now ? static_cast<long> (next - now) : 0;
 }
 
 int zmq::timers_t::execute ()
 {
     const uint64_t now = _clock.now_ms ();
 
-    const timersmap_t::iterator begin = _timers.begin ();
-    const timersmap_t::iterator end = _timers.end ();
-    timersmap_t::iterator it = _timers.begin ();
-    for (; it != end; ++it) {
-        if (0 == _cancelled_timers.erase (it->second.timer_id)) {
-            //  Timer is not cancelled
-
-            //  Map is ordered, if we have to wait for current timer we can stop.
-            if (it->first > now)
-                break;
-
-            const timer_t &timer = it->second;
+    timer_wheel_t::node_t *node;
+    while ((node = _timers.pop_due (now)) != NULL) {
+        const timer_t *timer = static_cast<timer_t *> (node);
+        const int timer_id = timer->id;
+        timers_timer_fn *const handler = timer->handler;
+        void *const arg = timer->arg;
 
-            timer.handler (timer.timer_id, timer.arg);
+        //  Reschedule the timer before invoking the handler so that the
+        //  handler can cancel or reset it. A timer with zero interval is
+        //  run again in the next millisecond rather than in this loop.
+        const size_t interval = timer->interval > 0 ? timer->interval : 1;
+        _timers.add (node, now + interval, now);
 
-            _timers.insert (
-              timersmap_t::value_type (now + timer.interval, timer));
-        }
+        handler (timer_id, arg);
     }
-    _timers.erase (begin, it);
 
     return 0;
 }
@@ -4,10 +4,9 @@
 #define __ZMQ_TIMERS_HPP_INCLUDED__
 
 #include <stddef.h>
-#include <map>
-#include <set>
 
 #include "clock.hpp"
+#include "timer_wheel.hpp"
 
 namespace zmq
 {
@@ -25,12 +24,10 @@ class timers_t
     int add (size_t interval_, timers_timer_fn handler_, void *arg_);
 
     //  Set the interval of the timer.
-    //  This method is slow, cancelling exsting and adding a new timer yield better performance.
     //  Returns 0 on success and -1 on error.
     int set_interval (int timer_id_, size_t interval_);
 
     //  Reset the timer.
-    //  This method is slow, cancelling exsting and adding a new timer yield better performance.
     //  Returns 0 on success and -1 on error.
     int reset (int timer_id_);
 
@@ -58,21 +55,23 @@ class timers_t
     //  Clock instance.
     clock_t _clock;
 
-    typedef struct timer_t
+    struct timer_t : public timer_wheel_t::node_t
     {
-        int timer_id;
-        size_t interval;
-        timers_timer_fn *handler;
-        void *arg;
-    } timer_t;
+        timer_t (int timer_id_,
+                 size_t interval_,
+                 timers_timer_fn *handler_,
+                 void *arg_);
 
-    typedef std::multimap<uint64_t, timer_t> timersmap_t;
-    timersmap_t _timers;
+        size_t interval;
+        timers_timer_fn *const handler;
+        void *const arg;
+    };
 
-    typedef std::set<int> cancelled_timers_t;
-    cancelled_timers_t _cancelled_timers;
+    //  Returns the timer with given id, or NULL if there is none.
+    timer_t *find (int timer_id_) const;
 
-    struct match_by_id;
+    //  Active timers, keyed by their id.
+    timer_wheel_t _timers;
 
     ZMQ_NON_COPYABLE_NOR_MOVABLE (timers_t)
 };
@@ -35,6 +35,13 @@ zmq::udp_engine_t::udp_engine_t (const options_t &options_) :
     _handle (static_cast<handle_t> (NULL)),
     _address (NULL),
     _options (options_),
+#if defined ZMQ_HAVE_MMSG
+    _out_pos (0),
+    _out_count (0),
+    _in_pos (0),
+    _in_count (0),
+    _gso (false),
+#endif
     _send_enabled (false),
     _recv_enabled (false)
 {
@@ -71,9 +78,77 @@ int zmq::udp_engine_t::init (address_t *address_, bool send_, bool recv_)
 
     unblock_socket (_fd);
 
+#if defined ZMQ_HAVE_MMSG
+    if (_send_enabled)
+        _out_batch.init (_options.udp_batch_size);
+    if (_recv_enabled)
+        _in_batch.init (_options.udp_batch_size);
+
+#if defined ZMQ_HAVE_UDP_SEGMENT
+    //  Raw sockets may send each datagram to a different peer.
+    if (_send_enabled && !_options.raw_socket) {
+        int gso_size = 0;
+        zmq_socklen_t len = sizeof (gso_size);
+        _gso = getsockopt (_fd, SOL_UDP, UDP_SEGMENT, &gso_size, &len) == 0;
+    }
+#endif
+#endif
+
     return 0;
 }
 
+#if defined ZMQ_HAVE_MMSG
+#if defined ZMQ_HAVE_UDP_SEGMENT
+const size_t zmq::udp_engine_t::mmsg_batch_t::control_size =
+  CMSG_SPACE (sizeof (uint16_t));
+#else
+const size_t zmq::udp_engine_t::mmsg_batch_t::control_size = 0;
+#endif
+
+zmq::udp_engine_t::mmsg_batch_t::mmsg_batch_t () :
+    hdrs (NULL),
+    iovs (NULL),
+    addresses (NULL),
+    buffers (NULL),
+    controls (NULL)
+{
+}
+
+zmq::udp_engine_t::mmsg_batch_t::~mmsg_batch_t ()
+{
+    free (hdrs);
+    free (iovs);
+    free (addresses);
+    free (buffers);
+    free (controls);
+}
+
+void zmq::udp_engine_t::mmsg_batch_t::init (int size_)
+{
+    zmq_assert (!hdrs);
+    hdrs = static_cast<mmsghdr *> (calloc (size_, sizeof (mmsghdr)));
+    alloc_assert (hdrs);
+    iovs = static_cast<iovec *> (malloc (size_ * sizeof (iovec)));
+    alloc_assert (iovs);
+    addresses = static_cast<sockaddr_storage *> (
+      malloc (size_ * sizeof (sockaddr_storage)));
+    alloc_assert (addresses);
+    buffers = static_cast<char *> (malloc (size_ * MAX_UDP_MSG));
+    alloc_assert (buffers);
+    if (control_size) {
+        controls = static_cast<char *> (malloc (size_ * control_size));
+        alloc_assert (controls);
+    }
+
+    for (int i = 0; i != size_; i++) {
+        iovs[i].iov_base = buffer (i);
+        iovs[i].iov_len = MAX_UDP_MSG;
+        hdrs[i].msg_hdr.msg_iov = &iovs[i];
+        hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+#endif
+
 void zmq::udp_engine_t::plug (io_thread_t *io_thread_, session_base_t *session_)
 {
     zmq_assert (!_plugged);
@@ -407,13 +482,15 @@ int zmq::udp_engine_t::resolve_raw_address (const char *name_, size_t length_)
     return 0;
 }
 
-void zmq::udp_engine_t::out_event ()
+int zmq::udp_engine_t::pull_datagram (char *buffer_)
 {
-    msg_t group_msg;
-    int rc = _session->pull_msg (&group_msg);
-    errno_assert (rc == 0 || (rc == -1 && errno == EAGAIN));
+    while (true) {
+        msg_t group_msg;
+        int rc = _session->pull_msg (&group_msg);
+        errno_assert (rc == 0 || (rc == -1 && errno == EAGAIN));
+        if (rc != 0)
+            return -1;
 
-    if (rc == 0) {
         msg_t body_msg;
         rc = _session->pull_msg (&body_msg);
         //  If there's a group, there should also be a body
@@ -421,67 +498,173 @@ void zmq::udp_engine_t::out_event ()
 
         const size_t group_size = group_msg.size ();
         const size_t body_size = body_msg.size ();
-        size_t size;
+        int size = -1;
 
         if (_options.raw_socket) {
             rc = resolve_raw_address (static_cast<char *> (group_msg.data ()),
                                       group_size);
 
             //  We discard the message if address is not valid
-            if (rc != 0) {
-                rc = group_msg.close ();
-                errno_assert (rc == 0);
-
-                rc = body_msg.close ();
-                errno_assert (rc == 0);
-
-                return;
+            if (rc == 0) {
+                size = static_cast<int> (body_size);
+                memcpy (buffer_, body_msg.data (), body_size);
             }
-
-            size = body_size;
-
-            memcpy (_out_buffer, body_msg.data (), body_size);
         } else {
-            size = group_size + body_size + 1;
+            size = static_cast<int> (group_size + body_size + 1);
 
             // TODO: check if larger than maximum size
-            _out_buffer[0] = static_cast<unsigned char> (group_size);
-            memcpy (_out_buffer + 1, group_msg.data (), group_size);
-            memcpy (_out_buffer + 1 + group_size, body_msg.data (), body_size);
+            buffer_[0] = static_cast<unsigned char> (group_size);
+            memcpy (buffer_ + 1, group_msg.data (), group_size);
+            memcpy (buffer_ + 1 + group_size, body_msg.data (), body_size);
         }
 
         rc = group_msg.close ();
         errno_assert (rc == 0);
 
-        body_msg.close ();
+        rc = body_msg.close ();
         errno_assert (rc == 0);
 
+        if (size >= 0)
+            return size;
+    }
+}
+
+void zmq::udp_engine_t::out_event ()
+{
+#if defined ZMQ_HAVE_MMSG
+    //  Collect a new batch once the previous one has been sent entirely.
+    if (_out_pos == _out_count) {
+        int count = 0;
+        while (count != _options.udp_batch_size) {
+            const int size = pull_datagram (_out_batch.buffer (count));
+            if (size == -1)
+                break;
+            _out_batch.iovs[count].iov_len = size;
+
+            //  Each datagram may go to a different peer.
+            if (_options.raw_socket)
+                memcpy (&_out_batch.addresses[count], &_raw_address,
+                        sizeof (_raw_address));
+            count++;
+        }
+
+        if (count == 0) {
+            reset_pollout (_handle);
+            return;
+        }
+        prepare_out_batch (0, count);
+    }
+
+    const int rc =
+      sendmmsg (_fd, _out_batch.hdrs + _out_pos, _out_count - _out_pos, 0);
+    _session->count_engine_write ();
+    if (rc < 0) {
+        //  The rest of the batch is sent once the socket becomes writable.
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return;
+#if defined ZMQ_HAVE_UDP_SEGMENT
+        //  The route does not support segmentation offload after all, e.g.
+        //  datagrams exceed the MTU or the device lacks checksum offload.
+        //  Send the datagrams one by one from now on.
+        if (_gso && (errno == EIO || errno == EINVAL || errno == EMSGSIZE)) {
+            _gso = false;
+            const msghdr &hdr = _out_batch.hdrs[_out_pos].msg_hdr;
+            const int first = static_cast<int> (hdr.msg_iov - _out_batch.iovs);
+            const int last = static_cast<int> (
+              _out_batch.hdrs[_out_count - 1].msg_hdr.msg_iov - _out_batch.iovs
+              + _out_batch.hdrs[_out_count - 1].msg_hdr.msg_iovlen);
+            prepare_out_batch (first, last);
+            return;
+        }
+#endif
+        assert_success_or_recoverable (_fd, rc);
+        error (connection_error);
+        return;
+    }
+    _out_pos += rc;
+#else
+    const int size = pull_datagram (_out_buffer);
+    if (size == -1) {
+        reset_pollout (_handle);
+        return;
+    }
+
 #ifdef ZMQ_HAVE_WINDOWS
-        rc = sendto (_fd, _out_buffer, static_cast<int> (size), 0, _out_address,
-                     _out_address_len);
+    const int rc =
+      sendto (_fd, _out_buffer, size, 0, _out_address, _out_address_len);
 #elif defined ZMQ_HAVE_VXWORKS
-        rc = sendto (_fd, reinterpret_cast<caddr_t> (_out_buffer), size, 0,
-                     (sockaddr *) _out_address, _out_address_len);
+    const int rc = sendto (_fd, reinterpret_cast<caddr_t> (_out_buffer), size,
+                           0, (sockaddr *) _out_address, _out_address_len);
 #else
-        rc = sendto (_fd, _out_buffer, size, 0, _out_address, _out_address_len);
+    const int rc =
+      sendto (_fd, _out_buffer, size, 0, _out_address, _out_address_len);
 #endif
-        if (rc < 0) {
+    _session->count_engine_write ();
+    if (rc < 0) {
 #ifdef ZMQ_HAVE_WINDOWS
-            if (WSAGetLastError () != WSAEWOULDBLOCK) {
-                assert_success_or_recoverable (_fd, rc);
-                error (connection_error);
-            }
+        if (WSAGetLastError () != WSAEWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, rc);
+            error (connection_error);
+        }
 #else
-            if (rc != EWOULDBLOCK) {
-                assert_success_or_recoverable (_fd, rc);
-                error (connection_error);
+        if (rc != EWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, rc);
+            error (connection_error);
+        }
+#endif
+    }
+#endif
+}
+
+#if defined ZMQ_HAVE_MMSG
+void zmq::udp_engine_t::prepare_out_batch (int first_, int last_)
+{
+    _out_pos = 0;
+    _out_count = 0;
+
+    for (int i = first_; i != last_;) {
+        int segments = 1;
+#if defined ZMQ_HAVE_UDP_SEGMENT
+        //  A run of datagrams of equal size is passed as a single buffer
+        //  and split into datagrams by the kernel or the NIC.
+        const size_t size = _out_batch.iovs[i].iov_len;
+        if (_gso) {
+            size_t total = size;
+            while (i + segments != last_ && segments != max_gso_segments
+                   && _out_batch.iovs[i + segments].iov_len == size
+                   && total + size <= max_gso_bytes) {
+                total += size;
+                segments++;
             }
+        }
 #endif
+        msghdr &hdr = _out_batch.hdrs[_out_count].msg_hdr;
+        hdr.msg_iov = &_out_batch.iovs[i];
+        hdr.msg_iovlen = segments;
+        if (_options.raw_socket)
+            hdr.msg_name = &_out_batch.addresses[i];
+        else
+            hdr.msg_name = const_cast<sockaddr *> (_out_address);
+        hdr.msg_namelen = _out_address_len;
+        hdr.msg_control = NULL;
+        hdr.msg_controllen = 0;
+#if defined ZMQ_HAVE_UDP_SEGMENT
+        if (segments > 1) {
+            hdr.msg_control = _out_batch.control (_out_count);
+            hdr.msg_controllen = mmsg_batch_t::control_size;
+            cmsghdr *cmsg = CMSG_FIRSTHDR (&hdr);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN (sizeof (uint16_t));
+            const uint16_t gso_size = static_cast<uint16_t> (size);
+            memcpy (CMSG_DATA (cmsg), &gso_size, sizeof (gso_size));
         }
-    } else {
-        reset_pollout (_handle);
+#endif
+        _out_count++;
+        i += segments;
     }
 }
+#endif
 
 const zmq::endpoint_uri_pair_t &zmq::udp_engine_t::get_endpoint () const
 {
@@ -501,58 +684,37 @@ void zmq::udp_engine_t::restart_output ()
     }
 }
 
-void zmq::udp_engine_t::in_event ()
+bool zmq::udp_engine_t::push_datagram (const char *buffer_,
+                                       int size_,
+                                       const sockaddr_storage *address_)
 {
-    sockaddr_storage in_address;
-    zmq_socklen_t in_addrlen =
-      static_cast<zmq_socklen_t> (sizeof (sockaddr_storage));
-
-    const int nbytes =
-      recvfrom (_fd, _in_buffer, MAX_UDP_MSG, 0,
-                reinterpret_cast<sockaddr *> (&in_address), &in_addrlen);
-
-    if (nbytes < 0) {
-#ifdef ZMQ_HAVE_WINDOWS
-        if (WSAGetLastError () != WSAEWOULDBLOCK) {
-            assert_success_or_recoverable (_fd, nbytes);
-            error (connection_error);
-        }
-#else
-        if (nbytes != EWOULDBLOCK) {
-            assert_success_or_recoverable (_fd, nbytes);
-            error (connection_error);
-        }
-#endif
-        return;
-    }
-
     int rc;
     int body_size;
     int body_offset;
     msg_t msg;
 
     if (_options.raw_socket) {
-        zmq_assert (in_address.ss_family == AF_INET);
-        sockaddr_to_msg (&msg, reinterpret_cast<sockaddr_in *> (&in_address));
+        zmq_assert (address_->ss_family == AF_INET);
+        sockaddr_to_msg (&msg, reinterpret_cast<const sockaddr_in *> (address_));
 
-        body_size = nbytes;
+        body_size = size_;
         body_offset = 0;
     } else {
         // TODO in out_event, the group size is an *unsigned* char. what is
         // the maximum value?
-        const char *group_buffer = _in_buffer + 1;
-        const int group_size = _in_buffer[0];
+        const char *group_buffer = buffer_ + 1;
+        const int group_size = buffer_[0];
+
+        //  This doesn't fit, just ignore
+        if (size_ - 1 < group_size)
+            return true;
 
         rc = msg.init_size (group_size);
         errno_assert (rc == 0);
         msg.set_flags (msg_t::more);
         memcpy (msg.data (), group_buffer, group_size);
 
-        //  This doesn't fit, just ignore
-        if (nbytes - 1 < group_size)
-            return;
-
-        body_size = nbytes - 1 - group_size;
+        body_size = size_ - 1 - group_size;
         body_offset = 1 + group_size;
     }
     // Push group description to session
@@ -565,14 +727,14 @@ void zmq::udp_engine_t::in_event ()
         errno_assert (rc == 0);
 
         reset_pollin (_handle);
-        return;
+        return false;
     }
 
     rc = msg.close ();
     errno_assert (rc == 0);
     rc = msg.init_size (body_size);
     errno_assert (rc == 0);
-    memcpy (msg.data (), _in_buffer + body_offset, body_size);
+    memcpy (msg.data (), buffer_ + body_offset, body_size);
 
     // Push message body to session
     rc = _session->push_msg (&msg);
@@ -583,11 +745,77 @@ void zmq::udp_engine_t::in_event ()
 
         _session->reset ();
         reset_pollin (_handle);
-        return;
+        return false;
     }
 
     rc = msg.close ();
     errno_assert (rc == 0);
+    return true;
+}
+
+void zmq::udp_engine_t::in_event ()
+{
+#if defined ZMQ_HAVE_MMSG
+    if (_in_pos == _in_count) {
+        for (int i = 0; i != _options.udp_batch_size; i++) {
+            msghdr &hdr = _in_batch.hdrs[i].msg_hdr;
+            hdr.msg_name = &_in_batch.addresses[i];
+            hdr.msg_namelen =
+              static_cast<socklen_t> (sizeof (sockaddr_storage));
+        }
+
+        const int count =
+          recvmmsg (_fd, _in_batch.hdrs, _options.udp_batch_size, 0, NULL);
+        _session->count_engine_read ();
+        if (count < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                assert_success_or_recoverable (_fd, count);
+                error (connection_error);
+            }
+            return;
+        }
+        _in_pos = 0;
+        _in_count = count;
+    }
+
+    //  If the pipe fills up, the datagram that did not fit is dropped, as
+    //  a single one read would be. The rest of the batch is kept until
+    //  restart_input.
+    while (_in_pos != _in_count) {
+        const int i = _in_pos++;
+        if (!push_datagram (_in_batch.buffer (i),
+                            static_cast<int> (_in_batch.hdrs[i].msg_len),
+                            &_in_batch.addresses[i]))
+            break;
+    }
+#else
+    sockaddr_storage in_address;
+    zmq_socklen_t in_addrlen =
+      static_cast<zmq_socklen_t> (sizeof (sockaddr_storage));
+
+    const int nbytes =
+      recvfrom (_fd, _in_buffer, MAX_UDP_MSG, 0,
+                reinterpret_cast<sockaddr *> (&in_address), &in_addrlen);
+    _session->count_engine_read ();
+
+    if (nbytes < 0) {
+#ifdef ZMQ_HAVE_WINDOWS
+        if (WSAGetLastError () != WSAEWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, nbytes);
+            error (connection_error);
+        }
+#else
+        if (nbytes != EWOULDBLOCK) {
+            assert_success_or_recoverable (_fd, nbytes);
+            error (connection_error);
+        }
+#endif
+        return;
+    }
+
+    if (!push_datagram (_in_buffer, nbytes, &in_address))
+        return;
+#endif
     _session->flush ();
 }
 
@@ -7,6 +7,14 @@
 #include "address.hpp"
 #include "msg.hpp"
 
+#if defined ZMQ_HAVE_MMSG
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+#if defined ZMQ_HAVE_UDP_SEGMENT
+#include <netinet/udp.h>
+#endif
+
 #define MAX_UDP_MSG 8192
 
 namespace zmq
@@ -42,6 +50,11 @@ class udp_engine_t ZMQ_FINAL : public io_object_t, public i_engine
 
     void zap_msg_available (){};
 
+    void crypto_done (crypto_job_t *){};
+    bool can_migrate () const { return false; }
+    void migrate_out () {}
+    void migrate_in (zmq::io_thread_t *) {}
+
     void in_event ();
     void out_event ();
 
@@ -51,6 +64,24 @@ class udp_engine_t ZMQ_FINAL : public io_object_t, public i_engine
     int resolve_raw_address (const char *name_, size_t length_);
     static void sockaddr_to_msg (zmq::msg_t *msg_, const sockaddr_in *addr_);
 
+    //  Pulls the next message from the session and encodes it as a datagram
+    //  into buffer_. For raw sockets the destination is left in
+    //  _raw_address. Returns the size of the datagram, or -1 if there is no
+    //  message to send.
+    int pull_datagram (char *buffer_);
+
+    //  Pushes a received datagram to the session. Returns false if it did
+    //  not fit into the pipe, in which case it is dropped and reading stops.
+    bool push_datagram (const char *buffer_,
+                        int size_,
+                        const sockaddr_storage *address_);
+
+#if defined ZMQ_HAVE_MMSG
+    //  Sets up the headers for sending datagrams first_ to last_ of
+    //  _out_batch.
+    void prepare_out_batch (int first_, int last_);
+#endif
+
     static int set_udp_reuse_address (fd_t s_, bool on_);
     static int set_udp_reuse_port (fd_t s_, bool on_);
     // Indicate, if the multicast data being sent should be looped back
@@ -82,8 +113,58 @@ class udp_engine_t ZMQ_FINAL : public io_object_t, public i_engine
     const struct sockaddr *_out_address;
     zmq_socklen_t _out_address_len;
 
+#if defined ZMQ_HAVE_MMSG
+    //  Datagrams handled by a single sendmmsg or recvmmsg call.
+    struct mmsg_batch_t
+    {
+        mmsg_batch_t ();
+        ~mmsg_batch_t ();
+
+        //  Allocates buffers for size_ datagrams.
+        void init (int size_);
+
+        char *buffer (int index_) { return buffers + index_ * MAX_UDP_MSG; }
+        char *control (int index_) { return controls + index_ * control_size; }
+
+        //  Room for the UDP_SEGMENT control message.
+        static const size_t control_size;
+
+        mmsghdr *hdrs;
+        iovec *iovs;
+        sockaddr_storage *addresses;
+        char *buffers;
+        char *controls;
+
+        ZMQ_NON_COPYABLE_NOR_MOVABLE (mmsg_batch_t)
+    };
+
+    mmsg_batch_t _out_batch;
+    mmsg_batch_t _in_batch;
+
+    //  Headers of _out_batch already sent and in total. With segmentation
+    //  offload a header may cover several datagrams.
+    int _out_pos;
+    int _out_count;
+
+    //  Datagrams of _in_batch already pushed to the session and in total.
+    //  The kernel is only read again once all of them have been pushed.
+    int _in_pos;
+    int _in_count;
+
+    //  True if datagrams of equal size are handed to the kernel as a
+    //  single buffer to be segmented (UDP_SEGMENT).
+    bool _gso;
+
+    //  Limits of the kernel for a single segmented send.
+    enum
+    {
+        max_gso_segments = 64,
+        max_gso_bytes = 65000
+    };
+#else
     char _out_buffer[MAX_UDP_MSG];
     char _in_buffer[MAX_UDP_MSG];
+#endif
     bool _send_enabled;
     bool _recv_enabled;
 };
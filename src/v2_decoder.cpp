@@ -13,8 +13,10 @@
 
 zmq::v2_decoder_t::v2_decoder_t (size_t bufsize_,
                                  int64_t maxmsgsize_,
-                                 bool zero_copy_) :
-    decoder_base_t<v2_decoder_t, shared_message_memory_allocator> (bufsize_),
+                                 bool zero_copy_,
+                                 i_msg_allocator *msg_allocator_) :
+    decoder_base_t<v2_decoder_t, shared_message_memory_allocator> (
+      bufsize_, msg_allocator_),
     _msg_flags (0),
     _zero_copy (zero_copy_),
     _max_msg_size (maxmsgsize_)
@@ -92,7 +94,8 @@ int zmq::v2_decoder_t::size_ready (uint64_t msg_size_,
                        allocator.data () + allocator.size () - read_pos_))) {
         // a new message has started, but the size would exceed the pre-allocated arena
         // this happens every time when a message does not fit completely into the buffer
-        rc = _in_progress.init_size (static_cast<size_t> (msg_size_));
+        rc = _in_progress.init_size (static_cast<size_t> (msg_size_),
+                                     allocator.msg_allocator ());
     } else {
         // construct message using n bytes from the buffer as storage
         // increase buffer ref count
@@ -116,9 +116,14 @@ void zmq::ws_connecter_t::timer_event (int id_)
 }
 
 void zmq::ws_connecter_t::start_connecting ()
+{
+    resolve_and_connect (options.ipv6);
+}
+
+void zmq::ws_connecter_t::connect_to (const tcp_address_t *address_)
 {
     //  Open the connecting socket.
-    const int rc = open ();
+    const int rc = address_ ? open (*address_) : -1;
 
     //  Connect may succeed in synchronous manner.
     if (rc == 0) {
@@ -137,6 +142,11 @@ void zmq::ws_connecter_t::start_connecting ()
         add_connect_timer ();
     }
 
+    //  IPv6 address family not supported, try automatic downgrade to IPv4.
+    else if (_s == retired_fd && errno == EAFNOSUPPORT && address_
+             && address_->family () == AF_INET6 && options.ipv6)
+        resolve_and_connect (false);
+
     //  Handle any other error condition by eventual reconnect.
     else {
         if (_s != retired_fd)
@@ -153,13 +163,11 @@ void zmq::ws_connecter_t::add_connect_timer ()
     }
 }
 
-int zmq::ws_connecter_t::open ()
+int zmq::ws_connecter_t::open (const tcp_address_t &tcp_addr_)
 {
     zmq_assert (_s == retired_fd);
 
-    tcp_address_t tcp_addr;
-    _s = tcp_open_socket (_addr->address.c_str (), options, false, true,
-                          &tcp_addr);
+    _s = tcp_create_socket (tcp_addr_, options);
     if (_s == retired_fd)
         return -1;
 
@@ -168,9 +176,9 @@ int zmq::ws_connecter_t::open ()
 
     //  Connect to the remote peer.
 #ifdef ZMQ_HAVE_VXWORKS
-    int rc = ::connect (_s, (sockaddr *) tcp_addr.addr (), tcp_addr.addrlen ());
+    int rc = ::connect (_s, (sockaddr *) tcp_addr_.addr (), tcp_addr_.addrlen ());
 #else
-    const int rc = ::connect (_s, tcp_addr.addr (), tcp_addr.addrlen ());
+    const int rc = ::connect (_s, tcp_addr_.addr (), tcp_addr_.addrlen ());
 #endif
     //  Connect was successful immediately.
     if (rc == 0) {
@@ -7,6 +7,7 @@
 
 #include "ws_protocol.hpp"
 #include "ws_decoder.hpp"
+#include "ws_mask.hpp"
 #include "likely.hpp"
 #include "wire.hpp"
 #include "err.hpp"
@@ -14,8 +15,10 @@
 zmq::ws_decoder_t::ws_decoder_t (size_t bufsize_,
                                  int64_t maxmsgsize_,
                                  bool zero_copy_,
-                                 bool must_mask_) :
-    decoder_base_t<ws_decoder_t, shared_message_memory_allocator> (bufsize_),
+                                 bool must_mask_,
+                                 i_msg_allocator *msg_allocator_) :
+    decoder_base_t<ws_decoder_t, shared_message_memory_allocator> (
+      bufsize_, msg_allocator_),
     _msg_flags (0),
     _zero_copy (zero_copy_),
     _max_msg_size (maxmsgsize_),
@@ -193,7 +196,8 @@ int zmq::ws_decoder_t::size_ready (unsigned char const *read_pos_)
         // a new message has started, but the size would exceed the pre-allocated arena
         // (or read_pos_ is in the initial handshake buffer)
         // this happens every time when a message does not fit completely into the buffer
-        rc = _in_progress.init_size (static_cast<size_t> (_size));
+        rc = _in_progress.init_size (static_cast<size_t> (_size),
+                                     allocator.msg_allocator ());
     } else {
         // construct message using n bytes from the buffer as storage
         // increase buffer ref count
@@ -234,12 +238,14 @@ int zmq::ws_decoder_t::size_ready (unsigned char const *read_pos_)
 int zmq::ws_decoder_t::message_ready (unsigned char const *)
 {
     if (_must_mask) {
-        int mask_index = _opcode == ws_protocol_t::opcode_binary ? 1 : 0;
+        const size_t mask_index =
+          _opcode == ws_protocol_t::opcode_binary ? 1 : 0;
 
+        //  The message owns its data, even when it lives in the receive
+        //  buffer, so it is unmasked in place.
         unsigned char *data =
           static_cast<unsigned char *> (_in_progress.data ());
-        for (size_t i = 0; i < _size; ++i, mask_index++)
-            data[i] = data[i] ^ _mask[mask_index % 4];
+        ws_mask (data, data, _size, _mask, mask_index);
     }
 
     //  Message is completely read. Signal this to the caller
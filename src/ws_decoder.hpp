@@ -19,7 +19,8 @@ class ws_decoder_t ZMQ_FINAL
     ws_decoder_t (size_t bufsize_,
                   int64_t maxmsgsize_,
                   bool zero_copy_,
-                  bool must_mask_);
+                  bool must_mask_,
+                  i_msg_allocator *msg_allocator_ = NULL);
     ~ws_decoder_t ();
 
     //  i_decoder interface.
@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "ws_mask.hpp"
+#include "stdint.hpp"
+
+#include <string.h>
+
+#if defined __AVX2__
+#include <immintrin.h>
+#endif
+#if defined __SSE2__ || defined _M_X64                                         \
+  || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define ZMQ_WS_MASK_SSE2
+#include <emmintrin.h>
+#elif defined __ARM_NEON || defined _M_ARM64
+#define ZMQ_WS_MASK_NEON
+#include <arm_neon.h>
+#endif
+
+void zmq::ws_mask (unsigned char *dest_,
+                   const unsigned char *src_,
+                   size_t size_,
+                   const unsigned char *mask_,
+                   size_t offset_)
+{
+    //  Rotate the key so that it starts with the byte for the first one.
+    //  As all the wide steps below are multiples of 4 bytes, the key
+    //  stays in phase with the data. Loading it with memcpy keeps the byte
+    //  order in the register the same as in memory.
+    unsigned char key[8];
+    for (int i = 0; i != 8; i++)
+        key[i] = mask_[(offset_ + i) % 4];
+
+    size_t i = 0;
+
+#if defined __AVX2__ || defined ZMQ_WS_MASK_SSE2 || defined ZMQ_WS_MASK_NEON
+    uint32_t key32;
+    memcpy (&key32, key, sizeof key32);
+#endif
+
+#if defined __AVX2__
+    const __m256i key256 = _mm256_set1_epi32 (static_cast<int> (key32));
+    for (; i + 32 <= size_; i += 32) {
+        const __m256i data =
+          _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (src_ + i));
+        _mm256_storeu_si256 (reinterpret_cast<__m256i *> (dest_ + i),
+                             _mm256_xor_si256 (data, key256));
+    }
+#endif
+
+#if defined ZMQ_WS_MASK_SSE2
+    const __m128i key128 = _mm_set1_epi32 (static_cast<int> (key32));
+    for (; i + 16 <= size_; i += 16) {
+        const __m128i data =
+          _mm_loadu_si128 (reinterpret_cast<const __m128i *> (src_ + i));
+        _mm_storeu_si128 (reinterpret_cast<__m128i *> (dest_ + i),
+                          _mm_xor_si128 (data, key128));
+    }
+#elif defined ZMQ_WS_MASK_NEON
+    const uint8x16_t key128 = vreinterpretq_u8_u32 (vdupq_n_u32 (key32));
+    for (; i + 16 <= size_; i += 16)
+        vst1q_u8 (dest_ + i, veorq_u8 (vld1q_u8 (src_ + i), key128));
+#endif
+
+    //  Without vector instructions, or for what is left, 8 bytes at a
+    //  time.
+    uint64_t key64;
+    memcpy (&key64, key, sizeof key64);
+    for (; i + 8 <= size_; i += 8) {
+        uint64_t data;
+        memcpy (&data, src_ + i, sizeof data);
+        data ^= key64;
+        memcpy (dest_ + i, &data, sizeof data);
+    }
+
+    for (; i < size_; i++)
+        dest_[i] = src_[i] ^ key[i % 4];
+}
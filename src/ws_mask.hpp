@@ -0,0 +1,22 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_WS_MASK_HPP_INCLUDED__
+#define __ZMQ_WS_MASK_HPP_INCLUDED__
+
+#include <stddef.h>
+
+namespace zmq
+{
+//  XORs size_ bytes from src_ with the 4 byte web socket masking key and
+//  stores them to dest_, which may be the same as src_. The first byte is
+//  masked with mask_[offset_ % 4], allowing for frames whose payload does
+//  not start with the message data.
+
+void ws_mask (unsigned char *dest_,
+              const unsigned char *src_,
+              size_t size_,
+              const unsigned char *mask_,
+              size_t offset_);
+}
+
+#endif
@@ -38,6 +38,9 @@ zmq::wss_engine_t::wss_engine_t (fd_t fd_,
 {
     int rc = 0;
 
+    //  TLS records are written from a single buffer at a time.
+    _out_iov_threshold = -1;
+
     if (client_) {
         // TODO: move to session_base, to allow changing the socket options between connect calls
         rc = gnutls_certificate_allocate_credentials (&_tls_client_cred);
@@ -325,6 +325,18 @@ int zmq::xpub_t::xsend (msg_t *msg_)
     return rc;
 }
 
+bool zmq::xpub_t::xbegin_batch (bool send_)
+{
+    if (send_)
+        _dist.begin_batch ();
+    return send_;
+}
+
+void zmq::xpub_t::xend_batch (bool)
+{
+    _dist.end_batch ();
+}
+
 bool zmq::xpub_t::xhas_out ()
 {
     return _dist.has_out ();
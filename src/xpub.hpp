@@ -28,6 +28,8 @@ class xpub_t : public socket_base_t
                        bool subscribe_to_all_ = false,
                        bool locally_initiated_ = false) ZMQ_OVERRIDE;
     int xsend (zmq::msg_t *msg_) ZMQ_FINAL;
+    bool xbegin_batch (bool send_) ZMQ_FINAL;
+    void xend_batch (bool send_) ZMQ_FINAL;
     bool xhas_out () ZMQ_FINAL;
     int xrecv (zmq::msg_t *msg_) ZMQ_OVERRIDE;
     bool xhas_in () ZMQ_OVERRIDE;
@@ -99,7 +99,7 @@ int zmq::xsub_t::xgetsockopt (int option_, void *optval_, size_t *optvallen_)
     if (option_ == ZMQ_TOPICS_COUNT) {
         // make sure to use a multi-thread safe function to avoid race conditions with I/O threads
         // where subscriptions are processed:
-#ifdef ZMQ_USE_RADIX_TREE
+#if defined ZMQ_USE_ART_TREE || defined ZMQ_USE_RADIX_TREE
         uint64_t num_subscriptions = _subscriptions.size ();
 #else
         uint64_t num_subscriptions = _subscriptions.num_prefixes ();
@@ -212,6 +212,11 @@ int zmq::xsub_t::xrecv (msg_t *msg_)
     }
 }
 
+bool zmq::xsub_t::xbegin_batch (bool send_)
+{
+    return !send_;
+}
+
 bool zmq::xsub_t::xhas_in ()
 {
     //  There are subsequent parts of the partly-read message available.
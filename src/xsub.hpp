@@ -7,7 +7,9 @@
 #include "session_base.hpp"
 #include "dist.hpp"
 #include "fq.hpp"
-#ifdef ZMQ_USE_RADIX_TREE
+#if defined ZMQ_USE_ART_TREE
+#include "art_tree.hpp"
+#elif defined ZMQ_USE_RADIX_TREE
 #include "radix_tree.hpp"
 #else
 #include "trie.hpp"
@@ -37,6 +39,7 @@ class xsub_t : public socket_base_t
     int xsend (zmq::msg_t *msg_) ZMQ_OVERRIDE;
     bool xhas_out () ZMQ_OVERRIDE;
     int xrecv (zmq::msg_t *msg_) ZMQ_FINAL;
+    bool xbegin_batch (bool send_) ZMQ_FINAL;
     bool xhas_in () ZMQ_FINAL;
     void xread_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
     void xwrite_activated (zmq::pipe_t *pipe_) ZMQ_FINAL;
@@ -59,7 +62,9 @@ class xsub_t : public socket_base_t
     dist_t _dist;
 
     //  The repository of subscriptions.
-#ifdef ZMQ_USE_RADIX_TREE
+#if defined ZMQ_USE_ART_TREE
+    art_tree_t _subscriptions;
+#elif defined ZMQ_USE_RADIX_TREE
     radix_tree_t _subscriptions;
 #else
     trie_with_size_t _subscriptions;
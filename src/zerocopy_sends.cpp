@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+#include "zerocopy_sends.hpp"
+#include "err.hpp"
+
+zmq::zerocopy_sends_t::zerocopy_sends_t () : _first_id (0)
+{
+}
+
+zmq::zerocopy_sends_t::~zerocopy_sends_t ()
+{
+    while (!_sends.empty ()) {
+        const int rc = _sends.front ().msg.close ();
+        errno_assert (rc == 0);
+        _sends.pop_front ();
+    }
+}
+
+void zmq::zerocopy_sends_t::add (msg_t *msg_)
+{
+    _sends.push_back (send_t ());
+    send_t &send = _sends.back ();
+    send.completed = false;
+    int rc = send.msg.init ();
+    errno_assert (rc == 0);
+    rc = send.msg.copy (*msg_);
+    errno_assert (rc == 0);
+}
+
+void zmq::zerocopy_sends_t::complete (uint32_t first_, uint32_t last_)
+{
+    //  Ids wrap around. Those of sends released already come out too
+    //  large and are ignored.
+    for (uint32_t id = first_; id != last_ + 1; id++) {
+        const uint32_t index = id - _first_id;
+        if (index < _sends.size ())
+            _sends[index].completed = true;
+    }
+    while (!_sends.empty () && _sends.front ().completed) {
+        const int rc = _sends.front ().msg.close ();
+        errno_assert (rc == 0);
+        _sends.pop_front ();
+        _first_id++;
+    }
+}
@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef __ZMQ_ZEROCOPY_SENDS_HPP_INCLUDED__
+#define __ZMQ_ZEROCOPY_SENDS_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <deque>
+
+#include "macros.hpp"
+#include "msg.hpp"
+#include "stdint.hpp"
+
+namespace zmq
+{
+//  Zero-copy sends waiting for the kernel to be done with their data. Each
+//  holds a reference to its message, so that the body stays alive while
+//  the kernel uses it. The kernel numbers the sends of a socket from 0 and
+//  reports them completed in ranges of ids, not necessarily in order.
+
+class zerocopy_sends_t
+{
+  public:
+    zerocopy_sends_t ();
+
+    //  Releases the messages of the sends still waiting.
+    ~zerocopy_sends_t ();
+
+    //  Keeps a reference to the message of the next send.
+    void add (msg_t *msg_);
+
+    //  Marks the sends from first_ to last_ as completed. The messages are
+    //  released as soon as the sends before them have completed as well.
+    void complete (uint32_t first_, uint32_t last_);
+
+    bool empty () const { return _sends.empty (); }
+    size_t size () const { return _sends.size (); }
+
+  private:
+    struct send_t
+    {
+        bool completed;
+        msg_t msg;
+    };
+
+    //  Sends waiting for completion, in the order of their ids.
+    std::deque<send_t> _sends;
+
+    //  Id of the first send waiting.
+    uint32_t _first_id;
+
+    ZMQ_NON_COPYABLE_NOR_MOVABLE (zerocopy_sends_t)
+};
+}
+
+#endif
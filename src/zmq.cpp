@@ -380,7 +380,8 @@ int zmq_send (void *s_, const void *buf_, size_t len_, int flags_)
     if (!s)
         return -1;
     zmq_msg_t msg;
-    int rc = zmq_msg_init_buffer (&msg, buf_, len_);
+    int rc = (reinterpret_cast<zmq::msg_t *> (&msg))
+               ->init_buffer (buf_, len_, s->get_ctx ()->get_msg_allocator ());
     if (unlikely (rc < 0))
         return -1;
 
@@ -599,6 +600,17 @@ int zmq_msg_init_buffer (zmq_msg_t *msg_, const void *buf_, size_t size_)
     return (reinterpret_cast<zmq::msg_t *> (msg_))->init_buffer (buf_, size_);
 }
 
+int zmq_msg_init_ctx_size (zmq_msg_t *msg_, void *ctx_, size_t size_)
+{
+    if (!ctx_ || !(static_cast<zmq::ctx_t *> (ctx_))->check_tag ()) {
+        errno = EFAULT;
+        return -1;
+    }
+    return (reinterpret_cast<zmq::msg_t *> (msg_))
+      ->init_size (size_,
+                   (static_cast<zmq::ctx_t *> (ctx_))->get_msg_allocator ());
+}
+
 int zmq_msg_init_data (
   zmq_msg_t *msg_, void *data_, size_t size_, zmq_free_fn *ffn_, void *hint_)
 {
@@ -622,6 +634,24 @@ int zmq_msg_recv (zmq_msg_t *msg_, void *s_, int flags_)
     return s_recvmsg (s, msg_, flags_);
 }
 
+int zmq_send_batch (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_)
+{
+    zmq::socket_base_t *s = as_socket_base_t (s_);
+    if (!s)
+        return -1;
+    return s->send_batch (reinterpret_cast<zmq::msg_t *> (msgs_), count_,
+                          flags_);
+}
+
+int zmq_recv_batch (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_)
+{
+    zmq::socket_base_t *s = as_socket_base_t (s_);
+    if (!s)
+        return -1;
+    return s->recv_batch (reinterpret_cast<zmq::msg_t *> (msgs_), count_,
+                          flags_);
+}
+
 int zmq_msg_close (zmq_msg_t *msg_)
 {
     return (reinterpret_cast<zmq::msg_t *> (msg_))->close ();
@@ -678,11 +708,24 @@ int zmq_msg_get (const zmq_msg_t *msg_, int property_)
     }
 }
 
-int zmq_msg_set (zmq_msg_t *, int, int)
+int zmq_msg_set (zmq_msg_t *msg_, int property_, int optval_)
 {
-    //  No properties supported at present
-    errno = EINVAL;
-    return -1;
+    switch (property_) {
+#ifdef ZMQ_BUILD_DRAFT_API
+        //  Marks the messages of a batch that are followed by more parts.
+        case ZMQ_MORE:
+            if (optval_)
+                ((zmq::msg_t *) msg_)->set_flags (zmq::msg_t::more);
+            else
+                ((zmq::msg_t *) msg_)->reset_flags (zmq::msg_t::more);
+            return 0;
+#endif
+        default:
+            LIBZMQ_UNUSED (msg_);
+            LIBZMQ_UNUSED (optval_);
+            errno = EINVAL;
+            return -1;
+    }
 }
 
 int zmq_msg_set_routing_id (zmq_msg_t *msg_, uint32_t routing_id_)
@@ -1751,6 +1794,26 @@ int zmq_proxy_steerable (void *frontend_,
     return -1;
 }
 
+int zmq_proxy_detached (void *frontend_,
+                        void *backend_,
+                        void *capture_,
+                        void *control_)
+{
+    zmq::socket_base_t *frontend = as_socket_base_t (frontend_);
+    if (!frontend)
+        return -1;
+    zmq::socket_base_t *backend = as_socket_base_t (backend_);
+    if (!backend)
+        return -1;
+    zmq::socket_base_t *capture = NULL;
+    if (capture_ && !(capture = as_socket_base_t (capture_)))
+        return -1;
+    zmq::socket_base_t *control = NULL;
+    if (control_ && !(control = as_socket_base_t (control_)))
+        return -1;
+    return zmq::proxy_detached (frontend, backend, capture, control);
+}
+
 //  The deprecated device functionality
 
 int zmq_device (int /* type */, void *frontend_, void *backend_)
@@ -1767,6 +1830,10 @@ int zmq_has (const char *capability_)
     if (strcmp (capability_, zmq::protocol_name::ipc) == 0)
         return true;
 #endif
+#if defined(ZMQ_HAVE_SHM)
+    if (strcmp (capability_, zmq::protocol_name::shm) == 0)
+        return true;
+#endif
 #if defined(ZMQ_HAVE_OPENPGM)
     if (strcmp (capability_, zmq::protocol_name::pgm) == 0)
         return true;
@@ -1814,3 +1881,14 @@ int zmq_socket_monitor_pipes_stats (void *s_)
         return -1;
     return s->query_pipes_stats ();
 }
+
+int zmq_socket_stats (void *s_,
+                      zmq_socket_stats_t *stats_,
+                      zmq_pipe_stats_t *pipes_,
+                      size_t *pipe_count_)
+{
+    zmq::socket_base_t *s = as_socket_base_t (s_);
+    if (!s)
+        return -1;
+    return s->get_stats (stats_, pipes_, pipe_count_);
+}
@@ -54,6 +54,16 @@
 #define ZMQ_NORM_NUM_PARITY 122
 #define ZMQ_NORM_NUM_AUTOPARITY 123
 #define ZMQ_NORM_PUSH 124
+#define ZMQ_OUT_IOV_THRESHOLD 125
+#define ZMQ_ZEROCOPY_THRESHOLD 126
+#define ZMQ_UDP_BATCH_SIZE 127
+#define ZMQ_SPIN_TIME 128
+#define ZMQ_SPIN_ADAPTIVE 129
+#define ZMQ_CORK_DELAY 130
+#define ZMQ_CORK_SIZE 131
+#define ZMQ_MEMFD_THRESHOLD 132
+#define ZMQ_REBALANCE_IVL 133
+#define ZMQ_SHM_SPIN 134
 
 /*  DRAFT ZMQ_NORM_MODE options                                               */
 #define ZMQ_NORM_FIXED 0
@@ -69,6 +79,28 @@
 
 /*  DRAFT Context options                                                     */
 #define ZMQ_ZERO_COPY_RECV 10
+#define ZMQ_MSG_ALLOCATOR 11
+#define ZMQ_MSG_POOL 12
+#define ZMQ_DNS_CACHE_TTL 13
+#define ZMQ_DNS_NEGATIVE_TTL 14
+#define ZMQ_CRYPTO_THREADS 15
+#define ZMQ_IO_THREAD_AFFINITY_CPU_ADD 16
+#define ZMQ_IO_THREAD_AFFINITY_CPU_REMOVE 17
+
+/*  DRAFT I/O thread and CPU, see ZMQ_IO_THREAD_AFFINITY_CPU_ADD              */
+typedef struct zmq_io_thread_cpu_t
+{
+    int io_thread;
+    int cpu;
+} zmq_io_thread_cpu_t;
+
+/*  DRAFT Message allocator hooks, see ZMQ_MSG_ALLOCATOR                      */
+typedef struct zmq_msg_allocator_t
+{
+    void *(*allocate_fn) (size_t size_, void *hint_);
+    void (*deallocate_fn) (void *data_, void *hint_);
+    void *hint;
+} zmq_msg_allocator_t;
 
 /*  DRAFT Context methods.                                                    */
 int zmq_ctx_set_ext (void *context_,
@@ -83,6 +115,8 @@ int zmq_ctx_get_ext (void *context_,
 /*  DRAFT Socket methods.                                                     */
 int zmq_join (void *s_, const char *group_);
 int zmq_leave (void *s_, const char *group_);
+int zmq_send_batch (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_);
+int zmq_recv_batch (void *s_, zmq_msg_t *msgs_, size_t count_, int flags_);
 
 /*  DRAFT Msg methods.                                                        */
 int zmq_msg_set_routing_id (zmq_msg_t *msg_, uint32_t routing_id_);
@@ -90,6 +124,7 @@ uint32_t zmq_msg_routing_id (zmq_msg_t *msg_);
 int zmq_msg_set_group (zmq_msg_t *msg_, const char *group_);
 const char *zmq_msg_group (zmq_msg_t *msg_);
 int zmq_msg_init_buffer (zmq_msg_t *msg_, const void *buf_, size_t size_);
+int zmq_msg_init_ctx_size (zmq_msg_t *msg_, void *context_, size_t size_);
 
 /*  DRAFT Msg property names.                                                 */
 #define ZMQ_MSG_PROPERTY_ROUTING_ID "Routing-Id"
@@ -159,6 +194,41 @@ int zmq_socket_monitor_versioned (
   void *s_, const char *addr_, uint64_t events_, int event_version_, int type_);
 int zmq_socket_monitor_pipes_stats (void *s_);
 
+/*  DRAFT Socket statistics                                                   */
+#define ZMQ_STATS_ENDPOINT_MAX 256
+
+typedef struct zmq_socket_stats_t
+{
+    uint64_t msgs_in;
+    uint64_t bytes_in;
+    uint64_t msgs_out;
+    uint64_t bytes_out;
+    uint64_t queued_in;
+    uint64_t queued_out;
+    uint64_t hwm_hits;
+    uint64_t drops;
+    uint64_t engine_reads;
+    uint64_t engine_writes;
+} zmq_socket_stats_t;
+
+typedef struct zmq_pipe_stats_t
+{
+    char local_endpoint[ZMQ_STATS_ENDPOINT_MAX];
+    char remote_endpoint[ZMQ_STATS_ENDPOINT_MAX];
+    zmq_socket_stats_t stats;
+} zmq_pipe_stats_t;
+
+int zmq_socket_stats (void *socket_,
+                      zmq_socket_stats_t *stats_,
+                      zmq_pipe_stats_t *pipes_,
+                      size_t *pipe_count_);
+
+/*  DRAFT Message proxying                                                    */
+int zmq_proxy_detached (void *frontend_,
+                        void *backend_,
+                        void *capture_,
+                        void *control_);
+
 #if !defined _WIN32
 int zmq_ppoll (zmq_pollitem_t *items_,
                int nitems_,
@@ -308,8 +308,9 @@ bool zmq::zmtp_engine_t::handshake_v2_0 ()
     _encoder = new (std::nothrow) v2_encoder_t (_options.out_batch_size);
     alloc_assert (_encoder);
 
-    _decoder = new (std::nothrow) v2_decoder_t (
-      _options.in_batch_size, _options.maxmsgsize, _options.zero_copy);
+    _decoder = new (std::nothrow)
+      v2_decoder_t (_options.in_batch_size, _options.maxmsgsize,
+                    _options.zero_copy, _options.msg_allocator);
     alloc_assert (_decoder);
 
     return true;
@@ -382,8 +383,9 @@ bool zmq::zmtp_engine_t::handshake_v3_0 ()
     _encoder = new (std::nothrow) v2_encoder_t (_options.out_batch_size);
     alloc_assert (_encoder);
 
-    _decoder = new (std::nothrow) v2_decoder_t (
-      _options.in_batch_size, _options.maxmsgsize, _options.zero_copy);
+    _decoder = new (std::nothrow)
+      v2_decoder_t (_options.in_batch_size, _options.maxmsgsize,
+                    _options.zero_copy, _options.msg_allocator);
     alloc_assert (_decoder);
 
     return zmq::zmtp_engine_t::handshake_v3_x (true);
@@ -394,8 +396,9 @@ bool zmq::zmtp_engine_t::handshake_v3_1 ()
     _encoder = new (std::nothrow) v3_1_encoder_t (_options.out_batch_size);
     alloc_assert (_encoder);
 
-    _decoder = new (std::nothrow) v2_decoder_t (
-      _options.in_batch_size, _options.maxmsgsize, _options.zero_copy);
+    _decoder = new (std::nothrow)
+      v2_decoder_t (_options.in_batch_size, _options.maxmsgsize,
+                    _options.zero_copy, _options.msg_allocator);
     alloc_assert (_decoder);
 
     return zmq::zmtp_engine_t::handshake_v3_x (false);
@@ -33,7 +33,7 @@ class mechanism_t;
 //  This engine handles any socket with SOCK_STREAM semantics,
 //  e.g. TCP socket or an UNIX domain socket.
 
-class zmtp_engine_t ZMQ_FINAL : public stream_engine_base_t
+class zmtp_engine_t : public stream_engine_base_t
 {
   public:
     zmtp_engine_t (fd_t fd_,
@@ -0,0 +1,220 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+#define BATCH_SIZE 16
+
+static void init_msgs (zmq_msg_t *msgs_, size_t count_)
+{
+    for (size_t i = 0; i < count_; i++)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msgs_[i]));
+}
+
+static void close_msgs (zmq_msg_t *msgs_, size_t count_)
+{
+    for (size_t i = 0; i < count_; i++)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msgs_[i]));
+}
+
+static void init_string (zmq_msg_t *msg_, const char *str_, int more_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_msg_init_buffer (msg_, str_, strlen (str_)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_set (msg_, ZMQ_MORE, more_));
+}
+
+static void assert_string (zmq_msg_t *msg_, const char *str_, int more_)
+{
+    TEST_ASSERT_EQUAL_UINT (strlen (str_), zmq_msg_size (msg_));
+    TEST_ASSERT_EQUAL_MEMORY (str_, zmq_msg_data (msg_), strlen (str_));
+    TEST_ASSERT_EQUAL_INT (more_, zmq_msg_more (msg_));
+}
+
+//  Receives exactly count_ message parts, in as many batches as it takes.
+static void recv_all (void *socket_, zmq_msg_t *msgs_, int count_)
+{
+    int received = 0;
+    while (received < count_)
+        received += TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_recv_batch (socket_, msgs_ + received, count_ - received, 0));
+}
+
+void test_invalid ()
+{
+    zmq_msg_t msgs[1];
+    init_msgs (msgs, 1);
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSOCK, zmq_send_batch (NULL, msgs, 1, 0));
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSOCK, zmq_recv_batch (NULL, msgs, 1, 0));
+
+    void *pair = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSUP, zmq_send_batch (pair, msgs, 1, 0));
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSUP,
+                               zmq_recv_batch (pair, msgs, 1, ZMQ_DONTWAIT));
+    TEST_ASSERT_FAILURE_ERRNO (EFAULT, zmq_send_batch (pair, NULL, 1, 0));
+    TEST_ASSERT_EQUAL_INT (0, zmq_send_batch (pair, msgs, 0, 0));
+    test_context_socket_close (pair);
+
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_recv_batch (pull, msgs, 1, ZMQ_DONTWAIT));
+    int timeout = 50;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVTIMEO, &timeout, sizeof (timeout)));
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_recv_batch (pull, msgs, 1, 0));
+    test_context_socket_close (pull);
+
+    close_msgs (msgs, 1);
+}
+
+void test_push_pull ()
+{
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://batch"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://batch"));
+
+    zmq_msg_t msgs[BATCH_SIZE];
+    char str[16];
+    for (int i = 0; i < 10; i++) {
+        sprintf (str, "msg %d", i);
+        init_string (&msgs[i], str, 0);
+    }
+    TEST_ASSERT_EQUAL_INT (10, zmq_send_batch (push, msgs, 10, 0));
+    //  Sent messages are left empty.
+    TEST_ASSERT_EQUAL_UINT (0, zmq_msg_size (&msgs[0]));
+    close_msgs (msgs, 10);
+
+    //  The whole batch is available at once.
+    init_msgs (msgs, BATCH_SIZE);
+    TEST_ASSERT_EQUAL_INT (10, zmq_recv_batch (pull, msgs, BATCH_SIZE, 0));
+    for (int i = 0; i < 10; i++) {
+        sprintf (str, "msg %d", i);
+        assert_string (&msgs[i], str, 0);
+    }
+    close_msgs (msgs, BATCH_SIZE);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_partial_send ()
+{
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *pull = test_context_socket (ZMQ_PULL);
+    int hwm = 2;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_SNDHWM, &hwm, sizeof (hwm)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVHWM, &hwm, sizeof (hwm)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://batch"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://batch"));
+
+    //  Over inproc, the high water marks of both sides add up.
+    zmq_msg_t msgs[BATCH_SIZE];
+    for (int i = 0; i < 6; i++)
+        init_string (&msgs[i], "x", 0);
+    TEST_ASSERT_EQUAL_INT (4, zmq_send_batch (push, msgs, 6, ZMQ_DONTWAIT));
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_send_batch (push, msgs + 4, 2, ZMQ_DONTWAIT));
+
+    //  The messages sent were flushed to the peer.
+    zmq_msg_t received[BATCH_SIZE];
+    init_msgs (received, BATCH_SIZE);
+    recv_all (pull, received, 4);
+
+    //  Now that there is room again, a blocking send goes through.
+    TEST_ASSERT_EQUAL_INT (2, zmq_send_batch (push, msgs + 4, 2, 0));
+    recv_all (pull, received, 2);
+    close_msgs (received, BATCH_SIZE);
+    close_msgs (msgs, 6);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_pub_sub ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    void *pub = test_context_socket (ZMQ_PUB);
+    void *sub = test_context_socket (ZMQ_SUB);
+    bind_loopback_ipv4 (pub, endpoint, sizeof (endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sub, ZMQ_SUBSCRIBE, "A", 1));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sub, endpoint));
+    msleep (SETTLE_TIME);
+
+    //  Multi-part messages are delimited by their more flags.
+    zmq_msg_t msgs[BATCH_SIZE];
+    init_string (&msgs[0], "A", 1);
+    init_string (&msgs[1], "first", 0);
+    init_string (&msgs[2], "B", 1);
+    init_string (&msgs[3], "filtered", 0);
+    init_string (&msgs[4], "A", 1);
+    init_string (&msgs[5], "second", 0);
+    TEST_ASSERT_EQUAL_INT (6, zmq_send_batch (pub, msgs, 6, 0));
+    close_msgs (msgs, 6);
+
+    init_msgs (msgs, BATCH_SIZE);
+    recv_all (sub, msgs, 4);
+    assert_string (&msgs[0], "A", 1);
+    assert_string (&msgs[1], "first", 0);
+    assert_string (&msgs[2], "A", 1);
+    assert_string (&msgs[3], "second", 0);
+    close_msgs (msgs, BATCH_SIZE);
+
+    test_context_socket_close (pub);
+    test_context_socket_close (sub);
+}
+
+void test_router_dealer ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    void *router = test_context_socket (ZMQ_ROUTER);
+    void *dealer = test_context_socket (ZMQ_DEALER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (dealer, ZMQ_ROUTING_ID, "D", 1));
+    bind_loopback_ipv4 (router, endpoint, sizeof (endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (dealer, endpoint));
+
+    zmq_msg_t msgs[BATCH_SIZE];
+    init_string (&msgs[0], "one", 0);
+    init_string (&msgs[1], "two", 0);
+    TEST_ASSERT_EQUAL_INT (2, zmq_send_batch (dealer, msgs, 2, 0));
+    close_msgs (msgs, 2);
+
+    //  The router prefixes each message with the routing id of the peer,
+    //  and the batch can be sent back as received.
+    init_msgs (msgs, BATCH_SIZE);
+    recv_all (router, msgs, 4);
+    assert_string (&msgs[0], "D", 1);
+    assert_string (&msgs[1], "one", 0);
+    assert_string (&msgs[2], "D", 1);
+    assert_string (&msgs[3], "two", 0);
+    TEST_ASSERT_EQUAL_INT (4, zmq_send_batch (router, msgs, 4, 0));
+    close_msgs (msgs, BATCH_SIZE);
+
+    init_msgs (msgs, BATCH_SIZE);
+    recv_all (dealer, msgs, 2);
+    assert_string (&msgs[0], "one", 0);
+    assert_string (&msgs[1], "two", 0);
+    close_msgs (msgs, BATCH_SIZE);
+
+    test_context_socket_close (router);
+    test_context_socket_close (dealer);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_invalid);
+    RUN_TEST (test_push_pull);
+    RUN_TEST (test_partial_send);
+    RUN_TEST (test_pub_sub);
+    RUN_TEST (test_router_dealer);
+    return UNITY_END ();
+}
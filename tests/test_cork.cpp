@@ -0,0 +1,223 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_PUSH);
+
+    int value;
+    size_t size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_CORK_DELAY, &value, &size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_CORK_SIZE, &value, &size));
+    TEST_ASSERT_EQUAL_INT (8192, value);
+
+    value = 500;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket, ZMQ_CORK_DELAY, &value, sizeof (value)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_CORK_DELAY, &value, &size));
+    TEST_ASSERT_EQUAL_INT (500, value);
+
+    value = 1400;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket, ZMQ_CORK_SIZE, &value, sizeof (value)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_CORK_SIZE, &value, &size));
+    TEST_ASSERT_EQUAL_INT (1400, value);
+
+    value = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (socket, ZMQ_CORK_DELAY, &value, sizeof (value)));
+    value = 0;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (socket, ZMQ_CORK_SIZE, &value, sizeof (value)));
+
+    test_context_socket_close (socket);
+}
+
+//  Connects a PUSH socket holding back writes to a PULL socket.
+static void setup (void **push_,
+                   void **pull_,
+                   int delay_,
+                   int size_,
+                   int threshold_)
+{
+    *pull_ = test_context_socket (ZMQ_PULL);
+    *push_ = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (*push_, ZMQ_CORK_DELAY, &delay_, sizeof (delay_)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (*push_, ZMQ_CORK_SIZE, &size_, sizeof (size_)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      *push_, ZMQ_OUT_IOV_THRESHOLD, &threshold_, sizeof (threshold_)));
+
+    const int timeout = 2000;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (*pull_, ZMQ_RCVTIMEO, &timeout, sizeof (timeout)));
+
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (*pull_, endpoint, sizeof (endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (*push_, endpoint));
+}
+
+static void held_back_until_delay (int threshold_)
+{
+    void *push;
+    void *pull;
+    setup (&push, &pull, 300000, 8192, threshold_);
+
+    //  Make sure the connection is up.
+    send_string_expect_success (push, "hello", 0);
+    recv_string_expect_success (pull, "hello", 0);
+
+    send_string_expect_success (push, "first", ZMQ_SNDMORE);
+    send_string_expect_success (push, "second", 0);
+
+    //  Nothing is written before the delay has passed.
+    zmq_pollitem_t item = {pull, 0, ZMQ_POLLIN, 0};
+    TEST_ASSERT_EQUAL_INT (0, zmq_poll (&item, 1, 100));
+
+    recv_string_expect_success (pull, "first", 0);
+    recv_string_expect_success (pull, "second", 0);
+
+    test_context_socket_close_zero_linger (push);
+    test_context_socket_close (pull);
+}
+
+void test_held_back_until_delay ()
+{
+    held_back_until_delay (-1);
+}
+
+void test_held_back_until_delay_iov ()
+{
+    held_back_until_delay (0);
+}
+
+static void written_at_size (int threshold_)
+{
+    void *push;
+    void *pull;
+
+    //  The delay is far longer than the receive timeout, so the messages
+    //  can only arrive because the batches filled up.
+    setup (&push, &pull, 60000000, 1000, threshold_);
+
+    char buf[200];
+    memset (buf, 'x', sizeof buf);
+    for (int i = 0; i < 10; i++)
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (sizeof buf),
+                               TEST_ASSERT_SUCCESS_ERRNO (
+                                 zmq_send (push, buf, sizeof buf, 0)));
+    for (int i = 0; i < 10; i++)
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (sizeof buf),
+                               TEST_ASSERT_SUCCESS_ERRNO (
+                                 zmq_recv (pull, buf, sizeof buf, 0)));
+
+    test_context_socket_close_zero_linger (push);
+    test_context_socket_close (pull);
+}
+
+void test_written_at_size ()
+{
+    written_at_size (-1);
+}
+
+void test_written_at_size_iov ()
+{
+    written_at_size (0);
+}
+
+void test_written_on_close ()
+{
+    void *push;
+    void *pull;
+    setup (&push, &pull, 60000000, 8192, 1024);
+
+    send_string_expect_success (push, "last words", 0);
+    test_context_socket_close (push);
+
+    recv_string_expect_success (pull, "last words", 0);
+    test_context_socket_close (pull);
+}
+
+static void set_int (void *socket_, int option_, int value_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket_, option_, &value_, sizeof (value_)));
+}
+
+static void written_on_close_in_parts (int threshold_)
+{
+    //  The batch held back is far larger than what the socket buffers
+    //  take, and the PULL socket reads a message at a time, so that it is
+    //  written in parts after the PUSH socket has been closed.
+    void *pull = test_context_socket (ZMQ_PULL);
+    void *push = test_context_socket (ZMQ_PUSH);
+    set_int (push, ZMQ_OUT_BATCH_SIZE, 1 << 20);
+    set_int (push, ZMQ_CORK_DELAY, 60000000);
+    set_int (push, ZMQ_CORK_SIZE, 1 << 20);
+    set_int (push, ZMQ_OUT_IOV_THRESHOLD, threshold_);
+    set_int (push, ZMQ_SNDBUF, 4096);
+    set_int (pull, ZMQ_RCVBUF, 4096);
+    set_int (pull, ZMQ_RCVHWM, 1);
+    set_int (pull, ZMQ_RCVTIMEO, 2000);
+
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof (endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    const int count = 20;
+    char buf[8192];
+    for (int i = 0; i < count; i++) {
+        memset (buf, 'a' + i, sizeof buf);
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (sizeof buf),
+                               TEST_ASSERT_SUCCESS_ERRNO (
+                                 zmq_send (push, buf, sizeof buf, 0)));
+    }
+    test_context_socket_close (push);
+
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_INT (static_cast<int> (sizeof buf),
+                               TEST_ASSERT_SUCCESS_ERRNO (
+                                 zmq_recv (pull, buf, sizeof buf, 0)));
+        TEST_ASSERT_EQUAL_INT ('a' + i, buf[0]);
+        TEST_ASSERT_EQUAL_INT ('a' + i, buf[sizeof buf - 1]);
+    }
+    test_context_socket_close (pull);
+}
+
+void test_written_on_close_in_parts ()
+{
+    written_on_close_in_parts (-1);
+}
+
+void test_written_on_close_in_parts_iov ()
+{
+    written_on_close_in_parts (0);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_held_back_until_delay);
+    RUN_TEST (test_held_back_until_delay_iov);
+    RUN_TEST (test_written_at_size);
+    RUN_TEST (test_written_at_size_iov);
+    RUN_TEST (test_written_on_close);
+    RUN_TEST (test_written_on_close_in_parts);
+    RUN_TEST (test_written_on_close_in_parts_iov);
+    return UNITY_END ();
+}
@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
 #include <limits>
+#include <string.h>
 #include "testutil.hpp"
 #include "testutil_unity.hpp"
 
@@ -178,6 +179,128 @@ void test_ctx_zero_copy ()
 #endif
 }
 
+void test_ctx_dns_cache ()
+{
+#ifdef ZMQ_DNS_CACHE_TTL
+    TEST_ASSERT_EQUAL_INT (
+      10000, zmq_ctx_get (get_test_context (), ZMQ_DNS_CACHE_TTL));
+    TEST_ASSERT_EQUAL_INT (
+      1000, zmq_ctx_get (get_test_context (), ZMQ_DNS_NEGATIVE_TTL));
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_ctx_set (get_test_context (), ZMQ_DNS_CACHE_TTL, -1));
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_DNS_CACHE_TTL, 60000));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_DNS_NEGATIVE_TTL, 0));
+    TEST_ASSERT_EQUAL_INT (
+      60000, zmq_ctx_get (get_test_context (), ZMQ_DNS_CACHE_TTL));
+    TEST_ASSERT_EQUAL_INT (
+      0, zmq_ctx_get (get_test_context (), ZMQ_DNS_NEGATIVE_TTL));
+
+    //  Host names are resolved by the resolver of the context, the second
+    //  connecter finds the address cached.
+    void *pull = zmq_socket (get_test_context (), ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    char host_endpoint[MAX_SOCKET_STRING];
+    snprintf (host_endpoint, sizeof host_endpoint, "tcp://localhost:%s",
+              strrchr (endpoint, ':') + 1);
+
+    void *push[2];
+    for (int i = 0; i < 2; i++) {
+        push[i] = zmq_socket (get_test_context (), ZMQ_PUSH);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push[i], host_endpoint));
+        send_string_expect_success (push[i], "abcd", 0);
+        recv_string_expect_success (pull, "abcd", 0);
+    }
+
+    for (int i = 0; i < 2; i++)
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_close (push[i]));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pull));
+#endif
+}
+
+void test_ctx_crypto_threads ()
+{
+#ifdef ZMQ_CRYPTO_THREADS
+    TEST_ASSERT_EQUAL_INT (
+      0, zmq_ctx_get (get_test_context (), ZMQ_CRYPTO_THREADS));
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_ctx_set (get_test_context (), ZMQ_CRYPTO_THREADS, -1));
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_CRYPTO_THREADS, 2));
+    TEST_ASSERT_EQUAL_INT (
+      2, zmq_ctx_get (get_test_context (), ZMQ_CRYPTO_THREADS));
+
+    //  Mechanisms without expensive steps leave the crypto threads alone.
+    void *pull = zmq_socket (get_test_context (), ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *push = zmq_socket (get_test_context (), ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+    send_string_expect_success (push, "abcd", 0);
+    recv_string_expect_success (pull, "abcd", 0);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (push));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pull));
+#endif
+}
+
+void test_ctx_io_thread_affinity ()
+{
+#ifdef ZMQ_IO_THREAD_AFFINITY_CPU_ADD
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_IO_THREADS, 2));
+
+    //  Both I/O threads on the first CPU, which every system has.
+    zmq_io_thread_cpu_t thread_cpu = {0, 0};
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set_ext (get_test_context (), ZMQ_IO_THREAD_AFFINITY_CPU_ADD,
+                       &thread_cpu, sizeof (thread_cpu)));
+    thread_cpu.io_thread = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set_ext (get_test_context (), ZMQ_IO_THREAD_AFFINITY_CPU_ADD,
+                       &thread_cpu, sizeof (thread_cpu)));
+
+    //  CPUs can be removed again, but only those that were added.
+    thread_cpu.cpu = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set_ext (get_test_context (), ZMQ_IO_THREAD_AFFINITY_CPU_ADD,
+                       &thread_cpu, sizeof (thread_cpu)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set_ext (get_test_context (), ZMQ_IO_THREAD_AFFINITY_CPU_REMOVE,
+                       &thread_cpu, sizeof (thread_cpu)));
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_ctx_set_ext (get_test_context (), ZMQ_IO_THREAD_AFFINITY_CPU_REMOVE,
+                       &thread_cpu, sizeof (thread_cpu)));
+
+    thread_cpu.io_thread = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_ctx_set_ext (get_test_context (), ZMQ_IO_THREAD_AFFINITY_CPU_ADD,
+                       &thread_cpu, sizeof (thread_cpu)));
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_ctx_set_ext (get_test_context (), ZMQ_IO_THREAD_AFFINITY_CPU_ADD,
+                       &thread_cpu, sizeof (int)));
+
+    //  The I/O threads start with the first socket, and carry messages.
+    void *pull = zmq_socket (get_test_context (), ZMQ_PULL);
+    char endpoint[MAX_SOCKET_STRING];
+    bind_loopback_ipv4 (pull, endpoint, sizeof endpoint);
+    void *push = zmq_socket (get_test_context (), ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+    send_string_expect_success (push, "abcd", 0);
+    recv_string_expect_success (pull, "abcd", 0);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (push));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pull));
+#endif
+}
+
 void test_ctx_option_max_sockets ()
 {
     TEST_ASSERT_EQUAL_INT (ZMQ_MAX_SOCKETS_DFLT,
@@ -277,6 +400,9 @@ int main (void)
     RUN_TEST (test_ctx_option_ipv6_set);
     RUN_TEST (test_ctx_thread_opts);
     RUN_TEST (test_ctx_zero_copy);
+    RUN_TEST (test_ctx_dns_cache);
+    RUN_TEST (test_ctx_crypto_threads);
+    RUN_TEST (test_ctx_io_thread_affinity);
     RUN_TEST (test_ctx_option_blocky);
     RUN_TEST (test_ctx_option_invalid);
     return UNITY_END ();
@@ -0,0 +1,203 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_PAIR);
+
+    int value;
+    size_t size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_MEMFD_THRESHOLD, &value, &size));
+    TEST_ASSERT_EQUAL_INT (-1, value);
+
+    value = 65536;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket, ZMQ_MEMFD_THRESHOLD, &value, sizeof (value)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_MEMFD_THRESHOLD, &value, &size));
+    TEST_ASSERT_EQUAL_INT (65536, value);
+
+    value = -2;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (socket, ZMQ_MEMFD_THRESHOLD, &value, sizeof (value)));
+
+    test_context_socket_close (socket);
+}
+
+static void set_threshold (void *socket_, int threshold_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      socket_, ZMQ_MEMFD_THRESHOLD, &threshold_, sizeof (threshold_)));
+}
+
+static void bind_and_connect (void *sb_, void *sc_, const char *address_)
+{
+    char endpoint[MAX_SOCKET_STRING];
+    size_t len = sizeof endpoint;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (sb_, address_));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (sb_, ZMQ_LAST_ENDPOINT, endpoint, &len));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc_, endpoint));
+}
+
+static void send_msg (void *socket_, size_t size_, int seed_, int flags_)
+{
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, size_));
+    unsigned char *data = static_cast<unsigned char *> (zmq_msg_data (&msg));
+    for (size_t i = 0; i < size_; ++i)
+        data[i] = static_cast<unsigned char> (i * 7 + seed_);
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (size_),
+                           zmq_msg_send (&msg, socket_, flags_));
+}
+
+//  Returns true if the process maps a memfd made for a message.
+static bool maps_memfd ()
+{
+#if defined ZMQ_HAVE_LINUX
+    FILE *maps = fopen ("/proc/self/maps", "r");
+    TEST_ASSERT_NOT_NULL (maps);
+    char line[512];
+    bool found = false;
+    while (!found && fgets (line, sizeof line, maps))
+        found = strstr (line, "memfd:zmq-msg") != NULL;
+    fclose (maps);
+    return found;
+#else
+    return false;
+#endif
+}
+
+//  Receives a frame filled by send_msg. If mapped_ is 0 or 1, also checks
+//  whether a memfd is mapped while the frame is held.
+static void
+recv_msg (void *socket_, size_t size_, int seed_, bool more_, int mapped_)
+{
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (size_),
+                           zmq_msg_recv (&msg, socket_, 0));
+    unsigned char *data = static_cast<unsigned char *> (zmq_msg_data (&msg));
+    for (size_t i = 0; i < size_; ++i)
+        if (data[i] != static_cast<unsigned char> (i * 7 + seed_))
+            TEST_FAIL_MESSAGE ("unexpected message contents");
+    TEST_ASSERT_EQUAL_INT (more_, zmq_msg_more (&msg));
+    if (mapped_ >= 0) {
+        TEST_ASSERT_EQUAL (mapped_ != 0, maps_memfd ());
+    }
+
+    //  The data belongs to the receiver, which may change it.
+    if (size_ > 0)
+        data[size_ - 1] = 0;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+}
+
+static bool memfd_available ()
+{
+#if defined ZMQ_HAVE_MEMFD
+    return true;
+#else
+    return false;
+#endif
+}
+
+void test_large_frames ()
+{
+    void *sb = test_context_socket (ZMQ_PAIR);
+    void *sc = test_context_socket (ZMQ_PAIR);
+    set_threshold (sb, 4096);
+    set_threshold (sc, 4096);
+    bind_and_connect (sb, sc, "ipc://*");
+
+    const int mapped = memfd_available () ? 1 : -1;
+    send_msg (sc, 10, 1, ZMQ_SNDMORE);
+    send_msg (sc, 1024 * 1024 + 3, 2, ZMQ_SNDMORE);
+    send_msg (sc, 4096, 3, ZMQ_SNDMORE);
+    send_msg (sc, 4095, 4, 0);
+
+    recv_msg (sb, 10, 1, true, -1);
+    recv_msg (sb, 1024 * 1024 + 3, 2, true, mapped);
+    recv_msg (sb, 4096, 3, true, mapped);
+    recv_msg (sb, 4095, 4, false, 0);
+
+    //  And the other way.
+    send_msg (sb, 100000, 5, 0);
+    recv_msg (sc, 100000, 5, false, mapped);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+void test_many_frames ()
+{
+    void *sb = test_context_socket (ZMQ_PULL);
+    void *sc = test_context_socket (ZMQ_PUSH);
+    set_threshold (sb, 0);
+    set_threshold (sc, 0);
+    bind_and_connect (sb, sc, "ipc://*");
+
+    //  More than are passed along with a single write.
+    const int count = 100;
+    for (int i = 0; i < count; i++)
+        send_msg (sc, 1000 + i, i, 0);
+    for (int i = 0; i < count; i++)
+        recv_msg (sb, 1000 + i, i, false, -1);
+
+    //  Empty frames are not worth a memfd.
+    send_msg (sc, 0, 0, 0);
+    recv_msg (sb, 0, 0, false, 0);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+void test_receiver_not_accepting ()
+{
+    void *sb = test_context_socket (ZMQ_PAIR);
+    void *sc = test_context_socket (ZMQ_PAIR);
+    set_threshold (sc, 4096);
+    bind_and_connect (sb, sc, "ipc://*");
+
+    send_msg (sc, 1024 * 1024, 1, 0);
+    recv_msg (sb, 1024 * 1024, 1, false, 0);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+void test_tcp_unaffected ()
+{
+    void *sb = test_context_socket (ZMQ_PAIR);
+    void *sc = test_context_socket (ZMQ_PAIR);
+    set_threshold (sb, 4096);
+    set_threshold (sc, 4096);
+    bind_and_connect (sb, sc, "tcp://127.0.0.1:*");
+
+    send_msg (sc, 1024 * 1024, 1, 0);
+    recv_msg (sb, 1024 * 1024, 1, false, 0);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_large_frames);
+    RUN_TEST (test_many_frames);
+    RUN_TEST (test_receiver_not_accepting);
+    RUN_TEST (test_tcp_unaffected);
+    return UNITY_END ();
+}
@@ -0,0 +1,209 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+void setUp ()
+{
+}
+
+void tearDown ()
+{
+}
+
+struct counters_t
+{
+    void *allocations;
+    void *deallocations;
+};
+
+static void *counting_allocate (size_t size_, void *hint_)
+{
+    zmq_atomic_counter_inc (static_cast<counters_t *> (hint_)->allocations);
+    return malloc (size_);
+}
+
+static void counting_deallocate (void *data_, void *hint_)
+{
+    zmq_atomic_counter_inc (static_cast<counters_t *> (hint_)->deallocations);
+    free (data_);
+}
+
+static void *new_counting_ctx (counters_t *counters_, int pool_)
+{
+    counters_->allocations = zmq_atomic_counter_new ();
+    counters_->deallocations = zmq_atomic_counter_new ();
+
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+    zmq_msg_allocator_t fns = {counting_allocate, counting_deallocate,
+                               counters_};
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set_ext (ctx, ZMQ_MSG_ALLOCATOR, &fns, sizeof (fns)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (ctx, ZMQ_MSG_POOL, pool_));
+    return ctx;
+}
+
+static void destroy_counters (counters_t *counters_)
+{
+    //  Everything must have been given back once the context is gone.
+    TEST_ASSERT_EQUAL_INT (
+      zmq_atomic_counter_value (counters_->allocations),
+      zmq_atomic_counter_value (counters_->deallocations));
+    zmq_atomic_counter_destroy (&counters_->allocations);
+    zmq_atomic_counter_destroy (&counters_->deallocations);
+}
+
+void test_hooks ()
+{
+    counters_t counters;
+    void *ctx = new_counting_ctx (&counters, 0);
+
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_ctx_size (&msg, ctx, 1000));
+    TEST_ASSERT_EQUAL_INT (1000, zmq_msg_size (&msg));
+    memset (zmq_msg_data (&msg), 'x', 1000);
+    TEST_ASSERT_EQUAL_INT (1, zmq_atomic_counter_value (counters.allocations));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    TEST_ASSERT_EQUAL_INT (1,
+                           zmq_atomic_counter_value (counters.deallocations));
+
+    //  Very small messages are stored inline.
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_ctx_size (&msg, ctx, 8));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    TEST_ASSERT_EQUAL_INT (1, zmq_atomic_counter_value (counters.allocations));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+    destroy_counters (&counters);
+}
+
+void test_pool_recycles ()
+{
+    counters_t counters;
+    void *ctx = new_counting_ctx (&counters, 1);
+
+    for (int i = 0; i < 1000; i++) {
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_ctx_size (&msg, ctx, 200));
+        memset (zmq_msg_data (&msg), i, 200);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    }
+
+    //  A single slab serves all the messages.
+    TEST_ASSERT_EQUAL_INT (1, zmq_atomic_counter_value (counters.allocations));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+    destroy_counters (&counters);
+}
+
+void test_options_fixed_after_use ()
+{
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (ctx, ZMQ_MSG_POOL, 1));
+    TEST_ASSERT_EQUAL_INT (1, zmq_ctx_get (ctx, ZMQ_MSG_POOL));
+
+    //  Both hooks must be supplied.
+    zmq_msg_allocator_t fns = {counting_allocate, NULL, NULL};
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_ctx_set_ext (ctx, ZMQ_MSG_ALLOCATOR, &fns, sizeof (fns)));
+
+    void *socket = zmq_socket (ctx, ZMQ_PAIR);
+    TEST_ASSERT_NOT_NULL (socket);
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL, zmq_ctx_set (ctx, ZMQ_MSG_POOL, 0));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (socket));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+}
+
+static void transfer (void *ctx_, const char *endpoint_)
+{
+    void *pull = zmq_socket (ctx_, ZMQ_PULL);
+    TEST_ASSERT_NOT_NULL (pull);
+    void *push = zmq_socket (ctx_, ZMQ_PUSH);
+    TEST_ASSERT_NOT_NULL (push);
+
+    char endpoint[MAX_SOCKET_STRING];
+    if (strcmp (endpoint_, "tcp") == 0)
+        bind_loopback_ipv4 (pull, endpoint, sizeof (endpoint));
+    else {
+        strcpy (endpoint, endpoint_);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, endpoint));
+    }
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    //  Cover inline, pooled, zero-copy decoded and unpooled sizes.
+    const size_t sizes[] = {10, 200, 3000, 20000, 100000};
+    const int count = sizeof (sizes) / sizeof (sizes[0]);
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < count; i++) {
+            zmq_msg_t msg;
+            TEST_ASSERT_SUCCESS_ERRNO (
+              zmq_msg_init_ctx_size (&msg, ctx_, sizes[i]));
+            memset (zmq_msg_data (&msg), 'a' + i, sizes[i]);
+            TEST_ASSERT_EQUAL_INT (static_cast<int> (sizes[i]),
+                                   zmq_msg_send (&msg, push, 0));
+        }
+        for (int i = 0; i < count; i++) {
+            zmq_msg_t msg;
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+            TEST_ASSERT_EQUAL_INT (static_cast<int> (sizes[i]),
+                                   zmq_msg_recv (&msg, pull, 0));
+            const char *data = static_cast<const char *> (zmq_msg_data (&msg));
+            TEST_ASSERT_EQUAL_INT ('a' + i, data[0]);
+            TEST_ASSERT_EQUAL_INT ('a' + i, data[sizes[i] - 1]);
+            TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+        }
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (push));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_close (pull));
+}
+
+void test_pool_inproc ()
+{
+    counters_t counters;
+    void *ctx = new_counting_ctx (&counters, 1);
+    transfer (ctx, "inproc://msg_allocator");
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+    destroy_counters (&counters);
+}
+
+void test_pool_tcp ()
+{
+    counters_t counters;
+    void *ctx = new_counting_ctx (&counters, 1);
+    transfer (ctx, "tcp");
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+    destroy_counters (&counters);
+}
+
+void test_hooks_tcp ()
+{
+    counters_t counters;
+    void *ctx = new_counting_ctx (&counters, 0);
+    transfer (ctx, "tcp");
+
+    //  Decoder buffers and large messages went through the hooks.
+    TEST_ASSERT_GREATER_THAN_INT (
+      100, zmq_atomic_counter_value (counters.allocations));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+    destroy_counters (&counters);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_hooks);
+    RUN_TEST (test_pool_recycles);
+    RUN_TEST (test_options_fixed_after_use);
+    RUN_TEST (test_pool_inproc);
+    RUN_TEST (test_pool_tcp);
+    RUN_TEST (test_hooks_tcp);
+    return UNITY_END ();
+}
@@ -0,0 +1,163 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+void test_option ()
+{
+    void *socket = test_context_socket (ZMQ_PUSH);
+
+    int value;
+    size_t size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_OUT_IOV_THRESHOLD, &value, &size));
+    TEST_ASSERT_EQUAL_INT (1024, value);
+
+    value = -1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket, ZMQ_OUT_IOV_THRESHOLD, &value, sizeof (value)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_OUT_IOV_THRESHOLD, &value, &size));
+    TEST_ASSERT_EQUAL_INT (-1, value);
+
+    value = -2;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (socket, ZMQ_OUT_IOV_THRESHOLD, &value, sizeof (value)));
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_ZEROCOPY_THRESHOLD, &value, &size));
+    TEST_ASSERT_EQUAL_INT (-1, value);
+    value = 65536;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket, ZMQ_ZEROCOPY_THRESHOLD, &value, sizeof (value)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_ZEROCOPY_THRESHOLD, &value, &size));
+    TEST_ASSERT_EQUAL_INT (65536, value);
+    value = -2;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (socket, ZMQ_ZEROCOPY_THRESHOLD, &value, sizeof (value)));
+
+    test_context_socket_close (socket);
+}
+
+static void send_msg (void *socket_, size_t size_, char fill_, int flags_)
+{
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, size_));
+    memset (zmq_msg_data (&msg), fill_, size_);
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (size_),
+                           zmq_msg_send (&msg, socket_, flags_));
+}
+
+static void recv_msg (void *socket_, size_t size_, char fill_, bool more_)
+{
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (size_),
+                           zmq_msg_recv (&msg, socket_, 0));
+    const char *data = static_cast<const char *> (zmq_msg_data (&msg));
+    for (size_t i = 0; i < size_; i++)
+        if (data[i] != fill_)
+            TEST_FAIL_MESSAGE ("Message corrupted");
+    TEST_ASSERT_EQUAL_INT (more_, zmq_msg_more (&msg));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+}
+
+static void
+transfer (int threshold_, const char *endpoint_, int zerocopy_threshold_ = -1)
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    void *push = test_context_socket (ZMQ_PUSH);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      push, ZMQ_OUT_IOV_THRESHOLD, &threshold_, sizeof (threshold_)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (push, ZMQ_ZEROCOPY_THRESHOLD, &zerocopy_threshold_,
+                      sizeof (zerocopy_threshold_)));
+
+    char endpoint[MAX_SOCKET_STRING];
+    if (strcmp (endpoint_, "tcp") == 0)
+        bind_loopback_ipv4 (pull, endpoint, sizeof (endpoint));
+    else
+        bind_loopback_ipc (pull, endpoint, sizeof (endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    //  Mix inline, short and long frames so that copied and referenced
+    //  chunks alternate within the same write.
+    const size_t sizes[] = {0, 10, 100, 1023, 1024, 5000, 300, 70000, 1};
+    const int count = sizeof (sizes) / sizeof (sizes[0]);
+
+    //  Queue far more than fits into the socket buffers before receiving
+    //  anything, so that writes end up partial.
+    for (int round = 0; round < 40; round++) {
+        for (int i = 0; i < count; i++)
+            send_msg (push, sizes[i], 'a' + i, 0);
+        for (int i = 0; i < count; i++)
+            send_msg (push, sizes[i], 'A' + i, i < count - 1 ? ZMQ_SNDMORE : 0);
+    }
+    for (int round = 0; round < 40; round++) {
+        for (int i = 0; i < count; i++)
+            recv_msg (pull, sizes[i], 'a' + i, false);
+        for (int i = 0; i < count; i++)
+            recv_msg (pull, sizes[i], 'A' + i, i < count - 1);
+    }
+
+    test_context_socket_close_zero_linger (push);
+    test_context_socket_close (pull);
+}
+
+void test_tcp_copy ()
+{
+    transfer (-1, "tcp");
+}
+
+void test_tcp_all_referenced ()
+{
+    transfer (0, "tcp");
+}
+
+void test_tcp_default ()
+{
+    transfer (1024, "tcp");
+}
+
+//  Zero-copy sends need not be supported by the kernel; either way the
+//  data must arrive intact.
+void test_tcp_zerocopy ()
+{
+    transfer (-1, "tcp", 4096);
+}
+
+void test_tcp_zerocopy_all ()
+{
+    transfer (1024, "tcp", 0);
+}
+
+void test_ipc_default ()
+{
+#if defined(ZMQ_HAVE_IPC)
+    transfer (1024, "ipc");
+#else
+    TEST_IGNORE_MESSAGE ("libzmq without IPC, ignoring test");
+#endif
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_option);
+    RUN_TEST (test_tcp_copy);
+    RUN_TEST (test_tcp_all_referenced);
+    RUN_TEST (test_tcp_default);
+    RUN_TEST (test_tcp_zerocopy);
+    RUN_TEST (test_tcp_zerocopy_all);
+    RUN_TEST (test_ipc_default);
+    return UNITY_END ();
+}
@@ -0,0 +1,237 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+//  The proxy takes its sockets over and closes them itself, so they are
+//  not created with test_context_socket.
+static void *proxy_socket (int type_, const char *endpoint_)
+{
+    void *socket = zmq_socket (get_test_context (), type_);
+    TEST_ASSERT_NOT_NULL (socket);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (socket, endpoint_));
+    return socket;
+}
+
+static int rcvmore (void *socket_)
+{
+    int more;
+    size_t more_size = sizeof (more);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket_, ZMQ_RCVMORE, &more, &more_size));
+    return more;
+}
+
+static void send_command (void *control_, const char *command_)
+{
+    send_string_expect_success (control_, command_, 0);
+    recv_string_expect_success (control_, "", 0);
+}
+
+void test_invalid ()
+{
+    void *pull = test_context_socket (ZMQ_PULL);
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *server = test_context_socket (ZMQ_SERVER);
+
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSOCK,
+                               zmq_proxy_detached (NULL, push, NULL, NULL));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_proxy_detached (pull, push, pull, NULL));
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_proxy_detached (pull, push, NULL, push));
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSUP,
+                               zmq_proxy_detached (server, push, NULL, NULL));
+
+    test_context_socket_close (pull);
+    test_context_socket_close (push);
+    test_context_socket_close (server);
+}
+
+void test_forward ()
+{
+    void *frontend = proxy_socket (ZMQ_PULL, "inproc://frontend");
+    void *backend = proxy_socket (ZMQ_PUSH, "inproc://backend");
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_proxy_detached (frontend, backend, NULL, NULL));
+
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://frontend"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (pull, "inproc://backend"));
+
+    for (int i = 0; i < 1000; i++) {
+        send_string_expect_success (push, "multi", ZMQ_SNDMORE);
+        send_string_expect_success (push, "part", 0);
+    }
+    for (int i = 0; i < 1000; i++) {
+        recv_string_expect_success (pull, "multi", 0);
+        TEST_ASSERT_TRUE (rcvmore (pull));
+        recv_string_expect_success (pull, "part", 0);
+        TEST_ASSERT_FALSE (rcvmore (pull));
+    }
+
+    //  Without a control socket, the proxy runs until the context is
+    //  terminated.
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_high_water_mark ()
+{
+    void *frontend = proxy_socket (ZMQ_PULL, "inproc://frontend");
+    void *backend = proxy_socket (ZMQ_PUSH, "inproc://backend");
+    int hwm = 10;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (backend, ZMQ_SNDHWM, &hwm, sizeof (hwm)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_proxy_detached (frontend, backend, NULL, NULL));
+
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVHWM, &hwm, sizeof (hwm)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://frontend"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (pull, "inproc://backend"));
+
+    //  The proxy holds messages back while the backend is full, and goes
+    //  on once the receiver catches up.
+    char buffer[16];
+    for (int i = 0; i < 500; i++) {
+        sprintf (buffer, "%d", i);
+        send_string_expect_success (push, buffer, 0);
+    }
+    msleep (SETTLE_TIME);
+    for (int i = 0; i < 500; i++) {
+        sprintf (buffer, "%d", i);
+        recv_string_expect_success (pull, buffer, 0);
+    }
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_steer ()
+{
+    void *frontend = proxy_socket (ZMQ_PULL, "inproc://frontend");
+    void *backend = proxy_socket (ZMQ_PUSH, "inproc://backend");
+    void *control = proxy_socket (ZMQ_REP, "inproc://control");
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_proxy_detached (frontend, backend, NULL, control));
+
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *pull = test_context_socket (ZMQ_PULL);
+    void *req = test_context_socket (ZMQ_REQ);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://frontend"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (pull, "inproc://backend"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (req, "inproc://control"));
+
+    send_string_expect_success (push, "first", 0);
+    recv_string_expect_success (pull, "first", 0);
+
+    send_command (req, "PAUSE");
+    send_string_expect_success (push, "second", 0);
+    int timeout = 100;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pull, ZMQ_RCVTIMEO, &timeout, sizeof (timeout)));
+    char buffer[16];
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_recv (pull, buffer, sizeof (buffer), 0));
+
+    send_command (req, "RESUME");
+    recv_string_expect_success (pull, "second", 0);
+
+    //  Frontend and backend counters of received and sent message parts
+    //  and bytes.
+    send_string_expect_success (req, "STATISTICS", 0);
+    const uint64_t expected[] = {2, 11, 0, 0, 0, 0, 2, 11};
+    for (size_t i = 0; i < sizeof expected / sizeof expected[0]; i++) {
+        uint64_t value;
+        TEST_ASSERT_EQUAL_INT (
+          sizeof value,
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_recv (req, &value, sizeof value, 0)));
+        TEST_ASSERT_EQUAL_UINT64 (expected[i], value);
+        TEST_ASSERT_EQUAL_INT (i + 1 < sizeof expected / sizeof expected[0],
+                               rcvmore (req));
+    }
+
+    send_command (req, "TERMINATE");
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+    test_context_socket_close (req);
+}
+
+void test_capture ()
+{
+    void *frontend = proxy_socket (ZMQ_PULL, "inproc://frontend");
+    void *backend = proxy_socket (ZMQ_PUSH, "inproc://backend");
+    void *capture = proxy_socket (ZMQ_PUSH, "inproc://capture");
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_proxy_detached (frontend, backend, capture, NULL));
+
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *pull = test_context_socket (ZMQ_PULL);
+    void *captured = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://frontend"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (pull, "inproc://backend"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (captured, "inproc://capture"));
+
+    send_string_expect_success (push, "multi", ZMQ_SNDMORE);
+    send_string_expect_success (push, "part", 0);
+    recv_string_expect_success (pull, "multi", 0);
+    recv_string_expect_success (pull, "part", 0);
+    recv_string_expect_success (captured, "multi", 0);
+    TEST_ASSERT_TRUE (rcvmore (captured));
+    recv_string_expect_success (captured, "part", 0);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+    test_context_socket_close (captured);
+}
+
+void test_router_dealer ()
+{
+    char frontend_endpoint[MAX_SOCKET_STRING];
+    char backend_endpoint[MAX_SOCKET_STRING];
+    void *frontend = zmq_socket (get_test_context (), ZMQ_ROUTER);
+    void *backend = zmq_socket (get_test_context (), ZMQ_DEALER);
+    bind_loopback_ipv4 (frontend, frontend_endpoint,
+                        sizeof (frontend_endpoint));
+    bind_loopback_ipv4 (backend, backend_endpoint, sizeof (backend_endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_proxy_detached (frontend, backend, NULL, NULL));
+
+    void *req = test_context_socket (ZMQ_REQ);
+    void *rep = test_context_socket (ZMQ_REP);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (req, frontend_endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (rep, backend_endpoint));
+
+    for (int i = 0; i < 10; i++) {
+        send_string_expect_success (req, "request", 0);
+        recv_string_expect_success (rep, "request", 0);
+        send_string_expect_success (rep, "reply", 0);
+        recv_string_expect_success (req, "reply", 0);
+    }
+
+    test_context_socket_close (req);
+    test_context_socket_close (rep);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_invalid);
+    RUN_TEST (test_forward);
+    RUN_TEST (test_high_water_mark);
+    RUN_TEST (test_steer);
+    RUN_TEST (test_capture);
+    RUN_TEST (test_router_dealer);
+    return UNITY_END ();
+}
@@ -101,6 +101,37 @@ void test_long_group ()
     test_context_socket_close (radio);
 }
 
+void test_long_group_fan_out ()
+{
+    void *radio = test_context_socket (ZMQ_RADIO);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (radio, "inproc://long-group"));
+
+    //  Copies of a message sent to several dishes share its long group.
+    const char *group = "0123456789ABCDEFGH";
+    void *dishes[2];
+    for (int i = 0; i < 2; i++) {
+        dishes[i] = test_context_socket (ZMQ_DISH);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_join (dishes[i], group));
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_connect (dishes[i], "inproc://long-group"));
+    }
+
+    msleep (SETTLE_TIME);
+
+    const char *long_body =
+      "A body too long to be stored within the message itself";
+    for (int i = 0; i < 10; i++) {
+        const char *body = i % 2 ? long_body : "HELLO";
+        msg_send_expect_success (radio, group, body);
+        for (int j = 0; j < 2; j++)
+            msg_recv_cmp (dishes[j], group, body);
+    }
+
+    for (int i = 0; i < 2; i++)
+        test_context_socket_close (dishes[i]);
+    test_context_socket_close (radio);
+}
+
 void test_join_too_long_fails ()
 {
     void *dish = test_context_socket (ZMQ_DISH);
@@ -255,6 +286,107 @@ void test_radio_dish_udp (int ipv6_)
 }
 MAKE_TEST_V4V6 (test_radio_dish_udp)
 
+void test_radio_dish_udp_batch (int ipv6_)
+{
+    void *radio = test_context_socket (ZMQ_RADIO);
+    void *dish = test_context_socket (ZMQ_DISH);
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (radio, ZMQ_IPV6, &ipv6_, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (dish, ZMQ_IPV6, &ipv6_, sizeof (int)));
+
+    //  Batches of different sizes on both ends, none dividing the number
+    //  of messages.
+    int batch_size = 4;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (radio, ZMQ_UDP_BATCH_SIZE,
+                                               &batch_size, sizeof (int)));
+    batch_size = 3;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (dish, ZMQ_UDP_BATCH_SIZE,
+                                               &batch_size, sizeof (int)));
+    batch_size = 0;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (dish, ZMQ_UDP_BATCH_SIZE, &batch_size, sizeof (int)));
+
+    const char *radio_url = ipv6_ ? "udp://[::1]:5557" : "udp://127.0.0.1:5557";
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (dish, "udp://*:5557"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (radio, radio_url));
+
+    msleep (SETTLE_TIME);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_join (dish, "TV"));
+
+    char body[16];
+    for (int i = 0; i < 50; i++) {
+        snprintf (body, sizeof (body), "Episode %d", i);
+        msg_send_expect_success (radio, "Movies", "Skipped");
+        msg_send_expect_success (radio, "TV", body);
+    }
+    for (int i = 0; i < 50; i++) {
+        snprintf (body, sizeof (body), "Episode %d", i);
+        msg_recv_cmp (dish, "TV", body);
+    }
+
+    test_context_socket_close (dish);
+    test_context_socket_close (radio);
+}
+MAKE_TEST_V4V6 (test_radio_dish_udp_batch)
+
+//  Datagrams read in one batch beyond the high water mark of the DISH are
+//  kept until it has room again, only the one that did not fit is dropped.
+void test_radio_dish_udp_batch_hwm (int ipv6_)
+{
+    void *radio = test_context_socket (ZMQ_RADIO);
+    void *dish = test_context_socket (ZMQ_DISH);
+
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (radio, ZMQ_IPV6, &ipv6_, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (dish, ZMQ_IPV6, &ipv6_, sizeof (int)));
+
+    int batch_size = 64;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (dish, ZMQ_UDP_BATCH_SIZE,
+                                               &batch_size, sizeof (int)));
+    const int hwm = 8;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (dish, ZMQ_RCVHWM, &hwm, sizeof (int)));
+    const int timeout = 250;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (dish, ZMQ_RCVTIMEO, &timeout, sizeof (int)));
+
+    const char *radio_url = ipv6_ ? "udp://[::1]:5557" : "udp://127.0.0.1:5557";
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (dish, "udp://*:5557"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (radio, radio_url));
+
+    msleep (SETTLE_TIME);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_join (dish, "TV"));
+
+    //  Fill the pipe of the DISH, then have the rest wait in the kernel
+    //  to be read in batches.
+    const int count = 48;
+    for (int i = 0; i < count; i++)
+        msg_send_expect_success (radio, "TV", "Episode");
+    msleep (SETTLE_TIME);
+
+    int received = 0;
+    char buffer[16];
+    while (zmq_recv (dish, buffer, sizeof buffer, 0) != -1)
+        received++;
+    TEST_ASSERT_EQUAL_INT (EAGAIN, zmq_errno ());
+
+    //  Each time the pipe fills up a single datagram is lost. Dropping the
+    //  rest of a batch would lose most of them.
+    TEST_ASSERT_GREATER_OR_EQUAL (count - count / (hwm / 2), received);
+
+    test_context_socket_close (dish);
+    test_context_socket_close (radio);
+}
+MAKE_TEST_V4V6 (test_radio_dish_udp_batch_hwm)
+
 #define MCAST_IPV4 "226.8.5.5"
 #define MCAST_IPV6 "ff02::7a65:726f:6df1:0a01"
 
@@ -511,6 +643,7 @@ int main (void)
     RUN_TEST (test_leave_unjoined_fails);
     RUN_TEST (test_join_too_long_fails);
     RUN_TEST (test_long_group);
+    RUN_TEST (test_long_group_fan_out);
     RUN_TEST (test_join_twice_fails);
     RUN_TEST (test_radio_bind_fails_ipv4);
     RUN_TEST (test_radio_bind_fails_ipv6);
@@ -520,6 +653,10 @@ int main (void)
     RUN_TEST (test_radio_dish_tcp_poll_ipv6);
     RUN_TEST (test_radio_dish_udp_ipv4);
     RUN_TEST (test_radio_dish_udp_ipv6);
+    RUN_TEST (test_radio_dish_udp_batch_ipv4);
+    RUN_TEST (test_radio_dish_udp_batch_ipv6);
+    RUN_TEST (test_radio_dish_udp_batch_hwm_ipv4);
+    RUN_TEST (test_radio_dish_udp_batch_hwm_ipv6);
 
     RUN_TEST (test_radio_dish_mcast_ipv4);
     RUN_TEST (test_radio_dish_no_loop_ipv4);
@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+void test_rebalance_ivl_option ()
+{
+    void *socket = test_context_socket (ZMQ_PUSH);
+
+    int value = -1;
+    size_t size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_REBALANCE_IVL, &value, &size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    value = 100;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket, ZMQ_REBALANCE_IVL, &value, sizeof (value)));
+    value = 0;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_REBALANCE_IVL, &value, &size));
+    TEST_ASSERT_EQUAL_INT (100, value);
+
+    value = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (socket, ZMQ_REBALANCE_IVL, &value, sizeof (value)));
+
+    test_context_socket_close (socket);
+}
+
+static const int pairs = 8;
+static const int io_threads = 4;
+static const int rounds = 3000;
+
+static void set_int (void *socket_, int option_, int value_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket_, option_, &value_, sizeof (value_)));
+}
+
+//  Connections are spread over the I/O threads as they are made, so that
+//  the busy ones, every fourth, share an I/O thread until they are moved.
+//  Messages carry sequence numbers, and must arrive complete and in order
+//  while the connections move. Some of the connections have heartbeats,
+//  whose timers move along.
+void test_rebalance_keeps_order ()
+{
+    void *ctx = zmq_ctx_new ();
+    TEST_ASSERT_NOT_NULL (ctx);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_set (ctx, ZMQ_IO_THREADS, io_threads));
+
+    void *push[pairs];
+    void *pull[pairs];
+    for (int i = 0; i < pairs; i++) {
+        pull[i] = zmq_socket (ctx, ZMQ_PULL);
+        push[i] = zmq_socket (ctx, ZMQ_PUSH);
+        TEST_ASSERT_NOT_NULL (pull[i]);
+        TEST_ASSERT_NOT_NULL (push[i]);
+        set_int (pull[i], ZMQ_REBALANCE_IVL, 5);
+        set_int (push[i], ZMQ_REBALANCE_IVL, 5);
+        if (i % 2)
+            set_int (push[i], ZMQ_HEARTBEAT_IVL, 20);
+
+        char endpoint[MAX_SOCKET_STRING];
+        bind_loopback_ipv4 (pull[i], endpoint, sizeof endpoint);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push[i], endpoint));
+    }
+
+    int sent[pairs] = {0};
+    int received[pairs] = {0};
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < pairs; i++) {
+            const int count = i % io_threads == 0 ? 200 : 1;
+            for (int j = 0; j < count; j++) {
+                TEST_ASSERT_EQUAL_INT (
+                  sizeof (int),
+                  zmq_send (push[i], &sent[i], sizeof (int), 0));
+                sent[i]++;
+            }
+        }
+        for (int i = 0; i < pairs; i++)
+            while (received[i] < sent[i]) {
+                int seq = -1;
+                TEST_ASSERT_EQUAL_INT (
+                  sizeof (int), zmq_recv (pull[i], &seq, sizeof (int), 0));
+                TEST_ASSERT_EQUAL_INT (received[i], seq);
+                received[i]++;
+            }
+    }
+
+    for (int i = 0; i < pairs; i++) {
+        close_zero_linger (push[i]);
+        close_zero_linger (pull[i]);
+    }
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_ctx_term (ctx));
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_rebalance_ivl_option);
+    RUN_TEST (test_rebalance_keeps_order);
+    return UNITY_END ();
+}
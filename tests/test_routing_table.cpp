@@ -0,0 +1,178 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+//  Enough peers for the routing table to grow several times, and to shrink
+//  again once most of them are gone.
+static const int peer_count = 500;
+
+//  More peers than the test context keeps track of.
+static void *peer_socket (int type_)
+{
+    void *const socket = zmq_socket (get_test_context (), type_);
+    TEST_ASSERT_NOT_NULL (socket);
+    return socket;
+}
+
+static void set_routing_id (void *socket_, int index_)
+{
+    char routing_id[16];
+    sprintf (routing_id, "peer-%d", index_);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      socket_, ZMQ_ROUTING_ID, routing_id, strlen (routing_id)));
+}
+
+//  Sends the index to the peer, returning -1 if the ROUTER cannot route it.
+static int send_to_dealer (void *router_, int index_)
+{
+    char routing_id[16];
+    sprintf (routing_id, "peer-%d", index_);
+    if (zmq_send (router_, routing_id, strlen (routing_id), ZMQ_SNDMORE)
+        == -1)
+        return -1;
+    return zmq_send (router_, &index_, sizeof (index_), 0) == -1 ? -1 : 0;
+}
+
+//  Sends the index to the peer, returning -1 if the SERVER cannot route it.
+static int send_to_client (void *server_, uint32_t routing_id_, int index_)
+{
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, sizeof (index_)));
+    memcpy (zmq_msg_data (&msg), &index_, sizeof (index_));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_set_routing_id (&msg, routing_id_));
+    if (zmq_msg_send (&msg, server_, ZMQ_DONTWAIT) == -1) {
+        const int err = errno;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+static void recv_index (void *socket_, int index_)
+{
+    int index = -1;
+    TEST_ASSERT_EQUAL_INT (sizeof (index),
+                           zmq_recv (socket_, &index, sizeof (index), 0));
+    TEST_ASSERT_EQUAL_INT (index_, index);
+}
+
+void test_router_many_peers ()
+{
+    void *router = test_context_socket (ZMQ_ROUTER);
+    int mandatory = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (
+      router, ZMQ_ROUTER_MANDATORY, &mandatory, sizeof (mandatory)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (router, "inproc://routing-table"));
+
+    void *dealers[peer_count];
+    for (int i = 0; i < peer_count; i++) {
+        dealers[i] = peer_socket (ZMQ_DEALER);
+        set_routing_id (dealers[i], i);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_connect (dealers[i], "inproc://routing-table"));
+    }
+
+    for (int i = 0; i < peer_count; i++)
+        TEST_ASSERT_SUCCESS_ERRNO (send_to_dealer (router, i));
+    for (int i = 0; i < peer_count; i++)
+        recv_index (dealers[i], i);
+
+    //  Remove most of the peers, from both ends of the table's probe runs.
+    for (int i = 0; i < peer_count; i++)
+        if (i % 10 != 0) {
+            close_zero_linger (dealers[i]);
+            dealers[i] = NULL;
+        }
+
+    //  Removed peers become unreachable, while the remaining ones can
+    //  still be found once the table has shrunk.
+    for (int i = 0; i < peer_count; i++) {
+        if (dealers[i]) {
+            TEST_ASSERT_SUCCESS_ERRNO (send_to_dealer (router, i));
+            recv_index (dealers[i], i);
+        } else {
+            while (send_to_dealer (router, i) == 0)
+                msleep (SETTLE_TIME / 10);
+            TEST_ASSERT_EQUAL_INT (EHOSTUNREACH, errno);
+        }
+    }
+
+    for (int i = 0; i < peer_count; i++)
+        if (dealers[i])
+            close_zero_linger (dealers[i]);
+    test_context_socket_close (router);
+}
+
+void test_server_many_peers ()
+{
+    void *server = test_context_socket (ZMQ_SERVER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (server, "inproc://routing-table"));
+
+    void *clients[peer_count];
+    for (int i = 0; i < peer_count; i++) {
+        clients[i] = peer_socket (ZMQ_CLIENT);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_connect (clients[i], "inproc://routing-table"));
+        TEST_ASSERT_EQUAL_INT (sizeof (i),
+                               zmq_send (clients[i], &i, sizeof (i), 0));
+    }
+
+    //  Learn the routing id of each client from its first message.
+    uint32_t routing_ids[peer_count];
+    for (int i = 0; i < peer_count; i++) {
+        zmq_msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+        TEST_ASSERT_EQUAL_INT (sizeof (i), zmq_msg_recv (&msg, server, 0));
+        int index;
+        memcpy (&index, zmq_msg_data (&msg), sizeof (index));
+        TEST_ASSERT_TRUE (index >= 0 && index < peer_count);
+        routing_ids[index] = zmq_msg_routing_id (&msg);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+    }
+
+    for (int i = 0; i < peer_count; i++)
+        if (i % 10 != 0) {
+            close_zero_linger (clients[i]);
+            clients[i] = NULL;
+        }
+
+    //  A pipe on its way out refuses messages before it is gone, which
+    //  happens once the SERVER has read up to its end.
+    for (int i = 0; i < peer_count; i++) {
+        if (clients[i]) {
+            TEST_ASSERT_SUCCESS_ERRNO (
+              send_to_client (server, routing_ids[i], i));
+            recv_index (clients[i], i);
+        } else {
+            while (send_to_client (server, routing_ids[i], i) == 0
+                   || errno == EAGAIN) {
+                TEST_ASSERT_FAILURE_ERRNO (
+                  EAGAIN, zmq_recv (server, NULL, 0, ZMQ_DONTWAIT));
+                msleep (SETTLE_TIME / 10);
+            }
+            TEST_ASSERT_EQUAL_INT (EHOSTUNREACH, errno);
+        }
+    }
+
+    for (int i = 0; i < peer_count; i++)
+        if (clients[i])
+            close_zero_linger (clients[i]);
+    test_context_socket_close (server);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_router_many_peers);
+    RUN_TEST (test_server_many_peers);
+    return UNITY_END ();
+}
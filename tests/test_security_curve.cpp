@@ -30,9 +30,16 @@ void *server;
 void *server_mon;
 char my_endpoint[MAX_SOCKET_STRING];
 
+//  Number of crypto threads of the contexts the tests run in.
+int crypto_threads = 0;
+
 void setUp ()
 {
     setup_test_context ();
+#ifdef ZMQ_CRYPTO_THREADS
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_ctx_set (get_test_context (), ZMQ_CRYPTO_THREADS, crypto_threads));
+#endif
     setup_context_and_server_side (&handler, &zap_thread, &server, &server_mon,
                                    my_endpoint);
 }
@@ -521,21 +528,8 @@ void test_null_client_secret_key ()
 }
 
 
-int main (void)
+static void run_tests ()
 {
-    if (!zmq_has ("curve")) {
-        printf ("CURVE encryption not installed, skipping test\n");
-        return 0;
-    }
-
-    zmq::random_open ();
-
-    setup_testutil_security_curve ();
-
-
-    setup_test_environment (180);
-
-    UNITY_BEGIN ();
     RUN_TEST (test_curve_security_with_valid_credentials);
     RUN_TEST (test_null_server_key);
     RUN_TEST (test_null_client_public_key);
@@ -553,6 +547,31 @@ int main (void)
     RUN_TEST (test_curve_security_invalid_initiate_command_name);
     RUN_TEST (test_curve_security_invalid_initiate_command_encrypted_cookie);
     RUN_TEST (test_curve_security_invalid_initiate_command_encrypted_content);
+}
+
+int main (void)
+{
+    if (!zmq_has ("curve")) {
+        printf ("CURVE encryption not installed, skipping test\n");
+        return 0;
+    }
+
+    zmq::random_open ();
+
+    setup_testutil_security_curve ();
+
+
+    setup_test_environment (180);
+
+    UNITY_BEGIN ();
+    run_tests ();
+
+#ifdef ZMQ_CRYPTO_THREADS
+    //  The same with the expensive steps of the server's handshakes run by
+    //  crypto threads.
+    crypto_threads = 2;
+    run_tests ();
+#endif
 
     // TODO this requires a deviating test setup, must be moved to a separate executable/fixture
     //  test with a large routing id (resulting in large metadata)
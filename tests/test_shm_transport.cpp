@@ -0,0 +1,206 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include <string.h>
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+//  Binds sb_ to a wildcard shm:// endpoint and connects sc_ to it.
+static void bind_and_connect (void *sb_, void *sc_)
+{
+    char endpoint[MAX_SOCKET_STRING];
+    size_t len = sizeof endpoint;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (sb_, "shm://*"));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (sb_, ZMQ_LAST_ENDPOINT, endpoint, &len));
+    TEST_ASSERT_EQUAL_INT (0, strncmp (endpoint, "shm://", 6));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc_, endpoint));
+}
+
+void test_has_shm ()
+{
+    TEST_ASSERT_TRUE (zmq_has ("shm"));
+}
+
+void test_roundtrip ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    size_t len = sizeof endpoint;
+
+    void *sb = test_context_socket (ZMQ_REP);
+    void *sc = test_context_socket (ZMQ_REQ);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (sb, "shm://*"));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (sb, ZMQ_LAST_ENDPOINT, endpoint, &len));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, endpoint));
+
+    bounce (sb, sc);
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_disconnect (sc, endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_unbind (sb, endpoint));
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+void test_multipart ()
+{
+    void *sb = test_context_socket (ZMQ_ROUTER);
+    void *sc = test_context_socket (ZMQ_DEALER);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sc, ZMQ_ROUTING_ID, "client", 6));
+    bind_and_connect (sb, sc);
+
+    send_string_expect_success (sc, "A", ZMQ_SNDMORE);
+    send_string_expect_success (sc, "B", ZMQ_SNDMORE);
+    send_string_expect_success (sc, "C", 0);
+
+    recv_string_expect_success (sb, "client", 0);
+    recv_string_expect_success (sb, "A", 0);
+    recv_string_expect_success (sb, "B", 0);
+    recv_string_expect_success (sb, "C", 0);
+    int more;
+    size_t more_size = sizeof more;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (sb, ZMQ_RCVMORE, &more, &more_size));
+    TEST_ASSERT_EQUAL_INT (0, more);
+
+    //  And back, routed by the routing id.
+    send_string_expect_success (sb, "client", ZMQ_SNDMORE);
+    send_string_expect_success (sb, "D", 0);
+    recv_string_expect_success (sc, "D", 0);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+void test_message_larger_than_ring ()
+{
+    void *sb = test_context_socket (ZMQ_PAIR);
+    void *sc = test_context_socket (ZMQ_PAIR);
+    bind_and_connect (sb, sc);
+
+    const size_t size = 1024 * 1024 + 7;
+    zmq_msg_t msg;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init_size (&msg, size));
+    unsigned char *data = static_cast<unsigned char *> (zmq_msg_data (&msg));
+    for (size_t i = 0; i < size; ++i)
+        data[i] = static_cast<unsigned char> (i * 7);
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (size),
+                           zmq_msg_send (&msg, sc, 0));
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_init (&msg));
+    TEST_ASSERT_EQUAL_INT (static_cast<int> (size),
+                           zmq_msg_recv (&msg, sb, 0));
+    data = static_cast<unsigned char *> (zmq_msg_data (&msg));
+    for (size_t i = 0; i < size; ++i)
+        TEST_ASSERT_EQUAL_UINT8 (static_cast<unsigned char> (i * 7), data[i]);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_msg_close (&msg));
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+void test_many_messages ()
+{
+    void *sb = test_context_socket (ZMQ_PULL);
+    void *sc = test_context_socket (ZMQ_PUSH);
+    bind_and_connect (sb, sc);
+
+    //  Far more than fits in the rings and the pipes at once, so that the
+    //  sender keeps blocking on the high water mark.
+    const int count = 100000;
+    char buf[64];
+    memset (buf, 'x', sizeof buf);
+    for (int i = 0; i < count; i++) {
+        memcpy (buf, &i, sizeof i);
+        TEST_ASSERT_EQUAL_INT (
+          static_cast<int> (sizeof buf),
+          TEST_ASSERT_SUCCESS_ERRNO (zmq_send (sc, buf, sizeof buf, 0)));
+        if (i % 1000 == 999) {
+            for (int j = i - 999; j <= i; j++) {
+                char received[sizeof buf];
+                TEST_ASSERT_EQUAL_INT (
+                  static_cast<int> (sizeof received),
+                  TEST_ASSERT_SUCCESS_ERRNO (
+                    zmq_recv (sb, received, sizeof received, 0)));
+                int index;
+                memcpy (&index, received, sizeof index);
+                TEST_ASSERT_EQUAL_INT (j, index);
+            }
+        }
+    }
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+void test_reconnect ()
+{
+    void *sb = test_context_socket (ZMQ_REP);
+    void *sc = test_context_socket (ZMQ_REQ);
+    char endpoint[MAX_SOCKET_STRING];
+    size_t len = sizeof endpoint;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (sb, "shm://*"));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (sb, ZMQ_LAST_ENDPOINT, endpoint, &len));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, endpoint));
+    bounce (sb, sc);
+    test_context_socket_close (sc);
+
+    //  The bound end notices the peer is gone and takes a new one.
+    sc = test_context_socket (ZMQ_REQ);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sc, endpoint));
+    bounce (sb, sc);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+void test_spin ()
+{
+    void *sb = test_context_socket (ZMQ_REP);
+    void *sc = test_context_socket (ZMQ_REQ);
+    int spin = -1;
+    size_t size = sizeof spin;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_getsockopt (sb, ZMQ_SHM_SPIN, &spin, &size));
+    TEST_ASSERT_EQUAL_INT (0, spin);
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (sb, ZMQ_SHM_SPIN, &spin, sizeof spin - 1));
+    spin = 50;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sb, ZMQ_SHM_SPIN, &spin, sizeof spin));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sc, ZMQ_SHM_SPIN, &spin, sizeof spin));
+    bind_and_connect (sb, sc);
+
+    for (int i = 0; i < 100; i++)
+        bounce (sb, sc);
+
+    test_context_socket_close (sc);
+    test_context_socket_close (sb);
+}
+
+void test_stream_not_supported ()
+{
+    void *s = test_context_socket (ZMQ_STREAM);
+    TEST_ASSERT_FAILURE_ERRNO (ENOCOMPATPROTO, zmq_bind (s, "shm://*"));
+    test_context_socket_close (s);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_has_shm);
+    RUN_TEST (test_roundtrip);
+    RUN_TEST (test_multipart);
+    RUN_TEST (test_message_larger_than_ring);
+    RUN_TEST (test_many_messages);
+    RUN_TEST (test_reconnect);
+    RUN_TEST (test_spin);
+    RUN_TEST (test_stream_not_supported);
+    return UNITY_END ();
+}
@@ -0,0 +1,204 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+#include <string.h>
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static zmq_socket_stats_t get_stats (void *socket_)
+{
+    zmq_socket_stats_t stats;
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_socket_stats (socket_, &stats, NULL, NULL));
+    return stats;
+}
+
+//  Sockets learn about new and closed pipes by processing commands, which
+//  querying ZMQ_EVENTS makes them do.
+static void process_commands (void *socket_)
+{
+    int events;
+    size_t events_size = sizeof (events);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket_, ZMQ_EVENTS, &events, &events_size));
+}
+
+void test_invalid ()
+{
+    zmq_socket_stats_t stats;
+    TEST_ASSERT_FAILURE_ERRNO (ENOTSOCK,
+                               zmq_socket_stats (NULL, &stats, NULL, NULL));
+
+    void *socket = test_context_socket (ZMQ_PAIR);
+    zmq_pipe_stats_t pipes[1];
+    TEST_ASSERT_FAILURE_ERRNO (EINVAL,
+                               zmq_socket_stats (socket, NULL, pipes, NULL));
+    test_context_socket_close (socket);
+}
+
+void test_queue_inproc ()
+{
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://stats"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://stats"));
+
+    zmq_socket_stats_t stats = get_stats (push);
+    TEST_ASSERT_EQUAL_UINT64 (0, stats.msgs_out);
+
+    for (int i = 0; i < 10; i++)
+        send_string_expect_success (push, "hello", 0);
+    send_string_expect_success (push, "multi", ZMQ_SNDMORE);
+    send_string_expect_success (push, "part", 0);
+
+    stats = get_stats (push);
+    TEST_ASSERT_EQUAL_UINT64 (11, stats.msgs_out);
+    TEST_ASSERT_EQUAL_UINT64 (59, stats.bytes_out);
+    TEST_ASSERT_EQUAL_UINT64 (11, stats.queued_out);
+    TEST_ASSERT_EQUAL_UINT64 (0, stats.msgs_in);
+
+    //  The receiving side sees the same queue.
+    process_commands (pull);
+    stats = get_stats (pull);
+    TEST_ASSERT_EQUAL_UINT64 (11, stats.queued_in);
+    TEST_ASSERT_EQUAL_UINT64 (0, stats.msgs_in);
+
+    for (int i = 0; i < 4; i++)
+        recv_string_expect_success (pull, "hello", 0);
+
+    stats = get_stats (pull);
+    TEST_ASSERT_EQUAL_UINT64 (4, stats.msgs_in);
+    TEST_ASSERT_EQUAL_UINT64 (20, stats.bytes_in);
+    TEST_ASSERT_EQUAL_UINT64 (7, stats.queued_in);
+    TEST_ASSERT_EQUAL_UINT64 (7, get_stats (push).queued_out);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+void test_pipes_tcp ()
+{
+    char endpoint[MAX_SOCKET_STRING];
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *pull = test_context_socket (ZMQ_PULL);
+    bind_loopback_ipv4 (pull, endpoint, sizeof (endpoint));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, endpoint));
+
+    for (int i = 0; i < 100; i++)
+        send_string_expect_success (push, "hello", 0);
+    for (int i = 0; i < 100; i++)
+        recv_string_expect_success (pull, "hello", 0);
+
+    //  With no room for a single pipe, only the count is returned.
+    zmq_pipe_stats_t pipes[2];
+    size_t pipe_count = 0;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_socket_stats (pull, NULL, pipes, &pipe_count));
+    TEST_ASSERT_EQUAL_UINT (1, pipe_count);
+
+    pipe_count = 2;
+    zmq_socket_stats_t stats;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_socket_stats (pull, &stats, pipes, &pipe_count));
+    TEST_ASSERT_EQUAL_UINT (1, pipe_count);
+    TEST_ASSERT_EQUAL_UINT64 (100, stats.msgs_in);
+    TEST_ASSERT_EQUAL_UINT64 (100, pipes[0].stats.msgs_in);
+    TEST_ASSERT_EQUAL_UINT64 (0, pipes[0].stats.queued_in);
+    TEST_ASSERT_GREATER_THAN (0, pipes[0].stats.engine_reads);
+    TEST_ASSERT_EQUAL_STRING (endpoint, pipes[0].local_endpoint);
+    TEST_ASSERT_EQUAL_INT (0, strncmp (pipes[0].remote_endpoint, "tcp://", 6));
+
+    pipe_count = 2;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_socket_stats (push, &stats, pipes, &pipe_count));
+    TEST_ASSERT_EQUAL_UINT (1, pipe_count);
+    TEST_ASSERT_EQUAL_UINT64 (100, stats.msgs_out);
+    TEST_ASSERT_EQUAL_UINT64 (500, stats.bytes_out);
+    TEST_ASSERT_GREATER_THAN (0, stats.engine_writes);
+    TEST_ASSERT_EQUAL_STRING (endpoint, pipes[0].remote_endpoint);
+
+    //  The counters of the pipe remain in the totals after it is gone. The
+    //  connecting side keeps its pipe to reconnect, so watch the binding
+    //  side.
+    test_context_socket_close (push);
+    do {
+        msleep (SETTLE_TIME / 10);
+        process_commands (pull);
+        TEST_ASSERT_SUCCESS_ERRNO (
+          zmq_socket_stats (pull, &stats, NULL, &pipe_count));
+    } while (pipe_count != 0);
+    TEST_ASSERT_EQUAL_UINT64 (100, stats.msgs_in);
+    TEST_ASSERT_EQUAL_UINT64 (0, stats.queued_in);
+
+    test_context_socket_close (pull);
+}
+
+void test_drops ()
+{
+    void *pub = test_context_socket (ZMQ_PUB);
+    void *sub = test_context_socket (ZMQ_SUB);
+    int hwm = 1;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (pub, ZMQ_SNDHWM, &hwm, sizeof (hwm)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (sub, ZMQ_RCVHWM, &hwm, sizeof (hwm)));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_setsockopt (sub, ZMQ_SUBSCRIBE, "", 0));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pub, "inproc://stats"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sub, "inproc://stats"));
+
+    //  Over inproc, the high water marks of both sides add up.
+    for (int i = 0; i < 10; i++)
+        send_string_expect_success (pub, "hello", 0);
+
+    const zmq_socket_stats_t stats = get_stats (pub);
+    TEST_ASSERT_EQUAL_UINT64 (2, stats.msgs_out);
+    TEST_ASSERT_EQUAL_UINT64 (8, stats.drops);
+    TEST_ASSERT_EQUAL_UINT64 (1, stats.hwm_hits);
+    TEST_ASSERT_EQUAL_UINT64 (2, stats.queued_out);
+
+    test_context_socket_close (pub);
+    test_context_socket_close (sub);
+}
+
+static void read_stats (void *socket_)
+{
+    for (int i = 0; i < 1000; i++)
+        get_stats (socket_);
+}
+
+void test_read_from_other_thread ()
+{
+    void *push = test_context_socket (ZMQ_PUSH);
+    void *pull = test_context_socket (ZMQ_PULL);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (pull, "inproc://stats"));
+
+    void *thread = zmq_threadstart (read_stats, push);
+
+    //  Pipes come and go while the other thread reads the statistics.
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (push, "inproc://stats"));
+        send_string_expect_success (push, "hello", 0);
+        recv_string_expect_success (pull, "hello", 0);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_disconnect (push, "inproc://stats"));
+    }
+
+    zmq_threadclose (thread);
+    TEST_ASSERT_EQUAL_UINT64 (20, get_stats (push).msgs_out);
+
+    test_context_socket_close (push);
+    test_context_socket_close (pull);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_invalid);
+    RUN_TEST (test_queue_inproc);
+    RUN_TEST (test_pipes_tcp);
+    RUN_TEST (test_drops);
+    RUN_TEST (test_read_from_other_thread);
+    return UNITY_END ();
+}
@@ -0,0 +1,151 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "testutil.hpp"
+#include "testutil_unity.hpp"
+
+SETUP_TEARDOWN_TESTCONTEXT
+
+static void set_spin (void *socket_, int spin_time_, int adaptive_)
+{
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket_, ZMQ_SPIN_TIME, &spin_time_, sizeof (int)));
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket_, ZMQ_SPIN_ADAPTIVE, &adaptive_, sizeof (int)));
+}
+
+void test_options ()
+{
+    void *socket = test_context_socket (ZMQ_PAIR);
+
+    int value;
+    size_t size = sizeof (value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_SPIN_TIME, &value, &size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_SPIN_ADAPTIVE, &value, &size));
+    TEST_ASSERT_EQUAL_INT (0, value);
+
+    set_spin (socket, 50, 1);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_SPIN_TIME, &value, &size));
+    TEST_ASSERT_EQUAL_INT (50, value);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_getsockopt (socket, ZMQ_SPIN_ADAPTIVE, &value, &size));
+    TEST_ASSERT_EQUAL_INT (1, value);
+
+    value = -1;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, zmq_setsockopt (socket, ZMQ_SPIN_TIME, &value, sizeof (value)));
+    value = 2;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL,
+      zmq_setsockopt (socket, ZMQ_SPIN_ADAPTIVE, &value, sizeof (value)));
+
+    test_context_socket_close (socket);
+}
+
+static void test_roundtrips (int spin_time_, int adaptive_)
+{
+    void *rep = test_context_socket (ZMQ_REP);
+    void *req = test_context_socket (ZMQ_REQ);
+    set_spin (rep, spin_time_, adaptive_);
+    set_spin (req, spin_time_, adaptive_);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (rep, "inproc://spin"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (req, "inproc://spin"));
+
+    for (int i = 0; i < 1000; i++)
+        bounce (rep, req);
+
+    test_context_socket_close (req);
+    test_context_socket_close (rep);
+}
+
+void test_roundtrips_fixed ()
+{
+    test_roundtrips (100, 0);
+}
+
+void test_roundtrips_adaptive ()
+{
+    test_roundtrips (100, 1);
+}
+
+void test_spin_honours_rcvtimeo ()
+{
+    void *socket = test_context_socket (ZMQ_PAIR);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (socket, "inproc://spin"));
+
+    //  Spinning for a full second must not outlast the receive timeout.
+    set_spin (socket, 1000000, 0);
+    int timeout = 10;
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_setsockopt (socket, ZMQ_RCVTIMEO, &timeout, sizeof (int)));
+
+    void *watch = zmq_stopwatch_start ();
+    char buffer[16];
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN,
+                               zmq_recv (socket, buffer, sizeof (buffer), 0));
+    TEST_ASSERT_LESS_THAN (500000, zmq_stopwatch_stop (watch));
+
+    test_context_socket_close (socket);
+}
+
+static void send_later (void *socket_)
+{
+    msleep (SETTLE_TIME / 3);
+    send_string_expect_success (socket_, "later", 0);
+}
+
+void test_poller_wait ()
+{
+    void *receiver = test_context_socket (ZMQ_PAIR);
+    void *sender = test_context_socket (ZMQ_PAIR);
+    set_spin (receiver, 100, 1);
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_bind (receiver, "inproc://spin"));
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_connect (sender, "inproc://spin"));
+
+    void *poller = zmq_poller_new ();
+    TEST_ASSERT_NOT_NULL (poller);
+    TEST_ASSERT_SUCCESS_ERRNO (
+      zmq_poller_add (poller, receiver, NULL, ZMQ_POLLIN));
+
+    //  Nothing arrives: the timeout is honoured.
+    zmq_poller_event_t event;
+    TEST_ASSERT_FAILURE_ERRNO (EAGAIN, zmq_poller_wait (poller, &event, 10));
+
+    //  A message sent from another thread wakes the poller up, whether it
+    //  arrives while spinning or after falling back to blocking.
+    for (int i = 0; i < 3; i++) {
+        void *thread = zmq_threadstart (send_later, sender);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_wait (poller, &event, -1));
+        TEST_ASSERT_EQUAL_PTR (receiver, event.socket);
+        TEST_ASSERT_EQUAL_INT (ZMQ_POLLIN, event.events);
+        zmq_threadclose (thread);
+        recv_string_expect_success (receiver, "later", 0);
+    }
+
+    //  Messages arriving in quick succession are picked up while spinning.
+    for (int i = 0; i < 100; i++) {
+        send_string_expect_success (sender, "now", 0);
+        TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_wait (poller, &event, -1));
+        recv_string_expect_success (receiver, "now", 0);
+    }
+
+    TEST_ASSERT_SUCCESS_ERRNO (zmq_poller_destroy (&poller));
+    test_context_socket_close (sender);
+    test_context_socket_close (receiver);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_options);
+    RUN_TEST (test_roundtrips_fixed);
+    RUN_TEST (test_roundtrips_adaptive);
+    RUN_TEST (test_spin_honours_rcvtimeo);
+    RUN_TEST (test_poller_wait);
+    return UNITY_END ();
+}
@@ -0,0 +1,362 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <art_tree.hpp>
+#include <stdint.hpp>
+
+#include <set>
+#include <string>
+#include <string.h>
+#include <unity.h>
+#include <vector>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+bool tree_add (zmq::art_tree_t &tree_, const std::string &key_)
+{
+    return tree_.add (reinterpret_cast<const unsigned char *> (key_.data ()),
+                      key_.size ());
+}
+
+bool tree_rm (zmq::art_tree_t &tree_, const std::string &key_)
+{
+    return tree_.rm (reinterpret_cast<const unsigned char *> (key_.data ()),
+                     key_.size ());
+}
+
+bool tree_check (zmq::art_tree_t &tree_, const std::string &key_)
+{
+    return tree_.check (reinterpret_cast<const unsigned char *> (key_.data ()),
+                        key_.size ());
+}
+
+void test_empty ()
+{
+    zmq::art_tree_t tree;
+
+    TEST_ASSERT_TRUE (tree.size () == 0);
+}
+
+void test_add_single_entry ()
+{
+    zmq::art_tree_t tree;
+
+    TEST_ASSERT_TRUE (tree_add (tree, "foo"));
+}
+
+void test_add_same_entry_twice ()
+{
+    zmq::art_tree_t tree;
+
+    TEST_ASSERT_TRUE (tree_add (tree, "test"));
+    TEST_ASSERT_FALSE (tree_add (tree, "test"));
+}
+
+void test_rm_when_empty ()
+{
+    zmq::art_tree_t tree;
+
+    TEST_ASSERT_FALSE (tree_rm (tree, "test"));
+}
+
+void test_rm_single_entry ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "temporary");
+    TEST_ASSERT_TRUE (tree_rm (tree, "temporary"));
+}
+
+void test_rm_unique_entry_twice ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "test");
+    TEST_ASSERT_TRUE (tree_rm (tree, "test"));
+    TEST_ASSERT_FALSE (tree_rm (tree, "test"));
+}
+
+void test_rm_duplicate_entry ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "test");
+    tree_add (tree, "test");
+    TEST_ASSERT_FALSE (tree_rm (tree, "test"));
+    TEST_ASSERT_TRUE (tree_rm (tree, "test"));
+}
+
+void test_rm_common_prefix ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "checkpoint");
+    tree_add (tree, "checklist");
+    TEST_ASSERT_FALSE (tree_rm (tree, "check"));
+}
+
+void test_rm_common_prefix_entry ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "checkpoint");
+    tree_add (tree, "checklist");
+    tree_add (tree, "check");
+    TEST_ASSERT_TRUE (tree_rm (tree, "check"));
+}
+
+void test_rm_null_entry ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "");
+    TEST_ASSERT_TRUE (tree_rm (tree, ""));
+}
+
+void test_check_empty ()
+{
+    zmq::art_tree_t tree;
+
+    TEST_ASSERT_FALSE (tree_check (tree, "foo"));
+}
+
+void test_check_added_entry ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "entry");
+    TEST_ASSERT_TRUE (tree_check (tree, "entry"));
+}
+
+void test_check_common_prefix ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "introduce");
+    tree_add (tree, "introspect");
+    TEST_ASSERT_FALSE (tree_check (tree, "intro"));
+}
+
+void test_check_prefix ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "toasted");
+    TEST_ASSERT_FALSE (tree_check (tree, "toast"));
+    TEST_ASSERT_FALSE (tree_check (tree, "toaste"));
+    TEST_ASSERT_FALSE (tree_check (tree, "toaster"));
+}
+
+void test_check_nonexistent_entry ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "red");
+    TEST_ASSERT_FALSE (tree_check (tree, "blue"));
+}
+
+void test_check_query_longer_than_entry ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "foo");
+    TEST_ASSERT_TRUE (tree_check (tree, "foobar"));
+}
+
+void test_check_null_entry_added ()
+{
+    zmq::art_tree_t tree;
+
+    tree_add (tree, "");
+    TEST_ASSERT_TRUE (tree_check (tree, "all queries return true"));
+}
+
+void test_size ()
+{
+    zmq::art_tree_t tree;
+
+    // Adapted from the example on wikipedia.
+    std::vector<std::string> keys;
+    keys.push_back ("tester");
+    keys.push_back ("water");
+    keys.push_back ("slow");
+    keys.push_back ("slower");
+    keys.push_back ("test");
+    keys.push_back ("team");
+    keys.push_back ("toast");
+
+    for (size_t i = 0; i < keys.size (); ++i)
+        TEST_ASSERT_TRUE (tree_add (tree, keys[i]));
+    TEST_ASSERT_TRUE (tree.size () == keys.size ());
+    for (size_t i = 0; i < keys.size (); ++i)
+        TEST_ASSERT_FALSE (tree_add (tree, keys[i]));
+    TEST_ASSERT_TRUE (tree.size () == 2 * keys.size ());
+    for (size_t i = 0; i < keys.size (); ++i)
+        TEST_ASSERT_FALSE (tree_rm (tree, keys[i]));
+    TEST_ASSERT_TRUE (tree.size () == keys.size ());
+    for (size_t i = 0; i < keys.size (); ++i)
+        TEST_ASSERT_TRUE (tree_rm (tree, keys[i]));
+    TEST_ASSERT_TRUE (tree.size () == 0);
+}
+
+void return_key (unsigned char *data_, size_t size_, void *arg_)
+{
+    std::vector<std::string> *vec =
+      reinterpret_cast<std::vector<std::string> *> (arg_);
+    std::string key;
+    for (size_t i = 0; i < size_; ++i)
+        key.push_back (static_cast<char> (data_[i]));
+    vec->push_back (key);
+}
+
+void test_apply ()
+{
+    zmq::art_tree_t tree;
+
+    std::set<std::string> keys;
+    keys.insert ("tester");
+    keys.insert ("water");
+    keys.insert ("slow");
+    keys.insert ("slower");
+    keys.insert ("test");
+    keys.insert ("team");
+    keys.insert ("toast");
+
+    const std::set<std::string>::iterator end = keys.end ();
+    for (std::set<std::string>::iterator it = keys.begin (); it != end; ++it)
+        tree_add (tree, *it);
+
+    std::vector<std::string> *vec = new std::vector<std::string> ();
+    tree.apply (return_key, static_cast<void *> (vec));
+    for (size_t i = 0; i < vec->size (); ++i)
+        TEST_ASSERT_TRUE (keys.count ((*vec)[i]) > 0);
+    delete vec;
+}
+
+//  Walks a node through all the layouts, up to 256 children and back.
+void test_node_layouts ()
+{
+    zmq::art_tree_t tree;
+
+    for (int i = 0; i < 256; ++i) {
+        std::string key ("topic.");
+        key.push_back (static_cast<char> (i));
+        key.append ("suffix");
+        TEST_ASSERT_TRUE (tree_add (tree, key));
+        for (int j = 0; j <= i; ++j) {
+            std::string query ("topic.");
+            query.push_back (static_cast<char> (j));
+            query.append ("suffix.more");
+            TEST_ASSERT_TRUE (tree_check (tree, query));
+        }
+        TEST_ASSERT_FALSE (tree_check (tree, "topic."));
+    }
+
+    std::vector<std::string> keys;
+    tree.apply (return_key, &keys);
+    TEST_ASSERT_EQUAL_INT (256, keys.size ());
+    for (int i = 0; i < 256; ++i)
+        TEST_ASSERT_EQUAL_UINT8 (i, static_cast<unsigned char> (keys[i][6]));
+
+    //  Remove every other key first, then the rest.
+    for (int pass = 0; pass < 2; ++pass)
+        for (int i = pass; i < 256; i += 2) {
+            std::string key ("topic.");
+            key.push_back (static_cast<char> (i));
+            key.append ("suffix");
+            TEST_ASSERT_TRUE (tree_rm (tree, key));
+            TEST_ASSERT_FALSE (tree_check (tree, key));
+        }
+    TEST_ASSERT_EQUAL_INT (0, tree.size ());
+    TEST_ASSERT_FALSE (tree_check (tree, "topic.a"));
+}
+
+//  Adds and removes random keys over a small alphabet, so that they share
+//  prefixes a lot, and checks the tree against a multiset.
+void test_against_multiset ()
+{
+    zmq::art_tree_t tree;
+    std::multiset<std::string> expected;
+    const char alphabet[] = "abc";
+
+    uint32_t random = 1;
+    for (int step = 0; step < 20000; ++step) {
+        random = random * 1103515245 + 12345;
+        std::string key;
+        const uint32_t length = (random >> 16) % 6;
+        for (uint32_t i = 0; i < length; ++i) {
+            random = random * 1103515245 + 12345;
+            key.push_back (alphabet[(random >> 16) % 3]);
+        }
+
+        random = random * 1103515245 + 12345;
+        if ((random >> 16) % 3 != 0) {
+            TEST_ASSERT_EQUAL (expected.count (key) == 0, tree_add (tree, key));
+            expected.insert (key);
+        } else {
+            const std::multiset<std::string>::iterator it =
+              expected.find (key);
+            const bool removed = it != expected.end () && expected.count (key) == 1;
+            TEST_ASSERT_EQUAL (removed, tree_rm (tree, key));
+            if (it != expected.end ())
+                expected.erase (it);
+        }
+        TEST_ASSERT_EQUAL_INT (expected.size (), tree.size ());
+
+        //  The key with a tail is matched if any of its prefixes is a key.
+        bool match = false;
+        const std::string query = key + "ab";
+        for (size_t i = 0; i <= query.size () && !match; ++i)
+            match = expected.count (query.substr (0, i)) > 0;
+        TEST_ASSERT_EQUAL (match, tree_check (tree, query));
+    }
+
+    std::vector<std::string> keys;
+    tree.apply (return_key, &keys);
+    const std::set<std::string> unique (expected.begin (), expected.end ());
+    TEST_ASSERT_EQUAL_INT (unique.size (), keys.size ());
+    for (size_t i = 0; i < keys.size (); ++i)
+        TEST_ASSERT_TRUE (unique.count (keys[i]) > 0);
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+
+    RUN_TEST (test_empty);
+    RUN_TEST (test_add_single_entry);
+    RUN_TEST (test_add_same_entry_twice);
+
+    RUN_TEST (test_rm_when_empty);
+    RUN_TEST (test_rm_single_entry);
+    RUN_TEST (test_rm_unique_entry_twice);
+    RUN_TEST (test_rm_duplicate_entry);
+    RUN_TEST (test_rm_common_prefix);
+    RUN_TEST (test_rm_common_prefix_entry);
+    RUN_TEST (test_rm_null_entry);
+
+    RUN_TEST (test_check_empty);
+    RUN_TEST (test_check_added_entry);
+    RUN_TEST (test_check_common_prefix);
+    RUN_TEST (test_check_prefix);
+    RUN_TEST (test_check_nonexistent_entry);
+    RUN_TEST (test_check_query_longer_than_entry);
+    RUN_TEST (test_check_null_entry_added);
+
+    RUN_TEST (test_size);
+
+    RUN_TEST (test_apply);
+
+    RUN_TEST (test_node_layouts);
+    RUN_TEST (test_against_multiset);
+
+    return UNITY_END ();
+}
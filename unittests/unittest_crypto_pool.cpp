@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+#include "../tests/testutil_unity.hpp"
+
+#include <atomic_counter.hpp>
+#include <crypto_pool.hpp>
+#include <ctx.hpp>
+#include <own.hpp>
+
+#include <unity.h>
+
+#include <vector>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+//  Requester the jobs are sent back to.
+class test_destination_t ZMQ_FINAL : public zmq::own_t
+{
+  public:
+    test_destination_t (zmq::ctx_t *ctx_) : own_t (ctx_, 0) {}
+};
+
+//  Job counting how often it ran. While the pool holds 'peers_' other
+//  jobs of the same kind, it waits for them all to run at the same time.
+class test_job_t ZMQ_FINAL : public zmq::crypto_job_t
+{
+  public:
+    test_job_t (zmq::atomic_counter_t *running_, int peers_) :
+        executed (0),
+        met_peers (false),
+        _running (running_),
+        _peers (peers_)
+    {
+    }
+
+    void execute ()
+    {
+        executed++;
+        if (_peers == 0)
+            return;
+
+        _running->add (1);
+        for (int i = 0; i < 1000 && !met_peers; i++) {
+            met_peers =
+              static_cast<int> (_running->get ()) == _peers + 1;
+            if (!met_peers)
+                msleep (1);
+        }
+    }
+
+    int executed;
+    bool met_peers;
+
+  private:
+    zmq::atomic_counter_t *const _running;
+    const int _peers;
+};
+
+//  Pool collecting the executed jobs instead of sending them.
+class test_pool_t ZMQ_FINAL : public zmq::crypto_pool_t
+{
+  public:
+    test_pool_t (zmq::ctx_t *ctx_, int thread_count_) :
+        crypto_pool_t (ctx_, thread_count_)
+    {
+    }
+
+    ~test_pool_t () { stop (); }
+
+    //  Waits until there are 'count_' executed jobs.
+    void wait_for_jobs (size_t count_)
+    {
+        while (true) {
+            {
+                zmq::scoped_lock_t locker (_sync);
+                if (_jobs.size () >= count_) {
+                    TEST_ASSERT_EQUAL_UINT (count_, _jobs.size ());
+                    return;
+                }
+            }
+            msleep (1);
+        }
+    }
+
+    size_t jobs ()
+    {
+        zmq::scoped_lock_t locker (_sync);
+        return _jobs.size ();
+    }
+
+  protected:
+    void reply (zmq::own_t *, zmq::crypto_job_t *job_) ZMQ_FINAL
+    {
+        zmq::scoped_lock_t locker (_sync);
+        _jobs.push_back (job_);
+    }
+
+  private:
+    zmq::mutex_t _sync;
+    std::vector<zmq::crypto_job_t *> _jobs;
+};
+
+void test_jobs_executed_once ()
+{
+    zmq::ctx_t ctx;
+    test_destination_t destination (&ctx);
+    test_pool_t pool (&ctx, 2);
+
+    zmq::atomic_counter_t running;
+    std::vector<test_job_t *> jobs;
+    for (int i = 0; i < 100; i++) {
+        jobs.push_back (new test_job_t (&running, 0));
+        pool.submit (&destination, jobs.back ());
+    }
+    pool.wait_for_jobs (jobs.size ());
+
+    for (size_t i = 0; i != jobs.size (); i++) {
+        TEST_ASSERT_EQUAL_INT (1, jobs[i]->executed);
+        delete jobs[i];
+    }
+}
+
+void test_jobs_run_in_parallel ()
+{
+    zmq::ctx_t ctx;
+    test_destination_t destination (&ctx);
+    test_pool_t pool (&ctx, 3);
+
+    zmq::atomic_counter_t running;
+    std::vector<test_job_t *> jobs;
+    for (int i = 0; i < 3; i++) {
+        jobs.push_back (new test_job_t (&running, 2));
+        pool.submit (&destination, jobs.back ());
+    }
+    pool.wait_for_jobs (jobs.size ());
+
+    for (size_t i = 0; i != jobs.size (); i++) {
+        TEST_ASSERT_TRUE (jobs[i]->met_peers);
+        delete jobs[i];
+    }
+}
+
+void test_stop_runs_queued_jobs ()
+{
+    zmq::ctx_t ctx;
+    test_destination_t destination (&ctx);
+    std::vector<test_job_t *> jobs;
+    zmq::atomic_counter_t running;
+    {
+        test_pool_t pool (&ctx, 1);
+        for (int i = 0; i < 100; i++) {
+            jobs.push_back (new test_job_t (&running, 0));
+            pool.submit (&destination, jobs.back ());
+        }
+        //  The destructor waits for the queue to drain.
+    }
+
+    for (size_t i = 0; i != jobs.size (); i++) {
+        TEST_ASSERT_EQUAL_INT (1, jobs[i]->executed);
+        delete jobs[i];
+    }
+}
+
+void test_cancel ()
+{
+    zmq::atomic_counter_t running;
+    test_job_t job (&running, 0);
+    TEST_ASSERT_FALSE (job.cancelled ());
+    job.cancel ();
+    TEST_ASSERT_TRUE (job.cancelled ());
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_jobs_executed_once);
+    RUN_TEST (test_jobs_run_in_parallel);
+    RUN_TEST (test_stop_runs_queued_jobs);
+    RUN_TEST (test_cancel);
+    return UNITY_END ();
+}
@@ -8,6 +8,7 @@
 #endif
 
 #include <curve_mechanism_base.hpp>
+#include <decoder_allocators.hpp>
 #include <msg.hpp>
 #include <random.hpp>
 
@@ -23,7 +24,29 @@ void tearDown ()
 {
 }
 
-void test_roundtrip (zmq::msg_t *msg_)
+#ifdef ZMQ_HAVE_CURVE
+//  Moves the message into a buffer of the allocator the way v2_decoder_t
+//  constructs the messages it reads.
+static void move_to_decoder_buffer (
+  zmq::shared_message_memory_allocator *allocator_, zmq::msg_t *msg_)
+{
+    unsigned char *const data = allocator_->allocate ();
+    TEST_ASSERT_NOT_NULL (data);
+    TEST_ASSERT_LESS_OR_EQUAL (allocator_->size (), msg_->size ());
+    memcpy (data, msg_->data (), msg_->size ());
+
+    const size_t size = msg_->size ();
+    TEST_ASSERT_SUCCESS_ERRNO (msg_->close ());
+    TEST_ASSERT_SUCCESS_ERRNO (msg_->init (
+      data, size, zmq::shared_message_memory_allocator::call_dec_ref,
+      allocator_->buffer (), allocator_->provide_content ()));
+    TEST_ASSERT_TRUE (msg_->is_zcmsg ());
+    allocator_->advance_content ();
+    allocator_->inc_ref ();
+}
+#endif
+
+void test_roundtrip (zmq::msg_t *msg_, bool in_decoder_buffer_ = false)
 {
 #ifdef ZMQ_HAVE_CURVE
     const std::vector<uint8_t> original (static_cast<uint8_t *> (msg_->data ()),
@@ -56,6 +79,11 @@ void test_roundtrip (zmq::msg_t *msg_)
 
     TEST_ASSERT_SUCCESS_ERRNO (encoding_client.encode (msg_));
 
+    zmq::shared_message_memory_allocator allocator (8192);
+    if (in_decoder_buffer_)
+        move_to_decoder_buffer (&allocator, msg_);
+    const uint8_t *const encoded = static_cast<uint8_t *> (msg_->data ());
+
     // TODO: This is hacky...
     encoding_server.set_peer_nonce (0);
     int error_event_code;
@@ -67,6 +95,11 @@ void test_roundtrip (zmq::msg_t *msg_)
         TEST_ASSERT_EQUAL_UINT8_ARRAY (&original[0], msg_->data (),
                                        original.size ());
     }
+
+    //  The payload is left where it was decrypted, after the command
+    //  name, the nonce, the MAC and the flags.
+    if (in_decoder_buffer_)
+        TEST_ASSERT_EQUAL_PTR (encoded + 8 + 8 + 16 + 1, msg_->data ());
 #endif
 }
 
@@ -114,6 +147,23 @@ void test_roundtrip_large ()
     msg.close ();
 }
 
+void test_roundtrip_large_in_decoder_buffer ()
+{
+#ifndef ZMQ_HAVE_CURVE
+    TEST_IGNORE_MESSAGE ("CURVE support is disabled");
+#endif
+    zmq::msg_t msg;
+    msg.init_size (2048);
+    for (size_t pos = 0; pos < 2048; pos += 32) {
+        memcpy (static_cast<char *> (msg.data ()) + pos,
+                "0123456789ABCDEF0123456789ABCDEF", 32);
+    }
+
+    test_roundtrip (&msg, true);
+
+    msg.close ();
+}
+
 void test_roundtrip_empty_more ()
 {
 #ifndef ZMQ_HAVE_CURVE
@@ -139,6 +189,7 @@ int main ()
     RUN_TEST (test_roundtrip_empty);
     RUN_TEST (test_roundtrip_small);
     RUN_TEST (test_roundtrip_large);
+    RUN_TEST (test_roundtrip_large_in_decoder_buffer);
 
     RUN_TEST (test_roundtrip_empty_more);
 
@@ -0,0 +1,152 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <group_table.hpp>
+
+#include <unity.h>
+
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <string.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+typedef zmq::group_table_t<int> table_t;
+
+void test_empty ()
+{
+    table_t table;
+    TEST_ASSERT_TRUE (table.empty ());
+    TEST_ASSERT_NULL (table.find (""));
+    TEST_ASSERT_NULL (table.find ("group"));
+    TEST_ASSERT_FALSE (table.erase ("group"));
+    TEST_ASSERT_FALSE (table.begin () != table.end ());
+}
+
+void test_insert_find_erase ()
+{
+    table_t table;
+    std::pair<int *, bool> res = table.insert ("group");
+    TEST_ASSERT_TRUE (res.second);
+    TEST_ASSERT_EQUAL_INT (0, *res.first);
+    *res.first = 42;
+
+    res = table.insert ("group");
+    TEST_ASSERT_FALSE (res.second);
+    TEST_ASSERT_EQUAL_INT (42, *res.first);
+    TEST_ASSERT_EQUAL_UINT (1, table.size ());
+
+    //  Prefixes and extensions are other groups.
+    TEST_ASSERT_NULL (table.find ("grou"));
+    TEST_ASSERT_NULL (table.find ("groups"));
+    TEST_ASSERT_NULL (table.find (""));
+    TEST_ASSERT_EQUAL_INT (42, *table.find ("group"));
+
+    table_t::iterator it = table.begin ();
+    TEST_ASSERT_EQUAL_STRING ("group", it.group ());
+    TEST_ASSERT_EQUAL_INT (42, it.value ());
+    TEST_ASSERT_FALSE (++it != table.end ());
+
+    TEST_ASSERT_TRUE (table.erase ("group"));
+    TEST_ASSERT_FALSE (table.erase ("group"));
+    TEST_ASSERT_NULL (table.find ("group"));
+    TEST_ASSERT_TRUE (table.empty ());
+}
+
+//  Groups up to ZMQ_GROUP_MAX_LENGTH are stored whole, and differ from the
+//  groups they are a prefix of.
+void test_long_groups ()
+{
+    table_t table;
+    char group[ZMQ_GROUP_MAX_LENGTH + 1];
+    for (int length = ZMQ_GROUP_MAX_LENGTH; length >= 0; length--) {
+        memset (group, 'g', length);
+        group[length] = '\0';
+        *table.insert (group).first = length;
+    }
+    TEST_ASSERT_EQUAL_UINT (ZMQ_GROUP_MAX_LENGTH + 1, table.size ());
+
+    for (int length = 0; length <= ZMQ_GROUP_MAX_LENGTH; length++) {
+        memset (group, 'g', length);
+        group[length] = '\0';
+        TEST_ASSERT_EQUAL_INT (length, *table.find (group));
+    }
+
+    for (table_t::iterator it = table.begin (), end = table.end (); it != end;
+         ++it)
+        TEST_ASSERT_EQUAL_INT (it.value (), strlen (it.group ()));
+}
+
+//  Grows the table well past its initial size, then removes groups in an
+//  order unrelated to their slots, checking against a std::map.
+void test_against_map ()
+{
+    table_t table;
+    std::map<std::string, int> expected;
+    const int count = 5000;
+    char group[32];
+
+    for (int i = 0; i < count; i++) {
+        sprintf (group, "group-%d", i * 7919 % count);
+        *table.insert (group).first = i;
+        expected[group] = i;
+    }
+    TEST_ASSERT_EQUAL_UINT (expected.size (), table.size ());
+
+    for (int i = 0; i < count; i++) {
+        if (i % 3 == 0)
+            continue;
+        sprintf (group, "group-%d", i);
+        TEST_ASSERT_TRUE (table.erase (group));
+        expected.erase (group);
+    }
+    TEST_ASSERT_EQUAL_UINT (expected.size (), table.size ());
+
+    for (int i = 0; i < count; i++) {
+        sprintf (group, "group-%d", i);
+        const int *value = table.find (group);
+        const std::map<std::string, int>::const_iterator it =
+          expected.find (group);
+        if (it == expected.end ()) {
+            TEST_ASSERT_NULL (value);
+        } else {
+            TEST_ASSERT_NOT_NULL (value);
+            TEST_ASSERT_EQUAL_INT (it->second, *value);
+        }
+    }
+
+    size_t walked = 0;
+    for (table_t::iterator it = table.begin (), end = table.end (); it != end;
+         ++it) {
+        TEST_ASSERT_EQUAL_INT (expected[it.group ()], it.value ());
+        walked++;
+    }
+    TEST_ASSERT_EQUAL_UINT (expected.size (), walked);
+
+    //  Shrink down to nothing.
+    for (int i = 0; i < count; i += 3) {
+        sprintf (group, "group-%d", i);
+        TEST_ASSERT_TRUE (table.erase (group));
+    }
+    TEST_ASSERT_TRUE (table.empty ());
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_empty);
+    RUN_TEST (test_insert_find_erase);
+    RUN_TEST (test_long_groups);
+    RUN_TEST (test_against_map);
+
+    return UNITY_END ();
+}
@@ -0,0 +1,166 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <mailbox.hpp>
+#include <mpsc_queue.hpp>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+void test_queue_read_empty ()
+{
+    zmq::mpsc_queue_t<int> queue;
+    int value = -1;
+    TEST_ASSERT_FALSE (queue.read (&value));
+    TEST_ASSERT_EQUAL_INT (-1, value);
+}
+
+void test_queue_write_and_read ()
+{
+    zmq::mpsc_queue_t<int> queue;
+    for (int i = 0; i < 3; i++)
+        queue.write (i);
+
+    int value;
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE (queue.read (&value));
+        TEST_ASSERT_EQUAL_INT (i, value);
+    }
+    TEST_ASSERT_FALSE (queue.read (&value));
+}
+
+void test_queue_destroy_unread ()
+{
+    zmq::mpsc_queue_t<int> queue;
+    queue.write (1);
+    queue.write (2);
+}
+
+void test_queue_grow ()
+{
+    //  Far more items than the first chunk holds, twice, so that the
+    //  second round runs on recycled nodes.
+    zmq::mpsc_queue_t<int> queue;
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 1000; i++)
+            queue.write (i);
+
+        int value;
+        for (int i = 0; i < 1000; i++) {
+            TEST_ASSERT_TRUE (queue.read (&value));
+            TEST_ASSERT_EQUAL_INT (i, value);
+        }
+        TEST_ASSERT_FALSE (queue.read (&value));
+    }
+}
+
+static zmq::command_t make_command (size_t sender_, uint64_t sequence_)
+{
+    zmq::command_t cmd;
+    cmd.destination = reinterpret_cast<zmq::object_t *> (sender_ + 1);
+    cmd.type = zmq::command_t::activate_write;
+    cmd.args.activate_write.msgs_read = sequence_;
+    return cmd;
+}
+
+void test_recv_empty ()
+{
+    zmq::mailbox_t mailbox;
+    zmq::command_t cmd;
+    TEST_ASSERT_EQUAL_INT (-1, mailbox.recv (&cmd, 0));
+    TEST_ASSERT_EQUAL_INT (EAGAIN, errno);
+}
+
+void test_send_and_recv ()
+{
+    zmq::mailbox_t mailbox;
+    for (uint64_t i = 0; i < 5; i++)
+        mailbox.send (make_command (0, i));
+
+    zmq::command_t cmd;
+    for (uint64_t i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_INT (0, mailbox.recv (&cmd, 0));
+        TEST_ASSERT_EQUAL_UINT64 (i, cmd.args.activate_write.msgs_read);
+    }
+    TEST_ASSERT_EQUAL_INT (-1, mailbox.recv (&cmd, 0));
+
+    //  The mailbox must wake up again after running dry.
+    mailbox.send (make_command (0, 5));
+    TEST_ASSERT_EQUAL_INT (0, mailbox.recv (&cmd, 0));
+    TEST_ASSERT_EQUAL_UINT64 (5, cmd.args.activate_write.msgs_read);
+}
+
+void test_destroy_unread ()
+{
+    zmq::mailbox_t mailbox;
+    zmq::command_t cmd;
+    mailbox.send (make_command (0, 0));
+    mailbox.send (make_command (0, 1));
+    TEST_ASSERT_EQUAL_INT (0, mailbox.recv (&cmd, 0));
+    mailbox.send (make_command (0, 2));
+}
+
+static const size_t sender_count = 8;
+static const uint64_t commands_per_sender = 20000;
+
+static void send_commands (void *arg_)
+{
+    zmq::mailbox_t *mailbox = static_cast<zmq::mailbox_t *> (arg_);
+
+    //  Senders identify themselves by the order they got started in.
+    static zmq::atomic_counter_t next_sender (0);
+    const size_t sender = next_sender.add (1) % sender_count;
+
+    for (uint64_t i = 0; i < commands_per_sender; i++)
+        mailbox->send (make_command (sender, i));
+}
+
+void test_many_senders ()
+{
+    zmq::mailbox_t mailbox;
+    void *threads[sender_count];
+    for (size_t i = 0; i < sender_count; i++)
+        threads[i] = zmq_threadstart (send_commands, &mailbox);
+
+    //  Commands of every sender arrive in order, interleaved arbitrarily
+    //  with the others.
+    uint64_t expected[sender_count] = {0};
+    zmq::command_t cmd;
+    for (uint64_t received = 0; received < sender_count * commands_per_sender;
+         received++) {
+        TEST_ASSERT_EQUAL_INT (0, mailbox.recv (&cmd, -1));
+        const size_t sender = reinterpret_cast<size_t> (cmd.destination) - 1;
+        TEST_ASSERT_LESS_THAN (sender_count, sender);
+        TEST_ASSERT_EQUAL_UINT64 (expected[sender],
+                                  cmd.args.activate_write.msgs_read);
+        expected[sender]++;
+    }
+    TEST_ASSERT_EQUAL_INT (-1, mailbox.recv (&cmd, 0));
+
+    for (size_t i = 0; i < sender_count; i++)
+        zmq_threadclose (threads[i]);
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_queue_read_empty);
+    RUN_TEST (test_queue_write_and_read);
+    RUN_TEST (test_queue_destroy_unread);
+    RUN_TEST (test_queue_grow);
+    RUN_TEST (test_recv_empty);
+    RUN_TEST (test_send_and_recv);
+    RUN_TEST (test_destroy_unread);
+    RUN_TEST (test_many_senders);
+
+    return UNITY_END ();
+}
@@ -0,0 +1,99 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <msg_allocator.hpp>
+
+#include <unity.h>
+
+#include <set>
+#include <vector>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+//  All CPUs belong to the second of two nodes, so that the allocating
+//  thread is on it wherever it runs.
+static std::vector<int> second_node_only ()
+{
+    return std::vector<int> (4096, 1);
+}
+
+static int expected_node ()
+{
+#if defined ZMQ_HAVE_LINUX && defined ZMQ_HAVE_SCHED_GETCPU
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void test_allocates_on_current_node ()
+{
+    zmq::heap_msg_allocator_t backend;
+    zmq::numa_msg_pool_t pool (&backend, second_node_only ());
+
+    //  Pooled sizes, and one too large for the pool.
+    const size_t sizes[] = {1, 100, 1000, 60000, 100000};
+    for (size_t i = 0; i != sizeof sizes / sizeof sizes[0]; i++) {
+        unsigned char *data =
+          static_cast<unsigned char *> (pool.allocate (sizes[i]));
+        TEST_ASSERT_NOT_NULL (data);
+        data[0] = data[sizes[i] - 1] = 0xff;
+        TEST_ASSERT_EQUAL_INT (expected_node (),
+                               zmq::msg_pool_t::node_of (data));
+        pool.deallocate (data);
+    }
+    pool.deallocate (NULL);
+}
+
+void test_recycles_within_node ()
+{
+    zmq::heap_msg_allocator_t backend;
+    zmq::numa_msg_pool_t pool (&backend, second_node_only ());
+
+    std::vector<void *> blocks;
+    for (int i = 0; i != 100; i++)
+        blocks.push_back (pool.allocate (200));
+    const std::set<void *> allocated (blocks.begin (), blocks.end ());
+    TEST_ASSERT_EQUAL_UINT (blocks.size (), allocated.size ());
+
+    //  Released blocks come back from the pool of the same node.
+    for (size_t i = 0; i != blocks.size (); i++)
+        pool.deallocate (blocks[i]);
+    for (size_t i = 0; i != blocks.size (); i++) {
+        blocks[i] = pool.allocate (200);
+        TEST_ASSERT_TRUE (allocated.count (blocks[i]) == 1);
+    }
+    for (size_t i = 0; i != blocks.size (); i++)
+        pool.deallocate (blocks[i]);
+}
+
+void test_cpu_nodes ()
+{
+    //  Either nothing, on machines with a single node, or the node of every
+    //  CPU, with at least two nodes among them.
+    const std::vector<int> cpu_nodes = zmq::numa_msg_pool_t::cpu_nodes ();
+    std::set<int> nodes;
+    for (size_t i = 0; i != cpu_nodes.size (); i++) {
+        TEST_ASSERT_TRUE (cpu_nodes[i] >= 0);
+        nodes.insert (cpu_nodes[i]);
+    }
+    TEST_ASSERT_TRUE (cpu_nodes.empty () || nodes.size () >= 2);
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_allocates_on_current_node);
+    RUN_TEST (test_recycles_within_node);
+    RUN_TEST (test_cpu_nodes);
+
+    return UNITY_END ();
+}
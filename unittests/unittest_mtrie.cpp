@@ -10,6 +10,9 @@
 
 #include <unity.h>
 
+#include <algorithm>
+#include <vector>
+
 void setUp ()
 {
 }
@@ -428,6 +431,79 @@ void test_rm_with_callback_duplicate_uniq_only ()
     mtrie.rm (&pipes[1], check_count, &count, true);
 }
 
+void mtrie_collect (int *pipe_, std::vector<int *> *pipes_)
+{
+    pipes_->push_back (pipe_);
+}
+
+void test_match_pipe_in_several_prefixes_once ()
+{
+    int pipes[3];
+    zmq::generic_mtrie_t<int> mtrie;
+    const char *names[] = {"", "f", "foo", "foobar"};
+
+    for (size_t i = 0; i < sizeof names / sizeof names[0]; ++i) {
+        const zmq::generic_mtrie_t<int>::prefix_t name_data =
+          reinterpret_cast<zmq::generic_mtrie_t<int>::prefix_t> (names[i]);
+        mtrie.add (name_data, getlen (name_data), &pipes[0]);
+        mtrie.add (name_data, getlen (name_data), &pipes[i % 2 + 1]);
+    }
+
+    const zmq::generic_mtrie_t<int>::prefix_t data =
+      reinterpret_cast<zmq::generic_mtrie_t<int>::prefix_t> ("foobaz");
+    std::vector<int *> matched;
+    mtrie.match (data, getlen (data), mtrie_collect, &matched);
+    TEST_ASSERT_EQUAL_INT (3, matched.size ());
+    std::sort (matched.begin (), matched.end ());
+    for (int i = 0; i < 3; ++i)
+        TEST_ASSERT_EQUAL_PTR (&pipes[i], matched[i]);
+
+    //  Matching again finds the same pipes, nothing is left over.
+    matched.clear ();
+    mtrie.match (data, getlen (data), mtrie_collect, &matched);
+    TEST_ASSERT_EQUAL_INT (3, matched.size ());
+}
+
+void count_removed (zmq::generic_mtrie_t<int>::prefix_t data_,
+                    size_t len_,
+                    int *count_)
+{
+    ++(*count_);
+}
+
+void test_match_many_pipes_after_rm ()
+{
+    const int pipe_count = 300;
+    int pipes[pipe_count];
+    zmq::generic_mtrie_t<int> mtrie;
+    const zmq::generic_mtrie_t<int>::prefix_t prefix =
+      reinterpret_cast<zmq::generic_mtrie_t<int>::prefix_t> ("a");
+    const zmq::generic_mtrie_t<int>::prefix_t data =
+      reinterpret_cast<zmq::generic_mtrie_t<int>::prefix_t> ("ab");
+
+    for (int i = 0; i < pipe_count; ++i) {
+        mtrie.add (prefix, getlen (prefix), &pipes[i]);
+        if (i % 3 == 0)
+            mtrie.add (data, getlen (data), &pipes[i]);
+    }
+
+    //  Remove every other pipe, then add them back so they reuse the
+    //  ids freed, in a different order.
+    int count = 0;
+    for (int i = 0; i < pipe_count; i += 2)
+        mtrie.rm (&pipes[i], count_removed, &count, false);
+    TEST_ASSERT_EQUAL_INT (pipe_count / 2 + pipe_count / 6, count);
+    for (int i = pipe_count - 2; i >= 0; i -= 2)
+        mtrie.add (data, getlen (data), &pipes[i]);
+
+    std::vector<int *> matched;
+    mtrie.match (data, getlen (data), mtrie_collect, &matched);
+    TEST_ASSERT_EQUAL_INT (pipe_count, matched.size ());
+    std::sort (matched.begin (), matched.end ());
+    for (int i = 0; i < pipe_count; ++i)
+        TEST_ASSERT_EQUAL_PTR (&pipes[i], matched[i]);
+}
+
 int main (void)
 {
     setup_test_environment ();
@@ -460,5 +536,8 @@ int main (void)
     RUN_TEST (test_rm_with_callback_duplicate);
     RUN_TEST (test_rm_with_callback_duplicate_uniq_only);
 
+    RUN_TEST (test_match_pipe_in_several_prefixes_once);
+    RUN_TEST (test_match_many_pipes_after_rm);
+
     return UNITY_END ();
 }
@@ -0,0 +1,254 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+#include "../tests/testutil_unity.hpp"
+
+#include <ctx.hpp>
+#include <own.hpp>
+#include <resolver.hpp>
+#include <tcp_address.hpp>
+
+#include <unity.h>
+
+#include <string.h>
+#include <vector>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+static const char host_name[] = "host.zeromq.org:5555";
+static const char unknown_name[] = "unknown.zeromq.org:5555";
+
+//  Requester the replies are addressed to.
+class test_destination_t ZMQ_FINAL : public zmq::own_t
+{
+  public:
+    test_destination_t (zmq::ctx_t *ctx_) : own_t (ctx_, 0) {}
+};
+
+//  Resolver with the system resolver stubbed out by a fixed table, which
+//  collects the replies instead of sending them.
+class test_resolver_t ZMQ_FINAL : public zmq::resolver_t
+{
+  public:
+    test_resolver_t (zmq::ctx_t *ctx_, int ttl_, int negative_ttl_) :
+        resolver_t (ctx_, ttl_, negative_ttl_), _lookups (0), _held (false)
+    {
+    }
+
+    ~test_resolver_t ()
+    {
+        stop ();
+        for (size_t i = 0; i != _addresses.size (); i++)
+            delete _addresses[i];
+    }
+
+    //  While held, lookups wait to be released.
+    void hold (bool held_)
+    {
+        zmq::scoped_lock_t locker (_sync);
+        _held = held_;
+    }
+
+    int lookups ()
+    {
+        zmq::scoped_lock_t locker (_sync);
+        return _lookups;
+    }
+
+    //  Waits until there are 'count_' replies, returning the last one.
+    const zmq::tcp_address_t *wait_for_replies (size_t count_, int *error_)
+    {
+        while (true) {
+            {
+                zmq::scoped_lock_t locker (_sync);
+                if (_addresses.size () >= count_) {
+                    TEST_ASSERT_EQUAL_UINT (count_, _addresses.size ());
+                    *error_ = _errors.back ();
+                    return _addresses.back ();
+                }
+            }
+            msleep (1);
+        }
+    }
+
+  protected:
+    int resolve_name (zmq::tcp_address_t *address_,
+                      const char *name_,
+                      bool ipv6_) ZMQ_FINAL
+    {
+        while (true) {
+            {
+                zmq::scoped_lock_t locker (_sync);
+                if (!_held) {
+                    _lookups++;
+                    break;
+                }
+            }
+            msleep (1);
+        }
+
+        if (strcmp (name_, host_name) == 0)
+            return address_->resolve (ipv6_ ? "[fdf5:d058:d656::1]:5555"
+                                            : "10.100.0.1:5555",
+                                      false, ipv6_, false);
+        errno = EINVAL;
+        return -1;
+    }
+
+    void
+    reply (zmq::own_t *, zmq::tcp_address_t *address_, int error_) ZMQ_FINAL
+    {
+        zmq::scoped_lock_t locker (_sync);
+        _addresses.push_back (address_);
+        _errors.push_back (error_);
+    }
+
+  private:
+    zmq::mutex_t _sync;
+    int _lookups;
+    bool _held;
+    std::vector<zmq::tcp_address_t *> _addresses;
+    std::vector<int> _errors;
+};
+
+static void validate_address (const zmq::tcp_address_t *address_,
+                              const char *expected_)
+{
+    TEST_ASSERT_NOT_NULL (address_);
+    std::string actual;
+    TEST_ASSERT_SUCCESS_ERRNO (address_->to_string (actual));
+    TEST_ASSERT_EQUAL_STRING (expected_, actual.c_str ());
+}
+
+void test_resolve_then_cached ()
+{
+    zmq::ctx_t ctx;
+    test_destination_t destination (&ctx);
+    test_resolver_t resolver (&ctx, 1000, 1000);
+
+    zmq::tcp_address_t address;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, resolver.resolve (&destination, host_name, false, &address));
+    int error;
+    validate_address (resolver.wait_for_replies (1, &error),
+                      "tcp://10.100.0.1:5555");
+    TEST_ASSERT_EQUAL_INT (0, error);
+
+    //  The second time around, the address comes from the cache.
+    TEST_ASSERT_SUCCESS_ERRNO (
+      resolver.resolve (&destination, host_name, false, &address));
+    validate_address (&address, "tcp://10.100.0.1:5555");
+    TEST_ASSERT_EQUAL_INT (1, resolver.lookups ());
+}
+
+void test_ipv6_cached_separately ()
+{
+    zmq::ctx_t ctx;
+    test_destination_t destination (&ctx);
+    test_resolver_t resolver (&ctx, 1000, 1000);
+
+    zmq::tcp_address_t address;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, resolver.resolve (&destination, host_name, false, &address));
+    int error;
+    resolver.wait_for_replies (1, &error);
+
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, resolver.resolve (&destination, host_name, true, &address));
+    validate_address (resolver.wait_for_replies (2, &error),
+                      "tcp://[fdf5:d058:d656::1]:5555");
+    TEST_ASSERT_EQUAL_INT (2, resolver.lookups ());
+}
+
+void test_failure_cached ()
+{
+    zmq::ctx_t ctx;
+    test_destination_t destination (&ctx);
+    test_resolver_t resolver (&ctx, 1000, 1000);
+
+    zmq::tcp_address_t address;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, resolver.resolve (&destination, unknown_name, false, &address));
+    int error;
+    TEST_ASSERT_NULL (resolver.wait_for_replies (1, &error));
+    TEST_ASSERT_EQUAL_INT (EINVAL, error);
+
+    TEST_ASSERT_FAILURE_ERRNO (
+      EINVAL, resolver.resolve (&destination, unknown_name, false, &address));
+    TEST_ASSERT_EQUAL_INT (1, resolver.lookups ());
+}
+
+void test_expiry ()
+{
+    zmq::ctx_t ctx;
+    test_destination_t destination (&ctx);
+    test_resolver_t resolver (&ctx, 20, 20);
+
+    zmq::tcp_address_t address;
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, resolver.resolve (&destination, host_name, false, &address));
+    int error;
+    resolver.wait_for_replies (1, &error);
+
+    msleep (50);
+    TEST_ASSERT_FAILURE_ERRNO (
+      EAGAIN, resolver.resolve (&destination, host_name, false, &address));
+    resolver.wait_for_replies (2, &error);
+    TEST_ASSERT_EQUAL_INT (2, resolver.lookups ());
+}
+
+void test_caching_disabled ()
+{
+    zmq::ctx_t ctx;
+    test_destination_t destination (&ctx);
+    test_resolver_t resolver (&ctx, 0, 0);
+
+    zmq::tcp_address_t address;
+    int error;
+    for (size_t i = 1; i <= 3; i++) {
+        TEST_ASSERT_FAILURE_ERRNO (
+          EAGAIN, resolver.resolve (&destination, host_name, false, &address));
+        resolver.wait_for_replies (i, &error);
+    }
+    TEST_ASSERT_EQUAL_INT (3, resolver.lookups ());
+}
+
+void test_queued_requests_share_lookup ()
+{
+    zmq::ctx_t ctx;
+    test_destination_t destination (&ctx);
+    test_resolver_t resolver (&ctx, 1000, 1000);
+
+    //  While the first lookup is in progress, more requests for the same
+    //  name queue up behind it.
+    resolver.hold (true);
+    zmq::tcp_address_t address;
+    for (int i = 0; i < 10; i++)
+        TEST_ASSERT_FAILURE_ERRNO (
+          EAGAIN, resolver.resolve (&destination, host_name, false, &address));
+    resolver.hold (false);
+
+    int error;
+    validate_address (resolver.wait_for_replies (10, &error),
+                      "tcp://10.100.0.1:5555");
+    TEST_ASSERT_EQUAL_INT (1, resolver.lookups ());
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_resolve_then_cached);
+    RUN_TEST (test_ipv6_cached_separately);
+    RUN_TEST (test_failure_cached);
+    RUN_TEST (test_expiry);
+    RUN_TEST (test_caching_disabled);
+    RUN_TEST (test_queued_requests_share_lookup);
+    return UNITY_END ();
+}
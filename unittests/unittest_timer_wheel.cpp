@@ -0,0 +1,209 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <timer_wheel.hpp>
+
+#include <unity.h>
+
+#include <map>
+#include <utility>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+static int owner;
+
+static zmq::timer_wheel_t::node_t *add (zmq::timer_wheel_t &wheel_,
+                                        int id_,
+                                        uint64_t expiry_,
+                                        uint64_t now_)
+{
+    zmq::timer_wheel_t::node_t *node =
+      new zmq::timer_wheel_t::node_t (&owner, id_);
+    wheel_.add (node, expiry_, now_);
+    return node;
+}
+
+//  Pops the next timer due at now_ and returns its id, or -1 if there is
+//  none.
+static int pop (zmq::timer_wheel_t &wheel_, uint64_t now_)
+{
+    zmq::timer_wheel_t::node_t *node = wheel_.pop_due (now_);
+    if (!node)
+        return -1;
+    const int id = node->id;
+    delete node;
+    return id;
+}
+
+void test_empty ()
+{
+    zmq::timer_wheel_t wheel;
+    TEST_ASSERT_TRUE (wheel.empty ());
+    TEST_ASSERT_NULL (wheel.pop_due (1000));
+    TEST_ASSERT_NULL (wheel.find (&owner, 1));
+}
+
+void test_expiry_order ()
+{
+    zmq::timer_wheel_t wheel;
+    const uint64_t start = 1000;
+
+    //  Spread over all the levels and beyond the range of the top one.
+    const uint64_t delays[] = {100000,           1,     70000,  255, 256,
+                               uint64_t (1) << 33, 20000000, 0,  5000};
+    const int count = sizeof delays / sizeof delays[0];
+    for (int i = 0; i < count; i++)
+        add (wheel, i, start + delays[i], start);
+    TEST_ASSERT_EQUAL_UINT64 (count, wheel.size ());
+
+    std::multimap<uint64_t, int> expected;
+    for (int i = 0; i < count; i++)
+        expected.insert (std::make_pair (start + delays[i], i));
+
+    for (std::multimap<uint64_t, int>::iterator it = expected.begin ();
+         it != expected.end (); ++it) {
+        TEST_ASSERT_EQUAL_UINT64 (it->first, wheel.next_expiry ());
+        TEST_ASSERT_EQUAL_INT (-1, pop (wheel, it->first - 1));
+        TEST_ASSERT_EQUAL_INT (it->second, pop (wheel, it->first));
+    }
+    TEST_ASSERT_TRUE (wheel.empty ());
+}
+
+void test_same_expiry_in_order ()
+{
+    zmq::timer_wheel_t wheel;
+    for (int i = 0; i < 10; i++)
+        add (wheel, i, 70000, 0);
+    for (int i = 0; i < 10; i++)
+        TEST_ASSERT_EQUAL_INT (i, pop (wheel, 80000));
+    TEST_ASSERT_EQUAL_INT (-1, pop (wheel, 80000));
+}
+
+void test_past_expiry ()
+{
+    zmq::timer_wheel_t wheel;
+    add (wheel, 1, 500, 1000);
+    TEST_ASSERT_EQUAL_INT (1, pop (wheel, 1000));
+
+    //  A timer expiring before the wheel's current tick is due at once.
+    add (wheel, 2, 2000, 1000);
+    TEST_ASSERT_EQUAL_INT (-1, pop (wheel, 1500));
+    add (wheel, 3, 1200, 1500);
+    TEST_ASSERT_EQUAL_UINT64 (1200, wheel.next_expiry ());
+    TEST_ASSERT_EQUAL_INT (3, pop (wheel, 1500));
+    TEST_ASSERT_EQUAL_INT (2, pop (wheel, 2000));
+}
+
+void test_find_and_remove ()
+{
+    zmq::timer_wheel_t wheel;
+    int other_owner;
+    zmq::timer_wheel_t::node_t *first = add (wheel, 1, 100, 0);
+    zmq::timer_wheel_t::node_t *second = add (wheel, 2, 300000, 0);
+    zmq::timer_wheel_t::node_t *third =
+      new zmq::timer_wheel_t::node_t (&other_owner, 1);
+    wheel.add (third, 50, 0);
+
+    TEST_ASSERT_EQUAL_PTR (first, wheel.find (&owner, 1));
+    TEST_ASSERT_EQUAL_PTR (second, wheel.find (&owner, 2));
+    TEST_ASSERT_EQUAL_PTR (third, wheel.find (&other_owner, 1));
+    TEST_ASSERT_NULL (wheel.find (&owner, 3));
+    TEST_ASSERT_EQUAL_UINT64 (50, wheel.next_expiry ());
+
+    wheel.remove (third);
+    delete third;
+    TEST_ASSERT_NULL (wheel.find (&other_owner, 1));
+    TEST_ASSERT_EQUAL_UINT64 (100, wheel.next_expiry ());
+
+    wheel.remove (first);
+    delete first;
+    TEST_ASSERT_EQUAL_UINT64 (300000, wheel.next_expiry ());
+    TEST_ASSERT_EQUAL_INT (-1, pop (wheel, 299999));
+    TEST_ASSERT_EQUAL_INT (2, pop (wheel, 300000));
+
+    //  Timers left in the wheel are deleted with it.
+    add (wheel, 4, 400000, 300000);
+}
+
+//  Adds, cancels and expires many timers and checks the wheel against a
+//  multimap.
+void test_against_multimap ()
+{
+    zmq::timer_wheel_t wheel;
+    std::multimap<uint64_t, int> expected;
+    std::map<int, uint64_t> expiries;
+
+    uint32_t random = 1;
+    uint64_t now = 0;
+    int next_id = 0;
+    for (int step = 0; step < 20000; step++) {
+        random = random * 1103515245 + 12345;
+        const uint32_t value = random >> 8;
+
+        if (value % 4 != 0 || expiries.empty ()) {
+            //  Delays cover every level.
+            const uint64_t delay = (value % 5 == 0) ? value % 100000000
+                                                    : value % 3000;
+            add (wheel, next_id, now + delay, now);
+            expected.insert (std::make_pair (now + delay, next_id));
+            expiries[next_id] = now + delay;
+            next_id++;
+        } else {
+            std::map<int, uint64_t>::iterator victim =
+              expiries.lower_bound (static_cast<int> (value % next_id));
+            if (victim == expiries.end ())
+                victim = expiries.begin ();
+            zmq::timer_wheel_t::node_t *node = wheel.find (&owner, victim->first);
+            TEST_ASSERT_NOT_NULL (node);
+            TEST_ASSERT_EQUAL_UINT64 (victim->second, node->expiry ());
+            wheel.remove (node);
+            delete node;
+            std::multimap<uint64_t, int>::iterator it =
+              expected.find (victim->second);
+            while (it->second != victim->first)
+                ++it;
+            expected.erase (it);
+            expiries.erase (victim);
+        }
+
+        now += value % 7;
+        if (!expected.empty ())
+            TEST_ASSERT_EQUAL_UINT64 (expected.begin ()->first,
+                                      wheel.next_expiry ());
+
+        zmq::timer_wheel_t::node_t *node;
+        while ((node = wheel.pop_due (now)) != NULL) {
+            TEST_ASSERT_FALSE (expected.empty ());
+            TEST_ASSERT_LESS_OR_EQUAL_UINT64 (now, node->expiry ());
+            TEST_ASSERT_EQUAL_UINT64 (expected.begin ()->first,
+                                      node->expiry ());
+            expected.erase (expected.begin ());
+            expiries.erase (node->id);
+            delete node;
+        }
+        if (!expected.empty ())
+            TEST_ASSERT_GREATER_THAN_UINT64 (now, expected.begin ()->first);
+    }
+    TEST_ASSERT_EQUAL_UINT64 (expected.size (), wheel.size ());
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_empty);
+    RUN_TEST (test_expiry_order);
+    RUN_TEST (test_same_expiry_in_order);
+    RUN_TEST (test_past_expiry);
+    RUN_TEST (test_find_and_remove);
+    RUN_TEST (test_against_multimap);
+
+    return UNITY_END ();
+}
@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+
+#include <ws_mask.hpp>
+
+#include <unity.h>
+
+#include <string.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+static const unsigned char mask[4] = {0x12, 0x34, 0x56, 0x78};
+
+//  Masks buffers of all sizes up to a few vector widths, starting at every
+//  alignment and key offset, and compares with masking byte by byte.
+static void check_mask (bool in_place_)
+{
+    unsigned char src[160];
+    unsigned char dest[160];
+    unsigned char expected[160];
+    for (size_t i = 0; i < sizeof src; i++)
+        src[i] = static_cast<unsigned char> (i * 7 + 3);
+
+    for (size_t align = 0; align < 8; align++)
+        for (size_t offset = 0; offset < 4; offset++)
+            for (size_t size = 0; size + align <= 128; size++) {
+                for (size_t i = 0; i < size; i++)
+                    expected[i] = src[align + i] ^ mask[(offset + i) % 4];
+
+                //  Bytes past the end must remain untouched.
+                memset (dest, 0xAA, sizeof dest);
+                unsigned char *out = dest + align;
+                if (in_place_)
+                    memcpy (out, src + align, size);
+                zmq::ws_mask (out, in_place_ ? out : src + align, size, mask,
+                              offset);
+
+                if (size > 0)
+                    TEST_ASSERT_EQUAL_MEMORY (expected, out, size);
+                TEST_ASSERT_EQUAL_HEX8 (0xAA, out[size]);
+            }
+}
+
+void test_mask ()
+{
+    check_mask (false);
+}
+
+void test_mask_in_place ()
+{
+    check_mask (true);
+}
+
+void test_unmask ()
+{
+    unsigned char data[1000];
+    unsigned char original[1000];
+    for (size_t i = 0; i < sizeof data; i++)
+        original[i] = data[i] = static_cast<unsigned char> (i);
+
+    zmq::ws_mask (data, data, sizeof data, mask, 1);
+    TEST_ASSERT_EQUAL_HEX8 (original[0] ^ mask[1], data[0]);
+    zmq::ws_mask (data, data, sizeof data, mask, 1);
+    TEST_ASSERT_EQUAL_MEMORY (original, data, sizeof data);
+}
+
+int main ()
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_mask);
+    RUN_TEST (test_mask_in_place);
+    RUN_TEST (test_unmask);
+    return UNITY_END ();
+}
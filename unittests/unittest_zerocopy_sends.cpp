@@ -0,0 +1,117 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../tests/testutil.hpp"
+#include "../tests/testutil_unity.hpp"
+
+#include <zerocopy_sends.hpp>
+
+#include <unity.h>
+
+void setUp ()
+{
+}
+void tearDown ()
+{
+}
+
+//  Bodies released so far, by their first byte.
+static bool released[8];
+
+static void release (void *data_, void *)
+{
+    released[static_cast<unsigned char *> (data_)[0]] = true;
+}
+
+static unsigned char bodies[8][16];
+
+//  Adds sends whose only references are held by the sends.
+static void add_sends (zmq::zerocopy_sends_t *sends_, int count_)
+{
+    for (int i = 0; i != count_; i++) {
+        bodies[i][0] = static_cast<unsigned char> (i);
+        released[i] = false;
+        zmq::msg_t msg;
+        TEST_ASSERT_SUCCESS_ERRNO (
+          msg.init_data (bodies[i], sizeof bodies[i], release, NULL));
+        sends_->add (&msg);
+        TEST_ASSERT_SUCCESS_ERRNO (msg.close ());
+    }
+}
+
+void test_in_order ()
+{
+    zmq::zerocopy_sends_t sends;
+    add_sends (&sends, 3);
+    TEST_ASSERT_EQUAL_INT (3, sends.size ());
+
+    sends.complete (0, 0);
+    TEST_ASSERT_TRUE (released[0]);
+    TEST_ASSERT_FALSE (released[1]);
+    TEST_ASSERT_EQUAL_INT (2, sends.size ());
+
+    sends.complete (1, 2);
+    TEST_ASSERT_TRUE (released[1]);
+    TEST_ASSERT_TRUE (released[2]);
+    TEST_ASSERT_TRUE (sends.empty ());
+}
+
+void test_out_of_order ()
+{
+    zmq::zerocopy_sends_t sends;
+    add_sends (&sends, 4);
+
+    //  A body is only released once the sends before it have completed.
+    sends.complete (2, 3);
+    TEST_ASSERT_FALSE (released[2]);
+    TEST_ASSERT_FALSE (released[3]);
+    TEST_ASSERT_EQUAL_INT (4, sends.size ());
+
+    sends.complete (1, 1);
+    TEST_ASSERT_FALSE (released[1]);
+
+    sends.complete (0, 0);
+    for (int i = 0; i != 4; i++)
+        TEST_ASSERT_TRUE (released[i]);
+    TEST_ASSERT_TRUE (sends.empty ());
+}
+
+void test_ids_continue ()
+{
+    zmq::zerocopy_sends_t sends;
+    add_sends (&sends, 2);
+    sends.complete (0, 1);
+    TEST_ASSERT_TRUE (sends.empty ());
+
+    //  The kernel goes on counting where it left off.
+    add_sends (&sends, 2);
+    sends.complete (0, 1);
+    TEST_ASSERT_FALSE (released[0]);
+    sends.complete (2, 3);
+    TEST_ASSERT_TRUE (released[0]);
+    TEST_ASSERT_TRUE (released[1]);
+    TEST_ASSERT_TRUE (sends.empty ());
+}
+
+void test_release_pending ()
+{
+    {
+        zmq::zerocopy_sends_t sends;
+        add_sends (&sends, 2);
+        sends.complete (1, 1);
+        TEST_ASSERT_FALSE (released[1]);
+    }
+    TEST_ASSERT_TRUE (released[0]);
+    TEST_ASSERT_TRUE (released[1]);
+}
+
+int main (void)
+{
+    setup_test_environment ();
+
+    UNITY_BEGIN ();
+    RUN_TEST (test_in_order);
+    RUN_TEST (test_out_of_order);
+    RUN_TEST (test_ids_continue);
+    RUN_TEST (test_release_pending);
+    return UNITY_END ();
+}